@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Boot the kernel with a cpu-bound workload on 1 and 4 cpus, and print how
+# long it took on each. The workload is enabled through the "smp-bench"
+# prop of the kernel in the boot entry of the image.
+
+set -e
+
+TASKS=${TASKS:-16}
+TIMEOUT=${TIMEOUT:-300}
+
+cd "$(git rev-parse --show-toplevel)"
+
+IMAGE=$(./skift.sh image build --format=dir | tail -n 1)
+
+python3 - "$IMAGE/boot/loader.json" "$TASKS" <<'PY'
+import json, sys
+
+path, tasks = sys.argv[1], int(sys.argv[2])
+with open(path) as f:
+    loader = json.load(f)
+for entry in loader["entries"]:
+    kernel = entry["kernel"]
+    if isinstance(kernel, str):
+        kernel = {"url": kernel}
+    kernel.setdefault("props", {})["smp-bench"] = tasks
+    entry["kernel"] = kernel
+with open(path, "w") as f:
+    json.dump(loader, f, indent=4)
+PY
+
+OVMF=/usr/share/edk2/x64/OVMF.fd
+if [ ! -f "$OVMF" ]; then
+    OVMF=/usr/share/OVMF/x64/OVMF.fd
+fi
+
+ACCEL=tcg
+if [ -r /dev/kvm ]; then
+    ACCEL=kvm
+fi
+
+for SMP in 1 4; do
+    echo "== -smp $SMP ($ACCEL)"
+    timeout "$TIMEOUT" qemu-system-x86_64 \
+        -machine q35 \
+        -accel "$ACCEL" \
+        -no-reboot \
+        -display none \
+        -serial stdio \
+        -bios "$OVMF" \
+        -m 256M \
+        -smp "$SMP" \
+        -drive "file=fat:rw:$IMAGE,media=disk,format=raw" |
+        awk '/smp: |smp-bench: / { print; fflush() }
+             /smp-bench: done/ { match($0, /on [0-9]+ cpus/); cpus = substr($0, RSTART + 3, RLENGTH - 8) + 0 }
+             /smp-bench: cpu[0-9]+ completed/ { if (++seen == cpus) exit }' || true
+done
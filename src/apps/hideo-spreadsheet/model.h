@@ -13,6 +13,10 @@ struct Pos {
     usize col;
 
     auto operator<=>(Pos const&) const = default;
+
+    Hash hash() const {
+        return hashCombine(Karm::hash(row), Karm::hash(col));
+    }
 };
 
 enum struct Wheight {
@@ -68,6 +68,10 @@ struct ConOut : public Fd {
         return Ok();
     }
 
+    Res<> sync() override {
+        return Ok();
+    }
+
     Res<Rc<Fd>> dup() override {
         notImplemented();
     }
@@ -159,6 +163,10 @@ struct FileProto : public Fd {
         return Ok();
     }
 
+    Res<> sync() override {
+        return flush();
+    }
+
     Res<Rc<Fd>> dup() override {
         notImplemented();
     }
@@ -336,6 +344,10 @@ Res<Rc<Fd>> openOrCreateFile(Mime::Url const&) {
     return Error::notImplemented();
 }
 
+Res<> removeFile(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
 Res<MmapResult> memMap(MmapOptions const& options) {
     usize vaddr = 0;
 
@@ -20,7 +20,7 @@ struct EfiHost :
           _stip(stip),
           _front(front),
           _back(back) {
-        _dirty.pushBack(front.bound());
+        _damage.add(front.bound());
     }
 
     Gfx::MutPixels mutPixels() override {
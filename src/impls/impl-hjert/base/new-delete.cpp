@@ -1,5 +1,6 @@
 #include <ce-heap/libheap.h>
 #include <hjert-core/mem.h>
+#include <hjert-core/slab.h>
 #include <karm-base/lock.h>
 #include <karm-logger/logger.h>
 
@@ -30,32 +31,45 @@ static Heap _heapImpl = {
 
 // MARK: New/Delete Implementation ---------------------------------------------
 
-void* operator new(usize size) {
+// NOTE: Small objects are served by the slab caches, the heap only sees
+//       allocations too large for any size class.
+
+static void* _alloc(usize size) {
+    if (auto* ptr = Hjert::Core::slabAlloc(size))
+        return ptr;
+
     LockScope scope(_heapLock);
     return heap_calloc(&_heapImpl, size, 1);
 }
 
-void* operator new[](usize size) {
+static void _free(void* ptr) {
+    if (Hjert::Core::slabFree(ptr))
+        return;
+
     LockScope scope(_heapLock);
-    return heap_calloc(&_heapImpl, size, 1);
+    heap_free(&_heapImpl, ptr);
+}
+
+void* operator new(usize size) {
+    return _alloc(size);
+}
+
+void* operator new[](usize size) {
+    return _alloc(size);
 }
 
 void operator delete(void* ptr) {
-    LockScope scope(_heapLock);
-    heap_free(&_heapImpl, ptr);
+    _free(ptr);
 }
 
 void operator delete[](void* ptr) {
-    LockScope scope(_heapLock);
-    heap_free(&_heapImpl, ptr);
+    _free(ptr);
 }
 
 void operator delete(void* ptr, usize) {
-    LockScope scope(_heapLock);
-    heap_free(&_heapImpl, ptr);
+    _free(ptr);
 }
 
 void operator delete[](void* ptr, usize) {
-    LockScope scope(_heapLock);
-    heap_free(&_heapImpl, ptr);
+    _free(ptr);
 }
@@ -2,7 +2,7 @@
 #include <impl-posix/utils.h>
 #include <karm-async/one.h>
 #include <karm-async/promise.h>
-#include <karm-base/map.h>
+#include <karm-base/array.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/async.h>
 #include <karm-sys/time.h>
@@ -15,9 +15,41 @@
 namespace Karm::Sys::_Embed {
 
 struct EpollSched : public Sys::Sched {
+    static constexpr usize MAX_EVENTS = 64;
+
+    // The registration of a file descriptor in the epoll set, fds stay
+    // registered across operations and their interest is only modified
+    // when the set of pending waiters changes.
+    struct _Watch {
+        // The fd object that owns the registration, if it was dropped the
+        // kernel already removed the fd and its number might be reused.
+        Opt<Weak<Fd>> owner;
+        bool added = false;
+        bool dirty = false;
+        u32 interest = 0;
+        Vec<Async::Promise<>> readers;
+        Vec<Async::Promise<>> writers;
+
+        u32 wanted() const {
+            u32 events = 0;
+            if (readers.len())
+                events |= EPOLLIN;
+            if (writers.len())
+                events |= EPOLLOUT;
+            return events;
+        }
+
+        void reset() {
+            owner = NONE;
+            added = false;
+            interest = 0;
+        }
+    };
+
     int _epollFd;
-    usize _id = 0;
-    Map<usize, Async::Promise<>> _promises;
+    Vec<_Watch> _watches;
+    Vec<int> _dirty;
+    Array<epoll_event, MAX_EVENTS> _events;
 
     EpollSched(int epollFd)
         : _epollFd(epollFd) {}
@@ -26,46 +58,137 @@ struct EpollSched : public Sys::Sched {
         close(_epollFd);
     }
 
-    Async::Task<> waitFor(epoll_event ev, int fd) {
-        usize id = _id++;
+    _Watch& _watch(int fd) {
+        while (_watches.len() <= (usize)fd)
+            _watches.emplaceBack();
+        return _watches[fd];
+    }
+
+    void _markDirty(int fd) {
+        auto& watch = _watches[fd];
+        if (watch.dirty)
+            return;
+        watch.dirty = true;
+        _dirty.pushBack(fd);
+    }
+
+    // Bring the registration of an fd in sync with its waiters.
+    Res<> _sync(int fd) {
+        auto& watch = _watches[fd];
+        watch.dirty = false;
+
+        u32 wanted = watch.wanted();
+        if (watch.added and watch.interest == wanted)
+            return Ok();
+
+        if (not wanted) {
+            // The fd is idle, it is removed from the set rather than
+            // modified, since hangups are reported regardless of interest.
+            if (watch.added and ::epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr) < 0 and errno != EBADF and errno != ENOENT)
+                return Posix::fromLastErrno();
+            watch.reset();
+            return Ok();
+        }
+
+        epoll_event ev = {.events = wanted, .data = {.fd = fd}};
+        int op = watch.added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (::epoll_ctl(_epollFd, op, fd, &ev) < 0) {
+            if (op == EPOLL_CTL_MOD and errno == ENOENT)
+                op = EPOLL_CTL_ADD;
+            else if (op == EPOLL_CTL_ADD and errno == EEXIST)
+                op = EPOLL_CTL_MOD;
+            else
+                return Posix::fromLastErrno();
+
+            if (::epoll_ctl(_epollFd, op, fd, &ev) < 0)
+                return Posix::fromLastErrno();
+        }
+
+        watch.added = true;
+        watch.interest = wanted;
+        return Ok();
+    }
+
+    void _fail(int fd, Error err) {
+        auto& watch = _watches[fd];
+        auto readers = std::move(watch.readers);
+        auto writers = std::move(watch.writers);
+        watch.reset();
+
+        for (auto& p : readers)
+            p.resolve(err);
+        for (auto& p : writers)
+            p.resolve(err);
+    }
+
+    // Apply the interest changes accumulated since the last wait, waiters
+    // that cancel each other out within a tick cost no syscall.
+    void _flush() {
+        auto dirty = std::move(_dirty);
+        for (auto fd : dirty)
+            if (auto res = _sync(fd); not res)
+                _fail(fd, res.none());
+    }
+
+    Async::Task<> waitFor(u32 events, int fd, Opt<Rc<Fd>> owner = NONE) {
+        auto& watch = _watch(fd);
+
+        // A registration left behind by a dropped fd is stale, the kernel
+        // removed it when the fd was closed and its number got reused.
+        if (owner) {
+            Opt<Rc<Fd>> current = NONE;
+            if (watch.owner)
+                current = watch.owner->upgrade();
+            if (not current or &**current != &**owner) {
+                watch.reset();
+                watch.owner = Weak<Fd>{*owner};
+            }
+        } else if (watch.owner) {
+            watch.reset();
+        }
+
         auto promise = Async::Promise<>();
         auto future = promise.future();
+        if (events & EPOLLIN)
+            watch.readers.pushBack(std::move(promise));
+        else
+            watch.writers.pushBack(std::move(promise));
+        _markDirty(fd);
 
-        ev.data.u64 = id;
-        if (::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
-            return Async::makeTask(Async::One<Res<>>{Posix::fromLastErrno()});
-
-        _promises.put(id, std::move(promise));
         return Async::makeTask(future);
     }
 
+    Async::Task<> waitFor(u32 events, Rc<Fd> fd) {
+        return waitFor(events, fd->handle().value(), fd);
+    }
+
     Async::Task<usize> readAsync(Rc<Fd> fd, MutBytes buf) override {
-        co_trya$(waitFor({.events = EPOLLIN | EPOLLET, .data = {}}, fd->handle().value()));
+        co_trya$(waitFor(EPOLLIN, fd));
         co_return Ok(co_try$(fd->read(buf)));
     }
 
     Async::Task<usize> writeAsync(Rc<Fd> fd, Bytes buf) override {
-        co_trya$(waitFor({.events = EPOLLOUT | EPOLLET, .data = {}}, fd->handle().value()));
+        co_trya$(waitFor(EPOLLOUT, fd));
         co_return Ok(co_try$(fd->write(buf)));
     }
 
     Async::Task<> flushAsync(Rc<Fd> fd) override {
-        co_trya$(waitFor({.events = EPOLLOUT | EPOLLET, .data = {}}, fd->handle().value()));
+        co_trya$(waitFor(EPOLLOUT, fd));
         co_return Ok(co_try$(fd->flush()));
     }
 
     Async::Task<_Accepted> acceptAsync(Rc<Fd> fd) override {
-        co_trya$(waitFor({.events = EPOLLIN | EPOLLET, .data = {}}, fd->handle().value()));
+        co_trya$(waitFor(EPOLLIN, fd));
         co_return Ok(co_try$(fd->accept()));
     }
 
     Async::Task<_Sent> sendAsync(Rc<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr) override {
-        co_trya$(waitFor({.events = EPOLLOUT | EPOLLET, .data = {}}, fd->handle().value()));
+        co_trya$(waitFor(EPOLLOUT, fd));
         co_return Ok(co_try$(fd->send(buf, handles, addr)));
     }
 
     Async::Task<_Received> recvAsync(Rc<Fd> fd, MutBytes buf, MutSlice<Handle> hnds) override {
-        co_trya$(waitFor({.events = EPOLLIN | EPOLLET, .data = {}}, fd->handle().value()));
+        co_trya$(waitFor(EPOLLIN, fd));
         co_return Ok(co_try$(fd->recv(buf, hnds)));
     }
 
@@ -79,6 +202,12 @@ struct EpollSched : public Sys::Sched {
         if (timeFd < 0)
             co_return Posix::fromLastErrno();
         Defer defer{[&] {
+            // The timer fd is not owned by an Fd object, so its
+            // registration is dropped by hand before the number is reused.
+            auto& watch = _watch(timeFd);
+            if (watch.added)
+                ::epoll_ctl(_epollFd, EPOLL_CTL_DEL, timeFd, nullptr);
+            watch.reset();
             close(timeFd);
         }};
 
@@ -87,30 +216,59 @@ struct EpollSched : public Sys::Sched {
         if (timerfd_settime(timeFd, 0, &spec, nullptr) < 0)
             co_return Posix::fromLastErrno();
 
-        co_trya$(waitFor({.events = EPOLLIN, .data = {}}, timeFd));
+        co_trya$(waitFor(EPOLLIN, timeFd));
 
         co_return Ok();
     }
 
+    void _dispatch(epoll_event const& ev) {
+        int fd = ev.data.fd;
+        if ((usize)fd >= _watches.len())
+            return;
+
+        // Errors and hangups wake every waiter, the operation itself
+        // reports what went wrong.
+        bool failed = ev.events & (EPOLLERR | EPOLLHUP);
+        auto& watch = _watches[fd];
+
+        Vec<Async::Promise<>> readers;
+        if (ev.events & EPOLLIN or failed)
+            readers = std::move(watch.readers);
+
+        Vec<Async::Promise<>> writers;
+        if (ev.events & EPOLLOUT or failed)
+            writers = std::move(watch.writers);
+
+        _markDirty(fd);
+
+        // Resolving a promise resumes its waiter, which might register
+        // new waiters and grow the table, so no reference is kept here.
+        for (auto& p : readers)
+            p.resolve(Ok());
+        for (auto& p : writers)
+            p.resolve(Ok());
+    }
+
     Res<> wait(Instant until) override {
-        epoll_event ev;
+        _flush();
+
         auto instant = Sys::instant();
         Duration delta = Duration::zero();
         if (instant < until)
             delta = until - instant;
         int timeout = until.isEndOfTime() ? -1 : delta.toMSecs();
 
-        int n = ::epoll_wait(_epollFd, &ev, 1, timeout);
+        int n = ::epoll_wait(_epollFd, _events.buf(), MAX_EVENTS, timeout);
 
-        if (n < 0)
+        if (n < 0) {
+            if (errno == EINTR)
+                return Ok();
             return Posix::fromLastErrno();
+        }
 
-        if (n == 0)
-            return Ok();
+        for (int i = 0; i < n; i++)
+            _dispatch(_events[i]);
 
-        usize id = ev.data.u64;
-        auto promise = _promises.take(id);
-        promise.resolve(Ok());
         return Ok();
     }
 };
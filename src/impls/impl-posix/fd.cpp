@@ -60,6 +60,12 @@ Res<> Fd::flush() {
     return Ok();
 }
 
+Res<> Fd::sync() {
+    if (::fsync(_raw) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 Res<Rc<Sys::Fd>> Fd::dup() {
     isize duped = ::dup(_raw);
 
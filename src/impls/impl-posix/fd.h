@@ -22,6 +22,8 @@ struct Fd : public Sys::Fd {
 
     Res<> flush() override;
 
+    Res<> sync() override;
+
     Res<Rc<Sys::Fd>> dup() override;
 
     Res<Sys::_Accepted> accept() override;
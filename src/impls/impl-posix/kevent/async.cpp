@@ -19,7 +19,7 @@ struct DarwinSched :
 
     int _kqueue;
     usize _id = 0;
-    Map<usize, Async::Promise<>> _promises;
+    HashMap<usize, Async::Promise<>> _promises;
 
     DarwinSched(int kqueue)
         : _kqueue(kqueue) {
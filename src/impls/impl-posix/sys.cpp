@@ -135,6 +135,14 @@ Res<Rc<Fd>> openOrCreateFile(Mime::Url const& url) {
     return Ok(fd);
 }
 
+Res<> removeFile(Mime::Url const& url) {
+    String str = try$(resolve(url)).str();
+
+    if (::unlink(str.buf()) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 Res<Pair<Rc<Fd>>> createPipe() {
     int fds[2];
 
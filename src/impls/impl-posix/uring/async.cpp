@@ -3,7 +3,7 @@
 //
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
-#include <karm-async/promise.h>
+#include <karm-async/one.h>
 #include <karm-base/map.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
@@ -41,295 +41,591 @@ struct __kernel_timespec toKernelTimespec(Duration ts) {
 struct UringSched : public Sys::Sched {
     static constexpr auto NCQES = 128;
 
+    // Provided buffers that multishot receives pick from, shared by every
+    // socket. Data is copied out as soon as it comes in so they can be
+    // handed back to the kernel right away.
+    static constexpr usize BUF_COUNT = 256;
+    static constexpr usize BUF_SIZE = 4096;
+    static constexpr u16 BUF_GROUP = 0;
+
+    // Past that much data nobody asked for yet, sockets stop receiving
+    // ahead until it has been read.
+    static constexpr usize MAX_PENDING_BYTES = 64 * 1024;
+    static constexpr usize MAX_PENDING_ACCEPTS = 64;
+
+    // user_data of requests whose completion nobody cares about.
+    static constexpr u64 IGNORED = Limits<u64>::MAX;
+
     struct _Job {
+        usize _slot = 0;
+
         virtual ~_Job() = default;
-        virtual void submit(io_uring_sqe* sqe) = 0;
         virtual void complete(io_uring_cqe* cqe) = 0;
     };
 
     io_uring _ring;
-    usize _id = 1;
-    Map<usize, Rc<_Job>> _jobs;
+    Vec<MutCursor<_Job>> _slots; //< Indexed by user_data
+    Vec<usize> _freeSlots;
 
     UringSched(io_uring ring)
         : _ring(ring) {}
 
     ~UringSched() {
+        if (_bufRing)
+            io_uring_free_buf_ring(&_ring, _bufRing, BUF_COUNT, BUF_GROUP);
         io_uring_queue_exit(&_ring);
     }
 
-    void submit(Rc<_Job> job) {
-        auto id = _id++;
+    // MARK: Submission --------------------------------------------------------
+
+    usize _attach(_Job& job) {
+        usize slot;
+        if (_freeSlots.len()) {
+            slot = _freeSlots.popBack();
+        } else {
+            slot = _slots.len();
+            _slots.pushBack(nullptr);
+        }
+        _slots[slot] = &job;
+        job._slot = slot;
+        return slot;
+    }
+
+    // SQEs are only handed to the kernel in wait(), unless the submission
+    // queue fills up before that.
+    io_uring_sqe* _sqe() {
         auto* sqe = io_uring_get_sqe(&_ring);
+        if (not sqe) {
+            io_uring_submit(&_ring);
+            sqe = io_uring_get_sqe(&_ring);
+        }
         if (not sqe) [[unlikely]]
             panic("failed to get sqe");
-        _jobs.put(id, job);
-        job->submit(sqe);
-        sqe->user_data = id;
-        io_uring_submit(&_ring);
+        return sqe;
     }
 
-    Async::Task<usize> readAsync(Rc<Fd> fd, MutBytes buf) override {
-        struct Job : public _Job {
-            Rc<Fd> _fd;
-            MutBytes _buf;
-            Async::Promise<usize> _promise;
-
-            Job(Rc<Fd> fd, MutBytes buf)
-                : _fd(fd), _buf(buf) {}
-
-            void submit(io_uring_sqe* sqe) override {
-                io_uring_prep_read(
-                    sqe,
-                    _fd->handle().value(),
-                    _buf.buf(),
-                    _buf.len(),
-                    -1
-                );
-            }
+    void _cancel(usize slot) {
+        auto* sqe = _sqe();
+        io_uring_prep_cancel64(sqe, slot, 0);
+        sqe->user_data = IGNORED;
+    }
 
-            void complete(io_uring_cqe* cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok(cqe->res));
-            }
+    // Memory an SQE points to, besides the caller's buffers. It is owned
+    // by the request rather than by the coroutine that issued it, as the
+    // kernel may still read it after that coroutine is gone.
+    struct _Data {};
+
+    // Data of requests whose operation was abandoned, freed once their
+    // last CQE comes in. Indexed by user_data.
+    HashMap<usize, Rc<_Data>> _orphans;
+
+    // Completes with the result of a single CQE. The operation lives in the
+    // frame of the coroutine awaiting it, so nothing is allocated per job
+    // unless it comes with data.
+    template <typename Prep>
+    struct _Submit {
+        using Inner = i32;
+
+        UringSched& _sched;
+        Prep _prep;
+        Opt<Rc<_Data>> _data = NONE;
+
+        template <Async::Receiver<i32> R>
+        auto connect(R r) {
+            struct Operation : public _Job {
+                UringSched& _sched;
+                Prep _prep;
+                Opt<Rc<_Data>> _data;
+                R _r;
+                bool _pending = false;
+
+                Operation(UringSched& sched, Prep prep, Opt<Rc<_Data>> data, R r)
+                    : _sched(sched), _prep(std::move(prep)), _data(std::move(data)), _r(std::move(r)) {}
+
+                ~Operation() {
+                    // NOTE: Abandoned before completing, its CQE is dropped
+                    //       when it comes in, and its data with it.
+                    if (_pending) {
+                        _sched._slots[_slot] = nullptr;
+                        _sched._cancel(_slot);
+                        if (_data)
+                            _sched._orphans.put(_slot, _data.take());
+                    }
+                }
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+                bool start() {
+                    auto* sqe = _sched._sqe();
+                    _prep(sqe);
+                    sqe->user_data = _sched._attach(*this);
+                    _pending = true;
+                    return false;
+                }
+
+                void complete(io_uring_cqe* cqe) override {
+                    _pending = false;
+                    _r.recv(Async::LATER, cqe->res);
+                }
+            };
 
-        auto job = makeRc<Job>(fd, buf);
-        submit(job);
-        return Async::makeTask(job->future());
+            return Operation{_sched, std::move(_prep), std::move(_data), std::move(r)};
+        }
+    };
+
+    auto _submitAsync(auto prep) {
+        return _Submit<decltype(prep)>{*this, std::move(prep)};
     }
 
-    Async::Task<usize> writeAsync(Rc<Fd> fd, Bytes buf) override {
-        struct Job : public _Job {
-            Rc<Fd> _fd;
-            Bytes _buf;
-            Async::Promise<usize> _promise;
-
-            Job(Rc<Fd> fd, Bytes buf)
-                : _fd(fd), _buf(buf) {}
-
-            void submit(io_uring_sqe* sqe) override {
-                io_uring_prep_write(
-                    sqe,
-                    _fd->handle().value(),
-                    _buf.buf(),
-                    _buf.len(),
-                    // NOTE: On files that support seeking, if the offset is set
-                    //       to -1, the write operation commences at the file
-                    //       offset, and the file offset is incremented by
-                    //       the number of bytes written. See io_uring_prep_write(3).
-                    -1
-                );
-            }
+    template <typename D>
+    auto _submitAsync(Rc<D> data, auto prep) {
+        return _Submit<decltype(prep)>{*this, std::move(prep), Rc<_Data>{std::move(data)}};
+    }
 
-            void complete(io_uring_cqe* cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok(cqe->res));
-            }
+    struct _Timeout : public _Data {
+        __kernel_timespec ts{};
+    };
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+    struct _Addr : public _Data {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(sockaddr_in);
+    };
+
+    struct _Msg : public _Data {
+        iovec iov{};
+        sockaddr_in addr{};
+        msghdr msg{};
+
+        _Msg(void* buf, usize len, sockaddr_in addr = {})
+            : addr(addr) {
+            iov.iov_base = buf;
+            iov.iov_len = len;
+            msg.msg_name = &this->addr;
+            msg.msg_namelen = sizeof(sockaddr_in);
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+        }
+    };
 
-        auto job = makeRc<Job>(fd, buf);
-        submit(job);
-        return Async::makeTask(job->future());
+    static Res<usize> _toUsize(i32 res) {
+        if (res < 0)
+            return Posix::fromErrno(-res);
+        return Ok((usize)res);
     }
 
-    Async::Task<> flushAsync(Rc<Fd> fd) override {
-        struct Job : public _Job {
-            Rc<Fd> _fd;
-            Async::Promise<> _promise;
+    // MARK: Multishot ---------------------------------------------------------
+
+    // A socket with a multishot request that keeps producing completions
+    // until it is canceled. It only holds a weak reference to its fd, so
+    // the request is canceled once the fd is dropped, see _sweep().
+    struct _Multishot : public _Job {
+        UringSched& _sched;
+        Weak<Fd> _fd;
+        bool _armed = false;
+        bool _canceling = false;
+        bool _oneshot = false; // The request in flight is single-shot
+
+        _Multishot(UringSched& sched, Rc<Fd> fd)
+            : _sched(sched), _fd(fd) {}
 
-            Job(Rc<Fd> fd)
-                : _fd(fd) {}
+        bool alive() const {
+            return _fd.upgrade().has();
+        }
+
+        virtual void _prep(io_uring_sqe* sqe, int fd) = 0;
+
+        // Same request, but producing a single completion, for kernels
+        // without support for the multishot one.
+        virtual void _prepOnce(io_uring_sqe* sqe, int fd) = 0;
+
+        void arm(Fd& fd) {
+            if (_armed)
+                return;
+            auto* sqe = _sched._sqe();
+            _oneshot = not _sched._multishot;
+            if (_oneshot)
+                _prepOnce(sqe, fd.handle().value());
+            else
+                _prep(sqe, fd.handle().value());
+            sqe->user_data = _sched._attach(*this);
+            _armed = true;
+            _canceling = false;
+        }
 
-            void submit(io_uring_sqe* sqe) override {
-                io_uring_prep_fsync(sqe, _fd->handle().value(), 0);
+        void disarm() {
+            if (_armed and not _canceling) {
+                _sched._cancel(_slot);
+                _canceling = true;
             }
+        }
 
-            void complete(io_uring_cqe* cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok());
+        // Called once the last CQE of the request came in, may free the
+        // state if it was retired.
+        void _done() {
+            auto& retired = _sched._retired;
+            for (usize i = 0; i < retired.len(); i++) {
+                if (&*retired[i] == this) {
+                    retired.removeAt(i);
+                    return;
+                }
             }
+        }
+    };
 
-            auto future() {
-                return _promise.future();
+    // Removes an abandoned waiter from the queue of its socket.
+    template <typename T>
+    static void _forget(Vec<MutCursor<T>>& queue, T& waiter) {
+        for (usize i = 0; i < queue.len(); i++) {
+            if (&*queue[i] == &waiter) {
+                queue.removeAt(i);
+                return;
             }
+        }
+    }
+
+    struct _Acceptor : public _Multishot {
+        struct Waiter {
+            virtual ~Waiter() = default;
+            virtual void resolve(Res<_Accepted> res) = 0;
         };
 
-        auto job = makeRc<Job>(fd);
-        submit(job);
-        return Async::makeTask(job->future());
-    }
+        Vec<Res<_Accepted>> _ready;
+        Vec<MutCursor<Waiter>> _waiters;
 
-    Async::Task<_Accepted> acceptAsync(Rc<Fd> fd) override {
-        struct Job : public _Job {
-            Rc<Fd> _fd;
-            sockaddr_in _addr{};
-            unsigned _addrLen = sizeof(sockaddr_in);
-            Async::Promise<_Accepted> _promise;
+        using _Multishot::_Multishot;
 
-            Job(Rc<Fd> fd)
-                : _fd(fd) {}
+        void _prep(io_uring_sqe* sqe, int fd) override {
+            io_uring_prep_multishot_accept(sqe, fd, nullptr, nullptr, 0);
+        }
 
-            void submit(io_uring_sqe* sqe) override {
-                io_uring_prep_accept(sqe, _fd->handle().value(), (struct sockaddr*)&_addr, &_addrLen, 0);
-            }
+        void _prepOnce(io_uring_sqe* sqe, int fd) override {
+            io_uring_prep_accept(sqe, fd, nullptr, nullptr, 0);
+        }
 
-            void complete(io_uring_cqe* cqe) override {
-                auto res = cqe->res;
-                if (res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else {
-                    _Accepted accepted = {makeRc<Posix::Fd>(res), Posix::fromSockAddr(_addr)};
-                    _promise.resolve(Ok(accepted));
-                }
-            }
+        void _deliver(Res<_Accepted> res) {
+            if (_waiters.len())
+                _waiters.popFront()->resolve(std::move(res));
+            else
+                _ready.pushBack(std::move(res));
+        }
 
-            auto future() {
-                return _promise.future();
-            }
+        void complete(io_uring_cqe* cqe) override;
+    };
+
+    struct _Stream : public _Multishot {
+        struct Reader {
+            MutBytes buf;
+
+            Reader(MutBytes buf)
+                : buf(buf) {}
+
+            virtual ~Reader() = default;
+            virtual void resolve(Res<usize> res) = 0;
         };
 
-        auto job = makeRc<Job>(fd);
-        submit(job);
-        return Async::makeTask(job->future());
-    }
+        Vec<u8> _pending;
+        bool _eof = false;
+        Opt<Error> _error = NONE;
+        Vec<MutCursor<Reader>> _readers;
 
-    Async::Task<_Sent> sendAsync(Rc<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr) override {
-        if (handles.len() > 0)
-            notImplemented(); // TODO: Implement handle passing on POSIX
+        using _Multishot::_Multishot;
 
-        struct Job : public _Job {
-            Rc<Fd> _fd;
-            Bytes _buf;
-            iovec _iov;
-            msghdr _msg;
-            sockaddr_in _addr;
-            Async::Promise<_Sent> _promise;
+        void _prep(io_uring_sqe* sqe, int fd) override {
+            io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+            sqe->flags |= IOSQE_BUFFER_SELECT;
+            sqe->buf_group = BUF_GROUP;
+        }
 
-            Job(Rc<Fd> fd, Bytes buf, SocketAddr addr)
-                : _fd(fd), _buf(buf), _addr(Posix::toSockAddr(addr)) {}
+        void _prepOnce(io_uring_sqe* sqe, int fd) override {
+            io_uring_prep_recv(sqe, fd, nullptr, BUF_SIZE, 0);
+            sqe->flags |= IOSQE_BUFFER_SELECT;
+            sqe->buf_group = BUF_GROUP;
+        }
 
-            void submit(io_uring_sqe* sqe) override {
-                _iov.iov_base = const_cast<Byte*>(_buf.begin());
-                _iov.iov_len = _buf.len();
+        usize _consume(MutBytes buf) {
+            usize n = min(buf.len(), _pending.len());
+            copy(sub(_pending, 0, n), buf);
+            _pending.removeRange(0, n);
+            return n;
+        }
 
-                _msg.msg_name = &_addr;
-                _msg.msg_namelen = sizeof(sockaddr_in);
-                _msg.msg_iov = &_iov;
-                _msg.msg_iovlen = 1;
+        void complete(io_uring_cqe* cqe) override;
+    };
 
-                io_uring_prep_sendmsg(sqe, _fd->handle().value(), &_msg, 0);
-            }
+    // Waits in the queue of a socket until it has something to hand out.
+    // The operation lives in the frame of the coroutine awaiting it and
+    // leaves the queue if it is abandoned before that.
+    struct _Read {
+        using Inner = Res<usize>;
 
-            void complete(io_uring_cqe* cqe) override {
-                if (cqe->res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok<_Sent>(cqe->res, 0));
-            }
+        Rc<_Stream> _stream;
+        MutBytes _buf;
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+        template <Async::Receiver<Res<usize>> R>
+        auto connect(R r) {
+            struct Operation : public _Stream::Reader {
+                Rc<_Stream> _stream;
+                R _r;
+                bool _queued = false;
 
-        auto job = makeRc<Job>(fd, buf, addr);
-        submit(job);
-        return Async::makeTask(job->future());
-    }
+                Operation(Rc<_Stream> stream, MutBytes buf, R r)
+                    : _Stream::Reader(buf), _stream(std::move(stream)), _r(std::move(r)) {}
 
-    Async::Task<_Received> recvAsync(Rc<Fd> fd, MutBytes buf, MutSlice<Handle>) override {
-        struct Job : public _Job {
-            Rc<Fd> _fd;
-            MutBytes _buf;
-            iovec _iov;
-            msghdr _msg;
-            sockaddr_in _addr;
-            Async::Promise<_Received> _promise;
-
-            Job(Rc<Fd> fd, MutBytes buf)
-                : _fd(fd), _buf(buf) {}
-
-            void submit(io_uring_sqe* sqe) override {
-                _iov.iov_base = _buf.begin();
-                _iov.iov_len = _buf.len();
-
-                _msg.msg_name = &_addr;
-                _msg.msg_namelen = sizeof(sockaddr_in);
-                _msg.msg_iov = &_iov;
-                _msg.msg_iovlen = 1;
-
-                io_uring_prep_recvmsg(sqe, _fd->handle().value(), &_msg, 0);
-            }
+                ~Operation() {
+                    if (_queued)
+                        _forget<_Stream::Reader>(_stream->_readers, *this);
+                }
 
-            void complete(io_uring_cqe* cqe) override {
-                if (cqe->res < 0)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else {
-                    _Received received = {(usize)cqe->res, 0, Posix::fromSockAddr(_addr)};
-                    _promise.resolve(Ok(received));
+                bool start() {
+                    _stream->_readers.pushBack(this);
+                    _queued = true;
+                    return false;
                 }
-            }
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+                void resolve(Res<usize> res) override {
+                    _queued = false;
+                    _r.recv(Async::LATER, std::move(res));
+                }
+            };
+
+            return Operation{std::move(_stream), _buf, std::move(r)};
+        }
+    };
 
-        auto job = makeRc<Job>(fd, buf);
-        submit(job);
-        return Async::makeTask(job->future());
+    struct _Accept {
+        using Inner = Res<_Accepted>;
+
+        Rc<_Acceptor> _acceptor;
+
+        template <Async::Receiver<Res<_Accepted>> R>
+        auto connect(R r) {
+            struct Operation : public _Acceptor::Waiter {
+                Rc<_Acceptor> _acceptor;
+                R _r;
+                bool _queued = false;
+
+                Operation(Rc<_Acceptor> acceptor, R r)
+                    : _acceptor(std::move(acceptor)), _r(std::move(r)) {}
+
+                ~Operation() {
+                    if (_queued)
+                        _forget<_Acceptor::Waiter>(_acceptor->_waiters, *this);
+                }
+
+                bool start() {
+                    _acceptor->_waiters.pushBack(this);
+                    _queued = true;
+                    return false;
+                }
+
+                void resolve(Res<_Accepted> res) override {
+                    _queued = false;
+                    _r.recv(Async::LATER, std::move(res));
+                }
+            };
+
+            return Operation{std::move(_acceptor), std::move(r)};
+        }
+    };
+
+    io_uring_buf_ring* _bufRing = nullptr;
+    Vec<u8> _bufs;
+    bool _multishot = true; // Whether the kernel supports multishot accept and receive
+
+    HashMap<Fd*, Rc<_Acceptor>> _acceptors;
+    HashMap<Fd*, Rc<_Stream>> _streams;
+
+    // Canceled requests whose last CQE didn't come in yet.
+    Vec<Rc<_Multishot>> _retired;
+
+    // NOTE: Provided buffer rings came with Linux 5.19, if they can't be set
+    //       up, sockets are read and accepted one request at a time.
+    bool _ensureBufRing() {
+        if (_bufRing or not _multishot)
+            return _bufRing != nullptr;
+
+        int ret = 0;
+        _bufRing = io_uring_setup_buf_ring(&_ring, BUF_COUNT, BUF_GROUP, 0, &ret);
+        if (not _bufRing) {
+            logWarn("provided buffers not supported, disabling multishot operations: {}", Posix::fromErrno(-ret));
+            _multishot = false;
+            return false;
+        }
+
+        _bufs.resize(BUF_COUNT * BUF_SIZE);
+        for (usize i = 0; i < BUF_COUNT; i++)
+            _recycle(i);
+        return true;
     }
 
-    Async::Task<> sleepAsync(Instant until) override {
-        struct Job : public _Job {
-            Instant _until;
-            Async::Promise<> _promise;
+    void _recycle(u16 bid) {
+        io_uring_buf_ring_add(
+            _bufRing,
+            _bufs.buf() + bid * BUF_SIZE,
+            BUF_SIZE,
+            bid,
+            io_uring_buf_ring_mask(BUF_COUNT),
+            0
+        );
+        io_uring_buf_ring_advance(_bufRing, 1);
+    }
 
-            struct __kernel_timespec _ts{};
+    template <typename T>
+    void _retire(HashMap<Fd*, Rc<T>>& map, Fd* key) {
+        auto state = map.take(key);
+        if (state->_armed) {
+            state->disarm();
+            _retired.pushBack(state);
+        }
+    }
 
-            Job(Instant until)
-                : _until(until) {}
+    // Cancel the multishot requests of sockets that have been dropped, the
+    // kernel keeps them open for as long as they are pending.
+    void _sweep() {
+        Vec<Fd*> dead;
+
+        for (auto const* it : _acceptors.iter())
+            if (not it->v1->alive())
+                dead.pushBack(it->v0);
+        for (auto* key : dead)
+            _retire(_acceptors, key);
+
+        dead.clear();
+        for (auto const* it : _streams.iter())
+            if (not it->v1->alive())
+                dead.pushBack(it->v0);
+        for (auto* key : dead)
+            _retire(_streams, key);
+    }
 
-            void submit(io_uring_sqe* sqe) override {
-                _ts = toKernelTimespec(_until);
-                io_uring_prep_timeout(sqe, &_ts, 0, IORING_TIMEOUT_ABS);
-            }
+    template <typename T>
+    Rc<T> _stateFor(HashMap<Fd*, Rc<T>>& map, Rc<Fd> fd) {
+        Fd* key = &*fd;
+        if (auto state = map.tryGet(key)) {
+            // The address may have been reused by a new fd.
+            if ((*state)->alive())
+                return *state;
+            _retire(map, key);
+        }
 
-            void complete(io_uring_cqe* cqe) override {
-                if (cqe->res < 0 and cqe->res != -ETIME)
-                    _promise.resolve(Posix::fromErrno(-cqe->res));
-                else
-                    _promise.resolve(Ok());
-            }
+        auto state = makeRc<T>(*this, fd);
+        map.put(key, state);
+        return state;
+    }
 
-            auto future() {
-                return _promise.future();
-            }
-        };
+    // MARK: Operations --------------------------------------------------------
+
+    Async::Task<usize> _readOnceAsync(Rc<Fd> fd, MutBytes buf) {
+        auto res = co_await _submitAsync([&](io_uring_sqe* sqe) {
+            io_uring_prep_read(
+                sqe,
+                fd->handle().value(),
+                buf.buf(),
+                buf.len(),
+                -1
+            );
+        });
+        co_return _toUsize(res);
+    }
 
-        auto job = makeRc<Job>(until);
-        submit(job);
-        return Async::makeTask(job->future());
+    Async::Task<usize> readAsync(Rc<Fd> fd, MutBytes buf) override {
+        auto stream = _streams.tryGet(&*fd);
+        if (not stream or not(*stream)->alive() or not _ensureBufRing())
+            return _readOnceAsync(fd, buf);
+
+        auto& s = **stream;
+        if (s._pending.len() or s._eof)
+            return Async::makeTask(Async::One<Res<usize>>{Ok(s._consume(buf))});
+
+        if (s._error)
+            return Async::makeTask(Async::One<Res<usize>>{s._error.take()});
+
+        s.arm(*fd);
+        return Async::makeTask(_Read{*stream, buf});
+    }
+
+    Async::Task<usize> writeAsync(Rc<Fd> fd, Bytes buf) override {
+        auto res = co_await _submitAsync([&](io_uring_sqe* sqe) {
+            io_uring_prep_write(
+                sqe,
+                fd->handle().value(),
+                buf.buf(),
+                buf.len(),
+                // NOTE: On files that support seeking, if the offset is set
+                //       to -1, the write operation commences at the file
+                //       offset, and the file offset is incremented by
+                //       the number of bytes written. See io_uring_prep_write(3).
+                -1
+            );
+        });
+        co_return _toUsize(res);
+    }
+
+    Async::Task<> flushAsync(Rc<Fd> fd) override {
+        auto res = co_await _submitAsync([&](io_uring_sqe* sqe) {
+            io_uring_prep_fsync(sqe, fd->handle().value(), 0);
+        });
+        if (res < 0)
+            co_return Posix::fromErrno(-res);
+        co_return Ok();
     }
 
+    Async::Task<_Accepted> _acceptOnceAsync(Rc<Fd> fd) {
+        auto addr = makeRc<_Addr>();
+        auto res = co_await _submitAsync(addr, [&](io_uring_sqe* sqe) {
+            io_uring_prep_accept(sqe, fd->handle().value(), (struct sockaddr*)&addr->addr, &addr->len, 0);
+        });
+        if (res < 0)
+            co_return Posix::fromErrno(-res);
+        co_return Ok<_Accepted>(makeRc<Posix::Fd>(res), Posix::fromSockAddr(addr->addr));
+    }
+
+    Async::Task<_Accepted> acceptAsync(Rc<Fd> fd) override {
+        if (not _ensureBufRing())
+            return _acceptOnceAsync(fd);
+
+        auto acceptor = _stateFor(_acceptors, fd);
+        if (acceptor->_ready.len())
+            return Async::makeTask(Async::One<Res<_Accepted>>{acceptor->_ready.popFront()});
+
+        acceptor->arm(*fd);
+        return Async::makeTask(_Accept{acceptor});
+    }
+
+    Async::Task<_Sent> sendAsync(Rc<Fd> fd, Bytes buf, Slice<Handle> handles, SocketAddr addr) override {
+        if (handles.len() > 0)
+            notImplemented(); // TODO: Implement handle passing on POSIX
+
+        auto msg = makeRc<_Msg>(const_cast<Byte*>(buf.begin()), buf.len(), Posix::toSockAddr(addr));
+        auto res = co_await _submitAsync(msg, [&](io_uring_sqe* sqe) {
+            io_uring_prep_sendmsg(sqe, fd->handle().value(), &msg->msg, 0);
+        });
+        if (res < 0)
+            co_return Posix::fromErrno(-res);
+        co_return Ok<_Sent>(res, 0);
+    }
+
+    Async::Task<_Received> recvAsync(Rc<Fd> fd, MutBytes buf, MutSlice<Handle>) override {
+        auto msg = makeRc<_Msg>(buf.begin(), buf.len());
+        auto res = co_await _submitAsync(msg, [&](io_uring_sqe* sqe) {
+            io_uring_prep_recvmsg(sqe, fd->handle().value(), &msg->msg, 0);
+        });
+        if (res < 0)
+            co_return Posix::fromErrno(-res);
+        co_return Ok<_Received>((usize)res, 0, Posix::fromSockAddr(msg->addr));
+    }
+
+    Async::Task<> sleepAsync(Instant until) override {
+        auto timeout = makeRc<_Timeout>();
+        timeout->ts = toKernelTimespec(until);
+        auto res = co_await _submitAsync(timeout, [&](io_uring_sqe* sqe) {
+            io_uring_prep_timeout(sqe, &timeout->ts, 0, IORING_TIMEOUT_ABS);
+        });
+        if (res < 0 and res != -ETIME)
+            co_return Posix::fromErrno(-res);
+        co_return Ok();
+    }
+
+    // MARK: Completion --------------------------------------------------------
+
     bool _inWait = false;
 
     Res<> wait(Instant until) override {
@@ -340,24 +636,40 @@ struct UringSched : public Sys::Sched {
             _inWait = false;
         };
 
+        _sweep();
+
         Instant now = Sys::instant();
 
         Duration delta = Duration::zero();
         if (now < until)
             delta = until - now;
 
+        // Everything queued since the last wait goes in with the same
+        // syscall that waits for completions.
         struct __kernel_timespec ts = toKernelTimespec(delta);
         io_uring_cqe* cqe = nullptr;
-        io_uring_wait_cqe_timeout(&_ring, &cqe, &ts);
+        io_uring_submit_and_wait_timeout(&_ring, &cqe, 1, &ts, nullptr);
 
         unsigned head;
         usize i = 0;
         io_uring_for_each_cqe(&_ring, head, cqe) {
-            auto id = cqe->user_data;
-            auto job = _jobs.get(id);
-            job->complete(cqe);
-            _jobs.del(id);
             ++i;
+
+            auto id = cqe->user_data;
+            if (id == IGNORED)
+                continue;
+
+            auto job = _slots[id];
+            if (not(cqe->flags & IORING_CQE_F_MORE)) {
+                _slots[id] = nullptr;
+                _freeSlots.pushBack(id);
+                if (not job)
+                    _orphans.del(id);
+            }
+
+            // NOTE: The job may be gone if it was abandoned.
+            if (job)
+                job->complete(cqe);
         }
 
         io_uring_cq_advance(&_ring, i);
@@ -366,6 +678,82 @@ struct UringSched : public Sys::Sched {
     }
 };
 
+void UringSched::_Acceptor::complete(io_uring_cqe* cqe) {
+    bool more = cqe->flags & IORING_CQE_F_MORE;
+    if (not more)
+        _armed = false;
+
+    if (cqe->res >= 0) {
+        // NOTE: The address can't be passed to a multishot accept, as
+        //       completions would overwrite it before it is read.
+        sockaddr_in addr{};
+        socklen_t addrLen = sizeof(addr);
+        getpeername(cqe->res, (struct sockaddr*)&addr, &addrLen);
+
+        Rc<Fd> conn = makeRc<Posix::Fd>(cqe->res);
+        _sched._stateFor(_sched._streams, conn);
+        _deliver(Ok<_Accepted>(conn, Posix::fromSockAddr(addr)));
+    } else if (cqe->res == -EINVAL and not _oneshot) {
+        // NOTE: Multishot accept came with Linux 5.19, on older kernels
+        //       the request is re-armed below as a single-shot one.
+        _sched._multishot = false;
+    } else if (cqe->res != -ECANCELED) {
+        _deliver(Posix::fromErrno(-cqe->res));
+    }
+
+    if (more) {
+        if (_ready.len() >= MAX_PENDING_ACCEPTS)
+            disarm();
+        return;
+    }
+
+    if (auto fd = _fd.upgrade(); fd and _waiters.len())
+        arm(**fd);
+    else
+        _done();
+}
+
+void UringSched::_Stream::complete(io_uring_cqe* cqe) {
+    bool more = cqe->flags & IORING_CQE_F_MORE;
+    if (not more)
+        _armed = false;
+
+    if (cqe->res > 0) {
+        u16 bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        Bytes data = {_sched._bufs.buf() + bid * BUF_SIZE, (usize)cqe->res};
+        _pending.insertMany(_pending.len(), data);
+        _sched._recycle(bid);
+    } else if (cqe->res == 0) {
+        _eof = true;
+    } else if (cqe->res == -EINVAL and not _oneshot) {
+        // NOTE: Multishot receive came with Linux 6.0, on older kernels
+        //       the request is re-armed below as a single-shot one.
+        _sched._multishot = false;
+    } else if (cqe->res != -ENOBUFS and cqe->res != -ECANCELED) {
+        _error = Posix::fromErrno(-cqe->res);
+    }
+
+    while (_readers.len() and (_pending.len() or _eof or _error)) {
+        auto reader = _readers.popFront();
+        if (_error and not _pending.len())
+            reader->resolve(_error.take());
+        else
+            reader->resolve(Ok(_consume(reader->buf)));
+    }
+
+    if (more) {
+        if (_pending.len() >= MAX_PENDING_BYTES)
+            disarm();
+        return;
+    }
+
+    // Ran out of provided buffers, keep going if someone is waiting.
+    if (auto fd = _fd.upgrade(); fd and _readers.len() and not _eof and not _error)
+        arm(**fd);
+    else
+        _done();
+}
+
 Sched& globalSched() {
     static UringSched sched = [] {
         io_uring ring{};
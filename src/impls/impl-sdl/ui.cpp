@@ -317,7 +317,7 @@ struct SdlHost :
                 break;
 
             case SDL_WINDOWEVENT_EXPOSED:
-                _dirty.pushBack(pixels().bound());
+                _damage.add(pixels().bound());
                 break;
             }
             break;
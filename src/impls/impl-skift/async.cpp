@@ -10,7 +10,7 @@ namespace Karm::Sys::_Embed {
 
 struct HjertSched : public Sys::Sched {
     Hj::Listener _listener;
-    Map<Hj::Cap, Async::Promise<>> _promises;
+    HashMap<Hj::Cap, Async::Promise<>> _promises;
     Vec<Pair<Instant, Async::Promise<>>> _sleeps;
 
     HjertSched(Hj::Listener listener) : _listener{std::move(listener)} {}
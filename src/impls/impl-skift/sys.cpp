@@ -33,6 +33,10 @@ Res<Rc<Sys::Fd>> openOrCreateFile(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> removeFile(Mime::Url const&) {
+    notImplemented();
+}
+
 Res<Pair<Rc<Sys::Fd>, Rc<Sys::Fd>>> createPipe() {
     notImplemented();
 }
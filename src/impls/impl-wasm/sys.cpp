@@ -47,6 +47,10 @@ struct JSConsole : public Sys::Fd {
         return _buf.flush();
     }
 
+    Res<> sync() override {
+        return flush();
+    }
+
     Res<Rc<Fd>> dup() override {
         notImplemented();
     }
@@ -115,6 +119,10 @@ Res<Rc<Fd>> openOrCreateFile(Mime::Url const&) {
     return Error::notImplemented();
 }
 
+Res<> removeFile(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
 // MARK: Sockets ---------------------------------------------------------------
 
 Res<Rc<Fd>> listenUdp(SocketAddr) {
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <karm-base/res.h>
+
+#include "asm.h"
+
+namespace x86_64 {
+
+struct Lapic {
+    volatile u32* _base;
+
+    // Registers
+    static constexpr usize ID = 0x20;
+    static constexpr usize EOI = 0xB0;
+    static constexpr usize SPURIOUS = 0xF0;
+    static constexpr usize ICR_LOW = 0x300;
+    static constexpr usize ICR_HIGH = 0x310;
+    static constexpr usize LVT_TIMER = 0x320;
+    static constexpr usize TIMER_INITIAL = 0x380;
+    static constexpr usize TIMER_CURRENT = 0x390;
+    static constexpr usize TIMER_DIVIDE = 0x3E0;
+
+    static constexpr u32 SPURIOUS_ENABLE = 1 << 8;
+    static constexpr u32 ICR_PENDING = 1 << 12;
+    static constexpr u32 ICR_ASSERT = 1 << 14;
+    static constexpr u32 ICR_INIT = 0b101 << 8;
+    static constexpr u32 ICR_STARTUP = 0b110 << 8;
+    static constexpr u32 TIMER_PERIODIC = 1 << 17;
+    static constexpr u32 TIMER_MASKED = 1 << 16;
+    static constexpr u32 TIMER_DIV16 = 0b11;
+
+    static Lapic lapic(usize base) {
+        return {reinterpret_cast<volatile u32*>(base)};
+    }
+
+    u32 read(usize reg) {
+        return _base[reg / 4];
+    }
+
+    void write(usize reg, u32 value) {
+        _base[reg / 4] = value;
+    }
+
+    u8 id() {
+        return read(ID) >> 24;
+    }
+
+    void enable(u8 spuriousVector) {
+        write(SPURIOUS, SPURIOUS_ENABLE | spuriousVector);
+    }
+
+    void eoi() {
+        write(EOI, 0);
+    }
+
+    void _waitIcr() {
+        while (read(ICR_LOW) & ICR_PENDING)
+            pause();
+    }
+
+    void _sendIcr(u8 dest, u32 cmd) {
+        _waitIcr();
+        write(ICR_HIGH, (u32)dest << 24);
+        write(ICR_LOW, cmd);
+        _waitIcr();
+    }
+
+    void sendInit(u8 dest) {
+        _sendIcr(dest, ICR_INIT | ICR_ASSERT);
+    }
+
+    void sendStartup(u8 dest, u8 page) {
+        _sendIcr(dest, ICR_STARTUP | ICR_ASSERT | page);
+    }
+
+    void sendIpi(u8 dest, u8 vector) {
+        _sendIcr(dest, ICR_ASSERT | vector);
+    }
+
+    // Start the timer counting down from its maximum value, used to
+    // calibrate it against a known clock.
+    void timerStart() {
+        write(TIMER_DIVIDE, TIMER_DIV16);
+        write(LVT_TIMER, TIMER_MASKED);
+        write(TIMER_INITIAL, 0xFFFFFFFF);
+    }
+
+    u32 timerElapsed() {
+        return 0xFFFFFFFF - read(TIMER_CURRENT);
+    }
+
+    void timerPeriodic(u8 vector, u32 ticks) {
+        write(TIMER_DIVIDE, TIMER_DIV16);
+        write(LVT_TIMER, TIMER_PERIODIC | vector);
+        write(TIMER_INITIAL, ticks);
+    }
+};
+
+} // namespace x86_64
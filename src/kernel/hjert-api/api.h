@@ -13,6 +13,12 @@ inline Res<Instant> now() {
     return Ok(ts);
 }
 
+inline Res<MemStats> stats() {
+    MemStats stats;
+    try$(_stats(&stats));
+    return Ok(stats);
+}
+
 inline Res<usize> log(Str msg) {
     try$(_log(msg.buf(), msg.len()));
     return Ok(msg.len());
@@ -251,6 +257,18 @@ struct Channel : public Object {
         return Ok<SentRecv>(buf.len(), caps.len());
     }
 
+    // Move a mapping to the other end of the channel without copying it,
+    // the pages are unmapped from this space and received as a vmo.
+    //
+    // NOTE: The vmo handle, and any other mapping of it, must have been
+    //       dropped beforehand, or the kernel refuses to move the pages.
+    Res<SentRecv> sendPages(Mapped pages, Slice<Cap> caps) {
+        auto range = pages.range();
+        try$(_send(_cap, reinterpret_cast<Byte const*>(range.start), range.size, caps.buf(), caps.len(), SendFlags::PAGES));
+        pages._addr = 0;
+        return Ok<SentRecv>(0uz, caps.len() + 1);
+    }
+
     Res<SentRecv> recv(MutBytes buf, MutSlice<Cap> caps) {
         usize bufLen = buf.len();
         usize capLen = caps.len();
@@ -116,8 +116,8 @@ Res<> _out(Cap cap, IoLen len, usize port, Arg val) {
     return _syscall(Syscall::OUT, cap.raw(), (Arg)len, port, val);
 }
 
-Res<> _send(Cap cap, Byte const* buf, usize bufLen, Cap const* caps, usize capLen) {
-    return _syscall(Syscall::SEND, cap.raw(), (Arg)buf, bufLen, (usize)caps, capLen);
+Res<> _send(Cap cap, Byte const* buf, usize bufLen, Cap const* caps, usize capLen, Flags<SendFlags> flags) {
+    return _syscall(Syscall::SEND, cap.raw(), (Arg)buf, bufLen, (usize)caps, capLen, (Arg)flags.val());
 }
 
 Res<> _recv(Cap cap, Byte* buf, usize* bufLen, Cap* caps, usize* capLen) {
@@ -140,4 +140,8 @@ Res<> _poll(Cap cap, Event* ev, usize evCap, usize* evLen, Instant until) {
     return _syscall(Syscall::POLL, cap.raw(), (Arg)ev, evCap, (usize)evLen, until.val());
 }
 
+Res<> _stats(MemStats* stats) {
+    return _syscall(Syscall::STATS, (Arg)stats);
+}
+
 } //  namespace Hj
@@ -28,7 +28,7 @@ Res<> _in(Cap cap, IoLen len, usize port, Arg* val);
 
 Res<> _out(Cap cap, IoLen len, usize port, Arg val);
 
-Res<> _send(Cap cap, Byte const* buf, usize bufLen, Cap const* caps, usize capLen);
+Res<> _send(Cap cap, Byte const* buf, usize bufLen, Cap const* caps, usize capLen, Flags<SendFlags> flags = SendFlags::NONE);
 
 Res<> _recv(Cap cap, Byte* buf, usize* bufLen, Cap* caps, usize* capLen);
 
@@ -40,4 +40,6 @@ Res<> _listen(Cap cap, Cap target, Flags<Sigs> set, Flags<Sigs> unset);
 
 Res<> _poll(Cap cap, Event* ev, usize evCap, usize* evLen, Instant until);
 
+Res<> _stats(MemStats* stats);
+
 } // namespace Hj
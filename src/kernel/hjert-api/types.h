@@ -2,6 +2,7 @@
 
 #include <hal/vmm.h>
 #include <karm-base/array.h>
+#include <karm-base/hash.h>
 #include <karm-base/time.h>
 
 namespace Hj {
@@ -59,7 +60,8 @@ static inline char const* toStr(Type type) {
     SYSCALL(CLOSE)               \
     SYSCALL(SIGNAL)              \
     SYSCALL(LISTEN)              \
-    SYSCALL(POLL)
+    SYSCALL(POLL)                \
+    SYSCALL(STATS)
 
 // clang-format off
 
@@ -146,6 +148,10 @@ struct Cap {
 
     std::strong_ordering operator<=>(Cap const& other) const = default;
 
+    Hash hash() const {
+        return Karm::hash(_raw);
+    }
+
     usize slot() const {
         auto curr = _raw & MASK;
         auto upper = _raw >> SHIFT;
@@ -259,6 +265,33 @@ struct SentRecv {
     usize caps;
 };
 
+enum struct SendFlags : u8 {
+    NONE = 0,
+
+    // Move the pages of a whole mapping to the receiver instead of copying
+    // the bytes, they are received as a vmo after the caps.
+    PAGES = 1 << 0,
+};
+
+FlagsEnum$(SendFlags);
+
+struct SlabStats {
+    usize size;   //< The size of the objects in this class (in bytes)
+    usize slabs;  //< The number of slabs backing this class
+    usize objs;   //< The number of objects the slabs can hold
+    usize allocs; //< The number of allocations since boot
+    usize frees;  //< The number of frees since boot
+};
+
+static constexpr usize SLAB_CLASSES = 8;
+
+struct MemStats {
+    usize total;  //< The usable physical memory (in bytes)
+    usize used;   //< The physical memory in use (in bytes)
+    usize cached; //< The free pages kept aside for fast reuse (in bytes)
+    Array<SlabStats, SLAB_CLASSES> slabs;
+};
+
 struct ChannelProps {
     static constexpr Type TYPE = Type::CHANNEL;
     usize bufCap;  //< The capacity of the data buffer (in bytes, must be >= 1)
@@ -16,6 +16,10 @@ struct Task;
 
 struct Space;
 
+// Entry point of the application processors once they run in the kernel
+// address space.
+[[noreturn]] void enterCpu(usize cpu);
+
 } // namespace Hjert::Core
 
 namespace Hjert::Arch {
@@ -24,6 +28,22 @@ struct Frame;
 
 Core::Cpu& globalCpu();
 
+usize cpuId();
+
+// Start the application processors, each one joins the scheduler through
+// Core::enterCpu().
+Res<> initCpus(Handover::Payload&);
+
+// Interrupt a cpu so it reschedules right away.
+void kick(usize cpu);
+
+// Flush a range from the tlb of the given cpus, and wait for them to be done.
+void shootdown(u64 cpus, Hal::VmmRange vrange);
+
+// Move the given cpus to the kernel address space if they still run on the
+// one rooted at root, and wait for them to be done.
+void evict(u64 cpus, usize root);
+
 Hal::Vmm& globalVmm();
 
 Io::TextWriter& globalOut();
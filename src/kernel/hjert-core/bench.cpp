@@ -0,0 +1,57 @@
+#include <karm-logger/logger.h>
+
+#include "arch.h"
+#include "bench.h"
+#include "sched.h"
+#include "space.h"
+#include "task.h"
+
+namespace Hjert::Core {
+
+static constexpr usize WORK_PER_TASK = 1uz << 28;
+
+static Atomic<usize> _pending{};
+static Atomic<usize> _sink{};
+static Array<Atomic<usize>, MAX_CPUS> _doneOn{};
+static Instant _start{};
+
+static void _benchTask(usize id) {
+    usize x = id + 1;
+    for (usize i = 0; i < WORK_PER_TASK; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    _sink.fetchAdd(x, MemOrder::RELAXED);
+    _doneOn[Arch::cpuId()].inc();
+
+    if (_pending.fetchSub(1) == 1) {
+        auto elapsed = now() - _start;
+        logInfo("smp-bench: done in {}ms on {} cpus", elapsed.toMSecs(), cpuCount());
+        for (usize cpu = 0; cpu < cpuCount(); cpu++)
+            logInfo("smp-bench: cpu{} completed {} tasks", cpu, _doneOn[cpu].load());
+    }
+
+    Task::self().signal(Hj::Sigs::EXITED, Hj::Sigs::NONE);
+    Task::self().leave();
+    while (true)
+        Arch::yield();
+}
+
+Res<> startSmpBench(usize tasks) {
+    logInfo("smp-bench: starting {} tasks on {} cpus...", tasks, cpuCount());
+
+    auto space = try$(Space::create());
+    _pending.store(tasks);
+    _start = now();
+    for (usize i = 0; i < tasks; i++) {
+        auto task = try$(Task::create(Mode::SUPER, space));
+        task->label("smp-bench");
+        try$(task->ready((usize)_benchTask, task->stack().loadSp(), {i}));
+        try$(enqueue(task));
+    }
+
+    return Ok();
+}
+
+} // namespace Hjert::Core
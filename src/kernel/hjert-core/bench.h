@@ -0,0 +1,11 @@
+#pragma once
+
+#include <karm-base/res.h>
+
+namespace Hjert::Core {
+
+// Spread a fixed amount of cpu-bound work over kernel tasks, and log how
+// long it took, and where it ran, once all of them are done.
+Res<> startSmpBench(usize tasks);
+
+} // namespace Hjert::Core
@@ -33,7 +33,7 @@ void Channel::_updateSignalsUnlock() {
     );
 }
 
-Res<Hj::SentRecv> Channel::send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps) {
+Res<Hj::SentRecv> Channel::send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps, Opt<Arc<Object>> extra) {
     ObjectLockScope scope{*this};
     try$(_ensureOpen());
 
@@ -44,7 +44,8 @@ Res<Hj::SentRecv> Channel::send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps) {
     if (_bytes.rem() < bytes.len())
         return Error::invalidInput("not enough space for bytes");
 
-    if (_caps.rem() < caps.len())
+    usize capsLen = caps.len() + (extra ? 1 : 0);
+    if (_caps.rem() < capsLen)
         return Error::invalidInput("not enough space for caps");
 
     // Everything is ready, let's send the message
@@ -59,13 +60,14 @@ Res<Hj::SentRecv> Channel::send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps) {
         _caps.pushBack(res.unwrap());
     }
 
-    for (usize i = 0; i < bytes.len(); i++)
-        _bytes.pushBack(bytes[i]);
+    if (extra)
+        _caps.pushBack(extra.take());
 
-    _sr.pushBack({bytes.len(), caps.len()});
+    _bytes.pushBack(bytes);
+    _sr.pushBack({bytes.len(), capsLen});
 
     _updateSignalsUnlock();
-    return Ok<Hj::SentRecv>(bytes.len(), caps.len());
+    return Ok<Hj::SentRecv>(bytes.len(), capsLen);
 }
 
 Res<Hj::SentRecv> Channel::recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps) {
@@ -91,8 +93,7 @@ Res<Hj::SentRecv> Channel::recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> c
     // Everything is ready, let's receive the message
     _sr.popFront();
 
-    for (usize i = 0; i < expectedBytes; i++)
-        bytes[i] = _bytes.popFront();
+    _bytes.popFront(mutSub(bytes, 0, expectedBytes));
 
     for (usize i = 0; i < expectedCaps; i++)
         // NOTE: We unwrap here because we know that the domain has enough space
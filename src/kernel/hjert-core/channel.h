@@ -25,7 +25,9 @@ struct Channel :
 
     void _updateSignalsUnlock();
 
-    Res<Hj::SentRecv> send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps);
+    // Send a message, `extra` is an object owned by the kernel that is
+    // received after the caps, eg. the pages of a large message.
+    Res<Hj::SentRecv> send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps, Opt<Arc<Object>> extra = NONE);
 
     Res<Hj::SentRecv> recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps);
 
@@ -1,18 +1,43 @@
 #include <elf/image.h>
 #include <handover/entry.h>
 #include <karm-base/size.h>
+#include <karm-io/aton.h>
 #include <karm-logger/logger.h>
 
 #include "arch.h"
+#include "bench.h"
 #include "cpu.h"
 #include "domain.h"
 #include "mem.h"
 #include "sched.h"
+#include "slab.h"
 #include "space.h"
 #include "task.h"
 
 namespace Hjert::Core {
 
+// NOTE: The props are JSON, but the kernel only has flat integer options
+//       so they are scanned rather than parsed.
+static Opt<usize> _kernelProp(Handover::Payload& payload, Str key) {
+    auto const* record = payload.fileByName("bundle://hjert/_bin");
+    if (not record)
+        return NONE;
+
+    Io::SScan s{payload.stringAt(record->file.meta)};
+    while (not s.ended()) {
+        if (s.skip('"') and s.skip(key) and s.skip('"')) {
+            s.eat(' ');
+            if (not s.skip(':'))
+                continue;
+            s.eat(' ');
+            return Io::atou(s);
+        }
+        s.next();
+    }
+
+    return NONE;
+}
+
 Res<> validateAndDump(u64 magic, Handover::Payload& payload) {
     if (not Handover::valid(magic, payload)) {
         logInfo("entry: handover: invalid");
@@ -110,7 +135,7 @@ Res<> enterUserspace(Handover::Payload& payload) {
     task->label("init-task");
 
     try$(task->ready(image.header().entry, stackRange.end(), {handoverRange.start}));
-    try$(globalSched().enqueue(task));
+    try$(enqueue(task));
 
     return Ok();
 }
@@ -122,12 +147,21 @@ Res<> init(u64 magic, Handover::Payload& payload) {
 
     try$(validateAndDump(magic, payload));
     try$(initMem(payload));
+    try$(initSlab(payload));
     try$(initSched(payload));
 
     logInfo("entry: everything is ready, enabling interrupts...");
     Arch::globalCpu().retainEnable();
     Arch::globalCpu().enableInterrupts();
 
+    logInfo("entry: starting cpus...");
+    try$(Arch::initCpus(payload));
+
+    // NOTE: When set, that many cpu-bound tasks are started to check that
+    //       the work gets spread over every cpu, see meta/scripts/smp-bench.sh
+    if (auto tasks = _kernelProp(payload, "smp-bench"); tasks and *tasks)
+        try$(startSmpBench(*tasks));
+
     logInfo("entry: entering userspace...");
     try$(enterUserspace(payload));
 
@@ -138,6 +172,16 @@ Res<> init(u64 magic, Handover::Payload& payload) {
         Arch::globalCpu().relaxe();
 }
 
+void enterCpu(usize cpu) {
+    initSched(cpu).unwrap("failed to initialize the scheduler");
+
+    logInfo("entry: cpu{} is ready, entering idle loop...", cpu);
+    Arch::globalCpu().retainEnable();
+    Arch::globalCpu().enableInterrupts();
+    while (true)
+        Arch::globalCpu().relaxe();
+}
+
 } // namespace Hjert::Core
 
 // MARK: Handover Entry Point ------ -------------------------------------------
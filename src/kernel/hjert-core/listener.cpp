@@ -9,6 +9,9 @@ Res<Arc<Listener>> Listener::create() {
 Res<> Listener::listen(Hj::Cap cap, Arc<Object> obj, Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset) {
     ObjectLockScope scope{*this};
 
+    // NOTE: A task might be blocked polling this listener.
+    _epoch.inc();
+
     for (usize i = 0; i < _listened.len(); ++i) {
         if (_listened[i].cap == cap) {
             auto& listened = _listened[i];
@@ -5,17 +5,38 @@
 
 #include "arch.h"
 #include "mem.h"
+#include "slab.h"
 
 namespace Hjert::Core {
 
 struct Pmm : public Hal::Pmm {
+    static constexpr usize CACHE_LEN = 64;
+
+    // NOTE: Memory below the first megabyte is the only one reachable from
+    //       real mode, it's kept for the callers that ask for lower memory.
+    static constexpr usize LOWER_END = mib(1);
+
     Hal::PmmRange _usable;
     Bits _bits;
     Lock _lock;
 
+    // The first bit above lower memory.
+    usize _floor;
+
+    // NOTE: Every bit between the floor and the hint is known to be used,
+    //       so searches don't rescan the start of memory that fills up
+    //       first.
+    usize _hint = 0;
+
+    // Recently freed single pages, they stay marked as used in the bitmap
+    // and are handed out again without searching it.
+    Array<usize, CACHE_LEN> _cache{};
+    usize _cacheLen = 0;
+
     Pmm(Hal::PmmRange usable, Bits bits)
         : _usable(usable),
-          _bits(bits) {
+          _bits(bits),
+          _floor(usable.start < LOWER_END ? (LOWER_END - usable.start) / Hal::PAGE_SIZE : 0) {
         clear();
     }
 
@@ -26,8 +47,39 @@ struct Pmm : public Hal::Pmm {
 
         try$(ensureAlign(size, Hal::PAGE_SIZE));
         size /= Hal::PAGE_SIZE;
-        auto prange = bits2Pmm(try$(_bits.alloc(size, upper ? -1 : 0, upper)));
-        return Ok(prange);
+
+        // NOTE: The cache holds pages from anywhere in memory, so it's only
+        //       used by callers that don't ask for upper memory.
+        if (upper)
+            return Ok(bits2Pmm(try$(_bits.alloc(size, -1, true))));
+
+        if ((flags & Hal::PmmFlags::LOWER) == Hal::PmmFlags::LOWER) {
+            auto range = try$(_bits.alloc(size, 0, false));
+            if (range.end() > _floor) {
+                _bits.set(range, false);
+                return Error::outOfMemory("no lower memory left");
+            }
+            return Ok(bits2Pmm(range));
+        }
+
+        if (size == 1 and _cacheLen)
+            return Ok(Hal::PmmRange{_cache[--_cacheLen], Hal::PAGE_SIZE});
+
+        auto range = _bits.alloc(size, _hint, false);
+        if (not range) {
+            // NOTE: A run might straddle the hint if it was freed in pieces.
+            range = _bits.alloc(size, _floor, false);
+        }
+
+        if (not range) {
+            // NOTE: Lower memory is only given away when nothing else is left.
+            range = try$(_bits.alloc(size, 0, false));
+        }
+
+        if (range->start == _hint)
+            _hint = range->end();
+
+        return Ok(bits2Pmm(*range));
     }
 
     Res<> used(Hal::PmmRange prange, Hal::PmmFlags) override {
@@ -47,13 +99,30 @@ struct Pmm : public Hal::Pmm {
 
         LockScope scope(_lock);
         try$(prange.ensureAligned(Hal::PAGE_SIZE));
-        _bits.set(pmm2Bits(prange), false);
+
+        if (prange.size == Hal::PAGE_SIZE and prange.start >= LOWER_END and _cacheLen < CACHE_LEN) {
+            _cache[_cacheLen++] = prange.start;
+            return Ok();
+        }
+
+        auto range = pmm2Bits(prange);
+        _bits.set(range, false);
+        _hint = max(_floor, min(_hint, range.start));
         return Ok();
     }
 
     void clear() {
         LockScope scope(_lock);
         _bits.fill(true);
+        _hint = _floor;
+        _cacheLen = 0;
+    }
+
+    void stats(Hj::MemStats& stats) {
+        LockScope scope(_lock);
+        stats.total = _usable.size;
+        stats.cached = _cacheLen * Hal::PAGE_SIZE;
+        stats.used = _bits.used() * Hal::PAGE_SIZE - stats.cached;
     }
 
     void dump() {
@@ -226,4 +295,12 @@ Hal::Kmm& kmm() {
     return *_kmm;
 }
 
+Hj::MemStats memStats() {
+    Hj::MemStats stats{};
+    if (_pmm)
+        _pmm->stats(stats);
+    slabStats(stats.slabs);
+    return stats;
+}
+
 } // namespace Hjert::Core
@@ -4,6 +4,7 @@
 #include <hal/pmm.h>
 #include <hal/vmm.h>
 #include <handover/spec.h>
+#include <hjert-api/types.h>
 
 namespace Hjert::Core {
 
@@ -13,4 +14,6 @@ Hal::Kmm& kmm();
 
 Hal::Pmm& pmm();
 
+Hj::MemStats memStats();
+
 } // namespace Hjert::Core
@@ -4,6 +4,8 @@ namespace Hjert::Core {
 
 Atomic<usize> Object::_counter = 0;
 
+Atomic<usize> Object::_epoch = 0;
+
 void Object::label(Str label) {
     LockScope scope(_lock);
     _label = String(label);
@@ -18,6 +20,7 @@ String Object::label() const {
 void Object::_signalUnlock(Flags<Hj::Sigs> set, Flags<Hj::Sigs> unset) {
     _signals |= set;
     _signals &= ~unset;
+    _epoch.inc();
 }
 
 Flags<Hj::Sigs> Object::_pollUnlock() {
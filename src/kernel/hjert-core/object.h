@@ -11,6 +11,10 @@ namespace Hjert::Core {
 struct Object : Meta::Pinned {
     static Atomic<usize> _counter;
 
+    // Bumped whenever the signals of any object change, blocked tasks are
+    // only looked at again when it moved or their deadline passed.
+    static Atomic<usize> _epoch;
+
     Lock _lock;
     usize _id = _counter.fetchAdd(1);
     Opt<String> _label;
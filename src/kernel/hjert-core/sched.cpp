@@ -7,57 +7,226 @@
 
 namespace Hjert::Core {
 
-static Opt<Sched> _sched;
+static Array<Opt<Sched>, MAX_CPUS> _scheds;
+static Atomic<usize> _cpuCount{};
+
+// NOTE: The clock is driven by the ticks of the boot cpu, so every cpu
+//       agrees on the current time.
+static Atomic<usize> _clock{};
 
 Res<> initSched(Handover::Payload&) {
     logInfo("sched: initializing...");
     auto bootTask = try$(Task::create(Mode::SUPER, try$(Space::create())));
     bootTask->label("entry");
     try$(bootTask->ready(0, 0, {}));
-    _sched.emplace(std::move(bootTask));
+    _scheds[0].emplace(0, Instant{}, std::move(bootTask));
+    _cpuCount.inc();
     return Ok();
 }
 
+Res<> initSched(usize cpu) {
+    if (cpu >= MAX_CPUS)
+        return Error::invalidInput("too many cpus");
+
+    auto idleTask = try$(Task::create(Mode::IDLE));
+    idleTask->label("idle");
+    try$(idleTask->ready(0, 0, {}));
+    _scheds[cpu].emplace(cpu, now(), std::move(idleTask));
+    _cpuCount.inc();
+    return Ok();
+}
+
+usize cpuCount() {
+    return _cpuCount.load();
+}
+
+Instant now() {
+    return Instant{_clock.load()};
+}
+
 Sched& globalSched() {
-    return *_sched;
+    return *_scheds[Arch::cpuId()];
+}
+
+Res<> enqueue(Arc<Task> task) {
+    auto weight = [](Sched& sched) {
+        return sched.load() + (sched.idle() ? 0 : 1);
+    };
+
+    Sched* best = &*_scheds[0];
+    for (usize i = 1; i < cpuCount(); i++) {
+        auto& sched = *_scheds[i];
+        if (weight(sched) < weight(*best))
+            best = &sched;
+    }
+
+    try$(best->enqueue(std::move(task)));
+
+    // NOTE: An idle cpu would only notice the task on its next tick.
+    if (best->_cpu != Arch::cpuId() and best->idle())
+        Arch::kick(best->_cpu);
+
+    return Ok();
+}
+
+Sched::Sched(usize cpu, Instant stamp, Arc<Task> idle)
+    : _cpu(cpu),
+      _stamp(stamp),
+      _prev(idle),
+      _curr(idle),
+      _idle(idle) {
+}
+
+template <typename T, typename Less>
+static void _heapPush(Vec<T>& heap, T val, Less less) {
+    heap.pushBack(std::move(val));
+
+    usize i = heap.len() - 1;
+    while (i > 0) {
+        usize parent = (i - 1) / 2;
+        if (not less(heap[i], heap[parent]))
+            break;
+        std::swap(heap[i], heap[parent]);
+        i = parent;
+    }
+}
+
+template <typename T, typename Less>
+static T _heapPop(Vec<T>& heap, Less less) {
+    std::swap(heap[0], heap[heap.len() - 1]);
+    auto val = heap.popBack();
+
+    usize i = 0;
+    while (true) {
+        usize min = i;
+        usize left = i * 2 + 1;
+        usize right = left + 1;
+        if (left < heap.len() and less(heap[left], heap[min]))
+            min = left;
+        if (right < heap.len() and less(heap[right], heap[min]))
+            min = right;
+        if (min == i)
+            break;
+        std::swap(heap[i], heap[min]);
+        i = min;
+    }
+
+    return val;
 }
 
-Sched::Sched(Arc<Task> boot)
-    : _tasks{boot},
-      _prev(boot),
-      _curr(boot),
-      _idle(boot) {
+static bool _before(Arc<Task> const& lhs, Arc<Task> const& rhs) {
+    return lhs->_sliceEnd < rhs->_sliceEnd;
+}
+
+static bool _wakesBefore(Arc<Task> const& lhs, Arc<Task> const& rhs) {
+    return lhs->_wakeAt < rhs->_wakeAt;
+}
+
+void Sched::_push(Arc<Task> task) {
+    _heapPush(_runnable, std::move(task), _before);
+    _load.store(_runnable.len());
+}
+
+Arc<Task> Sched::_pop() {
+    auto task = _heapPop(_runnable, _before);
+    _load.store(_runnable.len());
+    return task;
+}
+
+void Sched::_park(Arc<Task> task) {
+    auto state = task->eval(_stamp);
+    if (state == State::EXITED)
+        logInfo("{}: exited", *task);
+    else if (state == State::BLOCKED)
+        _heapPush(_blocked, std::move(task), _wakesBefore);
+    else
+        _push(std::move(task));
+}
+
+void Sched::_wake() {
+    // NOTE: Blockers only change their mind when something is signaled,
+    //       otherwise only the tasks whose deadline passed need a look.
+    auto epoch = Object::_epoch.load();
+    if (epoch != _epoch) {
+        _epoch = epoch;
+        auto blocked = std::move(_blocked);
+        for (auto& task : blocked)
+            _park(std::move(task));
+        return;
+    }
+
+    while (_blocked.len() and _blocked[0]->_wakeAt <= _stamp)
+        _park(_heapPop(_blocked, _wakesBefore));
+}
+
+Opt<Arc<Task>> Sched::_steal() {
+    Sched* victim = nullptr;
+    for (usize i = 0; i < cpuCount(); i++) {
+        auto& other = *_scheds[i];
+        if (&other != this and other.load() and (not victim or other.load() > victim->load()))
+            victim = &other;
+    }
+
+    // NOTE: The lock is only tried, so two cpus stealing from each other
+    //       can't deadlock.
+    if (not victim or not victim->_lock.tryAcquire())
+        return NONE;
+
+    // NOTE: A task that was switched out during the current tick of the
+    //       victim might still have its stack in use by the victim.
+    Opt<Arc<Task>> task = NONE;
+    if (victim->_runnable.len() and victim->_runnable[0]->_sliceEnd < victim->_stamp)
+        task = victim->_pop();
+
+    victim->_lock.release();
+    return task;
+}
+
+void Sched::_switch(Arc<Task> task) {
+    _idling.store(&task.unwrap() == &_idle.unwrap());
+    _curr = std::move(task);
 }
 
 Res<> Sched::enqueue(Arc<Task> task) {
     LockScope scope(_lock);
-    _tasks.pushBack(std::move(task));
+    _push(std::move(task));
     return Ok();
 }
 
 void Sched::schedule(Duration span) {
     LockScope scope(_lock);
 
-    _stamp += span;
+    if (_cpu == 0)
+        _clock.fetchAdd(span.val());
+    _stamp = now();
+
     _prev = _curr;
-    _curr->_sliceEnd = _stamp;
-
-    auto next = _idle;
-    // NOTE: to make sure the idle task is always scheduled last
-    _idle->_sliceEnd = _stamp + 1;
-
-    for (usize i = 0; i < _tasks.len(); ++i) {
-        auto& t = _tasks[i];
-        auto state = t->eval(_stamp);
-        if (state == State::EXITED) {
-            logInfo("{}: exited", *t);
-            _tasks.removeAt(i--);
-        } else if (state == State::RUNNABLE and t->_sliceEnd <= next->_sliceEnd) {
-            next = t;
+    if (not idle()) {
+        _curr->_sliceEnd = _stamp;
+        _park(_curr);
+    }
+
+    _wake();
+
+    while (_runnable.len()) {
+        auto next = _pop();
+        if (next->eval(_stamp) == State::RUNNABLE) {
+            _switch(next);
+            return;
+        }
+        _park(next);
+    }
+
+    if (auto stolen = _steal()) {
+        (*stolen)->_sliceEnd = _stamp;
+        if ((*stolen)->eval(_stamp) == State::RUNNABLE) {
+            _switch(*stolen);
+            return;
         }
+        _park(*stolen);
     }
 
-    _curr = next;
+    _switch(_idle);
 }
 
 } // namespace Hjert::Core
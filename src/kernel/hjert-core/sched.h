@@ -1,6 +1,7 @@
 #pragma once
 
 #include <handover/spec.h>
+#include <karm-base/atomic.h>
 #include <karm-base/rc.h>
 #include <karm-base/res.h>
 #include <karm-base/time.h>
@@ -10,16 +11,50 @@ namespace Hjert::Core {
 
 struct Task;
 
+static constexpr usize MAX_CPUS = 64;
+
+// The run queue of a single cpu, runnable tasks are kept in a min-heap
+// ordered by the end of their last slice so the one that waited the most
+// runs next, blocked tasks in one ordered by their deadline. Idle cpus
+// steal work from the busiest queue.
 struct Sched {
+    usize _cpu;
     Instant _stamp{};
     Lock _lock{};
 
-    Vec<Arc<Task>> _tasks;
+    Vec<Arc<Task>> _runnable;
+    Vec<Arc<Task>> _blocked;
+    usize _epoch = 0;
+    Atomic<usize> _load{};
+
+    // NOTE: Read by other cpus without holding the lock.
+    Atomic<bool> _idling{true};
+
     Arc<Task> _prev;
     Arc<Task> _curr;
     Arc<Task> _idle;
 
-    Sched(Arc<Task> boot);
+    Sched(usize cpu, Instant stamp, Arc<Task> idle);
+
+    usize load() {
+        return _load.load();
+    }
+
+    bool idle() {
+        return _idling.load();
+    }
+
+    void _switch(Arc<Task> task);
+
+    void _push(Arc<Task> task);
+
+    Arc<Task> _pop();
+
+    void _park(Arc<Task> task);
+
+    void _wake();
+
+    Opt<Arc<Task>> _steal();
 
     Res<> enqueue(Arc<Task> task);
 
@@ -28,6 +63,17 @@ struct Sched {
 
 Res<> initSched(Handover::Payload& payload);
 
+// Bring up the run queue of an application processor, with the current
+// context as its idle task.
+Res<> initSched(usize cpu);
+
+// Enqueue a task on the least loaded cpu.
+Res<> enqueue(Arc<Task> task);
+
+usize cpuCount();
+
+Instant now();
+
 Sched& globalSched();
 
 } // namespace Hjert::Core
@@ -0,0 +1,327 @@
+#include <karm-base/align.h>
+#include <karm-base/bits.h>
+#include <karm-base/lock.h>
+#include <karm-logger/logger.h>
+
+#include "arch.h"
+#include "mem.h"
+#include "sched.h"
+#include "slab.h"
+
+namespace Hjert::Core {
+
+// MARK: Pages -----------------------------------------------------------------
+
+// NOTE: Slabs are carved from the direct map, two bitmaps over the usable
+//       memory tell which pages belong to a slab and where each slab
+//       starts, so a freed pointer can be traced back to its slab header.
+static Hal::PmmRange _usable = {};
+static Opt<Bits> _owned = NONE;
+static Opt<Bits> _heads = NONE;
+static Lock _pagesLock;
+
+static usize _pageOf(void* ptr) {
+    return (reinterpret_cast<usize>(ptr) - Hal::UPPER_HALF - _usable.start) / Hal::PAGE_SIZE;
+}
+
+static bool _owns(void* ptr) {
+    if (not _owned)
+        return false;
+
+    auto addr = reinterpret_cast<usize>(ptr);
+    if (addr < Hal::UPPER_HALF + _usable.start or addr >= Hal::UPPER_HALF + _usable.end())
+        return false;
+
+    return _owned->get(_pageOf(ptr));
+}
+
+static void _markPages(Hal::KmmRange range, bool value) {
+    LockScope scope(_pagesLock);
+    auto first = _pageOf(reinterpret_cast<void*>(range.start));
+    _owned->set(BitsRange{first, range.size / Hal::PAGE_SIZE}, value);
+    _heads->set(first, value);
+}
+
+static Res<Bits> _allocBits(usize len) {
+    auto range = try$(kmm().allocRange(Hal::pageAlignUp(len / 8 + 1)));
+    Bits bits{MutSlice<u8>{range.as<u8>(), range.size}};
+    bits.fill(false);
+    return Ok(bits);
+}
+
+// MARK: Slabs -----------------------------------------------------------------
+
+struct _Free {
+    _Free* next;
+};
+
+// The header at the start of every slab, followed by its objects.
+struct _Slab {
+    _Slab* prev;
+    _Slab* next;
+    _Free* free;
+    usize used;
+    usize klass;
+};
+
+static constexpr usize SLAB_HEADER = alignUp(sizeof(_Slab), SLAB_MIN);
+
+static _Slab* _slabOf(void* ptr) {
+    auto page = _pageOf(ptr);
+    while (not _heads->get(page))
+        page--;
+    return reinterpret_cast<_Slab*>(Hal::UPPER_HALF + _usable.start + page * Hal::PAGE_SIZE);
+}
+
+// The slabs of a size class, slabs with free objects are kept in a list
+// with the partially used ones first so empty slabs can be given back.
+struct _Cache {
+    static constexpr usize MAX_EMPTY = 2;
+
+    Lock _lock;
+    usize _klass = 0;
+    usize _size = 0;
+    usize _pages = 0;
+
+    _Slab* _head = nullptr;
+    _Slab* _tail = nullptr;
+    usize _empty = 0;
+    usize _slabs = 0;
+
+    usize count() const {
+        return (_pages * Hal::PAGE_SIZE - SLAB_HEADER) / _size;
+    }
+
+    void _link(_Slab* slab, bool tail) {
+        if (tail) {
+            slab->prev = _tail;
+            slab->next = nullptr;
+            if (_tail)
+                _tail->next = slab;
+            else
+                _head = slab;
+            _tail = slab;
+        } else {
+            slab->prev = nullptr;
+            slab->next = _head;
+            if (_head)
+                _head->prev = slab;
+            else
+                _tail = slab;
+            _head = slab;
+        }
+    }
+
+    void _unlink(_Slab* slab) {
+        if (slab->prev)
+            slab->prev->next = slab->next;
+        else
+            _head = slab->next;
+
+        if (slab->next)
+            slab->next->prev = slab->prev;
+        else
+            _tail = slab->prev;
+
+        slab->prev = slab->next = nullptr;
+    }
+
+    Res<> _grow() {
+        auto range = try$(kmm().allocRange(_pages * Hal::PAGE_SIZE));
+        auto* slab = range.as<_Slab>();
+        slab->free = nullptr;
+        slab->used = 0;
+        slab->klass = _klass;
+
+        // NOTE: Objects are threaded in reverse so they are handed out in
+        //       address order.
+        for (usize i = count(); i > 0; i--) {
+            auto* obj = reinterpret_cast<_Free*>(range.start + SLAB_HEADER + (i - 1) * _size);
+            obj->next = slab->free;
+            slab->free = obj;
+        }
+
+        _markPages(range, true);
+        _link(slab, true);
+        _empty++;
+        _slabs++;
+        return Ok();
+    }
+
+    void _release(_Slab* slab) {
+        _unlink(slab);
+        Hal::KmmRange range = {reinterpret_cast<usize>(slab), _pages * Hal::PAGE_SIZE};
+        _markPages(range, false);
+        if (auto res = kmm().free(range); not res)
+            logWarn("slab: failed to release slab: {}", res.none());
+        _slabs--;
+    }
+
+    // Move up to `out.len()` objects out of the slabs, growing the cache
+    // if needed.
+    usize take(MutSlice<void*> out) {
+        LockScope scope(_lock);
+
+        usize n = 0;
+        while (n < out.len()) {
+            if (not _head and not _grow())
+                break;
+
+            auto* slab = _head;
+            if (slab->used == 0)
+                _empty--;
+
+            while (n < out.len() and slab->free) {
+                out[n++] = slab->free;
+                slab->free = slab->free->next;
+                slab->used++;
+            }
+
+            if (not slab->free)
+                _unlink(slab);
+        }
+
+        return n;
+    }
+
+    void give(Slice<void*> objs) {
+        LockScope scope(_lock);
+
+        for (auto* ptr : objs) {
+            auto* slab = _slabOf(ptr);
+            if (not slab->free)
+                _link(slab, false);
+
+            auto* obj = static_cast<_Free*>(ptr);
+            obj->next = slab->free;
+            slab->free = obj;
+            slab->used--;
+
+            if (slab->used)
+                continue;
+
+            if (_empty >= MAX_EMPTY) {
+                _release(slab);
+            } else {
+                _unlink(slab);
+                _link(slab, true);
+                _empty++;
+            }
+        }
+    }
+};
+
+static Array<_Cache, Hj::SLAB_CLASSES> _caches;
+
+static usize _classOf(usize size) {
+    usize klass = 0;
+    while ((SLAB_MIN << klass) < size)
+        klass++;
+    return klass;
+}
+
+// MARK: Magazines -------------------------------------------------------------
+
+// A small stack of free objects owned by a cpu, most allocations and frees
+// are served from it without taking any lock. It is refilled from and
+// flushed to the shared cache by halves so a cpu that alternates between
+// both doesn't bounce on the cache lock.
+struct _Magazine {
+    static constexpr usize LEN = 32;
+
+    usize len = 0;
+    Array<void*, LEN> objs{};
+    usize allocs = 0;
+    usize frees = 0;
+};
+
+static Array<Array<_Magazine, Hj::SLAB_CLASSES>, MAX_CPUS> _magazines;
+
+// MARK: Public API ------------------------------------------------------------
+
+Res<> initSlab(Handover::Payload& payload) {
+    logInfo("slab: initializing...");
+
+    _usable = payload.usableRange<Hal::PmmRange>();
+    auto pages = _usable.size / Hal::PAGE_SIZE;
+    _heads = try$(_allocBits(pages));
+
+    for (usize i = 0; i < Hj::SLAB_CLASSES; i++) {
+        auto& cache = _caches[i];
+        cache._klass = i;
+        cache._size = SLAB_MIN << i;
+
+        // NOTE: Large classes span a few pages so the header doesn't waste
+        //       most of the slab.
+        cache._pages = max(1uz, cache._size * 16 / Hal::PAGE_SIZE);
+    }
+
+    // NOTE: This is set last, it's what makes the slabs visible to the heap.
+    _owned = try$(_allocBits(pages));
+
+    return Ok();
+}
+
+void* slabAlloc(usize size) {
+    if (not _owned or size > SLAB_MAX)
+        return nullptr;
+
+    auto klass = _classOf(size);
+    auto& cache = _caches[klass];
+
+    // NOTE: Interrupts are held so the task can't migrate to another cpu
+    //       while it's using the magazine.
+    CriticalScope scope;
+    auto& mag = _magazines[Arch::cpuId()][klass];
+    if (mag.len == 0)
+        mag.len = cache.take(mutSub(mag.objs, 0, _Magazine::LEN / 2));
+
+    if (mag.len == 0)
+        return nullptr;
+
+    auto* ptr = mag.objs[--mag.len];
+    mag.allocs++;
+    memset(ptr, 0, cache._size);
+    return ptr;
+}
+
+bool slabFree(void* ptr) {
+    if (not _owns(ptr))
+        return false;
+
+    auto klass = _slabOf(ptr)->klass;
+
+    CriticalScope scope;
+    auto& mag = _magazines[Arch::cpuId()][klass];
+    if (mag.len == _Magazine::LEN) {
+        _caches[klass].give(sub(mag.objs, _Magazine::LEN / 2, _Magazine::LEN));
+        mag.len = _Magazine::LEN / 2;
+    }
+
+    mag.objs[mag.len++] = ptr;
+    mag.frees++;
+    return true;
+}
+
+void slabStats(Array<Hj::SlabStats, Hj::SLAB_CLASSES>& stats) {
+    for (usize i = 0; i < Hj::SLAB_CLASSES; i++) {
+        auto& cache = _caches[i];
+        auto& s = stats[i];
+
+        {
+            LockScope scope(cache._lock);
+            s.size = cache._size;
+            s.slabs = cache._slabs;
+            s.objs = cache._slabs * cache.count();
+        }
+
+        s.allocs = 0;
+        s.frees = 0;
+        for (usize cpu = 0; cpu < cpuCount(); cpu++) {
+            s.allocs += _magazines[cpu][i].allocs;
+            s.frees += _magazines[cpu][i].frees;
+        }
+    }
+}
+
+} // namespace Hjert::Core
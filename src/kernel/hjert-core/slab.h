@@ -0,0 +1,23 @@
+#pragma once
+
+#include <handover/spec.h>
+#include <hjert-api/types.h>
+
+namespace Hjert::Core {
+
+static constexpr usize SLAB_MIN = 16;
+static constexpr usize SLAB_MAX = 2048;
+
+Res<> initSlab(Handover::Payload& payload);
+
+// Allocate a zeroed object from the size class fitting `size`, returns
+// nullptr if the size is too large for any class or memory ran out.
+void* slabAlloc(usize size);
+
+// Give an object back to its size class, returns false if the pointer
+// doesn't belong to a slab.
+bool slabFree(void* ptr);
+
+void slabStats(Array<Hj::SlabStats, Hj::SLAB_CLASSES>& stats);
+
+} // namespace Hjert::Core
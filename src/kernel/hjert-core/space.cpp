@@ -2,6 +2,7 @@
 #include <karm-logger/logger.h>
 
 #include "arch.h"
+#include "sched.h"
 #include "space.h"
 
 namespace Hjert::Core {
@@ -10,48 +11,58 @@ Res<Arc<Space>> Space::create() {
     return Ok(makeArc<Space>(try$(Arch::createVmm())));
 }
 
-Space::Space(Arc<Hal::Vmm> vmm) : _vmm(vmm) {
 #ifdef __ck_bits_64__
-    _ranges.add({Hal::PAGE_SIZE, 0x800000000000});
+static constexpr Hal::VmmRange _userRange = {Hal::PAGE_SIZE, 0x800000000000 - Hal::PAGE_SIZE};
 #else
-    _ranges.add({Hal::PAGE_SIZE, 0xC0000000});
+static constexpr Hal::VmmRange _userRange = {Hal::PAGE_SIZE, 0xC0000000 - Hal::PAGE_SIZE};
 #endif
+
+// NOTE: The space each cpu has loaded, or null for the kernel one. Only
+//       ever compared, never dereferenced.
+static Array<Atomic<Space const*>, MAX_CPUS> _loaded;
+
+Space::Space(Arc<Hal::Vmm> vmm) : _vmm(vmm) {
 }
 
 Space::~Space() {
-    while (_maps.len()) {
-        unmap(first(_maps).vrange)
-            .unwrap("unmap failed");
+    // NOTE: The cpus that still have the space loaded are moved off of it
+    //       before its page tables go away.
+    u64 cpus = 0;
+    for (usize cpu = 0; cpu < MAX_CPUS; cpu++) {
+        if (not _loaded[cpu].cmpxchg(this, nullptr))
+            continue;
+
+        if (cpu == Arch::cpuId())
+            Arch::globalVmm().activate();
+        else
+            cpus |= 1uz << cpu;
     }
-}
 
-Res<usize> Space::_lookup(Hal::VmmRange vrange) {
-    for (usize i = 0; i < _maps.len(); i++) {
-        auto& map = _maps[i];
-        if (map.vrange == vrange) {
-            return Ok(i);
-        }
-    }
+    if (cpus)
+        Arch::evict(cpus, _vmm->root());
 
-    return Error::invalidInput("no such mapping");
+    while (auto vrange = _maps.first()) {
+        _detach(*vrange)
+            .unwrap("unmap failed");
+    }
 }
 
 Res<> Space::_ensureNotMapped(Hal::VmmRange vrange) {
-    for (usize i = 0; i < _maps.len(); i++) {
-        auto& map = _maps[i];
-        if (map.vrange.overlaps(vrange)) {
-            return Error::invalidInput("already mapped");
-        }
+    if (not _userRange.contains(vrange)) {
+        return Error::invalidInput("outside of address space");
+    }
+
+    if (_maps.overlaps(vrange)) {
+        return Error::invalidInput("already mapped");
     }
 
     return Ok();
 }
 
 Res<> Space::_validate(Hal::VmmRange vrange) {
-    for (auto& map : _maps) {
-        if (map.vrange.contains(vrange)) {
-            return Ok();
-        }
+    auto* map = _maps.lookup(vrange.start);
+    if (map and map->range.contains(vrange)) {
+        return Ok();
     }
 
     return Error::invalidInput("bad address");
@@ -73,51 +84,84 @@ Res<Hal::VmmRange> Space::map(Hal::VmmRange vrange, Arc<Vmo> vmo, usize off, Hj:
     }
 
     if (vrange.start == 0) {
-        vrange = try$(_ranges.take(vrange.size));
+        auto start = _maps.findGap(vrange.size, _userRange);
+        if (not start) {
+            return Error::outOfMemory("address space exhausted");
+        }
+        vrange.start = *start;
     } else {
         try$(_ensureNotMapped(vrange));
-        _ranges.remove(vrange);
     }
 
-    Map map = {vrange, off, std::move(vmo)};
+    Map map = {vrange, off, std::move(vmo), flags};
 
     Hal::PmmRange prange = {map.vmo->range().start + map.off, vrange.size};
     try$(_vmm->mapRange(map.vrange, prange, flags | Hal::VmmFlags::USER));
     try$(_vmm->flush(map.vrange));
 
-    _maps.pushBack(std::move(map));
+    try$(_maps.insert(vrange, std::move(map)));
 
     return Ok(vrange);
 }
 
 Res<> Space::unmap(Hal::VmmRange vrange) {
+    try$(detach(vrange));
+    return Ok();
+}
+
+Res<Space::Map> Space::detach(Hal::VmmRange vrange) {
+    auto map = try$(_detach(vrange));
+
+    // NOTE: The lock is released first, the other cpus might be spinning
+    //       on it with interrupts disabled.
+    if (auto cpus = _otherCpus())
+        Arch::shootdown(cpus, vrange);
+
+    return Ok(std::move(map));
+}
+
+Res<Space::Map> Space::_detach(Hal::VmmRange vrange) {
     ObjectLockScope scope(*this);
 
     try$(vrange.ensureAligned(Hal::PAGE_SIZE));
 
-    auto id = try$(_lookup(vrange));
-    auto& map = _maps[id];
+    auto* map = _maps.lookup(vrange.start);
+    if (not map or map->range != vrange) {
+        return Error::invalidInput("no such mapping");
+    }
 
-    try$(_vmm->free(map.vrange));
-    try$(_vmm->flush(map.vrange));
+    try$(_vmm->free(vrange));
+    try$(_vmm->flush(vrange));
 
-    _ranges.add(map.vrange);
-    _maps.removeAt(id);
-    return Ok();
+    return Ok(_maps.remove(vrange).unwrap());
 }
 
 void Space::activate() {
+    _loaded[Arch::cpuId()].store(this);
     _vmm->activate();
 }
 
+void Space::deactivate() {
+    if (_loaded[Arch::cpuId()].xchg(nullptr))
+        Arch::globalVmm().activate();
+}
+
+u64 Space::_otherCpus() {
+    u64 cpus = 0;
+    for (usize cpu = 0; cpu < cpuCount(); cpu++) {
+        if (cpu != Arch::cpuId() and _loaded[cpu].load() == this)
+            cpus |= 1uz << cpu;
+    }
+    return cpus;
+}
+
 void Space::dump() {
     ObjectLockScope scope(*this);
-    for (auto& map : _maps) {
-        auto vrange = map.vrange;
+    _maps.visit([&](auto vrange, auto& map) {
         auto prange = map.prange();
         auto size = vrange.size / 1024;
         logDebug("{}: map: {x}-{x} -> {x}-{x} {} {}kib", *this, vrange.start, vrange.end(), prange.start, prange.end(), map.vmo->label(), size);
-    }
+    });
     _vmm->dump();
 }
 
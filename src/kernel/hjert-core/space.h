@@ -1,6 +1,6 @@
 #pragma once
 
-#include <karm-base/ranges.h>
+#include <karm-base/range-tree.h>
 
 #include "object.h"
 #include "vmo.h"
@@ -12,6 +12,7 @@ struct Space : public BaseObject<Space, Hj::Type::SPACE> {
         Hal::VmmRange vrange;
         usize off;
         Arc<Vmo> vmo;
+        Hj::MapFlags flags;
 
         Hal::PmmRange prange() {
             return vmo->range().slice(off, vrange.size);
@@ -19,8 +20,7 @@ struct Space : public BaseObject<Space, Hj::Type::SPACE> {
     };
 
     Arc<Hal::Vmm> _vmm;
-    Ranges<Hal::VmmRange> _ranges;
-    Vec<Map> _maps;
+    RangeTree<Hal::VmmRange, Map> _maps;
 
     static Res<Arc<Space>> create();
 
@@ -28,8 +28,6 @@ struct Space : public BaseObject<Space, Hj::Type::SPACE> {
 
     ~Space() override;
 
-    Res<usize> _lookup(Hal::VmmRange vrange);
-
     Res<> _ensureNotMapped(Hal::VmmRange vrange);
 
     Res<> _validate(Hal::VmmRange vrange);
@@ -38,8 +36,20 @@ struct Space : public BaseObject<Space, Hj::Type::SPACE> {
 
     Res<> unmap(Hal::VmmRange vrange);
 
+    Res<Map> _detach(Hal::VmmRange vrange);
+
+    // Unmap a whole mapping and hand it back to the caller.
+    Res<Map> detach(Hal::VmmRange vrange);
+
     void activate();
 
+    // Switch the current cpu back to the kernel address space.
+    static void deactivate();
+
+    // The other cpus that have this space loaded, and might still have
+    // some of its translations cached.
+    u64 _otherCpus();
+
     void dump();
 };
 
@@ -8,6 +8,7 @@
 #include "iop.h"
 #include "irq.h"
 #include "listener.h"
+#include "mem.h"
 #include "sched.h"
 #include "syscalls.h"
 #include "task.h"
@@ -147,7 +148,7 @@ Res<> doStart(Task& self, Hj::Cap cap, usize ip, usize sp, User<Hj::Args const>
     (void)args;
     auto obj = try$(self.domain().get<Task>(cap));
     try$(obj->ready(ip, sp, try$(args.load(self.space()))));
-    try$(globalSched().enqueue(obj));
+    try$(enqueue(obj));
     return Ok();
 }
 
@@ -188,7 +189,59 @@ Res<> doOut(Task& self, Hj::Cap cap, Hj::IoLen len, usize port, Hj::Arg val) {
     return obj->out(port, Hj::ioLen2Bytes(len), val);
 }
 
-Res<> doSend(Task& self, Hj::Cap cap, UserSlice<Bytes> buf, UserSlice<Slice<Hj::Cap>> caps) {
+// NOTE: The pages are moved, not shared: once detached from the sender,
+//       the mapping must be the last reference to its vmo, and to every vmo
+//       it is a slice of. Otherwise the sender could still reach them
+//       through a handle or another mapping.
+static bool _soleOwner(Arc<Vmo> const& vmo) {
+    if (vmo.strong() != 1)
+        return false;
+    if (vmo->_parent)
+        return _soleOwner(*vmo->_parent);
+    return true;
+}
+
+Res<> _sendPages(Task& self, Hj::Cap cap, Hal::VmmRange vrange, UserSlice<Slice<Hj::Cap>> caps) {
+    auto obj = try$(self.domain().get<Channel>(cap));
+
+    // NOTE: The caps are copied first, they might live in the pages that
+    //       are about to be unmapped.
+    Vec<Hj::Cap> kcaps;
+    try$(caps.with(self.space(), [&](Slice<Hj::Cap> caps) -> Res<> {
+        kcaps.pushBack(caps);
+        return Ok();
+    }));
+
+    auto map = try$(self.space().detach(vrange));
+
+    // The message was not sent, give the pages back to the sender.
+    auto restore = [&](Error err) -> Res<> {
+        try$(self.space().map(map.vrange, map.vmo, map.off, map.flags));
+        return err;
+    };
+
+    if (not _soleOwner(map.vmo))
+        return restore(Error::permissionDenied("pages are still shared"));
+
+    auto vmo = map.vmo;
+    if (map.off != 0 or map.vrange.size != vmo->range().size) {
+        auto slice = Vmo::makeSlice(vmo, map.off, map.vrange.size);
+        if (not slice)
+            return restore(slice.none());
+        vmo = slice.take();
+    }
+
+    auto res = obj->send(self.domain(), {}, kcaps, vmo);
+    if (not res)
+        return restore(res.none());
+
+    return Ok();
+}
+
+Res<> doSend(Task& self, Hj::Cap cap, UserSlice<Bytes> buf, UserSlice<Slice<Hj::Cap>> caps, Flags<Hj::SendFlags> flags) {
+    if (flags.has(Hj::SendFlags::PAGES))
+        return _sendPages(self, cap, buf.vrange(), caps);
+
     return with(
         self.space(),
         [&](auto buf, auto caps) -> Res<> {
@@ -261,6 +314,10 @@ Res<> doPoll(Task& self, Hj::Cap cap, UserSlice<MutSlice<Hj::Event>> events, Use
     return Ok();
 }
 
+Res<> doStats(Task& self, User<Hj::MemStats> stats) {
+    return stats.store(self.space(), memStats());
+}
+
 Res<> dispatchSyscall(Task& self, Hj::Syscall id, Hj::Args args) {
     switch (id) {
     case Hj::Syscall::NOW:
@@ -304,7 +361,8 @@ Res<> dispatchSyscall(Task& self, Hj::Syscall id, Hj::Args args) {
             self,
             Hj::Cap{args[0]},
             {args[1], args[2]},
-            {args[3], args[4]}
+            {args[3], args[4]},
+            (Hj::SendFlags)args[5]
         );
 
     case Hj::Syscall::RECV: {
@@ -332,6 +390,9 @@ Res<> dispatchSyscall(Task& self, Hj::Syscall id, Hj::Args args) {
     case Hj::Syscall::POLL:
         return doPoll(self, Hj::Cap{args[0]}, {args[1], args[2]}, args[3], args[4]);
 
+    case Hj::Syscall::STATS:
+        return doStats(self, args[0]);
+
     default:
         return Error::invalidInput("invalid syscall id");
     }
@@ -85,7 +85,8 @@ State Task::eval(Instant now) {
         return State::EXITED;
 
     if (_block) {
-        if ((*_block)() > now) {
+        _wakeAt = (*_block)();
+        if (_wakeAt > now) {
             return State::BLOCKED;
         }
         _block = NONE;
@@ -101,6 +102,8 @@ void Task::save(Arch::Frame const& frame) {
 void Task::load(Arch::Frame& frame) {
     if (_space)
         (*_space)->activate();
+    else
+        Space::deactivate();
 
     (*_ctx)->load(frame);
 }
@@ -33,6 +33,7 @@ struct Task :
     Flags<Hj::Pledge> _pledges = Hj::Pledge::ALL;
 
     Instant _sliceEnd = 0;
+    Instant _wakeAt = 0;
 
     static Res<Arc<Task>> create(
         Mode mode,
@@ -23,6 +23,23 @@ Res<Arc<Vmo>> Vmo::makeDma(Hal::DmaRange prange) {
     return Ok(makeArc<Vmo>(prange));
 }
 
+Res<Arc<Vmo>> Vmo::makeSlice(Arc<Vmo> parent, usize off, usize size) {
+    if (size == 0) {
+        return Error::invalidInput("size is zero");
+    }
+
+    try$(ensureAlign(off, Hal::PAGE_SIZE));
+    try$(ensureAlign(size, Hal::PAGE_SIZE));
+
+    auto prange = parent->range();
+    if (off + size > prange.size) {
+        return Error::invalidInput("slice out of range");
+    }
+
+    Hal::DmaRange range = {prange.start + off, size};
+    return Ok(makeArc<Vmo>(range, std::move(parent)));
+}
+
 Hal::PmmRange Vmo::range() {
     return _mem.visit(
         Visitor{
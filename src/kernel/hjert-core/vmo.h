@@ -9,12 +9,18 @@ namespace Hjert::Core {
 struct Vmo : public BaseObject<Vmo, Hj::Type::VMO> {
     using _Mem = Union<Hal::PmmMem, Hal::DmaRange>;
     _Mem _mem;
+    Opt<Arc<Vmo>> _parent;
 
     static Res<Arc<Vmo>> alloc(usize size, Hj::VmoFlags);
 
     static Res<Arc<Vmo>> makeDma(Hal::DmaRange prange);
 
-    Vmo(_Mem mem) : _mem(std::move(mem)) {}
+    // A vmo sharing the pages of a range of its parent, which is kept alive
+    // for as long as the slice exists.
+    static Res<Arc<Vmo>> makeSlice(Arc<Vmo> parent, usize off, usize size);
+
+    Vmo(_Mem mem, Opt<Arc<Vmo>> parent = NONE)
+        : _mem(std::move(mem)), _parent(std::move(parent)) {}
 
     Hal::PmmRange range();
 };
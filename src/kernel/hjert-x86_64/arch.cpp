@@ -1,3 +1,5 @@
+#include <acpi/spec.h>
+#include <hal-x86_64/apic.h>
 #include <hal-x86_64/com.h>
 #include <hal-x86_64/gdt.h>
 #include <hal-x86_64/idt.h>
@@ -14,6 +16,8 @@
 #include <hjert-core/space.h>
 #include <hjert-core/syscalls.h>
 #include <hjert-core/task.h>
+#include <karm-base/defer.h>
+#include <karm-base/size.h>
 #include <karm-base/witty.h>
 
 #include "ints.h"
@@ -84,14 +88,29 @@ struct Cpu : public Core::Cpu {
     }
 };
 
-static Cpu _cpu{};
+static Array<Cpu, Core::MAX_CPUS> _cpus{};
+
+static Opt<x86_64::Lapic> _lapic = NONE;
+static Array<u8, 256> _lapicToCpu{};
+static Array<u8, Core::MAX_CPUS> _cpuToLapic{};
+
+usize cpuId() {
+    if (not _lapic)
+        return 0;
+    return _lapicToCpu[_lapic->id()];
+}
 
 Core::Cpu& globalCpu() {
-    return _cpu;
+    return _cpus[cpuId()];
 }
 
 // MARK: Interrupts ------------------------------------------------------------
 
+static constexpr u8 IPI_KICK = 101;
+static constexpr u8 LAPIC_TIMER = 102;
+static constexpr u8 IPI_SHOOTDOWN = 103;
+static constexpr u8 LAPIC_SPURIOUS = 0xFF;
+
 static char const* _faultMsg[32] = {
     "division-by-zero",
     "debug",
@@ -180,6 +199,62 @@ void kPanic(Frame& frame) {
     panic("cpu exception");
 }
 
+// MARK: Tlb Shootdown ---------------------------------------------------------
+
+static Lock _shootdownLock;
+static Hal::VmmRange _shootdownRange;
+static usize _shootdownRoot;
+static Atomic<u64> _shootdownPending;
+
+static void _serviceShootdown() {
+    u64 self = 1uz << cpuId();
+    if (not(_shootdownPending.load() & self))
+        return;
+
+    if (_shootdownRoot) {
+        if ((x86_64::rdcr3() & ~0xFFFuz) == _shootdownRoot)
+            globalVmm().activate();
+    } else {
+        for (usize i = 0; i < _shootdownRange.size; i += Hal::PAGE_SIZE)
+            x86_64::invlpg(_shootdownRange.start + i);
+    }
+
+    u64 pending = _shootdownPending.load();
+    while (not _shootdownPending.cmpxchg(pending, pending & ~self))
+        pending = _shootdownPending.load();
+}
+
+static void _shootdown(u64 cpus, Hal::VmmRange vrange, usize root) {
+    if (not _lapic)
+        return;
+
+    // NOTE: Whoever holds the lock might be waiting on us, keep answering
+    //       its requests while spinning.
+    while (not _shootdownLock.tryAcquire())
+        _serviceShootdown();
+
+    _shootdownRange = vrange;
+    _shootdownRoot = root;
+    _shootdownPending.store(cpus);
+    for (usize cpu = 0; cpu < Core::MAX_CPUS; cpu++) {
+        if (cpus & (1uz << cpu))
+            _lapic->sendIpi(_cpuToLapic[cpu], IPI_SHOOTDOWN);
+    }
+
+    while (_shootdownPending.load())
+        x86_64::pause();
+
+    _shootdownLock.release();
+}
+
+void shootdown(u64 cpus, Hal::VmmRange vrange) {
+    _shootdown(cpus, vrange, 0);
+}
+
+void evict(u64 cpus, usize root) {
+    _shootdown(cpus, {}, root);
+}
+
 extern "C" void _intDispatch(usize sp) {
     auto& frame = *reinterpret_cast<Frame*>(sp);
 
@@ -192,6 +267,17 @@ extern "C" void _intDispatch(usize sp) {
             kPanic(frame);
     } else if (frame.intNo == 100) {
         switchTask(0_ms, frame);
+    } else if (frame.intNo == IPI_KICK) {
+        switchTask(0_ms, frame);
+        _lapic->eoi();
+    } else if (frame.intNo == IPI_SHOOTDOWN) {
+        _serviceShootdown();
+        _lapic->eoi();
+    } else if (frame.intNo == LAPIC_TIMER) {
+        switchTask(1_ms, frame);
+        _lapic->eoi();
+    } else if (frame.intNo == LAPIC_SPURIOUS) {
+        // NOTE: Spurious interrupts must not be acknowledged.
     } else {
         isize irq = frame.intNo - 32;
 
@@ -350,4 +436,236 @@ Res<Box<Core::Context>> createContext(Core::Mode mode, usize ip, usize sp, usize
     return Ok<Box<Core::Context>>(std::move(ctx));
 }
 
+// MARK: Smp -------------------------------------------------------------------
+
+struct CpuLocal {
+    x86_64::Tss tss{};
+    x86_64::Gdt gdt{tss};
+    x86_64::GdtDesc gdtDesc{gdt};
+    Array<Byte, Hal::PAGE_SIZE * 16> kstack{};
+};
+
+static constexpr usize AP_STACK_SIZE = Hal::PAGE_SIZE * 16;
+
+static Array<Opt<Box<CpuLocal>>, Core::MAX_CPUS> _locals;
+static u32 _lapicTicksPerMs = 0;
+
+// Whether an application processor is allowed to come online, so one that
+// starts after the boot cpu gave up on it doesn't use memory that was
+// released in the meantime.
+enum struct ApState : u8 {
+    WAITING,
+    RUNNING,
+    ABORTED,
+};
+
+static Array<Atomic<ApState>, Core::MAX_CPUS> _apStates{};
+
+static void _delay(Duration span) {
+    auto until = Core::now() + span;
+    while (Core::now() < until)
+        x86_64::pause();
+}
+
+// Measure the frequency of the lapic timer against the tick of the boot
+// cpu, the application processors use it as their own tick.
+static void _calibrate() {
+    auto start = Core::now();
+    while (Core::now() == start)
+        x86_64::pause();
+
+    _lapic->timerStart();
+    _delay(10_ms);
+    _lapicTicksPerMs = _lapic->timerElapsed() / 10;
+}
+
+static Res<Vec<u8>> _findCpus(Handover::Payload& payload) {
+    auto const* record = payload.findTag(Handover::RSDP);
+    if (not record)
+        return Error::notFound("no rsdp");
+
+    auto const* rsdp = reinterpret_cast<Acpi::Rsdp const*>(record->start + Handover::UPPER_HALF);
+    auto const* rsdt = reinterpret_cast<Acpi::Rsdt const*>(rsdp->rsdt + Handover::UPPER_HALF);
+
+    usize len = (rsdt->len - sizeof(Acpi::Sdth)) / sizeof(u32);
+    for (usize i = 0; i < len; i++) {
+        auto const* sdt = reinterpret_cast<Acpi::Sdth const*>(rsdt->children[i] + Handover::UPPER_HALF);
+        if (Str{sdt->signature.buf(), sdt->signature.len()} != "APIC")
+            continue;
+
+        Vec<u8> lapics;
+        auto const* madt = static_cast<Acpi::Madt const*>(sdt);
+        auto const* curr = reinterpret_cast<u8 const*>(madt->records);
+        auto const* end = reinterpret_cast<u8 const*>(madt) + madt->len;
+        while (curr < end) {
+            auto const* r = reinterpret_cast<Acpi::Madt::Record const*>(curr);
+            if (r->len == 0)
+                break;
+
+            if (r->type == (u8)Acpi::Madt::Type::LAPIC) {
+                auto const* lapic = static_cast<Acpi::Madt::LapicRecord const*>(r);
+                if (lapic->flags & 1)
+                    lapics.pushBack(lapic->id);
+            }
+            curr += r->len;
+        }
+        return Ok(lapics);
+    }
+
+    return Error::notFound("no madt");
+}
+
+static void _apEntry(usize cpu) {
+    if (not _apStates[cpu].cmpxchg(ApState::WAITING, ApState::RUNNING))
+        stop();
+
+    auto& local = **_locals[cpu];
+    local.gdtDesc.load();
+    local.tss.rsp[0] = (u64)local.kstack.bytes().end();
+    x86_64::_tssUpdate();
+
+    _idtDesc.load();
+
+    x86_64::simdInit();
+    x86_64::sysInit(_sysHandler);
+
+    _lapic->enable(LAPIC_SPURIOUS);
+    _lapic->timerPeriodic(LAPIC_TIMER, _lapicTicksPerMs);
+
+    Core::enterCpu(cpu);
+}
+
+static bool _startCpu(Hal::PmmRange trampoline, usize cpu, u8 id) {
+    auto stack = Core::kmm().allocRange(AP_STACK_SIZE);
+    if (not stack)
+        return false;
+    _locals[cpu] = makeBox<CpuLocal>();
+    _apStates[cpu].store(ApState::WAITING);
+
+    auto* params = reinterpret_cast<ApParams*>(
+        trampoline.start + Handover::UPPER_HALF + (_apTrampolineParams - _apTrampolineStart)
+    );
+    params->cr3 = globalVmm().root();
+    params->stack = stack.unwrap().end();
+    params->entry = (u64)_apEntry;
+    params->cpu = cpu;
+    memoryBarier();
+
+    _lapicToCpu[id] = cpu;
+    _cpuToLapic[cpu] = id;
+
+    // NOTE: The INIT, SIPI, SIPI sequence, the second SIPI is only sent if
+    //       the cpu didn't start after the first one.
+    _lapic->sendInit(id);
+    _delay(10_ms);
+    for (usize attempt = 0; attempt < 2; attempt++) {
+        _lapic->sendStartup(id, trampoline.start / Hal::PAGE_SIZE);
+        for (usize i = 0; i < 100; i++) {
+            if (Core::cpuCount() > cpu)
+                return true;
+            _delay(1_ms);
+        }
+    }
+
+    // NOTE: The cpu made it to the kernel right as we gave up, it doesn't
+    //       use the trampoline anymore and will show up shortly.
+    if (not _apStates[cpu].cmpxchg(ApState::WAITING, ApState::ABORTED)) {
+        while (Core::cpuCount() <= cpu)
+            _delay(1_ms);
+        return true;
+    }
+
+    // The cpu might still be running the trampoline, or be on its way to
+    // the kernel, put it back in wait-for-SIPI before the trampoline, its
+    // stack and its locals go away.
+    _lapic->sendInit(id);
+    _delay(10_ms);
+
+    (void)Core::kmm().free(stack.unwrap());
+    _locals[cpu] = NONE;
+    return false;
+}
+
+Res<> initCpus(Handover::Payload& payload) {
+    auto base = x86_64::rdmsr(x86_64::Msrs::APIC) & ~0xFFFuz;
+    _lapic = x86_64::Lapic::lapic(base + Handover::UPPER_HALF);
+
+    u8 bsp = _lapic->id();
+    _lapicToCpu[bsp] = 0;
+    _cpuToLapic[0] = bsp;
+    _lapic->enable(LAPIC_SPURIOUS);
+    _calibrate();
+
+    auto lapics = _findCpus(payload);
+    if (not lapics) {
+        logWarn("smp: {}, running on the boot cpu only", lapics.none());
+        return Ok();
+    }
+
+    // NOTE: The application processors start in real mode, so the
+    //       trampoline must live in the first megabyte and stay identity
+    //       mapped until they reach the upper half.
+    auto lower = Core::pmm().allocRange(Hal::PAGE_SIZE, Hal::PmmFlags::LOWER);
+    if (not lower) {
+        logError("smp: no memory below 1MiB for the trampoline");
+        return lower.none();
+    }
+    auto trampoline = lower.take();
+
+    Defer defer{[&] {
+        (void)globalVmm().free(Hal::identityMapped(trampoline));
+        (void)globalVmm().flush(Hal::identityMapped(trampoline));
+
+        u64 aps = 0;
+        for (usize cpu = 1; cpu < Core::cpuCount(); cpu++)
+            aps |= 1uz << cpu;
+        if (aps)
+            shootdown(aps, Hal::identityMapped(trampoline));
+
+        (void)Core::pmm().free(trampoline);
+    }};
+
+    if (globalVmm().root() >= gib(4)) {
+        logError("smp: kernel page tables out of reach of the trampoline");
+        return Error::outOfMemory("kernel page tables above 4GiB");
+    }
+
+    try$(globalVmm().mapRange(
+        Hal::identityMapped(trampoline),
+        trampoline,
+        Hal::Vmm::READ | Hal::Vmm::WRITE | Hal::Vmm::EXEC
+    ));
+
+    copy(
+        Bytes{_apTrampolineStart, _apTrampolineEnd},
+        MutBytes{reinterpret_cast<u8*>(trampoline.start + Handover::UPPER_HALF), Hal::PAGE_SIZE}
+    );
+
+    usize cpu = 1;
+    for (auto id : lapics.unwrap()) {
+        if (id == bsp)
+            continue;
+
+        if (cpu >= Core::MAX_CPUS) {
+            logWarn("smp: too many cpus, ignoring the rest");
+            break;
+        }
+
+        if (not _startCpu(trampoline, cpu, id)) {
+            logWarn("smp: cpu with lapic {} did not start", id);
+            break;
+        }
+
+        cpu++;
+    }
+
+    logInfo("smp: {} cpus online", Core::cpuCount());
+    return Ok();
+}
+
+void kick(usize cpu) {
+    if (_lapic)
+        _lapic->sendIpi(_cpuToLapic[cpu], IPI_KICK);
+}
+
 } // namespace Hjert::Arch
@@ -39,4 +39,17 @@ extern "C" void _sysHandler();
 
 extern "C" uintptr_t _sysDispatch(uintptr_t rsp);
 
+extern "C" u8 _apTrampolineStart[];
+
+extern "C" u8 _apTrampolineParams[];
+
+extern "C" u8 _apTrampolineEnd[];
+
+struct [[gnu::packed]] ApParams {
+    u64 cr3;
+    u64 stack;
+    u64 entry;
+    u64 cpu;
+};
+
 } // namespace Hjert::Arch
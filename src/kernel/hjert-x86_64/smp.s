@@ -0,0 +1,91 @@
+section .text
+
+; The application processors start in real mode at the page the trampoline
+; was copied to, this code is position independent so it runs from there.
+
+global _apTrampolineStart
+global _apTrampolineParams
+global _apTrampolineEnd
+
+%define REL(label) (label - _apTrampolineStart)
+
+[bits 16]
+_apTrampolineStart:
+    cli
+    cld
+
+    mov ax, cs
+    mov ds, ax
+
+    xor ebx, ebx
+    mov bx, ax
+    shl ebx, 4                          ; linear address of the trampoline
+
+    lea eax, [ebx + REL(_apGdt)]
+    mov [REL(_apGdtr) + 2], eax
+    lea eax, [ebx + REL(_apLongMode)]
+    mov [REL(_apFarJump)], eax
+
+    o32 lgdt [REL(_apGdtr)]
+
+    mov eax, cr4
+    or eax, 1 << 5                      ; PAE
+    mov cr4, eax
+
+    mov eax, [REL(_apParamCr3)]
+    mov cr3, eax
+
+    mov ecx, 0xC0000080                 ; EFER
+    rdmsr
+    or eax, 1 << 8                      ; LME
+    wrmsr
+
+    mov eax, cr0
+    or eax, 0x80000001                  ; PG | PE
+    mov cr0, eax
+
+    o32 jmp far [REL(_apFarJump)]
+
+[bits 64]
+_apLongMode:
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+    xor ax, ax
+    mov fs, ax
+    mov gs, ax
+
+    mov rsp, [rel _apParamStack]
+    mov rdi, [rel _apParamCpu]
+    mov rax, [rel _apParamEntry]
+
+    push qword 0                        ; no return address
+    jmp rax
+
+align 16
+_apGdt:
+    dq 0
+    dq 0x00AF9A000000FFFF               ; kernel code
+    dq 0x00CF92000000FFFF               ; kernel data
+
+_apGdtr:
+    dw _apGdtr - _apGdt - 1
+    dd 0
+
+_apFarJump:
+    dd 0
+    dw 0x08
+
+align 8
+_apTrampolineParams:
+_apParamCr3:
+    dq 0
+_apParamStack:
+    dq 0
+_apParamEntry:
+    dq 0
+_apParamCpu:
+    dq 0
+
+_apTrampolineEnd:
@@ -28,7 +28,16 @@ Res<> loadEntry(Entry const& entry) {
     auto kernelFile = try$(Sys::File::open(entry.kernel.url));
     auto kernelMem = try$(Sys::mmap().map(kernelFile));
     Elf::Image image{kernelMem.bytes()};
-    payload.add(Handover::FILE, 0, kernelMem.prange());
+    auto kernelProps = try$(Json::unparse(entry.kernel.props));
+    payload.add({
+        .tag = Handover::FILE,
+        .start = kernelMem.prange().start,
+        .size = kernelMem.prange().size,
+        .file = {
+            .name = (u32)payload.add(entry.kernel.url.str()),
+            .meta = (u32)payload.add(kernelProps),
+        },
+    });
     logInfo("opstart: kernel at vaddr: {p} paddr: {p}", kernelMem.vaddr(), kernelMem.paddr());
 
     if (not image.valid()) {
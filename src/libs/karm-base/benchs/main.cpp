@@ -0,0 +1,172 @@
+#include <karm-base/map.h>
+#include <karm-base/range-tree.h>
+#include <karm-base/ranges.h>
+#include <karm-base/ring.h>
+#include <karm-base/size.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static usize _key(usize i) {
+    return i * 0x9e3779b97f4a7c15ull;
+}
+
+template <typename M>
+static Duration _bench(usize n) {
+    auto start = Sys::now();
+
+    M map;
+    for (usize i = 0; i < n; i++)
+        map.put(_key(i), i);
+
+    usize hits = 0;
+    for (usize round = 0; round < 4; round++)
+        for (usize i = 0; i < n * 2; i++)
+            if (map.has(_key(i)))
+                hits++;
+
+    if (hits != n * 4)
+        panic("unexpected lookup result");
+
+    return Sys::now() - start;
+}
+
+// Push messages through a byte ring and back out, the way a channel moves
+// its payloads, either byte by byte or with bulk copies.
+template <bool BULK>
+static Duration _benchRing(usize msgSize, usize total) {
+    Vec<Byte> in;
+    in.resize(msgSize, 0x55);
+    Vec<Byte> out;
+    out.resize(msgSize, 0);
+
+    auto start = Sys::now();
+
+    Ring<Byte> ring{msgSize};
+    for (usize sent = 0; sent < total; sent += msgSize) {
+        if constexpr (BULK) {
+            ring.pushBack(in);
+            ring.popFront(out);
+        } else {
+            for (usize i = 0; i < msgSize; i++)
+                ring.pushBack(in[i]);
+            for (usize i = 0; i < msgSize; i++)
+                out[i] = ring.popFront();
+        }
+    }
+
+    if (out[msgSize - 1] != 0x55)
+        panic("unexpected ring content");
+
+    return Sys::now() - start;
+}
+
+// An address space keeping a flat list of its mappings next to a list of
+// free ranges, every operation scans them.
+struct _LinearSpace {
+    Ranges<urange> _free;
+    Vec<urange> _maps;
+
+    _LinearSpace() {
+        _free.add({0x1000, 0x800000000000 - 0x1000});
+    }
+
+    usize map(usize size) {
+        auto range = _free.take(size).unwrap();
+        _maps.pushBack(range);
+        return range.start;
+    }
+
+    bool has(usize addr) {
+        for (auto& map : _maps)
+            if (map.contains(addr))
+                return true;
+        return false;
+    }
+
+    void unmap(urange range) {
+        for (usize i = 0; i < _maps.len(); i++) {
+            if (_maps[i] == range) {
+                _free.add(_maps.removeAt(i));
+                return;
+            }
+        }
+    }
+};
+
+struct _TreeSpace {
+    static constexpr urange BOUNDS = {0x1000, 0x800000000000 - 0x1000};
+    RangeTree<urange, usize> _maps;
+
+    usize map(usize size) {
+        auto start = _maps.findGap(size, BOUNDS).unwrap();
+        _maps.insert({start, size}, 0).unwrap();
+        return start;
+    }
+
+    bool has(usize addr) {
+        return _maps.lookup(addr) != nullptr;
+    }
+
+    void unmap(urange range) {
+        (void)_maps.remove(range);
+    }
+};
+
+// Map n regions of 4KiB to 64KiB, look each of them up a few times the way
+// faults and user pointers are validated, then churn through unmapping and
+// remapping them in random order.
+template <typename S>
+static Duration _benchSpace(usize n) {
+    auto start = Sys::now();
+
+    S space;
+    Vec<urange> live;
+    for (usize i = 0; i < n; i++) {
+        usize size = (1 + _key(i) % 16) * 0x1000;
+        live.pushBack({space.map(size), size});
+    }
+
+    for (usize round = 0; round < 4; round++)
+        for (auto& range : live)
+            if (not space.has(range.start + range.size / 2))
+                panic("unexpected lookup result");
+
+    for (usize i = 0; i < n; i++) {
+        auto& range = live[_key(i) % n];
+        space.unmap(range);
+        usize size = (1 + _key(i + n) % 16) * 0x1000;
+        range = {space.map(size), size};
+    }
+
+    return Sys::now() - start;
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Sys::println("keys\tMap\tHashMap");
+
+    for (usize n : {10uz, 100uz, 1000uz, 10000uz, 100000uz}) {
+        auto ordered = _bench<Map<usize, usize>>(n);
+        auto unordered = _bench<HashMap<usize, usize>>(n);
+        Sys::println("{}\t{}\t{}", n, ordered, unordered);
+    }
+
+    Sys::println("");
+    Sys::println("message\tper-byte\tbulk\t(64MiB through a Ring<Byte>)");
+
+    for (usize size : {64uz, kib(4), mib(1)}) {
+        auto perByte = _benchRing<false>(size, mib(64));
+        auto bulk = _benchRing<true>(size, mib(64));
+        Sys::println("{}\t{}\t{}", size, perByte, bulk);
+    }
+
+    Sys::println("");
+    Sys::println("mappings\tlinear\tRangeTree");
+
+    for (usize n : {100uz, 1000uz, 10000uz}) {
+        auto linear = _benchSpace<_LinearSpace>(n);
+        auto tree = _benchSpace<_TreeSpace>(n);
+        Sys::println("{}\t{}\t{}", n, linear, tree);
+    }
+
+    co_return Ok();
+}
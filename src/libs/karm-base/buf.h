@@ -216,6 +216,9 @@ struct Buf {
         if (index + count > _len) [[unlikely]]
             panic("index + count out of bounds");
 
+        for (usize i = index; i < index + count; i++)
+            _buf[i].dtor();
+
         for (usize i = index; i < _len - count; i++)
             _buf[i].ctor(_buf[i + count].take());
 
@@ -481,6 +484,262 @@ struct InlineBuf {
     }
 };
 
+/// A buffer that keeps its first N elements inline and only moves them to the
+/// heap once it outgrows them, great for lists that are usually short.
+template <typename T, usize N>
+struct SmallBuf {
+    using Inner = T;
+
+    Manual<T> _inline[N];
+    Manual<T>* _heap = nullptr;
+    usize _cap = N;
+    usize _len = 0;
+
+    SmallBuf(usize cap = 0) {
+        ensure(cap);
+    }
+
+    SmallBuf(std::initializer_list<T> other) {
+        ensure(other.size());
+
+        _len = other.size();
+        for (usize i = 0; i < _len; i++)
+            _slots()[i].ctor(std::move(other.begin()[i]));
+    }
+
+    SmallBuf(Sliceable<T> auto const& other) {
+        ensure(other.len());
+
+        _len = other.len();
+        for (usize i = 0; i < _len; i++)
+            _slots()[i].ctor(other[i]);
+    }
+
+    SmallBuf(SmallBuf const& other) {
+        ensure(other._len);
+
+        _len = other._len;
+        for (usize i = 0; i < _len; i++)
+            _slots()[i].ctor(other[i]);
+    }
+
+    SmallBuf(SmallBuf&& other) {
+        _steal(other);
+    }
+
+    ~SmallBuf() {
+        _release();
+    }
+
+    SmallBuf& operator=(SmallBuf const& other) {
+        *this = SmallBuf(other);
+        return *this;
+    }
+
+    SmallBuf& operator=(SmallBuf&& other) {
+        if (this != &other) {
+            _release();
+            _steal(other);
+        }
+        return *this;
+    }
+
+    Manual<T>* _slots() {
+        return _heap ? _heap : _inline;
+    }
+
+    Manual<T> const* _slots() const {
+        return _heap ? _heap : _inline;
+    }
+
+    void _steal(SmallBuf& other) {
+        if (other._heap) {
+            _heap = std::exchange(other._heap, nullptr);
+            _cap = std::exchange(other._cap, N);
+            _len = std::exchange(other._len, 0);
+            return;
+        }
+
+        // NOTE: Inline elements can't change hands, they have to be moved
+        //       one by one.
+        _len = other._len;
+        for (usize i = 0; i < _len; i++)
+            _inline[i].ctor(other._inline[i].take());
+        other._len = 0;
+    }
+
+    void _release() {
+        trunc(0);
+        delete[] std::exchange(_heap, nullptr);
+        _cap = N;
+    }
+
+    void _move(Manual<T>* to, usize cap) {
+        auto* from = _slots();
+        for (usize i = 0; i < _len; i++)
+            to[i].ctor(from[i].take());
+
+        delete[] _heap;
+        _heap = to == _inline ? nullptr : to;
+        _cap = cap;
+    }
+
+    constexpr T& operator[](usize i) lifetimebound {
+        return _slots()[i].unwrap();
+    }
+
+    constexpr T const& operator[](usize i) const lifetimebound {
+        return _slots()[i].unwrap();
+    }
+
+    void ensure(usize desired) {
+        if (desired <= _cap)
+            return;
+
+        usize newCap = max(_cap * 2, desired);
+        _move(new Manual<T>[newCap], newCap);
+    }
+
+    void fit() {
+        if (not _heap or _len == _cap)
+            return;
+
+        if (_len <= N)
+            _move(_inline, N);
+        else
+            _move(new Manual<T>[_len], _len);
+    }
+
+    template <typename... Args>
+    auto& emplace(usize index, Args&&... args) {
+        ensure(_len + 1);
+
+        auto* slots = _slots();
+        for (usize i = _len; i > index; i--) {
+            slots[i].ctor(slots[i - 1].take());
+        }
+
+        slots[index].ctor(std::forward<Args>(args)...);
+        _len++;
+        return slots[index].unwrap();
+    }
+
+    void insert(usize index, T&& value) {
+        emplace(index, std::move(value));
+    }
+
+    void replace(usize index, T&& value) {
+        if (index >= _len) {
+            insert(index, std::move(value));
+            return;
+        }
+
+        _slots()[index].dtor();
+        _slots()[index].ctor(std::move(value));
+    }
+
+    void insert(Copy, usize index, T const* first, usize count) {
+        ensure(_len + count);
+
+        auto* slots = _slots();
+        for (usize i = _len; i > index; i--) {
+            slots[i + count - 1].ctor(slots[i - 1].take());
+        }
+
+        for (usize i = 0; i < count; i++) {
+            slots[index + i].ctor(first[i]);
+        }
+
+        _len += count;
+    }
+
+    void insert(Move, usize index, T* first, usize count) {
+        ensure(_len + count);
+
+        auto* slots = _slots();
+        for (usize i = _len; i > index; i--) {
+            slots[i + count - 1].ctor(slots[i - 1].take());
+        }
+
+        for (usize i = 0; i < count; i++) {
+            slots[index + i].ctor(std::move(first[i]));
+        }
+
+        _len += count;
+    }
+
+    T removeAt(usize index) {
+        if (index >= _len) [[unlikely]]
+            panic("index out of bounds");
+
+        auto* slots = _slots();
+        T ret = slots[index].take();
+        for (usize i = index; i < _len - 1; i++) {
+            slots[i].ctor(slots[i + 1].take());
+        }
+        _len--;
+        return ret;
+    }
+
+    void removeRange(usize index, usize count) {
+        if (index > _len) [[unlikely]]
+            panic("index out of bounds");
+
+        if (index + count > _len) [[unlikely]]
+            panic("index + count out of bounds");
+
+        auto* slots = _slots();
+        for (usize i = index; i < index + count; i++)
+            slots[i].dtor();
+
+        for (usize i = index; i < _len - count; i++)
+            slots[i].ctor(slots[i + count].take());
+
+        _len -= count;
+    }
+
+    void resize(usize newLen, T fill = {}) {
+        if (newLen > _len) {
+            ensure(newLen);
+            for (usize i = _len; i < newLen; i++) {
+                _slots()[i].ctor(fill);
+            }
+        } else if (newLen < _len) {
+            for (usize i = newLen; i < _len; i++) {
+                _slots()[i].dtor();
+            }
+        }
+        _len = newLen;
+    }
+
+    void trunc(usize newLen) {
+        if (newLen >= _len)
+            return;
+
+        for (usize i = newLen; i < _len; i++) {
+            _slots()[i].dtor();
+        }
+
+        _len = newLen;
+    }
+
+    T* buf() lifetimebound {
+        return &_slots()->unwrap();
+    }
+
+    T const* buf() const lifetimebound {
+        return &_slots()->unwrap();
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    usize cap() const {
+        return _cap;
+    }
+};
+
 /// A buffer that does not own its backing storage.
 template <typename T>
 struct ViewBuf {
@@ -617,6 +876,9 @@ struct ViewBuf {
         if (index + count > _len) [[unlikely]]
             panic("index + count out of bounds");
 
+        for (usize i = index; i < index + count; i++)
+            _buf[i].dtor();
+
         for (usize i = index; i < _len - count; i++)
             _buf[i].ctor(_buf[i + count].take());
 
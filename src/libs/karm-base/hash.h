@@ -2,6 +2,7 @@
 
 #include "checked.h"
 #include "slice.h"
+#include "tuple.h"
 
 namespace Karm {
 
@@ -20,6 +21,11 @@ Hash hash(T const& v) {
     return Hasher<T>::hash(v);
 }
 
+// Mix two hashes together, order matters.
+constexpr Hash hashCombine(Hash seed, Hash h) {
+    return seed ^ (h + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
 template <>
 struct Hasher<Hash> {
     static constexpr Hash hash(Hash h) {
@@ -41,10 +47,15 @@ struct Hasher<Bytes> {
 template <Sliceable T>
 struct Hasher<T> {
     static constexpr Hash hash(T const& v) {
-        Hash hash{0};
-        for (auto& e : v)
-            hash = hash + ::hash(e);
-        return hash;
+        using Inner = typename T::Inner;
+        if constexpr (Meta::Integral<Inner> and sizeof(Inner) == 1) {
+            return Hasher<Bytes>::hash({reinterpret_cast<Byte const*>(v.buf()), v.len()});
+        } else {
+            Hash hash{0};
+            for (auto& e : v)
+                hash = hashCombine(hash, ::hash(e));
+            return hash;
+        }
     }
 };
 
@@ -62,4 +73,39 @@ struct Hasher<T> {
     }
 };
 
+template <typename T>
+    requires requires(T const& t) {
+        { t.hash() } -> Meta::Same<Hash>;
+    }
+struct Hasher<T> {
+    static constexpr Hash hash(T const& v) {
+        return v.hash();
+    }
+};
+
+template <Meta::Enum T>
+struct Hasher<T> {
+    static constexpr Hash hash(T const& v) {
+        return ::hash(static_cast<Meta::UnderlyingType<T>>(v));
+    }
+};
+
+template <typename T>
+struct Hasher<T*> {
+    static constexpr Hash hash(T const* v) {
+        return ::hash(reinterpret_cast<usize>(v));
+    }
+};
+
+template <typename T0, typename... Ts>
+struct Hasher<Tuple<T0, Ts...>> {
+    static constexpr Hash hash(Tuple<T0, Ts...> const& v) {
+        return v.apply([](auto const&... vs) {
+            Hash hash{0};
+            ((hash = hashCombine(hash, ::hash(vs))), ...);
+            return hash;
+        });
+    }
+};
+
 } // namespace Karm
@@ -1,95 +1,208 @@
 #pragma once
 
+#include "clamp.h"
 #include "cursor.h"
+#include "hash.h"
+#include "limits.h"
+#include "manual.h"
 #include "vec.h"
 
 namespace Karm {
 
+// Spread the hash bits before masking them down to a power of two
+// capacity, so weak hashes (small integers, pointers) don't cluster.
+always_inline constexpr usize _hashSlot(Hash h, usize cap) {
+    u64 x = h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return static_cast<usize>(x) & (cap - 1);
+}
+
+// Smallest power of two capacity that can hold `len` elements
+// while staying under a 75% load factor.
+always_inline constexpr usize _hashCap(usize len) {
+    usize cap = 8;
+    while (len * 4 > cap * 3)
+        cap *= 2;
+    return cap;
+}
+
+// MARK: Map -------------------------------------------------------------------
+
+// Insertion ordered map.
+//
+// Entries are stored densely in insertion order, and once the map grows past
+// a handful of entries an open addressing index is built on top of them so
+// lookups stay O(1). Keys without a Hasher are still supported but fall back
+// to a linear scan. Removing an entry is O(n) since the following entries
+// are shifted, use HashMap for tables with a lot of churn and no ordering
+// requirements.
 template <typename K, typename V>
 struct Map {
+    // Below this size, scanning the entries is faster than hashing the key.
+    static constexpr usize INDEX_THRESHOLD = 8;
+    static constexpr usize EMPTY = Limits<usize>::MAX;
+
     Vec<Pair<K, V>> _els{};
+    Vec<usize> _index{};
 
     Map() = default;
 
     Map(std::initializer_list<Pair<K, V>>&& list)
-        : _els(std::move(list)) {}
+        : _els(std::move(list)) {
+        _reindex();
+    }
 
-    void put(K const& key, V value) {
-        for (auto& i : ::mutIter(_els)) {
-            if (i.v0 == key) {
-                i.v1 = std::move(value);
+    void _insertIndex(usize i) {
+        usize mask = _index.len() - 1;
+        usize slot = _hashSlot(hash(_els[i].v0), _index.len());
+        while (_index[slot] != EMPTY)
+            slot = (slot + 1) & mask;
+        _index[slot] = i;
+    }
+
+    void _reindex() {
+        if constexpr (not Hashable<K>) {
+            return;
+        } else {
+            if (_els.len() <= INDEX_THRESHOLD) {
+                _index.clear();
                 return;
             }
+
+            _index.clear();
+            _index.resize(_hashCap(_els.len() * 2), EMPTY);
+            for (usize i = 0; i < _els.len(); i++)
+                _insertIndex(i);
         }
+    }
 
-        _els.pushBack(Pair<K, V>{key, std::move(value)});
+    void _indexLast() {
+        if constexpr (Hashable<K>) {
+            if (_els.len() <= INDEX_THRESHOLD)
+                return;
+
+            if (_els.len() * 4 > _index.len() * 3)
+                _reindex();
+            else
+                _insertIndex(_els.len() - 1);
+        }
     }
 
-    bool has(K const& key) const {
-        for (auto& i : _els) {
-            if (i.v0 == key) {
-                return true;
+    void _removeAt(usize i) {
+        if constexpr (Hashable<K>) {
+            if (_index.len()) {
+                usize mask = _index.len() - 1;
+                usize slot = _hashSlot(hash(_els[i].v0), _index.len());
+                while (_index[slot] != i)
+                    slot = (slot + 1) & mask;
+
+                // Backward shift deletion, entries following the hole
+                // are moved back if their probe sequence allows it, so
+                // we never need tombstones.
+                usize next = (slot + 1) & mask;
+                while (_index[next] != EMPTY) {
+                    usize home = _hashSlot(hash(_els[_index[next]].v0), _index.len());
+                    if (((next - home) & mask) >= ((next - slot) & mask)) {
+                        _index[slot] = _index[next];
+                        slot = next;
+                    }
+                    next = (next + 1) & mask;
+                }
+                _index[slot] = EMPTY;
+
+                for (usize j = 0; j < _index.len(); j++)
+                    if (_index[j] != EMPTY and _index[j] > i)
+                        _index[j]--;
             }
         }
 
-        return false;
+        _els.removeAt(i);
     }
 
-    V& get(K const& key) {
-        for (auto& i : _els) {
-            if (i.v0 == key) {
-                return i.v1;
+    usize _find(K const& key) const {
+        if constexpr (Hashable<K>) {
+            if (_index.len()) {
+                usize mask = _index.len() - 1;
+                usize slot = _hashSlot(hash(key), _index.len());
+                while (_index[slot] != EMPTY) {
+                    usize i = _index[slot];
+                    if (_els[i].v0 == key)
+                        return i;
+                    slot = (slot + 1) & mask;
+                }
+                return EMPTY;
             }
         }
 
-        panic("key not found");
+        for (usize i = 0; i < _els.len(); i++)
+            if (_els[i].v0 == key)
+                return i;
+
+        return EMPTY;
+    }
+
+    void put(K const& key, V value) {
+        usize i = _find(key);
+        if (i != EMPTY) {
+            _els[i].v1 = std::move(value);
+            return;
+        }
+
+        _els.pushBack(Pair<K, V>{key, std::move(value)});
+        _indexLast();
+    }
+
+    bool has(K const& key) const {
+        return _find(key) != EMPTY;
+    }
+
+    V& get(K const& key) {
+        usize i = _find(key);
+        if (i == EMPTY)
+            panic("key not found");
+        return _els[i].v1;
     }
 
     MutCursor<V> access(K const& key) {
-        for (auto& i : _els)
-            if (i.v0 == key)
-                return &i.v1;
-        return {};
+        usize i = _find(key);
+        if (i == EMPTY)
+            return {};
+        return &_els[i].v1;
     }
 
     Cursor<V> access(K const& key) const {
-        for (auto& i : _els)
-            if (i.v0 == key)
-                return &i.v1;
-        return {};
+        usize i = _find(key);
+        if (i == EMPTY)
+            return {};
+        return &_els[i].v1;
     }
 
     V take(K const& key) {
-        for (usize i = 0; i < _els.len(); i++) {
-            if (_els[i].v0 == key) {
-                V value = std::move(_els[i].v1);
-                _els.removeAt(i);
-                return value;
-            }
-        }
+        usize i = _find(key);
+        if (i == EMPTY)
+            panic("key not found");
 
-        panic("key not found");
+        V value = std::move(_els[i].v1);
+        _removeAt(i);
+        return value;
     }
 
     Opt<V> tryGet(K const& key) const {
-        for (auto& i : _els) {
-            if (i.v0 == key) {
-                return i.v1;
-            }
-        }
-
-        return NONE;
+        usize i = _find(key);
+        if (i == EMPTY)
+            return NONE;
+        return _els[i].v1;
     }
 
     bool del(K const& key) {
-        for (usize i = 0; i < _els.len(); i++) {
-            if (_els[i].v0 == key) {
-                _els.removeAt(i);
-                return true;
-            }
-        }
+        usize i = _find(key);
+        if (i == EMPTY)
+            return false;
 
-        return false;
+        _removeAt(i);
+        return true;
     }
 
     bool removeAll(V const& value) {
@@ -97,7 +210,7 @@ struct Map {
 
         for (usize i = 1; i < _els.len() + 1; i++) {
             if (_els[i - 1].v1 == value) {
-                _els.removeAt(i - 1);
+                _removeAt(i - 1);
                 changed = true;
                 i--;
             }
@@ -109,7 +222,7 @@ struct Map {
     bool removeFirst(V const& value) {
         for (usize i = 1; i < _els.len() + 1; i++) {
             if (_els[i - 1].v1 == value) {
-                _els.removeAt(i - 1);
+                _removeAt(i - 1);
                 return true;
             }
         }
@@ -135,6 +248,254 @@ struct Map {
 
     void clear() {
         _els.clear();
+        _index.clear();
+    }
+};
+
+// MARK: HashMap ---------------------------------------------------------------
+
+// Unordered open addressing hash map with linear probing.
+//
+// Same interface as Map minus positional access, iteration order is
+// unspecified and changes when the table grows.
+template <typename K, typename V>
+struct HashMap {
+    struct Slot : public Manual<Pair<K, V>> {
+        enum State : u8 {
+            FREE,
+            USED,
+            DEAD,
+        };
+
+        State state = State::FREE;
+    };
+
+    Slot* _slots = nullptr;
+    usize _cap = 0;
+    usize _len = 0;
+    usize _dead = 0;
+
+    HashMap() = default;
+
+    HashMap(std::initializer_list<Pair<K, V>>&& list) {
+        ensure(list.size());
+        for (auto& [k, v] : list)
+            put(k, v);
+    }
+
+    HashMap(HashMap const& other) {
+        ensure(other._len);
+        for (auto& [k, v] : other.iter())
+            put(k, v);
+    }
+
+    HashMap(HashMap&& other)
+        : _slots(std::exchange(other._slots, nullptr)),
+          _cap(std::exchange(other._cap, 0)),
+          _len(std::exchange(other._len, 0)),
+          _dead(std::exchange(other._dead, 0)) {}
+
+    ~HashMap() {
+        clear();
+    }
+
+    HashMap& operator=(HashMap const& other) {
+        *this = HashMap(other);
+        return *this;
+    }
+
+    HashMap& operator=(HashMap&& other) {
+        std::swap(_slots, other._slots);
+        std::swap(_cap, other._cap);
+        std::swap(_len, other._len);
+        std::swap(_dead, other._dead);
+        return *this;
+    }
+
+    void _rehash(usize cap) {
+        auto* oldSlots = _slots;
+        usize oldCap = _cap;
+
+        _slots = new Slot[cap];
+        _cap = cap;
+        _len = 0;
+        _dead = 0;
+
+        for (usize i = 0; i < oldCap; i++) {
+            if (oldSlots[i].state != Slot::USED)
+                continue;
+            auto pair = oldSlots[i].take();
+            _insert(std::move(pair.v0), std::move(pair.v1));
+        }
+
+        delete[] oldSlots;
+    }
+
+    void ensure(usize desired) {
+        usize cap = _hashCap(desired);
+        if (cap <= _cap)
+            return;
+        _rehash(cap);
+    }
+
+    // Insert a key that is known to not be in the table yet.
+    void _insert(K key, V value) {
+        usize mask = _cap - 1;
+        usize i = _hashSlot(hash(key), _cap);
+        while (_slots[i].state == Slot::USED)
+            i = (i + 1) & mask;
+
+        if (_slots[i].state == Slot::DEAD)
+            _dead--;
+
+        _slots[i].ctor(Pair<K, V>{std::move(key), std::move(value)});
+        _slots[i].state = Slot::USED;
+        _len++;
+    }
+
+    Slot* _lookup(K const& key) const {
+        if (_len == 0)
+            return nullptr;
+
+        usize mask = _cap - 1;
+        usize i = _hashSlot(hash(key), _cap);
+        while (_slots[i].state != Slot::FREE) {
+            auto& s = _slots[i];
+            if (s.state == Slot::USED and
+                s.unwrap().v0 == key)
+                return &s;
+            i = (i + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    void _remove(Slot* slot) {
+        slot->dtor();
+        slot->state = Slot::DEAD;
+        _len--;
+        _dead++;
+    }
+
+    void put(K const& key, V value) {
+        if (auto* slot = _lookup(key)) {
+            slot->unwrap().v1 = std::move(value);
+            return;
+        }
+
+        // Tombstones count toward the load, otherwise probing
+        // could loop forever on a table without free slots.
+        if ((_len + _dead + 1) * 4 > _cap * 3)
+            _rehash(_hashCap((_len + 1) * 2));
+
+        _insert(key, std::move(value));
+    }
+
+    bool has(K const& key) const {
+        return _lookup(key);
+    }
+
+    V& get(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            panic("key not found");
+        return slot->unwrap().v1;
+    }
+
+    MutCursor<V> access(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return {};
+        return &slot->unwrap().v1;
+    }
+
+    Cursor<V> access(K const& key) const {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return {};
+        return &slot->unwrap().v1;
+    }
+
+    V take(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            panic("key not found");
+
+        V value = std::move(slot->unwrap().v1);
+        _remove(slot);
+        return value;
+    }
+
+    Opt<V> tryGet(K const& key) const {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return NONE;
+        return slot->unwrap().v1;
+    }
+
+    bool del(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return false;
+
+        _remove(slot);
+        return true;
+    }
+
+    bool removeAll(V const& value) {
+        bool changed = false;
+
+        for (usize i = 0; i < _cap; i++) {
+            if (_slots[i].state == Slot::USED and
+                _slots[i].unwrap().v1 == value) {
+                _remove(&_slots[i]);
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    bool removeFirst(V const& value) {
+        for (usize i = 0; i < _cap; i++) {
+            if (_slots[i].state == Slot::USED and
+                _slots[i].unwrap().v1 == value) {
+                _remove(&_slots[i]);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto iter() const {
+        return Iter{[this, i = 0uz] mutable -> Pair<K, V> const* {
+            while (i < _cap and _slots[i].state != Slot::USED)
+                i++;
+
+            if (i == _cap)
+                return nullptr;
+
+            return &_slots[i++].unwrap();
+        }};
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    void clear() {
+        if (not _slots)
+            return;
+
+        for (usize i = 0; i < _cap; i++)
+            if (_slots[i].state == Slot::USED)
+                _slots[i].dtor();
+        delete[] _slots;
+
+        _slots = nullptr;
+        _cap = 0;
+        _len = 0;
+        _dead = 0;
     }
 };
 
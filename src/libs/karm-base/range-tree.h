@@ -0,0 +1,306 @@
+#pragma once
+
+#include <karm-meta/nocopy.h>
+
+#include "clamp.h"
+#include "opt.h"
+#include "range.h"
+#include "res.h"
+
+namespace Karm {
+
+// A set of disjoint ranges, each carrying a value, kept in an AVL tree
+// ordered by start. Every subtree also tracks its bounds and the largest
+// hole between its ranges, so lookups, overlap checks and first-fit
+// searches for free space are all O(log n).
+template <typename R, typename V>
+struct RangeTree : Meta::NoCopy {
+    using T = decltype(R{}.start);
+    using Size = typename R::Size;
+
+    struct Node {
+        R range;
+        V value;
+
+        Node* _left = nullptr;
+        Node* _right = nullptr;
+        isize _height = 1;
+        T _lo{};
+        T _hi{};
+        Size _gap{};
+    };
+
+    Node* _root = nullptr;
+    usize _len = 0;
+
+    RangeTree() = default;
+
+    RangeTree(RangeTree&& other)
+        : _root(std::exchange(other._root, nullptr)),
+          _len(std::exchange(other._len, 0)) {}
+
+    RangeTree& operator=(RangeTree&& other) {
+        std::swap(_root, other._root);
+        std::swap(_len, other._len);
+        return *this;
+    }
+
+    ~RangeTree() {
+        clear();
+    }
+
+    // MARK: Balancing ---------------------------------------------------------
+
+    static isize _heightOf(Node* node) {
+        return node ? node->_height : 0;
+    }
+
+    static void _update(Node* node) {
+        node->_height = max(_heightOf(node->_left), _heightOf(node->_right)) + 1;
+        node->_lo = node->range.start;
+        node->_hi = node->range.end();
+        node->_gap = {};
+
+        if (auto* left = node->_left) {
+            node->_lo = left->_lo;
+            node->_gap = max(left->_gap, node->range.start - left->_hi);
+        }
+
+        if (auto* right = node->_right) {
+            node->_hi = right->_hi;
+            node->_gap = max(node->_gap, right->_gap, right->_lo - node->range.end());
+        }
+    }
+
+    static Node* _rotateLeft(Node* node) {
+        auto* right = node->_right;
+        node->_right = right->_left;
+        right->_left = node;
+        _update(node);
+        _update(right);
+        return right;
+    }
+
+    static Node* _rotateRight(Node* node) {
+        auto* left = node->_left;
+        node->_left = left->_right;
+        left->_right = node;
+        _update(node);
+        _update(left);
+        return left;
+    }
+
+    static Node* _balance(Node* node) {
+        _update(node);
+        auto factor = _heightOf(node->_left) - _heightOf(node->_right);
+
+        if (factor > 1) {
+            if (_heightOf(node->_left->_left) < _heightOf(node->_left->_right))
+                node->_left = _rotateLeft(node->_left);
+            return _rotateRight(node);
+        }
+
+        if (factor < -1) {
+            if (_heightOf(node->_right->_right) < _heightOf(node->_right->_left))
+                node->_right = _rotateRight(node->_right);
+            return _rotateLeft(node);
+        }
+
+        return node;
+    }
+
+    static Node* _insert(Node* node, Node* leaf) {
+        if (not node)
+            return leaf;
+
+        if (leaf->range.start < node->range.start)
+            node->_left = _insert(node->_left, leaf);
+        else
+            node->_right = _insert(node->_right, leaf);
+
+        return _balance(node);
+    }
+
+    static Node* _takeMin(Node* node, Node*& min) {
+        if (not node->_left) {
+            min = node;
+            return node->_right;
+        }
+
+        node->_left = _takeMin(node->_left, min);
+        return _balance(node);
+    }
+
+    static Node* _remove(Node* node, T start, Node*& removed) {
+        if (start < node->range.start) {
+            node->_left = _remove(node->_left, start, removed);
+        } else if (node->range.start < start) {
+            node->_right = _remove(node->_right, start, removed);
+        } else {
+            removed = node;
+            if (not node->_right)
+                return node->_left;
+
+            Node* min = nullptr;
+            auto* right = _takeMin(node->_right, min);
+            min->_left = node->_left;
+            min->_right = right;
+            return _balance(min);
+        }
+
+        return _balance(node);
+    }
+
+    static void _clear(Node* node) {
+        if (not node)
+            return;
+        _clear(node->_left);
+        _clear(node->_right);
+        delete node;
+    }
+
+    // MARK: Queries -----------------------------------------------------------
+
+    Node* _find(T addr) const {
+        auto* node = _root;
+        while (node) {
+            if (addr < node->range.start)
+                node = node->_left;
+            else if (node->range.end() <= addr)
+                node = node->_right;
+            else
+                return node;
+        }
+        return nullptr;
+    }
+
+    // The first hole of at least `size` inside a subtree, the caller
+    // ensures there is one.
+    static T _findGap(Node* node, Size size) {
+        while (true) {
+            auto* left = node->_left;
+            auto* right = node->_right;
+
+            if (left and left->_gap >= size) {
+                node = left;
+            } else if (left and node->range.start - left->_hi >= size) {
+                return left->_hi;
+            } else if (right and right->_lo - node->range.end() >= size) {
+                return node->range.end();
+            } else {
+                node = right;
+            }
+        }
+    }
+
+    // MARK: Public API --------------------------------------------------------
+
+    usize len() const {
+        return _len;
+    }
+
+    bool overlaps(R range) const {
+        // NOTE: The ranges are disjoint, so the last one starting before
+        //       the end of `range` is the only one that can reach into it.
+        Node* last = nullptr;
+        auto* node = _root;
+        while (node) {
+            if (node->range.start < range.end()) {
+                last = node;
+                node = node->_right;
+            } else {
+                node = node->_left;
+            }
+        }
+        return last and last->range.end() > range.start;
+    }
+
+    // The entry whose range contains `addr`, or nullptr.
+    Node* lookup(T addr) {
+        return _find(addr);
+    }
+
+    Node const* lookup(T addr) const {
+        return _find(addr);
+    }
+
+    Res<> insert(R range, V value) {
+        if (range.empty())
+            return Error::invalidInput("empty range");
+
+        if (overlaps(range))
+            return Error::invalidInput("overlapping range");
+
+        auto* leaf = new Node{range, std::move(value)};
+        _update(leaf);
+        _root = _insert(_root, leaf);
+        _len++;
+        return Ok();
+    }
+
+    // Remove the entry with exactly this range.
+    Opt<V> remove(R range) {
+        auto* node = _find(range.start);
+        if (not node or node->range != range)
+            return NONE;
+
+        Node* removed = nullptr;
+        _root = _remove(_root, range.start, removed);
+        _len--;
+
+        V value = std::move(removed->value);
+        delete removed;
+        return value;
+    }
+
+    // The lowest address in `bounds` where `size` units are free, all the
+    // ranges are expected to lie within `bounds`.
+    Opt<T> findGap(Size size, R bounds) const {
+        if (not _root) {
+            if (bounds.size >= size)
+                return bounds.start;
+            return NONE;
+        }
+
+        if (bounds.start + size <= _root->_lo)
+            return bounds.start;
+
+        if (_root->_gap >= size)
+            return _findGap(_root, size);
+
+        if (_root->_hi + size <= bounds.end())
+            return _root->_hi;
+
+        return NONE;
+    }
+
+    Opt<R> first() const {
+        auto* node = _root;
+        if (not node)
+            return NONE;
+        while (node->_left)
+            node = node->_left;
+        return node->range;
+    }
+
+    // Visit every entry in address order.
+    void visit(auto f) {
+        _visit(_root, f);
+    }
+
+    static void _visit(Node* node, auto& f) {
+        if (not node)
+            return;
+        _visit(node->_left, f);
+        f(node->range, node->value);
+        _visit(node->_right, f);
+    }
+
+    void clear() {
+        _clear(_root);
+        _root = nullptr;
+        _len = 0;
+    }
+};
+
+} // namespace Karm
@@ -65,6 +65,19 @@ struct Ring {
         _len++;
     }
 
+    void pushBack(Slice<T> values) {
+        if (values.len() > rem()) [[unlikely]]
+            panic("push on full ring");
+
+        // NOTE: The values wrap around the end of the buffer at most once.
+        usize first = min(values.len(), _cap - _head);
+        _ctorMany(_buf + _head, values.buf(), first);
+        _ctorMany(_buf, values.buf() + first, values.len() - first);
+
+        _head = (_head + values.len()) % _cap;
+        _len += values.len();
+    }
+
     T popBack() {
         if (_len == 0) [[unlikely]]
             panic("pop on empty ring");
@@ -85,6 +98,38 @@ struct Ring {
         return value;
     }
 
+    void popFront(MutSlice<T> values) {
+        if (values.len() > _len) [[unlikely]]
+            panic("dequeue on empty ring");
+
+        usize first = min(values.len(), _cap - _tail);
+        _takeMany(values.buf(), _buf + _tail, first);
+        _takeMany(values.buf() + first, _buf, values.len() - first);
+
+        _tail = (_tail + values.len()) % _cap;
+        _len -= values.len();
+    }
+
+    static void _ctorMany(Manual<T>* dst, T const* src, usize len) {
+        if constexpr (Meta::TrivialyCopyable<T>) {
+            if (len)
+                memcpy(dst, src, len * sizeof(T));
+        } else {
+            for (usize i = 0; i < len; i++)
+                dst[i].ctor(src[i]);
+        }
+    }
+
+    static void _takeMany(T* dst, Manual<T>* src, usize len) {
+        if constexpr (Meta::TrivialyCopyable<T>) {
+            if (len)
+                memcpy(dst, src, len * sizeof(T));
+        } else {
+            for (usize i = 0; i < len; i++)
+                dst[i] = src[i].take();
+        }
+    }
+
     void clear() {
         for (usize i = 0; i < _len; i++)
             _buf[(_tail + i) % _cap].dtor();
@@ -115,6 +160,7 @@ struct Ring {
         for (usize i = newLen; i < _len; i++)
             _buf[(_tail + i) % _cap].dtor();
 
+        _head = (_tail + newLen) % _cap;
         _len = newLen;
     }
 
@@ -0,0 +1,135 @@
+#include <karm-base/map.h>
+#include <karm-base/string.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("map-put-get") {
+    Map<int, int> map{};
+    map.put(420, 69);
+    expect$(map.has(420));
+    expectEq$(map.get(420), 69);
+    map.put(420, 42);
+    expectEq$(map.get(420), 42);
+    expectEq$(map.len(), 1uz);
+
+    return Ok();
+}
+
+test$("map-del") {
+    Map<int, int> map{};
+    map.put(420, 69);
+    expect$(map.del(420));
+    expect$(not map.has(420));
+    expect$(not map.del(420));
+    expectEq$(map.len(), 0uz);
+
+    return Ok();
+}
+
+test$("map-ordered") {
+    Map<int, int> map{};
+    for (int i = 100; i > 0; i--)
+        map.put(i, i * 2);
+
+    for (int i = 0; i < 100; i += 2)
+        map.del(100 - i);
+
+    int expected = 99;
+    for (auto& [k, v] : map.iter()) {
+        expectEq$(k, expected);
+        expectEq$(v, expected * 2);
+        expected -= 2;
+    }
+    expectEq$(map.len(), 50uz);
+    expectEq$(map.at(0), 198);
+
+    return Ok();
+}
+
+test$("map-indexed-lookup") {
+    Map<usize, usize> map{};
+    for (usize i = 0; i < 1000; i++)
+        map.put(i * 7, i);
+
+    for (usize i = 0; i < 1000; i++)
+        expectEq$(map.get(i * 7), i);
+
+    expect$(not map.has(1));
+    expectEq$(map.take(7), 1uz);
+    expect$(not map.has(7));
+    expectEq$(map.get(14), 2uz);
+
+    return Ok();
+}
+
+test$("map-string-keys") {
+    Map<String, int> map{};
+    map.put("foo"s, 1);
+    map.put("bar"s, 2);
+    expectEq$(map.get("foo"s), 1);
+    expectEq$(map.get("bar"s), 2);
+    expect$(not map.has("baz"s));
+
+    return Ok();
+}
+
+test$("hash-map-put-get") {
+    HashMap<int, int> map{};
+    map.put(420, 69);
+    expect$(map.has(420));
+    expectEq$(map.get(420), 69);
+    map.put(420, 42);
+    expectEq$(map.get(420), 42);
+    expectEq$(map.len(), 1uz);
+
+    return Ok();
+}
+
+test$("hash-map-take") {
+    HashMap<int, String> map{};
+    map.put(1, "one"s);
+    expectEq$(map.take(1), "one"s);
+    expect$(not map.has(1));
+    expectEq$(map.len(), 0uz);
+
+    return Ok();
+}
+
+test$("hash-map-churn") {
+    HashMap<usize, usize> map{};
+    for (usize round = 0; round < 16; round++) {
+        for (usize i = 0; i < 1000; i++)
+            map.put(round * 1000 + i, i);
+        for (usize i = 0; i < 1000; i++)
+            expect$(map.del(round * 1000 + i));
+    }
+    expectEq$(map.len(), 0uz);
+
+    for (usize i = 0; i < 1000; i++)
+        map.put(i, i * 2);
+
+    usize sum = 0;
+    for (auto& [k, v] : map.iter()) {
+        expectEq$(v, k * 2);
+        sum += k;
+    }
+    expectEq$(sum, 999uz * 1000 / 2);
+
+    return Ok();
+}
+
+test$("hash-map-copy") {
+    HashMap<Pair<int>, int> map{};
+    map.put({1, 2}, 3);
+    map.put({2, 1}, 4);
+
+    auto copy = map;
+    expectEq$(copy.len(), 2uz);
+    expectEq$(copy.get({1, 2}), 3);
+    expectEq$(copy.get({2, 1}), 4);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
@@ -0,0 +1,142 @@
+#include <karm-base/range-tree.h>
+#include <karm-base/vec.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("range-tree-insert-lookup") {
+    RangeTree<urange, int> tree;
+
+    expect$(tree.insert({10, 10}, 1));
+    expect$(tree.insert({30, 5}, 2));
+    expect$(tree.insert({0, 10}, 3));
+    expectEq$(tree.len(), 3uz);
+
+    expectEq$(tree.lookup(0)->value, 3);
+    expectEq$(tree.lookup(19)->value, 1);
+    expectEq$(tree.lookup(34)->value, 2);
+    expect$(tree.lookup(20) == nullptr);
+    expect$(tree.lookup(35) == nullptr);
+
+    return Ok();
+}
+
+test$("range-tree-overlaps") {
+    RangeTree<urange, int> tree;
+
+    expect$(tree.insert({10, 10}, 1));
+    expect$(tree.insert({30, 10}, 2));
+
+    expect$(tree.overlaps({15, 1}));
+    expect$(tree.overlaps({0, 11}));
+    expect$(tree.overlaps({19, 12}));
+    expect$(not tree.overlaps({20, 10}));
+    expect$(not tree.overlaps({0, 10}));
+    expect$(not tree.overlaps({40, 10}));
+
+    expect$(not tree.insert({25, 10}, 3));
+    expectEq$(tree.len(), 2uz);
+
+    return Ok();
+}
+
+test$("range-tree-remove") {
+    RangeTree<urange, int> tree;
+
+    for (usize i = 0; i < 64; i++)
+        expect$(tree.insert({i * 10, 5}, (int)i));
+
+    expect$(not tree.remove({10, 4}));
+
+    for (usize i = 0; i < 64; i += 2)
+        expectEq$(tree.remove({i * 10, 5}), (int)i);
+
+    expectEq$(tree.len(), 32uz);
+    expect$(tree.lookup(0) == nullptr);
+    expectEq$(tree.lookup(10)->value, 1);
+    expectEq$(tree.first(), (urange{10, 5}));
+
+    return Ok();
+}
+
+test$("range-tree-find-gap") {
+    RangeTree<urange, int> tree;
+    urange bounds = {0, 100};
+
+    expectEq$(tree.findGap(100, bounds), 0uz);
+    expect$(not tree.findGap(101, bounds));
+
+    expect$(tree.insert({0, 10}, 0));
+    expect$(tree.insert({15, 10}, 1));
+    expect$(tree.insert({30, 10}, 2));
+    expect$(tree.insert({60, 30}, 3));
+
+    expectEq$(tree.findGap(5, bounds), 10uz);
+    expectEq$(tree.findGap(6, bounds), 40uz);
+    expectEq$(tree.findGap(20, bounds), 40uz);
+    expectEq$(tree.findGap(21, {0, 120}), 90uz);
+    expect$(not tree.findGap(21, bounds));
+
+    return Ok();
+}
+
+test$("range-tree-random") {
+    // Cross check the tree against a flat bitmap of the address space.
+    static constexpr usize LEN = 512;
+    RangeTree<urange, usize> tree;
+    Vec<bool> used;
+    used.resize(LEN, false);
+
+    auto isFree = [&](urange range) {
+        for (usize i = range.start; i < range.end(); i++)
+            if (used[i])
+                return false;
+        return true;
+    };
+
+    usize seed = 0x12345;
+    auto next = [&] {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return seed >> 33;
+    };
+
+    Vec<urange> live;
+    for (usize round = 0; round < 2000; round++) {
+        usize size = 1 + next() % 8;
+
+        if (live.len() and next() % 3 == 0) {
+            auto range = live.removeAt(next() % live.len());
+            expectEq$(tree.remove(range), range.start);
+            for (usize i = range.start; i < range.end(); i++)
+                used[i] = false;
+            continue;
+        }
+
+        Opt<usize> expected = NONE;
+        for (usize start = 0; start + size <= LEN; start++) {
+            if (isFree({start, size})) {
+                expected = start;
+                break;
+            }
+        }
+
+        auto found = tree.findGap(size, {0, LEN});
+        expectEq$(found, expected);
+        if (not found)
+            continue;
+
+        urange range = {*found, size};
+        expect$(tree.insert(range, range.start));
+        live.pushBack(range);
+        for (usize i = range.start; i < range.end(); i++)
+            used[i] = true;
+    }
+
+    expectEq$(tree.len(), live.len());
+    for (auto range : live)
+        expectEq$(tree.lookup(range.end() - 1)->value, range.start);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
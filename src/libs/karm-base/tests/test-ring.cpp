@@ -1,3 +1,4 @@
+#include <karm-base/array.h>
 #include <karm-base/ring.h>
 #include <karm-test/macros.h>
 
@@ -19,4 +20,42 @@ test$("ring-avoid-pop-back-underflow") {
     return Ok();
 }
 
+test$("ring-push-pop-many") {
+    Ring<int> ring(5);
+
+    ring.pushBack(0);
+    ring.pushBack(1);
+    ring.pushBack(2);
+    ring.popFront();
+    ring.popFront();
+
+    // Wraps around the end of the buffer
+    Array<int, 4> in = {3, 4, 5, 6};
+    ring.pushBack(in);
+    expectEq$(ring.len(), 5u);
+    expectEq$(ring._head, 2u);
+
+    Array<int, 5> out = {};
+    ring.popFront(out);
+    expectEq$(ring.len(), 0u);
+    expectEq$(out, (Array<int, 5>{2, 3, 4, 5, 6}));
+
+    return Ok();
+}
+
+test$("ring-trunc") {
+    Ring<int> ring(4);
+
+    ring.pushBack(0);
+    ring.pushBack(1);
+    ring.pushBack(2);
+    ring.trunc(1);
+    ring.pushBack(3);
+
+    expectEq$(ring.len(), 2u);
+    expectEq$(ring.peek(1), 3);
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
@@ -1,3 +1,4 @@
+#include <karm-base/string.h>
 #include <karm-base/vec.h>
 #include <karm-test/macros.h>
 
@@ -28,4 +29,38 @@ test$("vec-push-front-slice") {
     return Ok();
 }
 
+test$("small-vec-spill") {
+    SmallVec<String, 2> vec;
+    expectEq$(vec.cap(), 2uz);
+
+    vec.pushBack("a"s);
+    vec.pushBack("b"s);
+    expect$(vec._buf._heap == nullptr);
+
+    vec.pushBack("c"s);
+    vec.pushFront("z"s);
+    expect$(vec._buf._heap != nullptr);
+    expectEq$(vec.len(), 4uz);
+    expectEq$(vec[0], "z"s);
+    expectEq$(vec[3], "c"s);
+
+    SmallVec<String, 2> moved = std::move(vec);
+    expectEq$(vec.len(), 0uz);
+    expectEq$(moved.len(), 4uz);
+
+    moved.removeAt(0);
+    moved.removeAt(2);
+    moved.fit();
+    expect$(moved._buf._heap == nullptr);
+    expectEq$(moved[0], "a"s);
+    expectEq$(moved[1], "b"s);
+
+    SmallVec<String, 2> copy = moved;
+    moved.clear();
+    expectEq$(copy.len(), 2uz);
+    expectEq$(copy[1], "b"s);
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
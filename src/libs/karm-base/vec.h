@@ -150,4 +150,7 @@ using Vec = _Vec<Buf<T>>;
 template <typename T, usize N>
 using InlineVec = _Vec<InlineBuf<T, N>>;
 
+template <typename T, usize N>
+using SmallVec = _Vec<SmallBuf<T, N>>;
+
 } // namespace Karm
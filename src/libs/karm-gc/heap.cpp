@@ -0,0 +1,247 @@
+#include "heap.h"
+
+namespace Karm::Gc {
+
+// MARK: Visitor ---------------------------------------------------------------
+
+void Visitor::_visit(void const* ptr) {
+    _heap._mark(ptr);
+}
+
+// MARK: Allocation ------------------------------------------------------------
+
+_Arena* Heap::_allocArena(usize cellSize, usize size) {
+    auto* arena = static_cast<_Arena*>(::operator new(size, std::align_val_t{_Arena::SIZE}));
+    new (arena) _Arena{
+        ._heap = this,
+        ._size = size,
+        ._cellSize = cellSize,
+        ._cells = (size - _Arena::header()) / cellSize,
+    };
+
+    _arenas.put(reinterpret_cast<usize>(arena), arena);
+    _stats.arenaBytes += size;
+    return arena;
+}
+
+void Heap::_freeArena(_Arena* arena) {
+    _arenas.del(reinterpret_cast<usize>(arena));
+    _stats.arenaBytes -= arena->_size;
+    ::operator delete(arena, std::align_val_t{_Arena::SIZE});
+}
+
+void* Heap::_allocCell(usize size) {
+    _stats.liveCells++;
+
+    for (auto& c : _classes) {
+        if (c.size < size)
+            continue;
+
+        _stats.liveBytes += c.size;
+
+        if (not c.free) {
+            auto* arena = _allocArena(c.size, _Arena::SIZE);
+            arena->_next = c.arenas;
+            c.arenas = arena;
+
+            for (usize i = arena->_cells; i > 0; i--) {
+                auto* free = reinterpret_cast<_Free*>(arena->cell(i - 1));
+                free->next = c.free;
+                c.free = free;
+            }
+        }
+
+        auto* free = c.free;
+        c.free = free->next;
+
+        auto [arena, index] = _lookup(free).unwrap();
+        arena->used(index, true);
+        arena->_used++;
+        return free;
+    }
+
+    // Too big for any size class, give it its own arena.
+    auto* arena = _allocArena(size, alignUp(_Arena::header() + size, 16));
+    arena->_next = _large;
+    _large = arena;
+    arena->used(0, true);
+    arena->_used++;
+    _stats.liveBytes += size;
+    return arena->cell(0);
+}
+
+// MARK: Roots -----------------------------------------------------------------
+
+Heap& Heap::of(void const* ptr) {
+    auto* arena = reinterpret_cast<_Arena*>(alignDown(reinterpret_cast<usize>(ptr), _Arena::SIZE));
+    return *arena->_heap;
+}
+
+void Heap::_attach(_Root& root) {
+    root._heap = this;
+    root._prev = nullptr;
+    root._next = _roots;
+    if (_roots)
+        _roots->_prev = &root;
+    _roots = &root;
+}
+
+void Heap::_detach(_Root& root) {
+    if (root._prev)
+        root._prev->_next = root._next;
+    else
+        _roots = root._next;
+
+    if (root._next)
+        root._next->_prev = root._prev;
+
+    root._heap = nullptr;
+    root._prev = nullptr;
+    root._next = nullptr;
+}
+
+// MARK: Collection ------------------------------------------------------------
+
+Opt<Pair<_Arena*, usize>> Heap::_lookup(void const* ptr) {
+    auto addr = reinterpret_cast<usize>(ptr);
+    auto arena = _arenas.tryGet(alignDown(addr, _Arena::SIZE));
+    if (not arena)
+        return NONE;
+
+    auto start = reinterpret_cast<usize>((*arena)->start());
+    if (addr < start)
+        return NONE;
+
+    usize index = (addr - start) / (*arena)->_cellSize;
+    if (index >= (*arena)->_cells)
+        return NONE;
+
+    return Pair{*arena, index};
+}
+
+void Heap::_mark(void const* ptr) {
+    // Pointers that don't belong to the heap (eg. objects on the stack) are
+    // simply ignored.
+    auto res = _lookup(ptr);
+    if (not res)
+        return;
+
+    auto [arena, index] = *res;
+    if (not arena->used(index) or arena->marked(index))
+        return;
+
+    arena->marked(index, true);
+    _grey.pushBack(reinterpret_cast<Cell*>(arena->cell(index)));
+}
+
+void Heap::_sweepClass(_Class& c) {
+    c.free = nullptr;
+
+    _Arena** link = &c.arenas;
+    while (*link) {
+        auto* arena = *link;
+
+        for (usize i = 0; i < arena->_cells; i++) {
+            if (arena->used(i) and not arena->marked(i)) {
+                reinterpret_cast<Cell*>(arena->cell(i))->~Cell();
+                arena->used(i, false);
+                arena->_used--;
+                _stats.freedCells++;
+                _stats.freedBytes += c.size;
+            }
+            arena->marked(i, false);
+        }
+
+        if (arena->_used == 0) {
+            *link = arena->_next;
+            _freeArena(arena);
+            continue;
+        }
+
+        // Rebuild the free list in address order, so allocations
+        // following a collection stay close to each other.
+        for (usize i = arena->_cells; i > 0; i--) {
+            if (arena->used(i - 1))
+                continue;
+            auto* free = reinterpret_cast<_Free*>(arena->cell(i - 1));
+            free->next = c.free;
+            c.free = free;
+        }
+
+        link = &arena->_next;
+    }
+}
+
+void Heap::_sweepLarge() {
+    _Arena** link = &_large;
+    while (*link) {
+        auto* arena = *link;
+
+        if (not arena->marked(0)) {
+            reinterpret_cast<Cell*>(arena->cell(0))->~Cell();
+            _stats.freedCells++;
+            _stats.freedBytes += arena->_cellSize;
+            *link = arena->_next;
+            _freeArena(arena);
+            continue;
+        }
+
+        arena->marked(0, false);
+        link = &arena->_next;
+    }
+}
+
+void Heap::collect() {
+    _stats.freedCells = 0;
+    _stats.freedBytes = 0;
+
+    // Mark everything reachable from the roots, using an explicit
+    // worklist so long chains (eg. DOM siblings) don't blow the stack.
+    Visitor visitor{*this};
+    for (auto* root = _roots; root; root = root->_next)
+        _mark(root->_raw);
+
+    while (_grey.len())
+        _grey.popBack()->_trace(visitor);
+
+    for (auto& c : _classes)
+        _sweepClass(c);
+    _sweepLarge();
+
+    _stats.liveCells -= _stats.freedCells;
+    _stats.liveBytes -= _stats.freedBytes;
+    _stats.collections++;
+
+    _threshold = max(MIN_THRESHOLD, _stats.liveBytes * 2);
+}
+
+void Heap::destroyAll() {
+    for (auto& c : _classes) {
+        while (c.arenas) {
+            auto* arena = c.arenas;
+            for (usize i = 0; i < arena->_cells; i++)
+                if (arena->used(i))
+                    reinterpret_cast<Cell*>(arena->cell(i))->~Cell();
+            c.arenas = arena->_next;
+            _freeArena(arena);
+        }
+        c.free = nullptr;
+    }
+
+    while (_large) {
+        auto* arena = _large;
+        reinterpret_cast<Cell*>(arena->cell(0))->~Cell();
+        _large = arena->_next;
+        _freeArena(arena);
+    }
+
+    // Roots outliving the heap must not try to unlink themselves from it.
+    while (_roots)
+        _detach(*_roots);
+
+    _stats.liveCells = 0;
+    _stats.liveBytes = 0;
+    _threshold = MIN_THRESHOLD;
+}
+
+} // namespace Karm::Gc
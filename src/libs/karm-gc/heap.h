@@ -1,13 +1,66 @@
 #pragma once
 
+#include <karm-base/align.h>
+#include <karm-base/array.h>
+#include <karm-base/map.h>
+#include <karm-base/vec.h>
+
 #include "ptr.h"
 
 namespace Karm::Gc {
 
-struct Cell {
-    Cell* _next = nullptr;
+struct Heap;
+
+// MARK: Visitor ---------------------------------------------------------------
+
+// Passed to the `trace()` hook of objects living on the heap, which must
+// visit every Gc::Ref and Gc::Ptr they hold so they are kept alive.
+//
+//     void trace(Gc::Visitor& v) const {
+//         v.visit(_parent);
+//         v.visit(_children);
+//     }
+struct Visitor {
+    Heap& _heap;
+
+    void _visit(void const* ptr);
+
+    template <typename T>
+    void visit(Ref<T> const& ref) {
+        _visit(ref._ptr);
+    }
+
+    template <typename T>
+    void visit(Ptr<T> const& ptr) {
+        if (ptr._ptr)
+            _visit(ptr._ptr);
+    }
 
+    template <typename T>
+    void visit(Opt<T> const& opt) {
+        if (opt)
+            visit(*opt);
+    }
+
+    template <typename T>
+    void visit(Vec<T> const& vec) {
+        for (auto const& v : vec)
+            visit(v);
+    }
+
+    template <typename T>
+        requires requires(T const& t, Visitor& v) { t.trace(v); }
+    void visit(T const& v) {
+        v.trace(*this);
+    }
+};
+
+// MARK: Cell ------------------------------------------------------------------
+
+struct Cell {
     virtual ~Cell() = default;
+
+    virtual void _trace(Visitor&) {}
 };
 
 template <typename T>
@@ -18,22 +71,127 @@ struct _Cell : public Cell {
     _Cell(Args&&... args)
         : store{std::forward<Args>(args)...} {
     }
+
+    void _trace(Visitor& v) override {
+        if constexpr (requires { store.trace(v); })
+            store.trace(v);
+    }
+};
+
+// MARK: Arena -----------------------------------------------------------------
+
+// A block of cells of the same size, aligned on its own size so the arena
+// owning any interior pointer can be found by masking the address.
+struct _Arena {
+    static constexpr usize SIZE = 64 * 1024;
+    static constexpr usize MIN_CELL = 32;
+    static constexpr usize BITMAP = SIZE / MIN_CELL / 64;
+
+    Heap* _heap;
+    usize _size;
+    usize _cellSize;
+    usize _cells;
+    usize _used = 0;
+    _Arena* _next = nullptr;
+    Array<u64, BITMAP> _usedBits{};
+    Array<u64, BITMAP> _markBits{};
+
+    static constexpr usize header() {
+        return alignUp(sizeof(_Arena), 16);
+    }
+
+    u8* start() {
+        return reinterpret_cast<u8*>(this) + header();
+    }
+
+    u8* cell(usize index) {
+        return start() + index * _cellSize;
+    }
+
+    static bool _test(Array<u64, BITMAP> const& bits, usize index) {
+        return bits[index / 64] & (1ull << (index % 64));
+    }
+
+    static void _set(Array<u64, BITMAP>& bits, usize index, bool value) {
+        if (value)
+            bits[index / 64] |= 1ull << (index % 64);
+        else
+            bits[index / 64] &= ~(1ull << (index % 64));
+    }
+
+    bool used(usize index) const { return _test(_usedBits, index); }
+
+    void used(usize index, bool value) { _set(_usedBits, index, value); }
+
+    bool marked(usize index) const { return _test(_markBits, index); }
+
+    void marked(usize index, bool value) { _set(_markBits, index, value); }
 };
 
+// MARK: Root ------------------------------------------------------------------
+
+// Intrusive link registering a root reference into its heap, see root.h
+struct _Root {
+    Heap* _heap = nullptr;
+    _Root* _prev = nullptr;
+    _Root* _next = nullptr;
+    void* _raw = nullptr;
+};
+
+// MARK: Heap ------------------------------------------------------------------
+
+// Mark and sweep garbage collected heap.
+//
+// Objects are allocated in size-classed arenas, objects bigger than the
+// largest size class get an arena of their own. Liveness is computed from
+// the Gc::Root registered on the heap, tracing through the `trace()` hook
+// of every reachable object.
+//
+// References held on the native stack are not roots, so collect() must only
+// be called at a safe point where every live object is reachable from a root.
 struct Heap : Meta::Pinned {
-    Cell* _root = nullptr;
-    Cell* _last = nullptr;
-
-    void destroyAll() {
-        while (_root) {
-            auto* next = _root->_next;
-            delete _root;
-            _root = next;
+    static constexpr usize CLASSES = 13;
+
+    static constexpr Array<usize, CLASSES> SIZE_CLASSES = {
+        32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+    };
+
+    // Don't bother collecting until this much memory has been allocated.
+    static constexpr usize MIN_THRESHOLD = 1024 * 1024;
+
+    struct Stats {
+        usize liveCells = 0;
+        usize liveBytes = 0;
+        usize arenaBytes = 0;
+        usize collections = 0;
+        usize freedCells = 0;
+        usize freedBytes = 0;
+
+        void repr(Io::Emit& e) const {
+            e("(gc-stats live: {} cells, {} bytes arenas: {} bytes collections: {} last freed: {} cells, {} bytes)", liveCells, liveBytes, arenaBytes, collections, freedCells, freedBytes);
         }
+    };
 
-        _root = nullptr;
-        _last = nullptr;
-    }
+    struct _Free {
+        _Free* next;
+    };
+
+    struct _Class {
+        usize size;
+        _Arena* arenas = nullptr;
+        _Free* free = nullptr;
+    };
+
+    Array<_Class, CLASSES> _classes = Array<_Class, CLASSES>::fill([](usize i) {
+        return _Class{SIZE_CLASSES[i]};
+    });
+
+    _Arena* _large = nullptr;
+    HashMap<usize, _Arena*> _arenas;
+    _Root* _roots = nullptr;
+    Vec<Cell*> _grey;
+    Stats _stats;
+    usize _threshold = MIN_THRESHOLD;
 
     ~Heap() {
         destroyAll();
@@ -41,18 +199,48 @@ struct Heap : Meta::Pinned {
 
     template <typename T, typename... Args>
     Ref<T> alloc(Args&&... args) lifetimebound {
-        auto* cell = new _Cell<T>(std::forward<Args>(args)...);
-
-        if (not _root) {
-            _root = cell;
-            _last = cell;
-        } else {
-            _last->_next = cell;
-            _last = cell;
-        }
-
+        static_assert(alignof(_Cell<T>) <= 16, "over-aligned types are not supported");
+        auto* cell = new (_allocCell(sizeof(_Cell<T>))) _Cell<T>(std::forward<Args>(args)...);
         return {MOVE, &cell->store};
     }
+
+    // MARK: Allocation
+
+    _Arena* _allocArena(usize cellSize, usize size);
+
+    void _freeArena(_Arena* arena);
+
+    void* _allocCell(usize size);
+
+    // MARK: Roots
+
+    static Heap& of(void const* ptr);
+
+    void _attach(_Root& root);
+
+    void _detach(_Root& root);
+
+    // MARK: Collection
+
+    Opt<Pair<_Arena*, usize>> _lookup(void const* ptr);
+
+    void _mark(void const* ptr);
+
+    void _sweepClass(_Class& c);
+
+    void _sweepLarge();
+
+    bool shouldCollect() const {
+        return _stats.liveBytes >= _threshold;
+    }
+
+    void collect();
+
+    Stats stats() const {
+        return _stats;
+    }
+
+    void destroyAll();
 };
 
 } // namespace Karm::Gc
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <karm-base/base.h>
+#include <karm-base/hash.h>
 #include <karm-io/emit.h>
 
 namespace Karm::Gc {
@@ -52,6 +53,10 @@ struct Ref {
     bool operator==(Ref const& other) const {
         return _ptr == other._ptr;
     }
+
+    Hash hash() const {
+        return Karm::hash(_ptr);
+    }
 };
 
 // Nullable reference
@@ -1,11 +1,69 @@
 #pragma once
 
-#include "ptr.h"
+#include "heap.h"
 
 namespace Karm::Gc {
 
-// FIXME: Proper handling of root references
+// A reference that keeps its object, and everything reachable from it,
+// alive across collections. Must point to an object allocated on a heap.
 template <typename T>
-using Root = Ref<T>;
+struct Root : _Root {
+    Root(Ref<T> ref) {
+        _raw = ref._ptr;
+        Heap::of(_raw)._attach(*this);
+    }
+
+    Root(Root const& other)
+        : Root(other.ref()) {}
+
+    Root& operator=(Root const& other) {
+        if (_heap)
+            _heap->_detach(*this);
+        _raw = other._raw;
+        Heap::of(_raw)._attach(*this);
+        return *this;
+    }
+
+    ~Root() {
+        if (_heap)
+            _heap->_detach(*this);
+    }
+
+    T* _ptr() const {
+        return static_cast<T*>(_raw);
+    }
+
+    Ref<T> ref() const {
+        return {MOVE, _ptr()};
+    }
+
+    operator Ref<T>() const {
+        return ref();
+    }
+
+    T const* operator->() const {
+        return _ptr();
+    }
+
+    T* operator->() {
+        return _ptr();
+    }
+
+    T const& operator*() const {
+        return *_ptr();
+    }
+
+    T& operator*() {
+        return *_ptr();
+    }
+
+    void repr(Io::Emit& e) const {
+        e("{}", *_ptr());
+    }
+
+    bool operator==(Root const& other) const {
+        return _raw == other._raw;
+    }
+};
 
 } // namespace Karm::Gc
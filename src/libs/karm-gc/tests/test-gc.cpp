@@ -1,4 +1,5 @@
 #include <karm-gc/heap.h>
+#include <karm-gc/root.h>
 #include <karm-test/macros.h>
 
 namespace Karm::Gc::Tests {
@@ -15,4 +16,121 @@ test$("gc-simple-lifetime") {
     return Ok();
 }
 
+struct Node {
+    isize* _alive;
+    Ptr<Node> _next = nullptr;
+    Vec<Ref<Node>> _children = {};
+
+    Node(isize* alive) : _alive(alive) {
+        (*_alive)++;
+    }
+
+    ~Node() {
+        (*_alive)--;
+    }
+
+    void trace(Visitor& v) const {
+        v.visit(_next);
+        v.visit(_children);
+    }
+};
+
+test$("gc-collect-unreachable") {
+    Heap heap;
+    isize alive = 0;
+
+    for (usize i = 0; i < 100; i++)
+        heap.alloc<Node>(&alive);
+    expectEq$(alive, 100);
+
+    heap.collect();
+    expectEq$(alive, 0);
+    expectEq$(heap.stats().liveCells, 0uz);
+    expectEq$(heap.stats().freedCells, 100uz);
+
+    return Ok();
+}
+
+test$("gc-keep-rooted") {
+    Heap heap;
+    isize alive = 0;
+
+    Root<Node> root = heap.alloc<Node>(&alive);
+    auto node = root.ref();
+    for (usize i = 0; i < 1000; i++) {
+        auto next = heap.alloc<Node>(&alive);
+        node->_next = next;
+        node = next;
+    }
+    root->_children.pushBack(heap.alloc<Node>(&alive));
+    heap.alloc<Node>(&alive);
+    expectEq$(alive, 1003);
+
+    heap.collect();
+    expectEq$(alive, 1002);
+
+    root->_next = nullptr;
+    heap.collect();
+    expectEq$(alive, 2);
+
+    return Ok();
+}
+
+test$("gc-collect-cycles") {
+    Heap heap;
+    isize alive = 0;
+
+    {
+        Root<Node> a = heap.alloc<Node>(&alive);
+        auto b = heap.alloc<Node>(&alive);
+        a->_next = b;
+        b->_next = a.ref();
+
+        heap.collect();
+        expectEq$(alive, 2);
+    }
+
+    heap.collect();
+    expectEq$(alive, 0);
+
+    return Ok();
+}
+
+struct Large {
+    Array<u8, 64 * 1024> buf;
+};
+
+test$("gc-large-objects") {
+    Heap heap;
+
+    Root<Large> root = heap.alloc<Large>();
+    heap.alloc<Large>();
+    expectEq$(heap.stats().liveCells, 2uz);
+
+    heap.collect();
+    expectEq$(heap.stats().liveCells, 1uz);
+    expect$(heap.stats().arenaBytes >= sizeof(Large));
+
+    return Ok();
+}
+
+test$("gc-reuse-arenas") {
+    Heap heap;
+    isize alive = 0;
+
+    for (usize i = 0; i < 10000; i++)
+        heap.alloc<Node>(&alive);
+    heap.collect();
+    expectEq$(heap.stats().arenaBytes, 0uz);
+
+    Root<Node> root = heap.alloc<Node>(&alive);
+    for (usize i = 0; i < 10000; i++)
+        heap.alloc<Node>(&alive);
+    heap.collect();
+    expectEq$(alive, 1);
+    expectEq$(heap.stats().collections, 2uz);
+
+    return Ok();
+}
+
 } // namespace Karm::Gc::Tests
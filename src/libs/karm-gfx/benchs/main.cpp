@@ -3,43 +3,152 @@
 #include <karm-sys/entry.h>
 #include <karm-sys/time.h>
 
-Async::Task<> entryPointAsync(Sys::Context&) {
+static constexpr isize SAMPLES = 50;
+
+// Random strokes over the whole surface, at increasing scales.
+static void _strokes(Gfx::Canvas& g) {
+    for (isize size = 100; size < 1000; size += 10) {
+        f64 scale = size / 100.0;
+
+        g.push();
+        g.scale(scale);
+
+        for (isize i = 0; i < 50; i++) {
+            Math::Rand rand{};
+
+            f64 s = rand.nextInt(4, 10);
+            s *= s;
+
+            g.beginPath();
+            g.ellipse({
+                rand.nextVec2(Math::Recti{100, 100}).cast<f64>(),
+                s,
+            });
+
+            g.strokeStyle(
+                Gfx::stroke(Gfx::randomColor(rand))
+                    .withWidth(rand.nextInt(2, s))
+            );
+            g.stroke();
+        }
+
+        g.pop();
+    }
+}
+
+// Large self-intersecting polygons with many edges.
+static void _complexPaths(Gfx::Canvas& g) {
+    Math::Rand rand{};
+    for (isize i = 0; i < 20; i++) {
+        g.beginPath();
+        g.moveTo(rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>());
+        for (isize j = 0; j < 200; j++)
+            g.lineTo(rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>());
+        g.closePath();
+
+        g.fillStyle(Gfx::randomColor(rand));
+        g.fill(i % 2 ? Gfx::FillRule::EVENODD : Gfx::FillRule::NONZERO);
+    }
+}
+
+// Lots of small curved shapes, similar to glyph outlines.
+static void _smallShapes(Gfx::Canvas& g) {
+    Math::Rand rand{};
+    for (isize i = 0; i < 5000; i++) {
+        g.beginPath();
+        g.ellipse({
+            rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>(),
+            (f64)rand.nextInt(3, 12),
+        });
+        g.fillStyle(Gfx::randomColor(rand));
+        g.fill(Gfx::FillRule::NONZERO);
+    }
+}
+
+// Full surface clears, the way a shell starts every frame.
+static void _clears(Gfx::Canvas& g) {
+    Math::Rand rand{};
+    for (isize i = 0; i < 20; i++)
+        g.clear(Gfx::randomColor(rand));
+}
+
+// Same as _clears, one pixel at a time, as a baseline for the span kernels.
+static void _clearsScalar(Gfx::CpuCanvas& g) {
+    Math::Rand rand{};
+    auto pixels = g.mutPixels();
+    for (isize i = 0; i < 20; i++) {
+        auto color = Gfx::randomColor(rand);
+        for (isize y = 0; y < pixels.height(); y++)
+            for (isize x = 0; x < pixels.width(); x++)
+                pixels.store({x, y}, color);
+    }
+}
+
+// Translucent rectangles, like the panels and overlays of the shell.
+static void _translucentRects(Gfx::Canvas& g) {
+    Math::Rand rand{};
+    for (isize i = 0; i < 20; i++) {
+        g.fillStyle(Gfx::randomColor(rand).withOpacity(0.5));
+        g.fill(Math::Recti{0, 0, 1000, 1000});
+    }
+}
+
+// Same as _translucentRects, one pixel at a time.
+static void _translucentRectsScalar(Gfx::CpuCanvas& g) {
+    Math::Rand rand{};
+    auto pixels = g.mutPixels();
+    for (isize i = 0; i < 20; i++) {
+        auto color = Gfx::randomColor(rand).withOpacity(0.5);
+        for (isize y = 0; y < pixels.height(); y++)
+            for (isize x = 0; x < pixels.width(); x++)
+                pixels.blend({x, y}, color);
+    }
+}
+
+// Large shapes filled with gradients.
+static void _gradients(Gfx::Canvas& g) {
+    Math::Rand rand{};
+    for (isize i = 0; i < 20; i++) {
+        g.beginPath();
+        g.ellipse({
+            rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>(),
+            (f64)rand.nextInt(100, 500),
+        });
+        g.fillStyle(
+            Gfx::Gradient::linear()
+                .withColors(Gfx::randomColor(rand), Gfx::randomColor(rand).withOpacity(0.5))
+                .bake()
+        );
+        g.fill(Gfx::FillRule::NONZERO);
+    }
+}
+
+// Frosted glass panels, at a few radii.
+static void _blurs(Gfx::CpuCanvas& g) {
+    for (f64 radius : {4, 16, 32}) {
+        g.apply(Gfx::BlurFilter{radius}, {100, 100, 800, 600});
+        g.apply(Gfx::BlurFilter{radius}, {0, 900, 1000, 100});
+    }
+}
+
+static void _bench(Str name, bool sparse, Gfx::MutPixels pixels, auto draw) {
     Vec<Duration> samples;
-    auto surface = Gfx::Surface::alloc({1000, 1000});
+    usize edges = 0;
 
-    for (isize i = 0; i < 100; i++) {
+    for (isize i = 0; i < SAMPLES; i++) {
         auto start = Sys::now();
-        for (isize size = 100; size < 1000; size += 10) {
-            f64 scale = size / 100.0;
-
-            Gfx::CpuCanvas g;
-            g.begin(surface->mutPixels());
-            g.scale(scale);
-
-            for (isize i = 0; i < 50; i++) {
-                Math::Rand rand{};
-
-                f64 s = rand.nextInt(4, 10);
-                s *= s;
-
-                g.beginPath();
-                g.ellipse({
-                    rand.nextVec2(Math::Recti{100, 100}).cast<f64>(),
-                    s,
-                });
-
-                g.strokeStyle(
-                    Gfx::stroke(Gfx::randomColor(rand))
-                        .withWidth(rand.nextInt(2, s))
-                );
-                g.stroke();
-            }
-        }
+
+        Gfx::CpuCanvas g;
+        g._useSparseRast = sparse;
+        g.begin(pixels);
+        draw(g);
+        g.end();
+        edges = g._edgeCount;
 
         auto elapsed = Sys::now() - start;
         samples.pushBack(elapsed);
 
-        Sys::print("sampling {}/100: {}\r", i + 1, elapsed);
+        Sys::print("{} ({}) sampling {}/{}: {}\r", name, sparse ? "sparse" : "supersampled", i + 1, SAMPLES, elapsed);
     }
 
     // median
@@ -57,6 +166,44 @@ Async::Task<> entryPointAsync(Sys::Context&) {
     Sys::println("average: {}", Duration::fromUSecs(sum / samples.len()));
     Sys::println("min: {}", first(samples));
     Sys::println("max: {}", last(samples));
+    Sys::println("edges: {}", edges);
+    Sys::println("");
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    auto surface = Gfx::Surface::alloc({1000, 1000});
+
+    // A translucent image, in the other pixel format to exercise conversions.
+    auto image = Gfx::Surface::alloc({500, 500}, Gfx::BGRA8888);
+    Math::Rand rand{};
+    image->mutPixels().clear(Gfx::randomColor(rand).withOpacity(0.75));
+
+    auto blits = [&](Gfx::Canvas& g) {
+        for (isize i = 0; i < 20; i++) {
+            g.blit({0, 0, 500, 500}, {i * 10, i * 10, 500, 500}, image->pixels());
+            g.blit({0, 0, 500, 500}, {0, 0, 1000, 1000}, image->pixels());
+        }
+    };
+
+    _bench("clears", true, surface->mutPixels(), _clears);
+    _bench("clears (scalar)", true, surface->mutPixels(), _clearsScalar);
+    _bench("translucent rects", true, surface->mutPixels(), _translucentRects);
+    _bench("translucent rects (scalar)", true, surface->mutPixels(), _translucentRectsScalar);
+    _bench("gradients", true, surface->mutPixels(), _gradients);
+    _bench("blits", true, surface->mutPixels(), blits);
+    _bench("blurs", true, surface->mutPixels(), _blurs);
+
+    for (bool sparse : {false, true}) {
+        _bench("strokes", sparse, surface->mutPixels(), _strokes);
+        _bench("complex paths", sparse, surface->mutPixels(), _complexPaths);
+        _bench("small shapes", sparse, surface->mutPixels(), _smallShapes);
+    }
+
+    // Coarser flattening trades a little accuracy for fewer edges.
+    _bench("strokes (tolerance 1px)", true, surface->mutPixels(), [](Gfx::Canvas& g) {
+        g.tolerance(1);
+        _strokes(g);
+    });
 
     co_return Ok();
 }
@@ -1,5 +1,7 @@
 #include "buffer.h"
 
+#include "cpu/spans.h"
+
 namespace Karm::Gfx {
 
 [[gnu::flatten]] void blitUnsafe(MutPixels dst, Pixels src) {
@@ -8,14 +10,20 @@ namespace Karm::Gfx {
 
     dst._fmt.visit([&](auto fd) {
         src._fmt.visit([&](auto fs) {
-            for (isize y = 0; y < dst.height(); y++) {
-                for (isize x = 0; x < dst.width(); x++) {
-                    auto c = fs.load(src.pixelUnsafe({x, y}));
-                    fd.store(dst.pixelUnsafe({x, y}), c);
-                }
-            }
+            for (isize y = 0; y < dst.height(); y++)
+                copySpan<decltype(fd), decltype(fs)>(dst.pixelUnsafe({0, y}), src.pixelUnsafe({0, y}), dst.width());
         });
     });
 }
 
+[[gnu::flatten]] void clearUnsafe(MutPixels dst, Color color) {
+    if (dst.width() <= 0)
+        return;
+
+    dst._fmt.visit([&](auto f) {
+        for (isize y = 0; y < dst.height(); y++)
+            fillSpan<decltype(f)>(dst.pixelUnsafe({0, y}), dst.width(), color);
+    });
+}
+
 } // namespace Karm::Gfx
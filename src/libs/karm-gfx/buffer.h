@@ -219,14 +219,7 @@ struct _Pixels {
     always_inline void clear(Color color)
         requires(MUT)
     {
-        _fmt.visit([&](auto f) {
-            Array<u8, f.bpp()> pixel{};
-            f.store(pixel.buf(), color);
-
-            for (isize y = 0; y < height(); y++)
-                for (isize x = 0; x < width(); x++)
-                    memcpy(pixelUnsafe({x, y}), pixel.buf(), f.bpp());
-        });
+        clearUnsafe(*this, color);
     }
 
     always_inline void clear()
@@ -300,4 +293,6 @@ struct Surface {
 
 void blitUnsafe(MutPixels dst, Pixels src);
 
+void clearUnsafe(MutPixels dst, Color color);
+
 } // namespace Karm::Gfx
@@ -36,6 +36,9 @@ struct Canvas : Meta::NoCopy {
     // Set the current stroke style.
     virtual void strokeStyle(Stroke style) = 0;
 
+    // Set how far, in pixels, flattened curves may stray from the real ones.
+    virtual void tolerance(f64 tolerance) = 0;
+
     // Set the origin of the current context.
     virtual void origin(Math::Vec2f p);
 
@@ -1,8 +1,10 @@
 #include <karm-base/ring.h>
 #include <karm-logger/logger.h>
 #include <karm-math/funcs.h>
+#include <karm-text/font.h>
 
 #include "canvas.h"
+#include "spans.h"
 
 namespace Karm::Gfx {
 
@@ -54,6 +56,7 @@ void CpuCanvas::pop() {
         panic("context without save");
 
     _stack.popBack();
+    _updateTolerance();
 }
 
 void CpuCanvas::fillStyle(Fill fill) {
@@ -64,21 +67,71 @@ void CpuCanvas::strokeStyle(Stroke style) {
     current().stroke = style;
 }
 
+void CpuCanvas::tolerance(f64 tolerance) {
+    current().tolerance = tolerance;
+    _updateTolerance();
+}
+
 void CpuCanvas::transform(Math::Trans2f trans) {
     auto& t = current().trans;
     t = trans.multiply(t);
+    _updateTolerance();
+}
+
+f64 CpuCanvas::_pathTolerance() const {
+    // NOTE: Use the largest scale of the transform, so the tolerance holds
+    //       along every axis.
+    auto const& t = current().trans;
+    f64 scale = max(Math::Vec2f{t.xx, t.xy}.len(), Math::Vec2f{t.yx, t.yy}.len());
+    return current().tolerance / max(scale, Limits<f64>::EPSILON);
+}
+
+void CpuCanvas::_updateTolerance() {
+    _path.tolerance(_pathTolerance());
 }
 
 // MARK: Path Operations -------------------------------------------------------
 
+void CpuCanvas::_rasterize(Math::Recti clip, FillRule fillRule, auto cb) {
+    if (_useSparseRast)
+        _sparseRast.fill(_poly, clip, fillRule, cb);
+    else
+        _rast.fill(_poly, clip, fillRule, cb);
+}
+
+void CpuCanvas::_rasterizeSpans(Math::Recti clip, FillRule fillRule, auto cb) {
+    if (_useSparseRast)
+        _sparseRast.fillSpans(_poly, clip, fillRule, cb);
+    else
+        _rast.fillSpans(_poly, clip, fillRule, cb);
+}
+
 void CpuCanvas::_fillImpl(auto fill, auto format, FillRule fillRule) {
-    _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
-        auto pixels = mutPixels();
-        auto* pixel = pixels.pixelUnsafe(frag.xy);
-        auto color = fill.sample(frag.uv);
-        auto c = format.load(pixel);
-        c = color.withOpacity(frag.a).blendOver(c);
-        format.store(pixel, c);
+    using F = decltype(format);
+    using S = decltype(fill);
+
+    auto pixels = mutPixels();
+    _rasterizeSpans(current().clip, fillRule, [&](CpuRast::Span const& span) {
+        auto* row = pixels.pixelUnsafe({span.x, span.y});
+
+        if constexpr (Meta::Same<S, Color>) {
+            blendSpan<F>(row, span.a, fill);
+        } else {
+            // NOTE: Color is laid out like Rgba8888, so the sampled row can
+            //       be blended as is.
+            _row.resize(span.len());
+            if constexpr (Meta::Same<S, Gradient>) {
+                fill.sampleSpan(span.uv, {span.du, 0}, mutSub(_row));
+            } else {
+                for (usize i = 0; i < span.len(); i++)
+                    _row[i] = fill.sample({span.uv.x + i * span.du, span.uv.y});
+            }
+
+            for (usize i = 0; i < span.len(); i++)
+                _row[i] = _row[i].withOpacity(span.a[i]);
+
+            blendSpan<F, Rgba8888>(row, _row.buf(), span.len());
+        }
     });
 }
 
@@ -88,7 +141,7 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
         _poly.offset(pos - last);
         last = pos;
 
-        _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
+        _rasterize(current().clip, fillRule, [&](CpuRast::Frag frag) {
             u8* pixel = static_cast<u8*>(mutPixels().pixelUnsafe(frag.xy));
             auto color = fill.sample(frag.uv);
             auto c = format.load(pixel);
@@ -103,6 +156,7 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
 }
 
 void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
+    _edgeCount += _poly.len();
     fill.visit([&](auto fill) {
         pixels().fmt().visit([&](auto format) {
             if (_useSpaa)
@@ -115,6 +169,7 @@ void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
 
 void CpuCanvas::beginPath() {
     _path.clear();
+    _updateTolerance();
 }
 
 void CpuCanvas::closePath() {
@@ -182,7 +237,7 @@ void CpuCanvas::fill(FillRule rule) {
 
 void CpuCanvas::stroke() {
     _poly.clear();
-    createStroke(_poly, _path, current().stroke);
+    createStroke(_poly, _path, current().stroke, _pathTolerance());
     _poly.transform(current().trans);
     _fill(current().stroke.fill);
 }
@@ -199,18 +254,18 @@ void CpuCanvas::clip(FillRule) {
 
     r = current().clip.clipTo(r);
 
+    if (r.width <= 0 or r.height <= 0)
+        return;
+
     if (color.alpha == 255) {
         mutPixels()
             .clip(r)
             .clear(color);
     } else {
-        pixels().fmt().visit([&](auto f) {
-            for (isize y = r.y; y < r.y + r.height; ++y) {
-                for (isize x = r.x; x < r.x + r.width; ++x) {
-                    auto blended = color.blendOver(f.load(mutPixels().pixelUnsafe({x, y})));
-                    f.store(mutPixels().pixelUnsafe({x, y}), blended);
-                }
-            }
+        auto pixels = mutPixels();
+        pixels.fmt().visit([&](auto f) {
+            for (isize y = r.y; y < r.y + r.height; ++y)
+                blendSpan<decltype(f)>(pixels.pixelUnsafe({r.x, y}), r.width, color);
         });
     }
 }
@@ -240,7 +295,7 @@ void CpuCanvas::clip(Math::Rectf rect) {
 
 void CpuCanvas::stroke(Math::Path const& path) {
     _poly.clear();
-    createStroke(_poly, path, current().stroke);
+    createStroke(_poly, path, current().stroke, _pathTolerance());
     _poly.transform(current().trans);
     _fill(current().stroke.fill);
 }
@@ -252,10 +307,123 @@ void CpuCanvas::fill(Math::Path const& path, FillRule rule) {
     _fill(current().fill, rule);
 }
 
+Opt<CpuGlyphCache::Entry> CpuCanvas::_rasterizeGlyph(GlyphKey const& key, Text::Font& font, Text::Glyph glyph) {
+    // Flatten the outline relative to the pixel grid.
+    push();
+    current().trans = Math::Trans2f::IDENTITY;
+    beginPath();
+    origin({
+        key.subx / (f64)GlyphKey::SUBPIXELS,
+        key.suby / (f64)GlyphKey::SUBPIXELS,
+    });
+    scale(key.size / GlyphKey::SIZE_UNIT);
+    font.fontface->contour(*this, glyph);
+    _poly.clear();
+    createSolid(_poly, _path);
+    _poly.transform(current().trans);
+    pop();
+
+    // Leave room for the subpixel offsets.
+    Math::Recti bound = {};
+    if (_poly.len())
+        bound = _poly.bound().ceil().cast<isize>().grow(1);
+
+    auto entry = _glyphCache.alloc(key, font.fontface, bound.wh, bound.xy);
+    if (not entry)
+        return NONE;
+
+    // Rasterize each component into the mask, with its subpixel offset.
+    Math::Vec2f last = {};
+    auto rasterizeComponent = [&](usize comp, Math::Vec2f pos) {
+        pos = pos - bound.xy.cast<f64>();
+        _poly.offset(pos - last);
+        last = pos;
+
+        _rasterize(Math::Recti{bound.wh}, FillRule::NONZERO, [&](CpuRast::Frag frag) {
+            auto* mask = _glyphCache.mask(*entry, frag.xy);
+            mask[comp] = clamp01(frag.a) * 255 + 0.5;
+        });
+    };
+
+    rasterizeComponent(0, _lcdLayout.red);
+    rasterizeComponent(1, _lcdLayout.green);
+    rasterizeComponent(2, _lcdLayout.blue);
+
+    return entry;
+}
+
+void CpuCanvas::_blitGlyph(CpuGlyphCache::Entry const& entry, Math::Vec2i origin, Color color) {
+    Math::Recti dest = {origin + entry.offset, entry.rect.wh};
+    auto r = dest.clipTo(current().clip);
+
+    pixels().fmt().visit([&](auto format) {
+        for (isize y = r.y; y < r.y + r.height; y++) {
+            auto const* mask = _glyphCache.mask(entry, Math::Vec2i{r.x, y} - dest.xy);
+            blendMaskSpan<decltype(format)>(mutPixels().pixelUnsafe({r.x, y}), mask, r.width, color);
+        }
+    });
+}
+
 void CpuCanvas::fill(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) {
-    _useSpaa = true;
-    Canvas::fill(font, glyph, baseline);
-    _useSpaa = false;
+    auto const& trans = current().trans;
+
+    bool isSuitableForCache =
+        current().fill.is<Color>() and
+        trans.xy == 0 and trans.yx == 0 and
+        trans.xx == trans.yy and trans.xx > 0;
+
+    if (not isSuitableForCache) {
+        _useSpaa = true;
+        Canvas::fill(font, glyph, baseline);
+        _useSpaa = false;
+        return;
+    }
+
+    // Snap the origin to a fraction of a pixel, so the same mask can be
+    // reused for glyphs drawn at nearby positions.
+    auto pos = trans.apply(baseline);
+    Math::Vec2i snapped = {
+        Math::roundi(pos.x * GlyphKey::SUBPIXELS),
+        Math::roundi(pos.y * GlyphKey::SUBPIXELS),
+    };
+    Math::Vec2i origin = {
+        Math::floori(snapped.x / (f64)GlyphKey::SUBPIXELS),
+        Math::floori(snapped.y / (f64)GlyphKey::SUBPIXELS),
+    };
+
+    auto quantize = [](f64 v) {
+        return static_cast<i8>(Math::roundi(v * GlyphKey::SIZE_UNIT));
+    };
+
+    GlyphKey key = {
+        .fontface = &font.fontface.unwrap(),
+        .glyph = glyph,
+        .size = static_cast<u32>(Math::roundi(font.fontsize * trans.xx * GlyphKey::SIZE_UNIT)),
+        .subx = static_cast<u8>(snapped.x - origin.x * GlyphKey::SUBPIXELS),
+        .suby = static_cast<u8>(snapped.y - origin.y * GlyphKey::SUBPIXELS),
+        .layout = {
+            quantize(_lcdLayout.red.x),
+            quantize(_lcdLayout.red.y),
+            quantize(_lcdLayout.green.x),
+            quantize(_lcdLayout.green.y),
+            quantize(_lcdLayout.blue.x),
+            quantize(_lcdLayout.blue.y),
+        },
+    };
+
+    auto entry = _glyphCache.lookup(key);
+    if (not entry)
+        entry = _rasterizeGlyph(key, font, glyph);
+
+    if (not entry) {
+        // Too big to be cached.
+        _useSpaa = true;
+        Canvas::fill(font, glyph, baseline);
+        _useSpaa = false;
+        return;
+    }
+
+    _blitGlyph(*entry, origin, current().fill.unwrap<Color>());
 }
 
 // MARK: Clear Operations ------------------------------------------------------
@@ -327,27 +495,42 @@ void CpuCanvas::plot(Math::Recti rect, Color color) {
 
     auto clipDest = current().clip.clipTo(destRect);
 
+    if (clipDest.width <= 0 or clipDest.height <= 0)
+        return;
+
+    using S = decltype(srcFmt);
+    using D = decltype(destFmt);
+
     auto hratio = srcRect.height / (f64)destRect.height;
     auto wratio = srcRect.width / (f64)destRect.width;
 
+    // NOTE: Scaled rows are gathered into a buffer first so they can go
+    //       through the same span kernel as unscaled ones.
+    bool scaled = srcRect.width != destRect.width;
+    if (scaled)
+        _row.resize(clipDest.width);
+
     for (isize y = 0; y < clipDest.height; ++y) {
         isize yy = clipDest.y - destRect.y + y;
 
         auto srcY = srcRect.y + yy * hratio;
         auto destY = clipDest.y + y;
 
-        for (isize x = 0; x < clipDest.width; ++x) {
-            isize xx = clipDest.x - destRect.x + x;
+        isize xx = clipDest.x - destRect.x;
+        void* destRow = dest.pixelUnsafe({clipDest.x, destY});
 
-            auto srcX = srcRect.x + xx * wratio;
-            auto destX = clipDest.x + x;
+        if (not scaled) {
+            void const* srcRow = src.pixelUnsafe({srcRect.x + xx, (isize)srcY});
+            blendSpan<D, S>(destRow, srcRow, clipDest.width);
+            continue;
+        }
 
-            u8 const* srcPx = static_cast<u8 const*>(src.pixelUnsafe({(isize)srcX, (isize)srcY}));
-            u8* destPx = static_cast<u8*>(dest.pixelUnsafe({destX, destY}));
-            auto srcC = srcFmt.load(srcPx);
-            auto destC = destFmt.load(destPx);
-            destFmt.store(destPx, srcC.blendOver(destC));
+        for (isize x = 0; x < clipDest.width; ++x) {
+            auto srcX = srcRect.x + (xx + x) * wratio;
+            _row[x] = srcFmt.load(src.pixelUnsafe({(isize)srcX, (isize)srcY}));
         }
+
+        blendSpan<D, Rgba8888>(destRow, _row.buf(), clipDest.width);
     }
 }
 
@@ -5,6 +5,7 @@
 #include "../fill.h"
 #include "../filters.h"
 #include "../stroke.h"
+#include "glyphs.h"
 #include "rast.h"
 
 namespace Karm::Gfx {
@@ -25,6 +26,7 @@ struct CpuCanvas : public Canvas {
         Stroke stroke{};
         Math::Recti clip{};
         Math::Trans2f trans = Math::Trans2f::IDENTITY;
+        f64 tolerance = Math::Path::TOLERANCE;
     };
 
     Opt<MutPixels> _pixels{};
@@ -32,8 +34,17 @@ struct CpuCanvas : public Canvas {
     Math::Path _path{};
     Math::Polyf _poly;
     CpuRast _rast{};
+    CpuSparseRast _sparseRast{};
     LcdLayout _lcdLayout = RGB;
     bool _useSpaa = false;
+    bool _useSparseRast = true;
+    // Owned by the canvas, so glyphs are cached without any locking, keep
+    // the canvas around to reuse them from one frame to the next.
+    CpuGlyphCache _glyphCache{};
+    Vec<Color> _row{};
+
+    // Number of edges rasterized so far, for benchmarks.
+    usize _edgeCount = 0;
 
     // MARK: Buffers -----------------------------------------------------------
 
@@ -65,10 +76,25 @@ struct CpuCanvas : public Canvas {
 
     void strokeStyle(Stroke style) override;
 
+    void tolerance(f64 tolerance) override;
+
     void transform(Math::Trans2f trans) override;
 
+    // (internal) The tolerance in path units, under the current transform.
+    f64 _pathTolerance() const;
+
+    // (internal) Flatten the curves of the current path with the current
+    // tolerance and transform.
+    void _updateTolerance();
+
     // MARK: Path Operations ---------------------------------------------------
 
+    // (internal) Rasterize the current shape with the selected rasterizer.
+    void _rasterize(Math::Recti clip, FillRule fillRule, auto cb);
+
+    // (internal) Same as _rasterize but yields runs of pixels.
+    void _rasterizeSpans(Math::Recti clip, FillRule fillRule, auto cb);
+
     // (internal) Fill the current shape with the given fill.
     // NOTE: The shape must be flattened before calling this function.
     void _fillImpl(auto fill, auto format, FillRule fillRule);
@@ -123,6 +149,12 @@ struct CpuCanvas : public Canvas {
 
     void fill(Math::Path const& path, FillRule rule = FillRule::NONZERO) override;
 
+    // (internal) Rasterize a glyph into the glyph cache.
+    Opt<CpuGlyphCache::Entry> _rasterizeGlyph(GlyphKey const& key, Text::Font& font, Text::Glyph glyph);
+
+    // (internal) Composite a cached glyph mask with the given color.
+    void _blitGlyph(CpuGlyphCache::Entry const& entry, Math::Vec2i origin, Color color);
+
     void fill(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) override;
 
     // MARK: Clear Operations --------------------------------------------------
@@ -0,0 +1,98 @@
+#include "glyphs.h"
+
+namespace Karm::Gfx {
+
+void CpuGlyphCache::budget(usize budget) {
+    _budget = budget;
+    while (_pages.len() and _pages.len() * PAGE_BYTES > _budget) {
+        _recycle(_pages.len() - 1);
+        _pages.popBack();
+        _stats.pages--;
+    }
+}
+
+Opt<CpuGlyphCache::Entry> CpuGlyphCache::lookup(GlyphKey const& key) {
+    auto entry = _entries.tryGet(key);
+    if (not entry) {
+        _stats.misses++;
+        return NONE;
+    }
+
+    _stats.hits++;
+    _pages[entry->page].lastUse = ++_tick;
+    return entry;
+}
+
+Opt<Math::Recti> CpuGlyphCache::_pack(Page& page, Math::Vec2i size) {
+    // Use the first shelf that is tall enough without wasting too much
+    // space, otherwise open a new one.
+    for (auto& s : page.shelves) {
+        if (s.height < size.y or s.height > size.y * 2 or s.x + size.x > PAGE_SIZE)
+            continue;
+        Math::Recti rect = {s.x, s.y, size.x, size.y};
+        s.x += size.x;
+        return rect;
+    }
+
+    isize bottom = page._bottom();
+    if (bottom + size.y > PAGE_SIZE)
+        return NONE;
+
+    page.shelves.pushBack({bottom, size.y, size.x});
+    return Math::Recti{0, bottom, size.x, size.y};
+}
+
+void CpuGlyphCache::_recycle(usize index) {
+    auto& page = _pages[index];
+    for (auto const& key : page.keys)
+        _entries.del(key);
+    _stats.glyphs -= page.keys.len();
+    _stats.evictions++;
+
+    page.keys.clear();
+    page.shelves.clear();
+    zeroFill<u8>(mutSub(page.data, 0, PAGE_BYTES));
+}
+
+Opt<CpuGlyphCache::Entry> CpuGlyphCache::alloc(GlyphKey const& key, Rc<Text::Fontface> fontface, Math::Vec2i size, Math::Vec2i offset) {
+    if (size.x > PAGE_SIZE or size.y > PAGE_SIZE)
+        return NONE;
+
+    auto insert = [&](usize index, Math::Recti rect) {
+        auto& page = _pages[index];
+        page.keys.pushBack(key);
+        page.lastUse = ++_tick;
+        _stats.glyphs++;
+
+        Entry entry = {fontface, index, rect, offset};
+        _entries.put(key, entry);
+        return entry;
+    };
+
+    for (usize i = 0; i < _pages.len(); i++)
+        if (auto rect = _pack(_pages[i], size))
+            return insert(i, *rect);
+
+    if ((_pages.len() + 1) * PAGE_BYTES <= _budget or _pages.len() == 0) {
+        _pages.emplaceBack();
+        _stats.pages++;
+        return insert(_pages.len() - 1, _pack(last(_pages), size).unwrap());
+    }
+
+    usize lru = 0;
+    for (usize i = 1; i < _pages.len(); i++)
+        if (_pages[i].lastUse < _pages[lru].lastUse)
+            lru = i;
+
+    _recycle(lru);
+    return insert(lru, _pack(_pages[lru], size).unwrap());
+}
+
+void CpuGlyphCache::clear() {
+    _entries.clear();
+    _pages.clear();
+    _stats.pages = 0;
+    _stats.glyphs = 0;
+}
+
+} // namespace Karm::Gfx
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <karm-base/map.h>
+#include <karm-base/rc.h>
+#include <karm-io/emit.h>
+#include <karm-math/rect.h>
+#include <karm-text/base.h>
+
+namespace Karm::Text {
+struct Fontface;
+} // namespace Karm::Text
+
+namespace Karm::Gfx {
+
+// Identifies a rasterized glyph, positions and sizes are quantized so
+// glyphs drawn at nearby positions share the same mask.
+struct GlyphKey {
+    static constexpr isize SUBPIXELS = 4;
+    static constexpr f64 SIZE_UNIT = 64;
+
+    Text::Fontface const* fontface;
+    Text::Glyph glyph;
+    u32 size;            // Font size in 1/SIZE_UNIT of a pixel
+    u8 subx;             // Offset from the pixel grid in 1/SUBPIXELS of a pixel
+    u8 suby;             // ...
+    Array<i8, 6> layout; // Subpixel layout offsets in 1/SIZE_UNIT of a pixel
+
+    bool operator==(GlyphKey const&) const = default;
+
+    Hash hash() const {
+        Hash h = Karm::hash(fontface);
+        h = hashCombine(h, glyph.hash());
+        h = hashCombine(h, Karm::hash(size));
+        h = hashCombine(h, Karm::hash(subx));
+        h = hashCombine(h, Karm::hash(suby));
+        return hashCombine(h, Karm::hash(layout));
+    }
+};
+
+// Atlas of glyph coverage masks, one coverage byte per color component, so
+// subpixel antialiased glyphs can be composited without rasterizing their
+// outline again. Each CpuCanvas owns one, it isn't safe to share across
+// threads.
+//
+// Masks are packed into fixed size pages using shelves. Once the memory
+// budget is exhausted the least recently used page is recycled, dropping
+// every glyph it held.
+struct CpuGlyphCache {
+    static constexpr isize PAGE_SIZE = 256;
+    static constexpr usize CHANNELS = 3;
+    static constexpr usize PAGE_BYTES = PAGE_SIZE * PAGE_SIZE * CHANNELS;
+    static constexpr usize DEFAULT_BUDGET = 4 * 1024 * 1024;
+
+    struct Entry {
+        // Keeps the fontface alive so its address can't be reused by
+        // another one while it's still cached.
+        Rc<Text::Fontface> fontface;
+        usize page;
+        Math::Recti rect;   // In the page
+        Math::Vec2i offset; // Of the mask relative to the glyph origin
+    };
+
+    struct Shelf {
+        isize y;
+        isize height;
+        isize x = 0;
+    };
+
+    struct Page {
+        Buf<u8> data = Buf<u8>::init(PAGE_BYTES, 0);
+        Vec<Shelf> shelves = {};
+        Vec<GlyphKey> keys = {};
+        usize lastUse = 0;
+
+        isize _bottom() const {
+            if (shelves.len() == 0)
+                return 0;
+            auto const& s = last(shelves);
+            return s.y + s.height;
+        }
+    };
+
+    struct Stats {
+        usize hits = 0;
+        usize misses = 0;
+        usize evictions = 0;
+        usize pages = 0;
+        usize glyphs = 0;
+
+        void repr(Io::Emit& e) const {
+            e("(glyph-cache hits: {} misses: {} evictions: {} pages: {} glyphs: {})", hits, misses, evictions, pages, glyphs);
+        }
+    };
+
+    usize _budget;
+    Vec<Page> _pages = {};
+    HashMap<GlyphKey, Entry> _entries = {};
+    usize _tick = 0;
+    Stats _stats = {};
+
+    CpuGlyphCache(usize budget = DEFAULT_BUDGET)
+        : _budget(budget) {}
+
+    // Change the memory budget, recycling pages if it shrank.
+    void budget(usize budget);
+
+    usize budget() const {
+        return _budget;
+    }
+
+    Opt<Entry> lookup(GlyphKey const& key);
+
+    // Reserve room for a mask of `size`, returns NONE if the mask doesn't
+    // fit in a page.
+    Opt<Entry> alloc(GlyphKey const& key, Rc<Text::Fontface> fontface, Math::Vec2i size, Math::Vec2i offset);
+
+    Opt<Math::Recti> _pack(Page& page, Math::Vec2i size);
+
+    void _recycle(usize index);
+
+    u8* mask(Entry const& entry, Math::Vec2i pos) {
+        auto& page = _pages[entry.page];
+        return &page.data[((entry.rect.y + pos.y) * PAGE_SIZE + entry.rect.x + pos.x) * CHANNELS];
+    }
+
+    u8 const* mask(Entry const& entry, Math::Vec2i pos) const {
+        auto const& page = _pages[entry.page];
+        return &page.data[((entry.rect.y + pos.y) * PAGE_SIZE + entry.rect.x + pos.x) * CHANNELS];
+    }
+
+    Stats stats() const {
+        return _stats;
+    }
+
+    void clear();
+};
+
+} // namespace Karm::Gfx
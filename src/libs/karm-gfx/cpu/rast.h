@@ -1,6 +1,8 @@
 #pragma once
 
+#include <karm-base/clamp.h>
 #include <karm-base/range.h>
+#include <karm-math/funcs.h>
 #include <karm-math/poly.h>
 
 #include "../types.h"
@@ -23,6 +25,24 @@ struct CpuRast {
         f64 a;
     };
 
+    // A run of pixels on a row, with the coverage of each of them.
+    struct Span {
+        isize y;
+        isize x;
+        Slice<f64> a;
+        Math::Vec2f uv; // Of the first pixel
+        f64 du;
+
+        usize len() const {
+            return a.len();
+        }
+
+        void visit(auto cb) const {
+            for (usize i = 0; i < a.len(); i++)
+                cb(Frag{{x + (isize)i, y}, {uv.x + i * du, uv.y}, a[i]});
+        }
+    };
+
     Vec<Active> _active{};
     Vec<irange> _ranges;
     Vec<f64> _scanline{};
@@ -48,7 +68,7 @@ struct CpuRast {
         _ranges.pushBack(range);
     }
 
-    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+    void fillSpans(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
         auto polyBound = poly.bound().grow(UNIT);
         auto clipBound = polyBound
                              .ceil()
@@ -131,19 +151,228 @@ struct CpuRast {
             }
 
             for (auto r : _ranges) {
-                for (isize x = r.start; x < r.end(); x++) {
-                    auto xy = Math::Vec2i{x, y};
-
-                    auto uv = Math::Vec2f{
-                        (x - polyBound.start()) / polyBound.width,
+                auto a = mutSub(_scanline, r.start - clipBound.x, r.end() - clipBound.x);
+                for (auto& v : a)
+                    v = clamp01(v);
+
+                cb(Span{
+                    y,
+                    r.start,
+                    a,
+                    {
+                        (r.start - polyBound.start()) / polyBound.width,
                         (y - polyBound.top()) / polyBound.height,
-                    };
+                    },
+                    1.0 / polyBound.width,
+                });
+            }
+        }
+    }
 
-                    cb(Frag{xy, uv, clamp01(_scanline[x - clipBound.x])});
-                }
+    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        fillSpans(poly, clip, fillRule, [&](Span const& span) {
+            span.visit(cb);
+        });
+    }
+};
+
+// Exact-area coverage rasterizer, in the style of font-rs and stb_truetype.
+//
+// Edges are sorted by their top into an edge table, the active edge list is
+// updated incrementally as we walk down the rows, and each active edge
+// accumulates the signed area it covers into a per-row buffer. The coverage
+// of a pixel is the running sum of this buffer, so rows are only swept over
+// the span touched by an edge, and cost is O(rows × active edges + pixels).
+struct CpuSparseRast {
+    using Frag = CpuRast::Frag;
+    using Span = CpuRast::Span;
+
+    struct Edge {
+        f64 top;
+        f64 bottom;
+        f64 x;    // At `top`
+        f64 dxdy;
+        f64 dir;  // +1 going down, -1 going up
+    };
+
+    Vec<Edge> _edges{};
+    Vec<usize> _active{};
+    Vec<f64> _acc{};
+    Vec<f64> _cov{};
+
+    void _buildEdges(Math::Polyf& poly) {
+        _edges.clear();
+        for (auto& e : poly) {
+            if (e.sy == e.ey)
+                continue;
+
+            bool down = e.sy < e.ey;
+            auto top = down ? e.start : e.end;
+            auto bottom = down ? e.end : e.start;
+            _edges.pushBack({
+                .top = top.y,
+                .bottom = bottom.y,
+                .x = top.x,
+                .dxdy = (bottom.x - top.x) / (bottom.y - top.y),
+                .dir = down ? 1.0 : -1.0,
+            });
+        }
+
+        sort(_edges, [](Edge const& a, Edge const& b) {
+            return a.top <=> b.top;
+        });
+    }
+
+    // Accumulate the area covered by `edge` between y0 and y1 into the row
+    // buffer starting at `left`. Edges are clamped horizontally to the
+    // buffer, which keeps the winding of the pixels right of them intact.
+    void _accumulate(Edge const& edge, f64 y0, f64 y1, f64 left, f64 width, irange& dirty) {
+        f64 d = (y1 - y0) * edge.dir;
+        f64 xa = clamp(edge.x + (y0 - edge.top) * edge.dxdy - left, 0.0, width);
+        f64 xb = clamp(edge.x + (y1 - edge.top) * edge.dxdy - left, 0.0, width);
+
+        f64 x0 = min(xa, xb);
+        f64 x1 = max(xa, xb);
+        f64 x0floor = Math::floor(x0);
+        isize x0i = x0floor;
+        isize x1i = Math::ceili(x1);
+
+        auto touched = irange::fromStartEnd(x0i, x1i + 1);
+        dirty = dirty.empty() ? touched : dirty.merge(touched);
+
+        if (x1i <= x0i + 1) {
+            // The edge stays within a single pixel.
+            f64 xmf = 0.5 * (xa + xb) - x0floor;
+            _acc[x0i] += d - d * xmf;
+            _acc[x0i + 1] += d * xmf;
+            return;
+        }
+
+        f64 s = 1.0 / (x1 - x0);
+        f64 x0f = x0 - x0floor;
+        f64 a0 = 0.5 * s * (1.0 - x0f) * (1.0 - x0f);
+        f64 x1f = x1 - x1i + 1.0;
+        f64 am = 0.5 * s * x1f * x1f;
+
+        _acc[x0i] += d * a0;
+        if (x1i == x0i + 2) {
+            _acc[x0i + 1] += d * (1.0 - a0 - am);
+        } else {
+            f64 a1 = s * (1.5 - x0f);
+            _acc[x0i + 1] += d * (a1 - a0);
+            for (isize xi = x0i + 2; xi < x1i - 1; xi++)
+                _acc[xi] += d * s;
+            f64 a2 = a1 + (x1i - x0i - 3) * s;
+            _acc[x1i - 1] += d * (1.0 - a2 - am);
+        }
+        _acc[x1i] += d * am;
+    }
+
+    static f64 _coverage(f64 winding, FillRule fillRule) {
+        f64 a = Math::abs(winding);
+        if (fillRule == FillRule::EVENODD) {
+            a -= 2.0 * Math::floor(a / 2.0);
+            if (a > 1.0)
+                a = 2.0 - a;
+        }
+        return min(a, 1.0);
+    }
+
+    void fillSpans(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        auto polyBound = poly.bound();
+        auto clipBound = polyBound
+                             .grow(1)
+                             .ceil()
+                             .cast<isize>()
+                             .clipTo(clip);
+
+        if (clipBound.width <= 0 or clipBound.height <= 0)
+            return;
+
+        _buildEdges(poly);
+        _active.clear();
+        _acc.resize(clipBound.width + 2);
+        zeroFill<f64>(mutSub(_acc, 0, clipBound.width + 2));
+        _cov.resize(clipBound.width + 2);
+
+        usize next = 0;
+        for (isize y = clipBound.top(); y < clipBound.bottom(); y++) {
+            f64 rowTop = y;
+            f64 rowBottom = y + 1.0;
+
+            // Retire the edges ending above this row...
+            for (usize i = 0; i < _active.len();) {
+                if (_edges[_active[i]].bottom <= rowTop)
+                    _active.removeAt(i);
+                else
+                    i++;
+            }
+
+            // ...and activate the ones starting in it.
+            while (next < _edges.len() and _edges[next].top < rowBottom) {
+                if (_edges[next].bottom > rowTop)
+                    _active.pushBack(next);
+                next++;
+            }
+
+            if (_active.len() == 0) {
+                // Nothing left to draw.
+                if (next == _edges.len())
+                    break;
+                continue;
+            }
+
+            irange dirty = {};
+            for (auto i : _active) {
+                auto const& edge = _edges[i];
+                _accumulate(
+                    edge,
+                    max(edge.top, rowTop),
+                    min(edge.bottom, rowBottom),
+                    clipBound.x,
+                    clipBound.width,
+                    dirty
+                );
+            }
+
+            // Sweep the touched span, the running sum drops back to zero
+            // past the rightmost edge.
+            f64 winding = 0;
+            isize end = min(dirty.end(), clipBound.width);
+            for (isize x = dirty.start; x < end; x++) {
+                winding += _acc[x];
+                _acc[x] = 0;
+
+                f64 a = _coverage(winding, fillRule);
+                _cov[x] = a < 1.0 / 512 ? 0 : a;
+            }
+
+            if (dirty.start < end) {
+                cb(Span{
+                    y,
+                    clipBound.x + dirty.start,
+                    sub(_cov, dirty.start, end),
+                    {
+                        (clipBound.x + dirty.start - polyBound.start()) / polyBound.width,
+                        (y - polyBound.top()) / polyBound.height,
+                    },
+                    1.0 / polyBound.width,
+                });
             }
+
+            for (isize x = end; x < dirty.end(); x++)
+                _acc[x] = 0;
         }
     }
+
+    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        fillSpans(poly, clip, fillRule, [&](Span const& span) {
+            span.visit([&](Frag frag) {
+                if (frag.a > 0)
+                    cb(frag);
+            });
+        });
+    }
 };
 
 } // namespace Karm::Gfx
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <karm-base/simd.h>
+
+#include "../buffer.h"
+
+namespace Karm::Gfx {
+
+// Span kernels, they composite runs of 32-bit pixels four at a time using
+// the vector types from karm-base/simd.h. The kernels are picked at compile
+// time from the pixel formats. Pixels over a destination that isn't opaque
+// take the scalar path, so the results always match Color::blendOver.
+
+// MARK: Vector Helpers --------------------------------------------------------
+
+template <typename F>
+always_inline static u32 _pack(Color color) {
+    u32 pixel;
+    F::store(&pixel, color);
+    return pixel;
+}
+
+always_inline static u8x16 _splat(u32 pixel) {
+    u32x4 v = {pixel, pixel, pixel, pixel};
+    return (u8x16)v;
+}
+
+always_inline static u8x16 _load4(void const* pixels) {
+    u8x16 v;
+    memcpy(&v, pixels, sizeof(v));
+    return v;
+}
+
+always_inline static void _store4(void* pixels, u8x16 v) {
+    memcpy(pixels, &v, sizeof(v));
+}
+
+// Bring four pixels from the layout of S to the one of D, both formats
+// store their channels in the same bytes except for red and blue.
+template <typename D, typename S>
+always_inline static u8x16 _convert4(u8x16 v) {
+    if constexpr (Meta::Same<D, S>)
+        return v;
+    else {
+        auto p = (u32x4)v;
+        return (u8x16)((p & 0xff00ff00) | ((p >> 16) & 0xff) | ((p & 0xff) << 16));
+    }
+}
+
+// NOTE: The alpha checks look at the vector as two words, it's much cheaper
+//       than pulling out each alpha lane.
+static constexpr u64 _ALPHA_MASK64 = 0xff000000ff000000;
+
+always_inline static u64 _alphas4(u8x16 v, bool all) {
+    u64 w[2];
+    memcpy(w, &v, sizeof(w));
+    return (all ? w[0] & w[1] : w[0] | w[1]) & _ALPHA_MASK64;
+}
+
+always_inline static bool _opaque4(u8x16 v) {
+    return _alphas4(v, true) == _ALPHA_MASK64;
+}
+
+always_inline static bool _transparent4(u8x16 v) {
+    return _alphas4(v, false) == 0;
+}
+
+// floor(x / 255) without a division, exact for any x <= 255 * 255.
+always_inline static u16x16 _div255(u16x16 x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static constexpr u8x16 _ALPHA_MASK = {0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255};
+
+// The source terms of the over operator, s * a and 255 - a, they only
+// depend on the source so they can be hoisted out of loops.
+struct _Src4 {
+    u16x16 sa;
+    u16x16 ia;
+
+    always_inline static _Src4 from(u8x16 src) {
+        // NOTE: The alpha is spread over its pixel with shifts, a byte
+        //       shuffle would go through memory without SSSE3.
+        auto alpha = (u32x4)src >> 24;
+        alpha |= alpha << 8;
+        alpha |= alpha << 16;
+
+        auto s = __builtin_convertvector(src, u16x16);
+        auto a = __builtin_convertvector((u8x16)alpha, u16x16);
+        return {s * a, 255 - a};
+    }
+
+    // Composite over four opaque pixels.
+    always_inline u8x16 over(u8x16 dst) const {
+        auto d = __builtin_convertvector(dst, u16x16);
+        return __builtin_convertvector(_div255(sa + d * ia), u8x16) | _ALPHA_MASK;
+    }
+};
+
+template <typename F>
+always_inline static void _over1(u8* dst, Color src) {
+    F::store(dst, src.blendOver(F::load(dst)));
+}
+
+// Composite four pixels already in the destination layout.
+template <typename F>
+always_inline static void _blend4(u8* dst, u8x16 src) {
+    if (_transparent4(src))
+        return;
+
+    if (_opaque4(src)) {
+        _store4(dst, src);
+        return;
+    }
+
+    auto d = _load4(dst);
+    if (_opaque4(d)) {
+        _store4(dst, _Src4::from(src).over(d));
+        return;
+    }
+
+    for (usize i = 0; i < 4; i++) {
+        u32 pixel = ((u32x4)src)[i];
+        _over1<F>(dst + i * 4, F::load(&pixel));
+    }
+}
+
+// MARK: Kernels ---------------------------------------------------------------
+
+// Fill a run of pixels with a color.
+template <typename F>
+void fillSpan(void* dst, usize len, Color color) {
+    auto* d = static_cast<u8*>(dst);
+    u32 pixel = _pack<F>(color);
+    auto v = _splat(pixel);
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4)
+        _store4(d + i * 4, v);
+
+    for (; i < len; i++)
+        memcpy(d + i * 4, &pixel, 4);
+}
+
+// Composite a color over a run of pixels.
+template <typename F>
+void blendSpan(void* dst, usize len, Color color) {
+    if (color.alpha == 255)
+        return fillSpan<F>(dst, len, color);
+
+    if (color.alpha == 0)
+        return;
+
+    auto* d = static_cast<u8*>(dst);
+    auto v = _splat(_pack<F>(color));
+    auto src = _Src4::from(v);
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4) {
+        auto px = _load4(d + i * 4);
+        if (_opaque4(px)) {
+            _store4(d + i * 4, src.over(px));
+        } else {
+            for (usize j = 0; j < 4; j++)
+                _over1<F>(d + (i + j) * 4, color);
+        }
+    }
+
+    for (; i < len; i++)
+        _over1<F>(d + i * 4, color);
+}
+
+// Composite a color over a run of pixels, scaled by the coverage of each
+// pixel as produced by the rasterizers.
+template <typename F>
+void blendSpan(void* dst, Slice<f64> coverage, Color color) {
+    auto* d = static_cast<u8*>(dst);
+    u32 pixel = _pack<F>(color) & 0x00ffffff;
+
+    auto alpha = [&](f64 a) -> u32 {
+        return static_cast<u8>(color.alpha * a) << 24;
+    };
+
+    usize i = 0;
+    for (; i + 4 <= coverage.len(); i += 4) {
+        u32x4 src = {
+            pixel | alpha(coverage[i]),
+            pixel | alpha(coverage[i + 1]),
+            pixel | alpha(coverage[i + 2]),
+            pixel | alpha(coverage[i + 3]),
+        };
+        _blend4<F>(d + i * 4, (u8x16)src);
+    }
+
+    for (; i < coverage.len(); i++)
+        _over1<F>(d + i * 4, color.withOpacity(coverage[i]));
+}
+
+// Composite a color over one pixel through a subpixel coverage mask.
+template <typename F>
+always_inline static void _overMask1(u8* dst, u8 const* mask, Color color) {
+    auto alpha = [&](u8 m) {
+        return static_cast<u8>(color.alpha * m / 255u);
+    };
+
+    auto c = F::load(dst);
+    c = color.withAlpha(alpha(mask[0])).blendOverComponent(c, Color::RED_COMPONENT);
+    c = color.withAlpha(alpha(mask[1])).blendOverComponent(c, Color::GREEN_COMPONENT);
+    c = color.withAlpha(alpha(mask[2])).blendOverComponent(c, Color::BLUE_COMPONENT);
+    F::store(dst, c);
+}
+
+// Composite a color over a run of pixels through a subpixel coverage mask,
+// with one coverage byte per color component, as kept by the glyph cache.
+template <typename F>
+void blendMaskSpan(void* dst, u8 const* mask, usize len, Color color) {
+    auto* d = static_cast<u8*>(dst);
+    auto s = __builtin_convertvector(_splat(_pack<F>(color)), u16x16);
+
+    // The coverage of four pixels, in the layout of the destination, with
+    // nothing on the alpha channel so it is left as is.
+    auto coverage4 = [&](u8 const* m) -> u8x16 {
+        u32x4 v = {
+            _pack<F>({m[0], m[1], m[2], 0}),
+            _pack<F>({m[3], m[4], m[5], 0}),
+            _pack<F>({m[6], m[7], m[8], 0}),
+            _pack<F>({m[9], m[10], m[11], 0}),
+        };
+        return (u8x16)v;
+    };
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4) {
+        auto const* m = mask + i * 3;
+
+        // NOTE: Most of the box of a glyph is left uncovered.
+        u64 lo;
+        u32 hi;
+        memcpy(&lo, m, sizeof(lo));
+        memcpy(&hi, m + sizeof(lo), sizeof(hi));
+        if ((lo | hi) == 0)
+            continue;
+
+        auto cov = coverage4(m);
+
+        auto px = _load4(d + i * 4);
+        if (not _opaque4(px)) {
+            for (usize j = 0; j < 4; j++)
+                _overMask1<F>(d + (i + j) * 4, m + j * 3, color);
+            continue;
+        }
+
+        auto a = _div255(__builtin_convertvector(cov, u16x16) * color.alpha);
+        auto p = __builtin_convertvector(px, u16x16);
+        _store4(d + i * 4, __builtin_convertvector(_div255(s * a + p * (255 - a)), u8x16) | _ALPHA_MASK);
+    }
+
+    for (; i < len; i++)
+        _overMask1<F>(d + i * 4, mask + i * 3, color);
+}
+
+// Composite a run of pixels over another, converting between formats.
+template <typename D, typename S>
+void blendSpan(void* dst, void const* src, usize len) {
+    auto* d = static_cast<u8*>(dst);
+    auto const* s = static_cast<u8 const*>(src);
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4)
+        _blend4<D>(d + i * 4, _convert4<D, S>(_load4(s + i * 4)));
+
+    for (; i < len; i++)
+        _over1<D>(d + i * 4, S::load(s + i * 4));
+}
+
+// Copy a run of pixels, converting between formats.
+template <typename D, typename S>
+void copySpan(void* dst, void const* src, usize len) {
+    if constexpr (Meta::Same<D, S>) {
+        memcpy(dst, src, len * 4);
+    } else {
+        auto* d = static_cast<u8*>(dst);
+        auto const* s = static_cast<u8 const*>(src);
+
+        usize i = 0;
+        for (; i + 4 <= len; i += 4)
+            _store4(d + i * 4, _convert4<D, S>(_load4(s + i * 4)));
+
+        for (; i < len; i++)
+            D::store(d + i * 4, S::load(s + i * 4));
+    }
+}
+
+} // namespace Karm::Gfx
@@ -128,12 +128,7 @@ struct Gradient {
         return *this;
     }
 
-    always_inline f64 transform(Math::Vec2f pos) const {
-        pos = pos - _start;
-        pos = pos.rotate(-(_end - _start).angle());
-        f64 scale = (_end - _start).len();
-        pos = pos / scale;
-
+    always_inline f64 _shape(Math::Vec2f pos) const {
         switch (_type) {
         case LINEAR:
             return pos.x;
@@ -149,10 +144,33 @@ struct Gradient {
         }
     }
 
-    always_inline Color sample(Math::Vec2f pos) const {
-        auto p = transform(pos);
+    always_inline f64 transform(Math::Vec2f pos) const {
+        pos = pos - _start;
+        pos = pos.rotate(-(_end - _start).angle());
+        f64 scale = (_end - _start).len();
+        pos = pos / scale;
+        return _shape(pos);
+    }
+
+    always_inline Color _lookup(f64 p) const {
         return (*_buf)[clamp(usize(p * 255), 0uz, 255uz)];
     }
+
+    always_inline Color sample(Math::Vec2f pos) const {
+        return _lookup(transform(pos));
+    }
+
+    // Sample a run of colors starting at `pos`, `step` apart, the gradient
+    // space is only rotated once for the whole run.
+    void sampleSpan(Math::Vec2f pos, Math::Vec2f step, MutSlice<Color> out) const {
+        f64 angle = -(_end - _start).angle();
+        f64 scale = (_end - _start).len();
+        pos = (pos - _start).rotate(angle) / scale;
+        step = step.rotate(angle) / scale;
+
+        for (usize i = 0; i < out.len(); i++)
+            out[i] = _lookup(_shape(pos + step * (f64)i));
+    }
 };
 
 using _Fills = Union<
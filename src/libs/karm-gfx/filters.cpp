@@ -1,100 +1,139 @@
-#include <karm-base/ring.h>
+#include <karm-base/simd.h>
+#include <karm-math/funcs.h>
 #include <karm-math/rand.h>
 
 #include "filters.h"
 
 namespace Karm::Gfx {
 
-struct StackBlur {
-    isize _radius;
-    Ring<Math::Vec4u> _queue;
-    Math::Vec4u _sum;
-
-    StackBlur(isize radius)
-        : _radius(radius), _queue(width()) {
-        clear();
+// MARK: Blur ------------------------------------------------------------------
+
+// A gaussian blur approximated by three box blurs, sized so the result has
+// the same spread as a stack blur of the same radius. Each box is a running
+// sum over a line, so the cost doesn't depend on the radius. Columns are
+// blurred as rows of a transposed copy of the region, which is built and
+// written back in tiles to stay in cache.
+struct BoxBlur {
+    static constexpr usize PASSES = 3;
+    static constexpr isize TILE = 16;
+
+    Array<isize, PASSES> _radii{};
+    isize _pad = 0;
+    Vec<i32x4> _front;
+    Vec<i32x4> _back;
+    Vec<u32> _transposed;
+
+    BoxBlur(isize radius) {
+        // NOTE: The stack blur kernel is a tent, made of two boxes of
+        //       radius + 1 pixels, this is the variance of that tent.
+        f64 variance = ((radius + 1) * (radius + 1) - 1) / 6.0;
+
+        // See "Fast Almost-Gaussian Filtering" by Peter Kovesi.
+        isize lower = Math::floori(Math::sqrt(12 * variance / PASSES + 1));
+        if (lower % 2 == 0)
+            lower--;
+        isize upper = lower + 2;
+        isize m = Math::roundi(
+            (12 * variance - PASSES * lower * lower - 4 * PASSES * lower - 3 * PASSES) /
+            (-4.0 * lower - 4)
+        );
+
+        for (usize i = 0; i < PASSES; i++)
+            _radii[i] = ((isize)i < m ? lower : upper) / 2;
+        _pad = upper / 2 + 1;
     }
 
-    Math::Vec4u outgoingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(i);
-        }
-        return sum;
-    }
+    // out[x] is the average of in[x - r] ... in[x + r], `in` is padded on
+    // both sides by at least r + 1 pixels.
+    static void _box(i32x4 const* in, i32x4* out, isize len, isize r) {
+        // NOTE: The sums are small enough to be exact as floats, and unlike
+        //       32-bit integer multiplies, float ones are in baseline SSE2.
+        f32 inv = 1.0f / (2 * r + 1);
+
+        i32x4 sum = {};
+        for (isize x = -r; x <= r; x++)
+            sum += in[x];
 
-    Math::Vec4u incomingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(width() - i - 1);
+        for (isize x = 0; x < len; x++) {
+            out[x] = __builtin_convertvector(__builtin_convertvector(sum, f32x4) * inv + 0.5f, i32x4);
+            sum += in[x + r + 1] - in[x - r];
         }
-        return sum;
     }
 
-    isize width() const {
-        return _radius * 2 + 1;
+    // Extend the line past its ends by repeating them.
+    void _extend(i32x4* line, isize len) {
+        for (isize i = 1; i <= _pad; i++) {
+            line[-i] = line[0];
+            line[len - 1 + i] = line[len - 1];
+        }
     }
 
-    isize denominator() const {
-        return _radius * (_radius + 2) - 1;
-    }
+    void _blurLine(u32* pixels, isize len) {
+        _front.resize(len + _pad * 2, i32x4{});
+        _back.resize(len + _pad * 2, i32x4{});
+        auto* front = _front.buf() + _pad;
+        auto* back = _back.buf() + _pad;
+
+        // NOTE: All the channels are blurred the same way, so the pixel
+        //       format doesn't matter.
+        for (isize x = 0; x < len; x++) {
+            u8x4 px;
+            memcpy(&px, &pixels[x], sizeof(px));
+            front[x] = __builtin_convertvector(px, i32x4);
+        }
 
-    void enqueue(Math::Vec4u color) {
-        _queue.pushBack(color);
-        _sum = _sum + incomingSum() - outgoingSum();
-    }
+        for (auto r : _radii) {
+            _extend(front, len);
+            _box(front, back, len, r);
+            std::swap(front, back);
+        }
 
-    Math::Vec4u dequeue() {
-        auto res = _sum / denominator();
-        _queue.popFront();
-        return res;
+        for (isize x = 0; x < len; x++) {
+            auto px = __builtin_convertvector(front[x], u8x4);
+            memcpy(&pixels[x], &px, sizeof(px));
+        }
     }
 
-    void clear() {
-        _sum = {};
-        _queue.clear();
-        for (isize i = 0; i < width(); i++) {
-            _queue.pushBack({});
+    // Transpose a `w` by `h` block of pixels, strides are in pixels.
+    static void _transpose(u32 const* src, isize srcStride, u32* dst, isize dstStride, isize w, isize h) {
+        for (isize ty = 0; ty < h; ty += TILE) {
+            for (isize tx = 0; tx < w; tx += TILE) {
+                isize th = min(TILE, h - ty);
+                isize tw = min(TILE, w - tx);
+                for (isize y = 0; y < th; y++)
+                    for (isize x = 0; x < tw; x++)
+                        dst[(tx + x) * dstStride + ty + y] = src[(ty + y) * srcStride + tx + x];
+            }
         }
     }
-};
 
-[[gnu::flatten]] void BlurFilter::apply(MutPixels p) const {
-    if (amount == 0)
-        return;
+    void apply(MutPixels p) {
+        isize w = p.width();
+        isize h = p.height();
+        if (w <= 0 or h <= 0)
+            return;
 
-    StackBlur stack{(isize)amount};
-    auto b = p.bound();
+        auto* pixels = static_cast<u32*>(p.pixelUnsafe({0, 0}));
+        isize stride = p.stride() / sizeof(u32);
 
-    for (isize y = b.top(); y < b.bottom(); y++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            auto x = b.start() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
-        }
+        for (isize y = 0; y < h; y++)
+            _blurLine(pixels + y * stride, w);
 
-        for (isize x = b.start(); x < b.end(); x++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x + (isize)amount + 1, y}));
-        }
+        _transposed.resize(w * h);
+        _transpose(pixels, stride, _transposed.buf(), h, w, h);
 
-        stack.clear();
-    }
+        for (isize x = 0; x < w; x++)
+            _blurLine(_transposed.buf() + x * h, h);
 
-    for (isize x = b.start(); x < b.end(); x++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            isize const y = b.top() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
-        }
+        _transpose(_transposed.buf(), h, pixels, stride, h, w);
+    }
+};
 
-        for (isize y = b.top(); y < b.bottom(); y++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x, y + (isize)amount + 1}));
-        }
+[[gnu::flatten]] void BlurFilter::apply(MutPixels p) const {
+    if (amount == 0)
+        return;
 
-        stack.clear();
-    }
+    BoxBlur{(isize)amount}.apply(p);
 }
 
 void SaturationFilter::apply(MutPixels p) const {
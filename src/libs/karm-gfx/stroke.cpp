@@ -4,8 +4,8 @@ namespace Karm::Gfx {
 
 // MARK: Common ----------------------------------------------------------------
 
-static void _createArc(Math::Polyf& poly, Math::Vec2f center, Math::Vec2f start, Math::Vec2f end, f64 startAngle, f64 delta, f64 radius) {
-    isize divs = 32; // FIXME: determine this procedurally
+static void _createArc(Math::Polyf& poly, Math::Vec2f center, Math::Vec2f start, Math::Vec2f end, f64 startAngle, f64 delta, f64 radius, f64 tolerance) {
+    isize divs = Math::Path::arcSegments(radius, delta, tolerance);
     f64 step = delta / divs;
     for (isize i = 0; i < divs; i++) {
         f64 sa = startAngle + step * i;
@@ -49,7 +49,7 @@ static void _createJoinMiter(Math::Polyf& poly, Math::Edgef curr, Math::Edgef ne
     poly.pushBack({v, next.start});
 }
 
-static void _createJoinRound(Math::Polyf& poly, Math::Edgef curr, Math::Edgef next, Math::Vec2f corner, f64 radius) {
+static void _createJoinRound(Math::Polyf& poly, Math::Edgef curr, Math::Edgef next, Math::Vec2f corner, f64 radius, f64 tolerance) {
     f64 startAngle = (curr.end - corner).angle();
     f64 endAngle = (next.start - corner).angle();
 
@@ -64,10 +64,10 @@ static void _createJoinRound(Math::Polyf& poly, Math::Edgef curr, Math::Edgef ne
         return;
     }
 
-    _createArc(poly, corner, curr.end, next.start, startAngle, delta, radius);
+    _createArc(poly, corner, curr.end, next.start, startAngle, delta, radius, tolerance);
 }
 
-static void _createJoin(Math::Polyf& poly, Stroke stroke, Math::Edgef curr, Math::Edgef next, Math::Vec2f corner, f64 radius) {
+static void _createJoin(Math::Polyf& poly, Stroke stroke, Math::Edgef curr, Math::Edgef next, Math::Vec2f corner, f64 radius, f64 tolerance) {
     // Make sure that the edge is not degenerate
     if (Math::Edgef{curr.end, next.start}.degenerated())
         return;
@@ -82,7 +82,7 @@ static void _createJoin(Math::Polyf& poly, Stroke stroke, Math::Edgef curr, Math
         break;
 
     case ROUND_JOIN:
-        _createJoinRound(poly, curr, next, corner, radius);
+        _createJoinRound(poly, curr, next, corner, radius, tolerance);
         break;
 
     default:
@@ -109,7 +109,7 @@ static void _createCapSquare(Math::Polyf& poly, Cap cap, f64 width) {
     poly.pushBack({e.end, cap.end});
 }
 
-static void _createCapRound(Math::Polyf& poly, Cap cap, f64 width) {
+static void _createCapRound(Math::Polyf& poly, Cap cap, f64 width, f64 tolerance) {
     f64 startAngle = (cap.start - cap.center).angle();
     f64 endAngle = (cap.end - cap.center).angle();
 
@@ -119,10 +119,10 @@ static void _createCapRound(Math::Polyf& poly, Cap cap, f64 width) {
 
     f64 delta = endAngle - startAngle;
 
-    _createArc(poly, cap.center, cap.start, cap.end, startAngle, delta, width / 2);
+    _createArc(poly, cap.center, cap.start, cap.end, startAngle, delta, width / 2, tolerance);
 }
 
-static void _createCap(Math::Polyf& poly, Stroke stroke, Cap cap) {
+static void _createCap(Math::Polyf& poly, Stroke stroke, Cap cap, f64 tolerance) {
     switch (stroke.cap) {
     case BUTT_CAP:
         _createCapButt(poly, cap);
@@ -131,7 +131,7 @@ static void _createCap(Math::Polyf& poly, Stroke stroke, Cap cap) {
         _createCapSquare(poly, cap, stroke.width);
         break;
     case ROUND_CAP:
-        _createCapRound(poly, cap, stroke.width);
+        _createCapRound(poly, cap, stroke.width, tolerance);
         break;
     default:
         panic("unknown cap type");
@@ -140,7 +140,7 @@ static void _createCap(Math::Polyf& poly, Stroke stroke, Cap cap) {
 
 // MARK: Public Api ------------------------------------------------------------
 
-void createStroke(Math::Polyf& poly, Math::Path const& path, Stroke stroke) {
+void createStroke(Math::Polyf& poly, Math::Path const& path, Stroke stroke, f64 tolerance) {
     f64 outerDist = 0;
 
     if (stroke.align == CENTER_ALIGN) {
@@ -169,12 +169,12 @@ void createStroke(Math::Polyf& poly, Math::Path const& path, Stroke stroke) {
 
             if (i == 0 and not contour.close) {
                 auto center = (innerCurr.end + outerCurr.start) / 2;
-                _createCap(poly, stroke, {innerCurr.end, outerCurr.start, center});
+                _createCap(poly, stroke, {innerCurr.end, outerCurr.start, center}, tolerance);
             }
 
             if (i + 1 == l and not contour.close) {
                 auto center = (outerCurr.end + innerCurr.start) / 2;
-                _createCap(poly, stroke, {outerCurr.end, innerCurr.start, center});
+                _createCap(poly, stroke, {outerCurr.end, innerCurr.start, center}, tolerance);
             }
 
             if (contour.close or i + 1 != l) {
@@ -192,10 +192,10 @@ void createStroke(Math::Polyf& poly, Math::Path const& path, Stroke stroke) {
                 auto innerNext = innerDist < 0.001 ? next.swap() : next.offset(innerDist).swap();
 
                 if (outerDist < -0.001)
-                    _createJoin(poly, stroke, outerCurr, outerNext, curr.end, Math::abs(outerDist));
+                    _createJoin(poly, stroke, outerCurr, outerNext, curr.end, Math::abs(outerDist), tolerance);
 
                 if (innerDist > 0.001)
-                    _createJoin(poly, stroke, innerNext, innerCurr, curr.end, Math::abs(innerDist));
+                    _createJoin(poly, stroke, innerNext, innerCurr, curr.end, Math::abs(innerDist), tolerance);
             }
         }
     }
@@ -66,7 +66,9 @@ inline Stroke stroke(auto... args) {
     return {args...};
 }
 
-void createStroke(Math::Polyf& poly, Math::Path const& path, Stroke stroke);
+// NOTE: The tolerance is in path units, it drives how finely round joins
+//       and caps are flattened.
+void createStroke(Math::Polyf& poly, Math::Path const& path, Stroke stroke, f64 tolerance = Math::Path::TOLERANCE);
 
 void createSolid(Math::Polyf& poly, Math::Path const& path);
 
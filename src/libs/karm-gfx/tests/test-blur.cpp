@@ -0,0 +1,50 @@
+#include <karm-gfx/buffer.h>
+#include <karm-gfx/filters.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+test$("karm-gfx-blur-uniform") {
+    auto surface = Surface::alloc({37, 23});
+    surface->mutPixels().clear(Color{10, 20, 30, 255});
+
+    BlurFilter{8}.apply(surface->mutPixels());
+
+    for (isize y = 0; y < 23; y++)
+        for (isize x = 0; x < 37; x++)
+            expectEq$(surface->pixels().load({x, y}), (Color{10, 20, 30, 255}));
+
+    return Ok();
+}
+
+test$("karm-gfx-blur-spread") {
+    auto surface = Surface::alloc({65, 33});
+    auto pixels = surface->mutPixels();
+    pixels.clear(Color{0, 0, 0, 255});
+    pixels.store({32, 16}, Color{255, 255, 255, 255});
+
+    BlurFilter{6}.apply(pixels);
+
+    // The dot is spread evenly in every direction, fading with distance.
+    u32 sum = 0;
+    for (isize y = 0; y < 33; y++)
+        for (isize x = 0; x < 65; x++)
+            sum += pixels.load({x, y}).red;
+    expect$(sum > 200 and sum < 310);
+
+    u8 last = pixels.load({32, 16}).red;
+    expect$(last > 0 and last < 255);
+    for (isize d = 1; d < 8; d++) {
+        auto c = pixels.load({32 + d, 16}).red;
+        expectEq$(pixels.load({32 - d, 16}).red, c);
+        expectEq$(pixels.load({32, 16 + d}).red, c);
+        expectEq$(pixels.load({32, 16 - d}).red, c);
+        expect$(c <= last);
+        last = c;
+    }
+    expectEq$(pixels.load({32 + 20, 16}).red, 0);
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -0,0 +1,96 @@
+#include <karm-gfx/cpu/glyphs.h>
+#include <karm-test/macros.h>
+#include <karm-text/vga.h>
+
+namespace Karm::Gfx::Tests {
+
+static GlyphKey _key(Text::Fontface const& fontface, u16 index, u32 size = 12) {
+    return {
+        .fontface = &fontface,
+        .glyph = {index, 0},
+        .size = size,
+        .subx = 0,
+        .suby = 0,
+        .layout = {},
+    };
+}
+
+test$("karm-gfx-glyph-cache-lookup") {
+    Rc<Text::Fontface> fontface = makeRc<Text::VgaFontface>();
+    CpuGlyphCache cache;
+
+    expectNot$(cache.lookup(_key(*fontface, 1)));
+
+    auto entry = cache.alloc(_key(*fontface, 1), fontface, {10, 12}, {-1, -11});
+    expect$(entry);
+    expectEq$(entry->rect.wh, (Math::Vec2i{10, 12}));
+    cache.mask(*entry, {3, 4})[1] = 128;
+
+    auto hit = cache.lookup(_key(*fontface, 1));
+    expect$(hit);
+    expectEq$(hit->offset, (Math::Vec2i{-1, -11}));
+    expectEq$(cache.mask(*hit, {3, 4})[1], 128);
+
+    // Different sizes are different glyphs.
+    expectNot$(cache.lookup(_key(*fontface, 1, 13)));
+
+    auto stats = cache.stats();
+    expectEq$(stats.hits, 1uz);
+    expectEq$(stats.misses, 2uz);
+    expectEq$(stats.glyphs, 1uz);
+
+    return Ok();
+}
+
+test$("karm-gfx-glyph-cache-packing") {
+    Rc<Text::Fontface> fontface = makeRc<Text::VgaFontface>();
+    CpuGlyphCache cache;
+
+    // 12 masks per shelf, 10 shelves per page.
+    Vec<Math::Recti> rects;
+    for (u16 i = 0; i < 120; i++) {
+        auto entry = cache.alloc(_key(*fontface, i), fontface, {20, 24}, {});
+        expect$(entry);
+        for (auto const& r : rects)
+            expectNot$(r.colide(entry->rect));
+        rects.pushBack(entry->rect);
+    }
+    expectEq$(cache.stats().pages, 1uz);
+
+    expect$(cache.alloc(_key(*fontface, 120), fontface, {20, 24}, {}));
+    expectEq$(cache.stats().pages, 2uz);
+
+    // Masks bigger than a page are not cached.
+    expectNot$(cache.alloc(_key(*fontface, 1000), fontface, {CpuGlyphCache::PAGE_SIZE + 1, 10}, {}));
+
+    return Ok();
+}
+
+test$("karm-gfx-glyph-cache-eviction") {
+    Rc<Text::Fontface> fontface = makeRc<Text::VgaFontface>();
+    CpuGlyphCache cache{CpuGlyphCache::PAGE_BYTES * 2};
+
+    // Fill two pages with glyphs taking a quarter of a page each.
+    isize quarter = CpuGlyphCache::PAGE_SIZE / 2;
+    for (u16 i = 0; i < 8; i++)
+        expect$(cache.alloc(_key(*fontface, i), fontface, {quarter, quarter}, {}));
+    expectEq$(cache.stats().pages, 2uz);
+    expectEq$(cache.stats().evictions, 0uz);
+
+    // Touch the first page, so the second one is the least recently used.
+    expect$(cache.lookup(_key(*fontface, 0)));
+
+    expect$(cache.alloc(_key(*fontface, 8), fontface, {quarter, quarter}, {}));
+    expectEq$(cache.stats().pages, 2uz);
+    expectEq$(cache.stats().evictions, 1uz);
+    expect$(cache.lookup(_key(*fontface, 0)));
+    expectNot$(cache.lookup(_key(*fontface, 4)));
+    expect$(cache.lookup(_key(*fontface, 8)));
+
+    cache.budget(CpuGlyphCache::PAGE_BYTES);
+    expectEq$(cache.stats().pages, 1uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
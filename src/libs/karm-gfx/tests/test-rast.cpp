@@ -0,0 +1,111 @@
+#include <karm-gfx/cpu/rast.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+static Math::Polyf _poly(Slice<Math::Vec2f> points) {
+    Math::Polyf poly;
+    for (usize i = 0; i < points.len(); i++)
+        poly.pushBack({points[i], points[(i + 1) % points.len()]});
+    return poly;
+}
+
+static Vec<f64> _render(auto& rast, Math::Polyf& poly, FillRule rule = FillRule::NONZERO) {
+    Vec<f64> cov;
+    cov.resize(32 * 32);
+    rast.fill(poly, {0, 0, 32, 32}, rule, [&](CpuRast::Frag frag) {
+        cov[frag.xy.y * 32 + frag.xy.x] += frag.a;
+    });
+    return cov;
+}
+
+static f64 _area(Vec<f64> const& cov) {
+    f64 sum = 0;
+    for (auto a : cov)
+        sum += a;
+    return sum;
+}
+
+test$("karm-gfx-sparse-rast-rect") {
+    CpuSparseRast rast;
+
+    Array points = {
+        Math::Vec2f{4.25, 4.5},
+        Math::Vec2f{12.75, 4.5},
+        Math::Vec2f{12.75, 10.5},
+        Math::Vec2f{4.25, 10.5},
+    };
+    auto poly = _poly(points);
+    auto cov = _render(rast, poly);
+
+    expect$(Math::epsilonEq(_area(cov), 8.5 * 6, 1e-6));
+    expect$(Math::epsilonEq(cov[4 * 32 + 4], 0.75 * 0.5, 1e-6));
+    expect$(Math::epsilonEq(cov[6 * 32 + 8], 1.0, 1e-6));
+    expect$(Math::epsilonEq(cov[6 * 32 + 12], 0.75, 1e-6));
+    expectEq$(cov[6 * 32 + 13], 0.0);
+
+    // Winding direction doesn't matter.
+    reverse(mutSub(points, 0, points.len()));
+    auto reversed = _poly(points);
+    expect$(Math::epsilonEq(_area(_render(rast, reversed)), 8.5 * 6, 1e-6));
+
+    return Ok();
+}
+
+test$("karm-gfx-sparse-rast-clip") {
+    CpuSparseRast rast;
+
+    Array points = {
+        Math::Vec2f{-10, -10},
+        Math::Vec2f{16.5, -10},
+        Math::Vec2f{16.5, 40},
+        Math::Vec2f{-10, 40},
+    };
+    auto poly = _poly(points);
+    expect$(Math::epsilonEq(_area(_render(rast, poly)), 16.5 * 32, 1e-6));
+
+    return Ok();
+}
+
+test$("karm-gfx-sparse-rast-fill-rule") {
+    CpuSparseRast rast;
+
+    // Two overlapping squares wound in the same direction.
+    Array points = {
+        Math::Vec2f{2, 2},
+        Math::Vec2f{10, 2},
+        Math::Vec2f{10, 10},
+        Math::Vec2f{2, 10},
+    };
+    auto poly = _poly(points);
+    for (auto& p : points)
+        p = p + Math::Vec2f{4, 4};
+    for (auto e : _poly(points))
+        poly.pushBack(e);
+
+    expect$(Math::epsilonEq(_area(_render(rast, poly, FillRule::NONZERO)), 64.0 + 64 - 16, 1e-6));
+    expect$(Math::epsilonEq(_area(_render(rast, poly, FillRule::EVENODD)), 64.0 + 64 - 32, 1e-6));
+
+    return Ok();
+}
+
+test$("karm-gfx-sparse-rast-matches-supersampled") {
+    CpuRast reference;
+    CpuSparseRast rast;
+
+    Array points = {
+        Math::Vec2f{3, 2},
+        Math::Vec2f{29, 9},
+        Math::Vec2f{8, 30},
+    };
+    auto poly = _poly(points);
+    auto expected = _render(reference, poly);
+    auto actual = _render(rast, poly);
+
+    for (usize i = 0; i < expected.len(); i++)
+        expect$(Math::abs(expected[i] - actual[i]) < 0.1);
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
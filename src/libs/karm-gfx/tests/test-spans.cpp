@@ -0,0 +1,146 @@
+#include <karm-gfx/cpu/spans.h>
+#include <karm-math/rand.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+static constexpr usize LEN = 67;
+
+static Color _randomColor(Math::Rand& rand, bool mixed) {
+    Color c = {rand.nextU8(), rand.nextU8(), rand.nextU8(), rand.nextU8()};
+    // Favor the alpha values the kernels have fast paths for.
+    switch (rand.nextInt(4)) {
+    case 0:
+        c.alpha = 0;
+        break;
+    case 1:
+        c.alpha = 255;
+        break;
+    default:
+        if (not mixed)
+            c.alpha = 255;
+        break;
+    }
+    return c;
+}
+
+template <typename F>
+static Array<u8, LEN * 4> _randomPixels(Math::Rand& rand, bool mixed) {
+    Array<u8, LEN * 4> pixels = {};
+    for (usize i = 0; i < LEN; i++)
+        F::store(&pixels[i * 4], _randomColor(rand, mixed));
+    return pixels;
+}
+
+template <typename D, typename S>
+static Res<> _checkBlend(Test::Driver& _driver, Math::Rand& rand) {
+    for (bool mixed : {false, true}) {
+        auto src = _randomPixels<S>(rand, true);
+        auto dst = _randomPixels<D>(rand, mixed);
+        auto expected = dst;
+
+        for (usize i = 0; i < LEN; i++)
+            D::store(&expected[i * 4], S::load(&src[i * 4]).blendOver(D::load(&expected[i * 4])));
+
+        blendSpan<D, S>(dst.buf(), src.buf(), LEN);
+        expectEq$(sub(dst), sub(expected));
+
+        copySpan<D, S>(dst.buf(), src.buf(), LEN);
+        for (usize i = 0; i < LEN; i++)
+            expectEq$(D::load(&dst[i * 4]), S::load(&src[i * 4]));
+    }
+
+    return Ok();
+}
+
+test$("karm-gfx-spans-blend-pixels") {
+    Math::Rand rand{};
+    try$((_checkBlend<Rgba8888, Rgba8888>(_driver, rand)));
+    try$((_checkBlend<Rgba8888, Bgra8888>(_driver, rand)));
+    try$((_checkBlend<Bgra8888, Rgba8888>(_driver, rand)));
+    try$((_checkBlend<Bgra8888, Bgra8888>(_driver, rand)));
+    return Ok();
+}
+
+template <typename F>
+static Res<> _checkFill(Test::Driver& _driver, Math::Rand& rand) {
+    for (bool mixed : {false, true}) {
+        auto color = _randomColor(rand, true);
+        auto dst = _randomPixels<F>(rand, mixed);
+
+        Array<f64, LEN> coverage = {};
+        for (auto& a : coverage)
+            a = rand.nextInt(3) ? rand.nextDouble() : rand.nextInt(2);
+
+        auto expected = dst;
+        for (usize i = 0; i < LEN; i++) {
+            auto c = color.withOpacity(coverage[i]);
+            F::store(&expected[i * 4], c.blendOver(F::load(&expected[i * 4])));
+        }
+
+        auto blended = dst;
+        blendSpan<F>(blended.buf(), sub(coverage), color);
+        expectEq$(sub(blended), sub(expected));
+
+        expected = dst;
+        for (usize i = 0; i < LEN; i++)
+            F::store(&expected[i * 4], color.blendOver(F::load(&expected[i * 4])));
+
+        blendSpan<F>(dst.buf(), LEN, color);
+        expectEq$(sub(dst), sub(expected));
+
+        fillSpan<F>(dst.buf(), LEN, color);
+        for (usize i = 0; i < LEN; i++)
+            expectEq$(F::load(&dst[i * 4]), color);
+    }
+
+    return Ok();
+}
+
+test$("karm-gfx-spans-blend-color") {
+    Math::Rand rand{};
+    for (usize i = 0; i < 16; i++) {
+        try$((_checkFill<Rgba8888>(_driver, rand)));
+        try$((_checkFill<Bgra8888>(_driver, rand)));
+    }
+    return Ok();
+}
+
+template <typename F>
+static Res<> _checkMask(Test::Driver& _driver, Math::Rand& rand) {
+    for (bool mixed : {false, true}) {
+        auto color = _randomColor(rand, true);
+        auto dst = _randomPixels<F>(rand, mixed);
+
+        // Runs of uncovered pixels, as around a glyph, with some partly
+        // and fully covered ones.
+        Array<u8, LEN * 3> mask = {};
+        for (auto& m : mask)
+            m = rand.nextInt(3) ? 0 : (rand.nextInt(2) ? rand.nextU8() : 255);
+
+        auto expected = dst;
+        for (usize i = 0; i < LEN; i++) {
+            auto c = F::load(&expected[i * 4]);
+            c = color.withAlpha(color.alpha * mask[i * 3 + 0] / 255).blendOverComponent(c, Color::RED_COMPONENT);
+            c = color.withAlpha(color.alpha * mask[i * 3 + 1] / 255).blendOverComponent(c, Color::GREEN_COMPONENT);
+            c = color.withAlpha(color.alpha * mask[i * 3 + 2] / 255).blendOverComponent(c, Color::BLUE_COMPONENT);
+            F::store(&expected[i * 4], c);
+        }
+
+        blendMaskSpan<F>(dst.buf(), mask.buf(), LEN, color);
+        expectEq$(sub(dst), sub(expected));
+    }
+
+    return Ok();
+}
+
+test$("karm-gfx-spans-blend-mask") {
+    Math::Rand rand{};
+    for (usize i = 0; i < 16; i++) {
+        try$((_checkMask<Rgba8888>(_driver, rand)));
+        try$((_checkMask<Bgra8888>(_driver, rand)));
+    }
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -27,6 +27,8 @@ export struct Transport {
 
 static constexpr usize BUF_SIZE = 4096;
 
+static constexpr usize MAX_HEADER_SIZE = 64 * 1024;
+
 struct ContentBody : public Body {
     Buf<Byte> _resumes;
     usize _resumesPos = 0;
@@ -79,9 +81,30 @@ struct HttpTransport : public Transport {
         co_return Ok();
     }
 
+    static bool _hasEndOfHeader(Bytes buf) {
+        for (usize i = 0; i + 4 <= buf.len(); i++)
+            if (buf[i] == '\r' and buf[i + 1] == '\n' and buf[i + 2] == '\r' and buf[i + 3] == '\n')
+                return true;
+        return false;
+    }
+
     Async::Task<Rc<Response>> _recvResponseAsync(Sys::TcpConnection& conn) {
-        Array<u8, BUF_SIZE> buf = {};
-        Io::BufReader reader = sub(buf, 0, co_trya$(conn.readAsync(buf)));
+        // NOTE: On a slow connection the header can arrive over several
+        //       reads, whatever comes after it is the start of the body.
+        Buf<u8> buf;
+        Array<u8, BUF_SIZE> chunk = {};
+        while (not _hasEndOfHeader(buf)) {
+            if (buf.len() > MAX_HEADER_SIZE)
+                co_return Error::invalidData("response header too large");
+
+            usize read = co_trya$(conn.readAsync(chunk));
+            if (read == 0)
+                co_return Error::unexpectedEof("connection closed before the end of the response header");
+
+            buf.insert(COPY, buf.len(), chunk.buf(), read);
+        }
+
+        Io::BufReader reader = sub(buf);
         auto response = co_try$(Response::read(reader));
 
         if (auto contentLength = response.header.contentLength()) {
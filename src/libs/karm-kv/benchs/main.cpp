@@ -0,0 +1,100 @@
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+import Karm.Kv;
+
+static constexpr usize KEYS = 1'000'000;
+static constexpr usize SYNCED_KEYS = 1'000;
+static constexpr usize BATCH = 1'000;
+
+static Array<u8, 16> _key(usize i) {
+    Array<u8, 16> key{};
+    // Scramble the keys so they are not inserted in order.
+    u64 k = i * 0x9e3779b97f4a7c15ull;
+    for (usize j = 0; j < 8; j++)
+        key[j] = (k >> (56 - j * 8)) & 0xff;
+    for (usize j = 8; j < 16; j++)
+        key[j] = (i >> ((15 - j) * 8)) & 0xff;
+    return key;
+}
+
+static void _report(Str what, usize ops, Duration elapsed) {
+    f64 secs = elapsed.toUSecs() / 1e6;
+    Sys::println("{}: {} ({} ops/s)", what, elapsed, (usize)(ops / secs));
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    auto url = "file:./kv-bench"_url;
+    co_try$(Kv::Store::destroy(url));
+
+    Array<u8, 100> value{};
+
+    {
+        auto store = co_try$(Kv::Store::open(url));
+
+        auto start = Sys::now();
+        for (usize i = 0; i < KEYS; i++)
+            co_try$(store->put(_key(i), value));
+        _report("put", KEYS, Sys::now() - start);
+
+        start = Sys::now();
+        for (usize i = 0; i < KEYS; i++)
+            if (not co_try$(store->get(_key(i))))
+                co_return Error::other("missing key");
+        _report("get", KEYS, Sys::now() - start);
+
+        start = Sys::now();
+        for (usize i = KEYS; i < KEYS * 2; i++)
+            if (co_try$(store->get(_key(i))))
+                co_return Error::other("unexpected key");
+        _report("get (missing)", KEYS, Sys::now() - start);
+
+        start = Sys::now();
+        usize n = 0;
+        for (auto const& r : store->iter()) {
+            co_try$(r);
+            n++;
+        }
+        if (n != KEYS)
+            co_return Error::other("unexpected key count");
+        _report("scan", KEYS, Sys::now() - start);
+
+        Sys::println("segments: {}", store->segments());
+    }
+
+    {
+        auto start = Sys::now();
+        auto store = co_try$(Kv::Store::open(url));
+        Sys::println("reopen: {}", Sys::now() - start);
+    }
+
+    co_try$(Kv::Store::destroy(url));
+
+    // Batched writes, with and without syncing the log.
+    for (auto sync : {Kv::SyncPolicy::NEVER, Kv::SyncPolicy::EVERY_BATCH}) {
+        bool synced = sync == Kv::SyncPolicy::EVERY_BATCH;
+        auto store = co_try$(Kv::Store::open(url, {.wal = {.sync = sync}}));
+
+        // Syncing every put is slow, don't wait all day.
+        usize keys = synced ? SYNCED_KEYS : KEYS;
+        auto start = Sys::now();
+        for (usize i = 0; i < keys; i++)
+            co_try$(store->put(_key(i), value));
+        _report(synced ? "put (synced)" : "put", keys, Sys::now() - start);
+
+        start = Sys::now();
+        Kv::WriteBatch batch;
+        for (usize i = 0; i < KEYS; i++) {
+            batch.put(_key(i), value);
+            if (batch.len() == BATCH or i == KEYS - 1) {
+                co_try$(store->write(batch));
+                batch.clear();
+            }
+        }
+        _report(synced ? "batched put (synced)" : "batched put", KEYS, Sys::now() - start);
+
+        co_try$(Kv::Store::destroy(url));
+    }
+
+    co_return Ok();
+}
@@ -1,5 +1,6 @@
 module;
 
+#include <karm-base/hash.h>
 #include <karm-base/rc.h>
 #include <karm-base/slice.h>
 
@@ -108,6 +109,10 @@ export struct Blob {
     auto operator<=>(Blob const& other) const {
         return bytes() <=> other.bytes();
     }
+
+    Hash hash() const {
+        return Karm::hash(bytes());
+    }
 };
 
 Blob MutBlob::slice(urange slice) const {
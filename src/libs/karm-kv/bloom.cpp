@@ -0,0 +1,87 @@
+module;
+
+#include <karm-base/align.h>
+#include <karm-base/buf.h>
+#include <karm-base/clamp.h>
+
+export module Karm.Kv:bloom;
+
+namespace Karm::Kv {
+
+// Bloom filter over the keys of a segment, lets point lookups skip the
+// segments that can't contain the key they are looking for.
+//
+// The filter is persisted alongside the segment, so the hash function is
+// part of the on-disk format and must never change.
+export struct Bloom {
+    // ~1% false positive rate.
+    static constexpr usize BITS_PER_KEY = 10;
+    static constexpr u32 HASHES = 7;
+
+    u32 _hashes = HASHES;
+    Buf<u8> _bits;
+
+    static Bloom forKeys(usize keys) {
+        Bloom bloom;
+        bloom._bits = Buf<u8>::init(alignUp(max(keys * BITS_PER_KEY, 64uz), 8) / 8, 0);
+        return bloom;
+    }
+
+    static Bloom load(u32 hashes, Bytes bits) {
+        Bloom bloom;
+        bloom._hashes = hashes;
+        bloom._bits = Buf<u8>(bits);
+        return bloom;
+    }
+
+    static u64 _hash(Bytes key) {
+        // FNV-1a followed by the murmur3 finalizer.
+        u64 h = 0xcbf29ce484222325;
+        for (auto b : key) {
+            h ^= b;
+            h *= 0x100000001b3;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
+
+    usize _len() const {
+        return _bits.len() * 8;
+    }
+
+    void add(Bytes key) {
+        // Double hashing, see Kirsch and Mitzenmacher
+        u64 h = _hash(key);
+        u64 delta = (h >> 17) | (h << 47);
+        for (u32 i = 0; i < _hashes; i++) {
+            usize bit = h % _len();
+            _bits[bit / 8] |= 1 << (bit % 8);
+            h += delta;
+        }
+    }
+
+    bool mayContain(Bytes key) const {
+        if (_bits.len() == 0)
+            return true;
+
+        u64 h = _hash(key);
+        u64 delta = (h >> 17) | (h << 47);
+        for (u32 i = 0; i < _hashes; i++) {
+            usize bit = h % _len();
+            if (not(_bits[bit / 8] & (1 << (bit % 8))))
+                return false;
+            h += delta;
+        }
+        return true;
+    }
+
+    Bytes bytes() const {
+        return _bits;
+    }
+};
+
+} // namespace Karm::Kv
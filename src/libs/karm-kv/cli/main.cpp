@@ -3,8 +3,7 @@
 import Karm.Kv;
 
 Async::Task<> entryPointAsync(Sys::Context&) {
-    auto wal = co_try$(Kv::Wal::open("file:./db.wal"_url));
-    auto store = Kv::Store::open(wal);
+    auto store = co_try$(Kv::Store::open("file:./db"_url));
 
     co_try$(store->put(bytes("hello"s), bytes("world"s)));
     co_try$(store->del(bytes("hello"s)));
@@ -1,5 +1,7 @@
 export module Karm.Kv;
 
 export import :blob;
+export import :bloom;
+export import :segment;
 export import :store;
 export import :wal;
@@ -0,0 +1,327 @@
+module;
+
+#include <karm-base/rc.h>
+#include <karm-crypto/crc32.h>
+#include <karm-io/bscan.h>
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+#include <karm-sys/file.h>
+
+export module Karm.Kv:segment;
+
+import :blob;
+import :bloom;
+import :wal;
+
+namespace Karm::Kv {
+
+// Immutable sorted run of records flushed from the memtable or produced by
+// compaction.
+//
+//     header | block... | index | bloom | footer
+//
+// Blocks hold the records in key order, the index holds the first key of
+// every block. Only the index and the bloom filter are loaded when the
+// segment is opened, blocks are read on demand.
+export struct Segment {
+    static constexpr usize BLOCK_SIZE = 4096;
+
+    static constexpr Array<u8, 8> MAGIC = {
+        'K', 'V', 'S', 'E', 'G', 0, 0, 0
+    };
+
+    struct [[gnu::packed]] RawEntry {
+        Wal::Record::Type type;
+        Le<u32> keylen;
+        Le<u32> vallen;
+    };
+
+    struct [[gnu::packed]] RawIndex {
+        Le<u64> off;
+        Le<u32> len;
+        Le<u32> crc;
+        Le<u32> keylen;
+    };
+
+    struct [[gnu::packed]] RawFooter {
+        Le<u64> indexOff;
+        Le<u64> indexLen;
+        Le<u64> bloomLen;
+        Le<u64> count;
+        Le<u32> hashes;
+        Le<u32> crc;
+        Array<u8, 8> magic;
+
+        Bytes bytes() const {
+            return {
+                reinterpret_cast<u8 const*>(this),
+                sizeof(RawFooter),
+            };
+        }
+
+        MutBytes mutBytes() {
+            return {
+                reinterpret_cast<u8*>(this),
+                sizeof(RawFooter),
+            };
+        }
+    };
+
+    struct Block {
+        Blob first;
+        u64 off;
+        u32 len;
+        u32 crc;
+    };
+
+    Mime::Url _url;
+    Sys::FileReader _file;
+    Vec<Block> _index;
+    Bloom _bloom;
+    usize _count;
+    usize _size;
+
+    // Last block read by a point lookup, lookups tend to be clustered.
+    Opt<Pair<usize, Blob>> _cached = NONE;
+
+    static Res<Rc<Segment>> open(Mime::Url const& url) {
+        auto file = try$(Sys::File::open(url));
+        usize size = try$(Io::size(file));
+        if (size < MAGIC.len() + sizeof(RawFooter))
+            return Error::invalidData("segment too small");
+
+        RawFooter footer;
+        try$(_readFull(file, footer.mutBytes(), size - sizeof(RawFooter)));
+        if (footer.magic != MAGIC)
+            return Error::invalidData("invalid segment footer");
+
+        usize metaLen = footer.indexLen + footer.bloomLen;
+        if (footer.indexOff + metaLen + sizeof(RawFooter) != size)
+            return Error::invalidData("invalid segment layout");
+
+        auto meta = MutBlob::alloc(metaLen);
+        try$(_readFull(file, meta.mutBytes(), footer.indexOff));
+        if (Crypto::crc32(meta.bytes()) != footer.crc)
+            return Error::invalidData("invalid segment index crc");
+
+        Vec<Block> index;
+        Io::BScan s{meta.bytes()};
+        usize indexEnd = footer.indexLen;
+        while (s.tell() < indexEnd) {
+            RawIndex raw;
+            if (indexEnd - s.tell() < sizeof(RawIndex))
+                return Error::invalidData("truncated segment index");
+            s.readTo(&raw);
+            if (s.tell() + raw.keylen > indexEnd)
+                return Error::invalidData("truncated segment index");
+            index.pushBack(Block{
+                .first = meta.slice({s.tell(), raw.keylen}),
+                .off = raw.off,
+                .len = raw.len,
+                .crc = raw.crc,
+            });
+            s.skip(raw.keylen);
+        }
+
+        auto bloom = Bloom::load(footer.hashes, sub(meta.bytes(), footer.indexLen, metaLen));
+
+        return Ok(makeRc<Segment>(
+            url,
+            std::move(file),
+            std::move(index),
+            std::move(bloom),
+            footer.count,
+            size
+        ));
+    }
+
+    static Res<> _readFull(Sys::FileReader& file, MutBytes bytes, usize off) {
+        if (try$(Io::pread(file, bytes, Io::Seek::fromBegin(off))) != bytes.len())
+            return Error::invalidData("unexpected end of segment");
+        return Ok();
+    }
+
+    usize len() const {
+        return _count;
+    }
+
+    usize size() const {
+        return _size;
+    }
+
+    Res<Blob> _readBlock(usize i) {
+        if (_cached and _cached->v0 == i)
+            return Ok(_cached->v1);
+
+        auto const& block = _index[i];
+        auto buf = MutBlob::alloc(block.len);
+        try$(_readFull(_file, buf.mutBytes(), block.off));
+        if (Crypto::crc32(buf.bytes()) != block.crc)
+            return Error::invalidData("invalid segment block crc");
+
+        _cached = Pair<usize, Blob>{i, buf};
+        return Ok(buf);
+    }
+
+    // Index of the block that may contain `key`.
+    Opt<usize> _find(Bytes key) const {
+        return searchLowerBound(_index, [&](Block const& b) {
+            return b.first.bytes() <=> key;
+        });
+    }
+
+    static Opt<Wal::Record> _next(Blob const& block, Io::BScan& s) {
+        RawEntry raw;
+        if (s.rem() < sizeof(RawEntry))
+            return NONE;
+        s.readTo(&raw);
+        usize off = s.tell();
+        if (off + raw.keylen + raw.vallen > block.len())
+            return NONE;
+        s.skip(raw.keylen + raw.vallen);
+        return Wal::Record{
+            .type = raw.type,
+            .key = block.slice({off, raw.keylen}),
+            .value = block.slice({off + raw.keylen, raw.vallen}),
+        };
+    }
+
+    // Look up the most recent record for `key`, deletions included.
+    Res<Opt<Wal::Record>> lookup(Bytes key) {
+        if (not _bloom.mayContain(key))
+            return Ok(NONE);
+
+        auto i = _find(key);
+        if (not i)
+            return Ok(NONE);
+
+        auto block = try$(_readBlock(*i));
+        Io::BScan s{block.bytes()};
+        while (auto r = _next(block, s)) {
+            auto cmp = r->key.bytes() <=> key;
+            if (cmp == 0)
+                return Ok(r);
+            if (cmp > 0)
+                break;
+        }
+        return Ok(NONE);
+    }
+
+    // Iterate over the records in key order, starting at `from`. A block
+    // that can't be read ends the iteration with its error.
+    Generator<Res<Wal::Record>> iter(Opt<Blob> from = NONE) {
+        usize start = 0;
+        if (from)
+            start = _find(from->bytes()).unwrapOr(0);
+
+        for (usize i = start; i < _index.len(); i++) {
+            auto maybeBlock = _readBlock(i);
+            if (not maybeBlock) {
+                co_yield maybeBlock.none();
+                co_return;
+            }
+
+            auto block = maybeBlock.take();
+            Io::BScan s{block.bytes()};
+            while (true) {
+                auto r = _next(block, s);
+                if (not r)
+                    break;
+                if (from and r->key.bytes() < from->bytes())
+                    continue;
+                co_yield Ok(r.take());
+            }
+        }
+    }
+};
+
+// Writes records, in strictly increasing key order, to a new segment file.
+export struct SegmentWriter {
+    Sys::FileWriter _file;
+    Io::BufferWriter _block{Segment::BLOCK_SIZE * 2};
+    Io::BufferWriter _index;
+    Opt<Blob> _first = NONE;
+    Bloom _bloom;
+    usize _off = 0;
+    usize _count = 0;
+
+    static Res<SegmentWriter> create(Mime::Url const& url, usize expectedKeys) {
+        auto file = try$(Sys::File::create(url));
+        try$(file.write(Segment::MAGIC));
+        return Ok(SegmentWriter{
+            ._file = std::move(file),
+            ._bloom = Bloom::forKeys(expectedKeys),
+            ._off = Segment::MAGIC.len(),
+        });
+    }
+
+    Res<> add(Wal::Record const& r) {
+        if (not _first)
+            _first = r.key;
+
+        Segment::RawEntry raw;
+        raw.type = r.type;
+        raw.keylen = r.key.len();
+        raw.vallen = r.value.len();
+
+        Io::BEmit e{_block};
+        e.writeFrom(raw);
+        try$(_block.write(r.key.bytes()));
+        try$(_block.write(r.value.bytes()));
+
+        _bloom.add(r.key.bytes());
+        _count++;
+
+        if (_block.bytes().len() >= Segment::BLOCK_SIZE)
+            try$(_flushBlock());
+
+        return Ok();
+    }
+
+    Res<> _flushBlock() {
+        if (not _first)
+            return Ok();
+
+        auto bytes = _block.bytes();
+        Segment::RawIndex raw;
+        raw.off = _off;
+        raw.len = bytes.len();
+        raw.crc = Crypto::crc32(bytes);
+        raw.keylen = _first->len();
+
+        Io::BEmit e{_index};
+        e.writeFrom(raw);
+        try$(_index.write(_first->bytes()));
+
+        try$(_file.write(bytes));
+        _off += bytes.len();
+        _block.clear();
+        _first = NONE;
+
+        return Ok();
+    }
+
+    Res<> finish() {
+        try$(_flushBlock());
+
+        Crypto::Crc32 crc;
+        crc.update(_index.bytes());
+        crc.update(_bloom.bytes());
+
+        Segment::RawFooter footer;
+        footer.indexOff = _off;
+        footer.indexLen = _index.bytes().len();
+        footer.bloomLen = _bloom.bytes().len();
+        footer.count = _count;
+        footer.hashes = _bloom._hashes;
+        footer.crc = crc.digest();
+        footer.magic = Segment::MAGIC;
+
+        try$(_file.write(_index.bytes()));
+        try$(_file.write(_bloom.bytes()));
+        try$(_file.write(footer.bytes()));
+        return _file.sync();
+    }
+};
+
+} // namespace Karm::Kv
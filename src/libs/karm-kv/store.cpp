@@ -2,42 +2,513 @@ module;
 
 #include <karm-base/rc.h>
 #include <karm-crypto/crc32.h>
-#include <karm-logger/logger.h>
+#include <karm-io/bscan.h>
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+#include <karm-sys/file.h>
 
 export module Karm.Kv:store;
 
 import :blob;
+import :segment;
 import :wal;
 
 namespace Karm::Kv {
 
+// Merge several sorted record streams, when a key appears in more than one
+// stream the record from the first one wins.
+struct _Merge {
+    Vec<Generator<Res<Wal::Record>>> _sources;
+    Vec<Opt<Wal::Record>> _heads;
+
+    static Res<_Merge> create(Vec<Generator<Res<Wal::Record>>> sources) {
+        _Merge merge{std::move(sources)};
+        for (usize i = 0; i < merge._sources.len(); i++) {
+            merge._heads.pushBack(NONE);
+            try$(merge._pull(i));
+        }
+        return Ok(std::move(merge));
+    }
+
+    Res<> _pull(usize i) {
+        auto r = _sources[i].next();
+        if (not r) {
+            _heads[i] = NONE;
+            return Ok();
+        }
+        _heads[i] = try$(r.take());
+        return Ok();
+    }
+
+    Res<Opt<Wal::Record>> next() {
+        Opt<usize> best = NONE;
+        for (usize i = 0; i < _heads.len(); i++) {
+            if (not _heads[i])
+                continue;
+            if (not best or _heads[i]->key.bytes() < _heads[*best]->key.bytes())
+                best = i;
+        }
+
+        if (not best)
+            return Ok(NONE);
+
+        auto record = _heads[*best].take();
+        try$(_pull(*best));
+
+        // Drop the shadowed records of older streams.
+        for (usize i = *best + 1; i < _heads.len(); i++) {
+            if (_heads[i] and _heads[i]->key == record.key)
+                try$(_pull(i));
+        }
+
+        return Ok(record);
+    }
+};
+
+export struct StoreOptions {
+    usize memtableSize = 4 * 1024 * 1024;
+    usize mergeWidth = 4;
+    WalOptions wal = {};
+};
+
+// Log-structured key-value store.
+//
+// Writes go to the write-ahead log and to an in-memory table, once the table
+// grows past `StoreOptions::memtableSize` it is flushed to an immutable sorted
+// segment and the log is rotated. Segments are merged by size-tiered
+// compaction: once `StoreOptions::mergeWidth` segments of the same tier pile up
+// they are merged into a single segment of the next tier, dropping shadowed
+// records, and deletions once the oldest segment takes part in the merge.
+//
+// The live segments and log are recorded in a manifest, which is written
+// alternately to two slots so a torn write never loses the previous state.
+// Opening the store only loads the manifest, the segment indexes and bloom
+// filters, and replays the current log.
+//
+//     <name>.manifest.{0,1}
+//     <name>.<seq>.wal
+//     <name>.<seq>.seg
 export struct Store {
+    struct _Level {
+        usize seq;
+        usize tier;
+        Rc<Segment> segment;
+    };
+
+    struct [[gnu::packed]] RawManifest {
+        static constexpr Array<u8, 8> MAGIC = {
+            'K', 'V', 'M', 'A', 'N', 0, 0, 0
+        };
+
+        Array<u8, 8> magic;
+        Le<u64> gen;
+        Le<u64> walSeq;
+        Le<u64> nextSeq;
+        Le<u64> count;
+    };
+
+    struct [[gnu::packed]] RawLevel {
+        Le<u64> seq;
+        Le<u64> tier;
+    };
+
+    Mime::Url _url;
+    StoreOptions _options;
     Rc<Wal> _wal;
-    Map<Blob, Blob> _memdb;
-
-    static Rc<Store> open(Rc<Wal> wal) {
-        auto db = makeRc<Store>(wal);
-        for (Wal::Record const& r : wal->iter()) {
-            if (r.type == Wal::PUT) {
-                db->_memdb.put(r.key, r.value);
-            } else if (r.type == Wal::DEL) {
-                db->_memdb.del(r.key);
+    usize _gen = 0;
+    usize _walSeq = 0;
+    usize _nextSeq = 0;
+    Vec<_Level> _levels = {}; // Oldest first
+    HashMap<Blob, Wal::Record> _memtable = {};
+    usize _memtableSize = 0;
+
+    static Res<Rc<Store>> open(Mime::Url const& url, StoreOptions options = {}) {
+        Vec<_Level> levels;
+        usize gen = 0, walSeq = 0, nextSeq = 1;
+
+        if (auto manifest = _loadManifest(url)) {
+            Io::BScan s{*manifest};
+            RawManifest raw;
+            s.readTo(&raw);
+            gen = raw.gen;
+            walSeq = raw.walSeq;
+            nextSeq = raw.nextSeq;
+            for (usize i = 0; i < raw.count; i++) {
+                RawLevel level;
+                s.readTo(&level);
+                levels.pushBack({
+                    level.seq,
+                    level.tier,
+                    try$(Segment::open(_segmentUrl(url, level.seq))),
+                });
             }
         }
-        return db;
-    };
 
-    Res<> put(Bytes key, Bytes value) {
-        try$(_wal->record(Wal::PUT, key, value));
-        _memdb.put(Blob::from(key), Blob::from(value));
+        auto wal = try$(Wal::open(_walUrl(url, walSeq), options.wal));
+        auto db = makeRc<Store>(url, options, wal, gen, walSeq, nextSeq, std::move(levels));
+
+        for (Wal::Record const& r : wal->iter())
+            db->_apply(r);
+
+        return Ok(db);
+    }
+
+    // Remove every file belonging to the store at `url`.
+    static Res<> destroy(Mime::Url const& url) {
+        if (auto manifest = _loadManifest(url)) {
+            Io::BScan s{*manifest};
+            RawManifest raw;
+            s.readTo(&raw);
+            for (usize i = 0; i < raw.count; i++) {
+                RawLevel level;
+                s.readTo(&level);
+                try$(Sys::File::remove(_segmentUrl(url, level.seq)));
+            }
+            try$(Sys::File::remove(_walUrl(url, raw.walSeq)));
+        } else {
+            (void)Sys::File::remove(_walUrl(url, 0));
+        }
+
+        (void)Sys::File::remove(_manifestUrl(url, 0));
+        (void)Sys::File::remove(_manifestUrl(url, 1));
         return Ok();
     }
 
-    Res<> del(Bytes key) {
-        try$(_wal->record(Wal::DEL, key, {}));
-        _memdb.del(Blob::from(key));
+    static Mime::Url _walUrl(Mime::Url const& url, usize seq) {
+        return url.parent(1) / Io::format("{}.{}.wal", url.basename(), seq);
+    }
+
+    static Mime::Url _segmentUrl(Mime::Url const& url, usize seq) {
+        return url.parent(1) / Io::format("{}.{}.seg", url.basename(), seq);
+    }
+
+    static Mime::Url _manifestUrl(Mime::Url const& url, usize slot) {
+        return url.parent(1) / Io::format("{}.manifest.{}", url.basename(), slot);
+    }
+
+    // MARK: Manifest ----------------------------------------------------------
+
+    static Opt<Buf<u8>> _readManifest(Mime::Url const& url) {
+        auto file = Sys::File::open(url);
+        if (not file)
+            return NONE;
+
+        Io::BufferWriter buf;
+        if (not Io::copy(file.unwrap(), buf))
+            return NONE;
+
+        auto bytes = buf.bytes();
+        if (bytes.len() < sizeof(RawManifest) + sizeof(u32le))
+            return NONE;
+
+        Io::BScan s{bytes};
+        RawManifest raw;
+        s.readTo(&raw);
+        if (raw.magic != RawManifest::MAGIC)
+            return NONE;
+
+        usize len = sizeof(RawManifest) + raw.count * sizeof(RawLevel);
+        if (bytes.len() != len + sizeof(u32le))
+            return NONE;
+
+        u32le crc;
+        s.skip(raw.count * sizeof(RawLevel));
+        s.readTo(&crc);
+        if (Crypto::crc32(sub(bytes, 0, len)) != crc)
+            return NONE;
+
+        return buf.take();
+    }
+
+    static Opt<Buf<u8>> _loadManifest(Mime::Url const& url) {
+        auto a = _readManifest(_manifestUrl(url, 0));
+        auto b = _readManifest(_manifestUrl(url, 1));
+        if (not a or not b)
+            return a ? a : b;
+
+        auto genOf = [](Buf<u8> const& m) {
+            return Io::BScan{m}.skip(sizeof(RawManifest::MAGIC)).nextU64le();
+        };
+        return genOf(*a) > genOf(*b) ? a : b;
+    }
+
+    Res<> _writeManifest() {
+        RawManifest raw;
+        raw.magic = RawManifest::MAGIC;
+        raw.gen = _gen + 1;
+        raw.walSeq = _walSeq;
+        raw.nextSeq = _nextSeq;
+        raw.count = _levels.len();
+
+        Io::BufferWriter buf;
+        Io::BEmit e{buf};
+        e.writeFrom(raw);
+        for (auto const& l : _levels) {
+            RawLevel level;
+            level.seq = l.seq;
+            level.tier = l.tier;
+            e.writeFrom(level);
+        }
+        e.writeU32le(Crypto::crc32(buf.bytes()));
+
+        auto file = try$(Sys::File::create(_manifestUrl(_url, raw.gen % 2)));
+        try$(file.write(buf.bytes()));
+        try$(file.sync());
+
+        _gen = raw.gen;
         return Ok();
     }
+
+    // MARK: Memtable ----------------------------------------------------------
+
+    static usize _sizeOf(Wal::Record const& r) {
+        return r.key.len() + r.value.len() + sizeof(Wal::Record);
+    }
+
+    void _apply(Wal::Record const& r) {
+        if (auto old = _memtable.tryGet(r.key))
+            _memtableSize -= _sizeOf(*old);
+        _memtable.put(r.key, r);
+        _memtableSize += _sizeOf(r);
+    }
+
+    void _apply(WriteBatch const& batch) {
+        for (Wal::Record const& r : batch.iter())
+            _apply(r);
+    }
+
+    Res<> _flushIfNeeded() {
+        if (_memtableSize >= _options.memtableSize)
+            return flush();
+        return Ok();
+    }
+
+    Vec<Wal::Record> _sortedMemtable() const {
+        Vec<Wal::Record> records;
+        records.ensure(_memtable.len());
+        for (auto const& [_, r] : _memtable.iter())
+            records.pushBack(r);
+        sort(records, [](Wal::Record const& a, Wal::Record const& b) {
+            return a.key <=> b.key;
+        });
+        return records;
+    }
+
+    static Generator<Res<Wal::Record>> _iterRecords(Vec<Wal::Record> records, Opt<Blob> from) {
+        for (auto& r : records) {
+            if (from and r.key.bytes() < from->bytes())
+                continue;
+            co_yield Ok(r);
+        }
+    }
+
+    // Write the memtable to a new segment and start a fresh log.
+    Res<> flush() {
+        if (_memtable.len() == 0)
+            return Ok();
+
+        auto records = _sortedMemtable();
+        usize seq = _nextSeq++;
+        auto writer = try$(SegmentWriter::create(_segmentUrl(_url, seq), records.len()));
+        for (auto const& r : records)
+            try$(writer.add(r));
+        try$(writer.finish());
+
+        auto segment = try$(Segment::open(_segmentUrl(_url, seq)));
+        usize walSeq = _nextSeq++;
+        auto wal = try$(Wal::open(_walUrl(_url, walSeq), _options.wal));
+
+        // NOTE: Writes keep going to the old log until the manifest points
+        //       to the new one, so none of them is lost if it can't be
+        //       written.
+        auto oldWal = _walSeq;
+        _levels.pushBack({seq, 0, segment});
+        _walSeq = walSeq;
+        if (auto res = _writeManifest(); not res) {
+            _levels.popBack();
+            _walSeq = oldWal;
+            (void)Sys::File::remove(_walUrl(_url, walSeq));
+            (void)Sys::File::remove(_segmentUrl(_url, seq));
+            return res;
+        }
+
+        _wal = wal;
+        (void)Sys::File::remove(_walUrl(_url, oldWal));
+
+        _memtable.clear();
+        _memtableSize = 0;
+
+        return _compact();
+    }
+
+    // MARK: Compaction --------------------------------------------------------
+
+    Res<> _writeMerged(usize start, usize end, usize seq) {
+        Vec<Generator<Res<Wal::Record>>> sources;
+        usize expected = 0;
+        for (usize i = end; i > start; i--) {
+            sources.pushBack(_levels[i - 1].segment->iter());
+            expected += _levels[i - 1].segment->len();
+        }
+
+        // Deletions only need to be kept as long as there are older
+        // segments they could be shadowing.
+        bool dropDeletions = start == 0;
+
+        auto writer = try$(SegmentWriter::create(_segmentUrl(_url, seq), expected));
+        auto merge = try$(_Merge::create(std::move(sources)));
+        while (auto r = try$(merge.next())) {
+            if (dropDeletions and r->type == Wal::DEL)
+                continue;
+            try$(writer.add(*r));
+        }
+        return writer.finish();
+    }
+
+    // Merge the levels in [start, end) into a single segment of `tier`.
+    Res<> _merge(usize start, usize end, usize tier) {
+        usize seq = _nextSeq++;
+
+        // NOTE: The levels are left untouched if one of them can't be read,
+        //       the half written segment isn't in the manifest yet.
+        if (auto res = _writeMerged(start, end, seq); not res) {
+            (void)Sys::File::remove(_segmentUrl(_url, seq));
+            return res;
+        }
+
+        Vec<usize> obsolete;
+        for (usize i = start; i < end; i++)
+            obsolete.pushBack(_levels[i].seq);
+
+        _levels.removeRange(start, end - start);
+        _levels.insert(start, {seq, tier, try$(Segment::open(_segmentUrl(_url, seq)))});
+        try$(_writeManifest());
+
+        for (auto s : obsolete)
+            (void)Sys::File::remove(_segmentUrl(_url, s));
+
+        return Ok();
+    }
+
+    Res<> _compact() {
+        auto width = max(_options.mergeWidth, 2uz);
+        while (_levels.len() >= width) {
+            usize end = _levels.len();
+            usize tier = _levels[end - 1].tier;
+
+            bool same = true;
+            for (usize i = end - width; i < end; i++)
+                same = same and _levels[i].tier == tier;
+            if (not same)
+                break;
+
+            try$(_merge(end - width, end, tier + 1));
+        }
+        return Ok();
+    }
+
+    // Merge every segment into one, regardless of their tiers.
+    Res<> compact() {
+        try$(flush());
+        if (_levels.len() <= 1)
+            return Ok();
+
+        usize tier = 0;
+        for (auto const& l : _levels)
+            tier = max(tier, l.tier);
+        return _merge(0, _levels.len(), tier);
+    }
+
+    // MARK: Public API --------------------------------------------------------
+
+    // Atomically apply every put and deletion of `batch`.
+    //
+    // NOTE: Fails with WOULD_BLOCK while a writeAsync() is being committed,
+    //       writers sharing a store with async ones should use writeAsync().
+    Res<> write(WriteBatch const& batch) {
+        try$(_wal->write(batch));
+        _apply(batch);
+        return _flushIfNeeded();
+    }
+
+    // Same as write(), but batches written concurrently are group committed
+    // to the log. The batch is visible to readers as soon as it is queued,
+    // and the task completes once it's durable.
+    Async::Task<> writeAsync(WriteBatch const& batch) {
+        // Keep the log alive, a flush may rotate it while we are waiting.
+        auto wal = _wal;
+        wal->append(batch);
+        _apply(batch);
+        co_trya$(wal->commitAsync());
+        co_return _flushIfNeeded();
+    }
+
+    Res<> put(Bytes key, Bytes value) {
+        WriteBatch batch;
+        batch.put(key, value);
+        return write(batch);
+    }
+
+    Res<> del(Bytes key) {
+        WriteBatch batch;
+        batch.del(key);
+        return write(batch);
+    }
+
+    Res<Opt<Blob>> get(Bytes key) {
+        auto r = _memtable.tryGet(Blob::from(key));
+        for (usize i = _levels.len(); i > 0 and not r; i--)
+            r = try$(_levels[i - 1].segment->lookup(key));
+
+        if (not r or r->type == Wal::DEL)
+            return Ok(NONE);
+        return Ok(r->value);
+    }
+
+    bool has(Bytes key) {
+        return get(key).unwrapOr(NONE).has();
+    }
+
+    // Iterate over the live key-value pairs in key order, in [from, until).
+    // A segment that can't be read ends the iteration with its error.
+    Generator<Res<Pair<Blob>>> iter(Opt<Blob> from = NONE, Opt<Blob> until = NONE) {
+        Vec<Generator<Res<Wal::Record>>> sources;
+        sources.pushBack(_iterRecords(_sortedMemtable(), from));
+
+        // Keep the segments alive, even if they get compacted away while
+        // we are iterating.
+        Vec<Rc<Segment>> segments;
+        for (usize i = _levels.len(); i > 0; i--) {
+            segments.pushBack(_levels[i - 1].segment);
+            sources.pushBack(segments[segments.len() - 1]->iter(from));
+        }
+
+        auto maybeMerge = _Merge::create(std::move(sources));
+        if (not maybeMerge) {
+            co_yield maybeMerge.none();
+            co_return;
+        }
+
+        auto merge = maybeMerge.take();
+        while (true) {
+            auto maybeRecord = merge.next();
+            if (not maybeRecord) {
+                co_yield maybeRecord.none();
+                co_return;
+            }
+
+            auto r = maybeRecord.take();
+            if (not r or (until and r->key.bytes() >= until->bytes()))
+                co_return;
+            if (r->type == Wal::DEL)
+                continue;
+            co_yield Ok(Pair<Blob>{r->key, r->value});
+        }
+    }
+
+    usize segments() const {
+        return _levels.len();
+    }
 };
 
 } // namespace Karm::Kv
@@ -0,0 +1,122 @@
+#include <karm-test/macros.h>
+
+import Karm.Kv;
+
+namespace Karm::Kv::Tests {
+
+static Res<bool> _holds(Store& store, Str key, Opt<Str> value) {
+    auto r = try$(store.get(bytes(key)));
+    if (not value)
+        return Ok(not r);
+    return Ok(r and r->bytes() == bytes(*value));
+}
+
+test$("karm-kv-store-flush") {
+    auto url = "file:./karm-kv-test-flush"_url;
+    try$(Store::destroy(url));
+    auto store = try$(Store::open(url));
+
+    try$(store->put(bytes("a"s), bytes("1"s)));
+    try$(store->put(bytes("b"s), bytes("2"s)));
+    try$(store->del(bytes("b"s)));
+    try$(store->flush());
+    expectEq$(store->segments(), 1uz);
+
+    expect$(try$(_holds(*store, "a", "1")));
+    expect$(try$(_holds(*store, "b", NONE)));
+
+    // Newer writes shadow the flushed ones
+    try$(store->put(bytes("a"s), bytes("3"s)));
+    try$(store->put(bytes("b"s), bytes("4"s)));
+    expect$(try$(_holds(*store, "a", "3")));
+    expect$(try$(_holds(*store, "b", "4")));
+
+    try$(store->del(bytes("a"s)));
+    try$(store->flush());
+    expect$(try$(_holds(*store, "a", NONE)));
+    expect$(try$(_holds(*store, "b", "4")));
+
+    return Store::destroy(url);
+}
+
+test$("karm-kv-store-overwrite-size") {
+    auto url = "file:./karm-kv-test-overwrite"_url;
+    try$(Store::destroy(url));
+    auto store = try$(Store::open(url, {.memtableSize = 1024}));
+
+    // Overwriting the same key doesn't grow the memtable
+    Array<u8, 100> value{};
+    for (usize i = 0; i < 100; i++)
+        try$(store->put(bytes("key"s), value));
+    expectEq$(store->segments(), 0uz);
+
+    return Store::destroy(url);
+}
+
+test$("karm-kv-store-compaction") {
+    auto url = "file:./karm-kv-test-compaction"_url;
+    try$(Store::destroy(url));
+    auto store = try$(Store::open(url, {.mergeWidth = 2}));
+
+    try$(store->put(bytes("a"s), bytes("1"s)));
+    try$(store->flush());
+    try$(store->put(bytes("b"s), bytes("2"s)));
+    try$(store->flush());
+
+    // Two segments of the same tier are merged right away
+    expectEq$(store->segments(), 1uz);
+    expect$(try$(_holds(*store, "a", "1")));
+    expect$(try$(_holds(*store, "b", "2")));
+
+    try$(store->del(bytes("a"s)));
+    try$(store->put(bytes("c"s), bytes("3"s)));
+    try$(store->compact());
+    expectEq$(store->segments(), 1uz);
+
+    Vec<String> keys;
+    for (auto r : store->iter()) {
+        auto pair = try$(r);
+        keys.pushBack(String{Str{reinterpret_cast<char const*>(pair.v0.bytes().buf()), pair.v0.bytes().len()}});
+    }
+    expectEq$(keys.len(), 2uz);
+    expectEq$(keys[0], "b"s);
+    expectEq$(keys[1], "c"s);
+
+    return Store::destroy(url);
+}
+
+test$("karm-kv-store-reopen") {
+    auto url = "file:./karm-kv-test-reopen"_url;
+    try$(Store::destroy(url));
+
+    {
+        auto store = try$(Store::open(url));
+        try$(store->put(bytes("a"s), bytes("1"s)));
+        try$(store->put(bytes("b"s), bytes("2"s)));
+        try$(store->flush());
+
+        // Only in the log
+        try$(store->put(bytes("c"s), bytes("3"s)));
+        try$(store->del(bytes("a"s)));
+    }
+
+    {
+        auto store = try$(Store::open(url));
+        expectEq$(store->segments(), 1uz);
+        expect$(try$(_holds(*store, "a", NONE)));
+        expect$(try$(_holds(*store, "b", "2")));
+        expect$(try$(_holds(*store, "c", "3")));
+        try$(store->flush());
+    }
+
+    {
+        auto store = try$(Store::open(url));
+        expect$(try$(_holds(*store, "a", NONE)));
+        expect$(try$(_holds(*store, "b", "2")));
+        expect$(try$(_holds(*store, "c", "3")));
+    }
+
+    return Store::destroy(url);
+}
+
+} // namespace Karm::Kv::Tests
@@ -0,0 +1,124 @@
+#include <karm-sys/file.h>
+#include <karm-test/macros.h>
+
+import Karm.Kv;
+
+namespace Karm::Kv::Tests {
+
+static String _str(Blob const& blob) {
+    return Str{reinterpret_cast<char const*>(blob.bytes().buf()), blob.bytes().len()};
+}
+
+static Vec<String> _replay(Wal& wal) {
+    Vec<String> keys;
+    for (auto const& r : wal.iter())
+        keys.pushBack(_str(r.key));
+    return keys;
+}
+
+static WriteBatch _batch(Slice<Str> keys, usize valueLen = 1) {
+    Vec<u8> value;
+    value.resize(valueLen, 'x');
+
+    WriteBatch batch;
+    for (auto key : keys)
+        batch.put(bytes(key), value);
+    return batch;
+}
+
+test$("karm-kv-wal-batch-replay") {
+    auto url = "file:./karm-kv-test-wal-batch.wal"_url;
+    (void)Sys::File::remove(url);
+
+    {
+        auto wal = try$(Wal::open(url));
+        try$(wal->write(_batch(Array<Str, 3>{"a", "b", "c"})));
+
+        // A complete batch with a corrupted op is dropped as a whole
+        wal->append(_batch(Array<Str, 2>{"d", "e"}));
+        auto pending = wal->_pending.take();
+        pending[pending.len() - 1] ^= 0xff;
+        try$(wal->_writeAll(pending));
+    }
+
+    {
+        auto wal = try$(Wal::open(url));
+        auto keys = _replay(*wal);
+        expectEq$(keys.len(), 3uz);
+        expectEq$(keys[0], "a"s);
+        expectEq$(keys[1], "b"s);
+        expectEq$(keys[2], "c"s);
+    }
+
+    return Sys::File::remove(url);
+}
+
+test$("karm-kv-wal-torn-batch") {
+    auto url = "file:./karm-kv-test-wal-torn.wal"_url;
+    (void)Sys::File::remove(url);
+
+    {
+        auto wal = try$(Wal::open(url));
+        try$(wal->write(_batch(Array<Str, 2>{"a", "b"})));
+
+        // Only the start of the batch made it to the file
+        wal->append(_batch(Array<Str, 2>{"c", "d"}, 256));
+        auto pending = wal->_pending.take();
+        try$(wal->_writeAll(sub(pending, 0, pending.len() / 2)));
+    }
+
+    {
+        auto wal = try$(Wal::open(url));
+        auto keys = _replay(*wal);
+        expectEq$(keys.len(), 2uz);
+
+        // Shorter than what's left of the torn batch
+        try$(wal->write(_batch(Array<Str, 1>{"e"})));
+    }
+
+    {
+        auto wal = try$(Wal::open(url));
+        auto keys = _replay(*wal);
+        expectEq$(keys.len(), 3uz);
+        expectEq$(keys[0], "a"s);
+        expectEq$(keys[1], "b"s);
+        expectEq$(keys[2], "e"s);
+    }
+
+    return Sys::File::remove(url);
+}
+
+Async::Task<> groupCommitAsync(Test::Driver& _driver) {
+    auto url = "file:./karm-kv-test-wal-group.wal"_url;
+    (void)Sys::File::remove(url);
+
+    auto wal = co_try$(Wal::open(url, {.sync = SyncPolicy::EVERY_BATCH}));
+
+    static constexpr usize WRITERS = 8;
+    for (usize i = 0; i < WRITERS; i++)
+        wal->append(_batch(Array<Str, 1>{"k"}));
+
+    usize done = 0;
+    for (usize i = 0; i < WRITERS - 1; i++) {
+        Async::detach(wal->commitAsync(), [&](Res<> res) {
+            if (res)
+                done++;
+        });
+    }
+    co_trya$(wal->commitAsync());
+
+    co_expectEq$(done, WRITERS - 1);
+    co_expectEq$(wal->_writes, 1uz);
+    co_expectEq$(wal->_syncs, 1uz);
+
+    auto keys = _replay(*wal);
+    co_expectEq$(keys.len(), WRITERS);
+
+    co_return Sys::File::remove(url);
+}
+
+testAsync$("karm-kv-wal-group-commit") {
+    return groupCommitAsync(_driver);
+}
+
+} // namespace Karm::Kv::Tests
@@ -1,8 +1,13 @@
 module;
 
+#include <karm-async/promise.h>
 #include <karm-crypto/crc32.h>
+#include <karm-io/bscan.h>
+#include <karm-io/impls.h>
 #include <karm-logger/logger.h>
+#include <karm-sys/async.h>
 #include <karm-sys/file.h>
+#include <karm-sys/time.h>
 
 export module Karm.Kv:wal;
 
@@ -10,6 +15,27 @@ import :blob;
 
 namespace Karm::Kv {
 
+export struct WriteBatch;
+
+export enum struct SyncPolicy : u8 {
+    EVERY_BATCH, //< Sync the log before a commit returns
+    INTERVAL,    //< Sync at most once every `WalOptions::interval`, needs an event loop to sync the tail of a burst
+    NEVER,       //< Leave it to the operating system
+};
+
+export struct WalOptions {
+    SyncPolicy sync = SyncPolicy::NEVER;
+    Duration interval = Duration::fromMSecs(100);
+};
+
+// Write-ahead log, a sequence of batches each framed by a header carrying
+// their length and checksum.
+//
+//     header | batch... (RawBatch | op...)
+//
+// A batch is written with a single write, and is either replayed as a whole
+// or not at all: replay stops at the first torn or corrupted batch, and the
+// next commit overwrites it.
 export struct Wal {
     struct Record {
         enum struct Type : u8 {
@@ -24,7 +50,7 @@ export struct Wal {
 
     struct [[gnu::packed]] RawHeader {
         static constexpr Array<u8, 8> MAGIC = {
-            'K', 'V', 'W', 'A', 'L', 0, 0, 0
+            'K', 'V', 'W', 'A', 'L', 0, 0, 1
         };
 
         Array<u8, 8> magic;
@@ -44,39 +70,54 @@ export struct Wal {
         }
     };
 
-    struct [[gnu::packed]] RawRecord {
-        Record::Type type;
-        Le<u64> keylen;
-        Le<u64> vallen;
-        Le<u32> crc;
+    struct [[gnu::packed]] RawBatch {
+        Le<u32> count;
+        Le<u32> len;
+        Le<u32> crc; // Of the ops
 
         Bytes bytes() const {
             return {
                 reinterpret_cast<u8 const*>(this),
-                sizeof(RawRecord),
+                sizeof(RawBatch),
             };
         }
 
         MutBytes mutBytes() {
             return {
                 reinterpret_cast<u8*>(this),
-                sizeof(RawRecord),
+                sizeof(RawBatch),
             };
         }
+    };
 
-        bool check() {
-            auto old = std::exchange(this->crc, 0);
-            auto crc = Crypto::crc32(this->bytes());
-            this->crc = old;
-            return old == crc;
-        }
+    struct [[gnu::packed]] RawOp {
+        Record::Type type;
+        Le<u32> keylen;
+        Le<u32> vallen;
     };
 
     Sys::File _file;
-    RawHeader _header;
+    WalOptions _options = {};
+    Instant _lastSync = Sys::instant();
+    Opt<Weak<Wal>> _self = NONE;
+
+    // Written since the last sync, and whether a deferred sync is armed,
+    // see _syncIfNeeded()
+    bool _dirty = false;
+    bool _syncScheduled = false;
+
+    // Batches appended but not yet written, see commitAsync()
+    Io::BufferWriter _pending = {};
+    Vec<Async::Promise<>> _waiters = {};
+    bool _committing = false;
+
+    // Commits that wrote to the file, and syncs, for tests and benchmarks
+    usize _writes = 0;
+    usize _syncs = 0;
+
     using enum Record::Type;
 
-    static Res<Rc<Wal>> open(Mime::Url const& url) {
+    static Res<Rc<Wal>> open(Mime::Url const& url, WalOptions options = {}) {
         if (Sys::isFile(url)) {
             auto file = try$(Sys::File::openOrCreate(url));
             RawHeader header;
@@ -85,75 +126,279 @@ export struct Wal {
                 return Error::invalidData("invalid wal file");
 
             try$(file.seek(Io::Seek::fromEnd(0)));
-            return Ok(makeRc<Wal>(std::move(file), header));
+            return Ok(_make(std::move(file), options));
         }
 
         auto file = try$(Sys::File::openOrCreate(url));
         RawHeader header = {RawHeader::MAGIC};
         try$(file.write(header.bytes()));
-        return Ok(makeRc<Wal>(std::move(file)));
+        try$(file.sync());
+        return Ok(_make(std::move(file), options));
     }
 
-    Res<> record(Record::Type type, Bytes key, Bytes value) {
-        RawRecord record = {};
-        record.type = type;
-        record.keylen = key.len();
-        record.vallen = value.len();
+    static Rc<Wal> _make(Sys::File file, WalOptions options) {
+        auto wal = makeRc<Wal>(std::move(file), options);
+        wal->_self = Weak<Wal>{wal};
+        return wal;
+    }
 
-        record.crc = 0;
-        record.crc = Crypto::crc32(record.bytes());
+    // MARK: Writing -----------------------------------------------------------
 
-        try$(_file.write(record.bytes()));
+    // Queue a batch to be written by the next commit.
+    void append(WriteBatch const& batch);
 
-        try$(_file.write(key));
-        try$(_file.write(value));
+    Res<> _writeAll(Bytes bytes) {
+        while (bytes.len()) {
+            auto written = try$(_file.write(bytes));
+            if (written == 0)
+                return Error::writeZero();
+            bytes = next(bytes, written);
+        }
+        return Ok();
+    }
 
-        Crypto::Crc32 crc = {};
-        crc.update(key);
-        crc.update(value);
-        try$(_file.write({reinterpret_cast<u8 const*>(&crc), sizeof(crc)}));
+    // Wait for the end of the interval and sync whatever was written in
+    // the meantime, so the last batches of a burst don't stay unsynced
+    // until the next write.
+    //
+    // NOTE: Only holds a weak reference, the store may rotate the log while
+    //       we are sleeping.
+    static Async::Task<> _syncLaterAsync(Weak<Wal> self, Instant until) {
+        co_trya$(Sys::globalSched().sleepAsync(until));
+        auto maybeWal = self.upgrade();
+        if (not maybeWal)
+            co_return Ok();
+        auto wal = maybeWal.take();
+        wal->_syncScheduled = false;
+        if (not wal->_dirty)
+            co_return Ok();
+        co_return wal->sync();
+    }
 
-        return Ok();
+    Res<> _syncIfNeeded() {
+        _dirty = true;
+        switch (_options.sync) {
+        case SyncPolicy::EVERY_BATCH:
+            break;
+
+        case SyncPolicy::INTERVAL:
+            if (Sys::instant() - _lastSync < _options.interval) {
+                if (not _syncScheduled and _self) {
+                    _syncScheduled = true;
+                    Async::detach(_syncLaterAsync(*_self, _lastSync + _options.interval), [](Res<> res) {
+                        if (not res)
+                            logError("wal: deferred sync failed: {}", res.none());
+                    });
+                }
+                return Ok();
+            }
+            break;
+
+        case SyncPolicy::NEVER:
+            return Ok();
+        }
+
+        return sync();
     }
 
+    // Write every batch appended so far, and sync them according to the
+    // sync policy.
+    //
+    // NOTE: Refuses to run while a commitAsync() is in flight, it would
+    //       steal the batches of its waiters and interleave its writes
+    //       with theirs.
+    Res<> commit() {
+        if (_committing)
+            return Error::wouldBlock("wal: async commit in flight");
+        if (_pending.bytes().len() == 0)
+            return Ok();
+        auto pending = _pending.take();
+        _writes++;
+        try$(_writeAll(pending));
+        return _syncIfNeeded();
+    }
+
+    Res<> write(WriteBatch const& batch) {
+        if (_committing)
+            return Error::wouldBlock("wal: async commit in flight");
+        append(batch);
+        return commit();
+    }
+
+    Res<> record(Record::Type type, Bytes key, Bytes value);
+
+    // Group commit: if a commit is already in flight, wait for it to
+    // complete and let the next one write our batches together with those
+    // of every other writer that showed up in the meantime, so they all
+    // share a single write and sync.
+    Async::Task<> commitAsync() {
+        Async::Promise<> promise;
+        auto future = promise.future();
+        _waiters.pushBack(std::move(promise));
+        if (_committing)
+            co_return co_await future;
+
+        _committing = true;
+        while (_waiters.len()) {
+            auto pending = _pending.take();
+            auto waiters = std::move(_waiters);
+
+            // NOTE: The batches of late waiters might already have been
+            //       written, and synced, by the previous round.
+            Res<> res = Ok();
+            Bytes bytes = pending;
+            if (bytes.len())
+                _writes++;
+            while (res and bytes.len()) {
+                auto written = co_await _file.writeAsync(bytes);
+                if (written and written.unwrap() == 0)
+                    written = Error::writeZero();
+                if (not written)
+                    res = written.none();
+                else
+                    bytes = next(bytes, written.unwrap());
+            }
+
+            if (res and pending.len())
+                res = _syncIfNeeded();
+
+            for (auto& w : waiters)
+                w.resolve(res);
+        }
+        _committing = false;
+
+        co_return co_await future;
+    }
+
+    // Force everything written so far to disk, regardless of the policy.
+    Res<> sync() {
+        _lastSync = Sys::instant();
+        _dirty = false;
+        _syncs++;
+        return _file.sync();
+    }
+
+    // MARK: Replay ------------------------------------------------------------
+
+    static Opt<Record> _next(Blob const& ops, Io::BScan& s) {
+        RawOp raw;
+        if (s.rem() < sizeof(RawOp))
+            return NONE;
+        s.readTo(&raw);
+        usize off = s.tell();
+        if (off + raw.keylen + raw.vallen > ops.len())
+            return NONE;
+        s.skip(raw.keylen + raw.vallen);
+        return Record{
+            .type = raw.type,
+            .key = ops.slice({off, raw.keylen}),
+            .value = ops.slice({off + raw.keylen, raw.vallen}),
+        };
+    }
+
+    // Replay the records of every complete batch, leaving the log positioned
+    // right after the last of them.
     Generator<Record> iter() {
+        usize end = sizeof(RawHeader);
+
         // FIXME: Handle errors properly
-        _file.seek(Io::Seek::fromBegin(sizeof(RawHeader))).unwrap("could not seek");
+        _file.seek(Io::Seek::fromBegin(end)).unwrap("could not seek");
 
         while (true) {
-            RawRecord record;
-            auto res = _file.read(record.mutBytes());
-            if (res.unwrapOr(0) == 0)
-                co_return;
-
-            if (not record.check()) {
-                panic("invalid crc for record");
-                co_return;
-            }
+            RawBatch batch;
+            if (_file.read(batch.mutBytes()).unwrapOr(0) != sizeof(RawBatch))
+                break;
 
-            auto key = MutBlob::alloc(record.keylen);
-            _file.read(key.mutBytes()).unwrap("could not read key");
-            auto value = MutBlob::alloc(record.vallen);
-            _file.read(value.mutBytes()).unwrap("could not read value");
+            auto ops = MutBlob::alloc(batch.len);
+            if (_file.read(ops.mutBytes()).unwrapOr(0) != batch.len)
+                break;
 
-            u32le crc;
-            _file.read({reinterpret_cast<u8*>(&crc), sizeof(crc)}).unwrap("could not read crc");
+            if (Crypto::crc32(ops.bytes()) != batch.crc) {
+                logWarn("wal: ignoring corrupted batch at {}", end);
+                break;
+            }
 
-            Crypto::Crc32 c;
-            c.update(key.bytes());
-            c.update(value.bytes());
+            end += sizeof(RawBatch) + batch.len;
 
-            if (crc != c.digest()) {
-                logError("invalid crc for key/value");
+            Io::BScan s{ops.bytes()};
+            for (usize i = 0; i < batch.count; i++) {
+                auto r = _next(ops, s);
+                if (not r)
+                    break;
+                co_yield r.take();
             }
+        }
 
-            co_yield Record{
-                .type = record.type,
-                .key = key,
-                .value = value,
-            };
+        _file.seek(Io::Seek::fromBegin(end)).unwrap("could not seek");
+    }
+};
+
+// A group of puts and deletions written to the log, and applied, atomically.
+export struct WriteBatch {
+    Io::BufferWriter _ops;
+    usize _count = 0;
+
+    void _add(Wal::Record::Type type, Bytes key, Bytes value) {
+        Wal::RawOp raw;
+        raw.type = type;
+        raw.keylen = key.len();
+        raw.vallen = value.len();
+
+        Io::BEmit e{_ops};
+        e.writeFrom(raw);
+        (void)_ops.write(key);
+        (void)_ops.write(value);
+        _count++;
+    }
+
+    void put(Bytes key, Bytes value) {
+        _add(Wal::PUT, key, value);
+    }
+
+    void del(Bytes key) {
+        _add(Wal::DEL, key, {});
+    }
+
+    usize len() const {
+        return _count;
+    }
+
+    Bytes bytes() const {
+        return _ops.bytes();
+    }
+
+    void clear() {
+        _ops.clear();
+        _count = 0;
+    }
+
+    Generator<Wal::Record> iter() const {
+        auto ops = Blob::from(bytes());
+        Io::BScan s{ops.bytes()};
+        while (true) {
+            auto r = Wal::_next(ops, s);
+            if (not r)
+                break;
+            co_yield r.take();
         }
     }
 };
 
+void Wal::append(WriteBatch const& batch) {
+    RawBatch raw;
+    raw.count = batch.len();
+    raw.len = batch.bytes().len();
+    raw.crc = Crypto::crc32(batch.bytes());
+
+    Io::BEmit e{_pending};
+    e.writeFrom(raw);
+    (void)_pending.write(batch.bytes());
+}
+
+Res<> Wal::record(Record::Type type, Bytes key, Bytes value) {
+    WriteBatch batch;
+    batch._add(type, key, value);
+    return write(batch);
+}
+
 } // namespace Karm::Kv
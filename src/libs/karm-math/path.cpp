@@ -49,21 +49,38 @@ void Path::_flattenLineTo(Math::Vec2f p) {
     last(_contours).end++;
 }
 
-void Path::_flattenCurveTo(Math::Curvef curve, isize depth) {
-    if (depth > 16)
-        return;
+void Path::tolerance(f64 tolerance) {
+    _tolerance = max(tolerance, Limits<f64>::EPSILON);
+}
 
-    if (curve.degenerated())
-        return;
+isize Path::arcSegments(f64 radius, f64 angle, f64 tolerance) {
+    radius = Math::abs(radius);
+    if (radius <= tolerance)
+        return 1;
+
+    // The sagitta of a chord over `step` radians must stay under the
+    // tolerance, so cos(step / 2) >= 1 - t. 2 * sin(step / 2) is used as
+    // the step, it's a bit smaller, which errs on the side of more segments.
+    f64 t = tolerance / radius;
+    f64 step = 2 * Math::sqrt(2 * t - t * t);
+    return clamp(Math::ceili(Math::abs(angle) / step), 1, MAX_SEGMENTS);
+}
 
-    if (curve.straightish(0.25)) {
-        _flattenLineTo(curve.d);
+void Path::_flattenCurveTo(Math::Curvef curve) {
+    if (curve.degenerated())
         return;
-    }
 
-    auto [left, right] = curve.split();
-    _flattenCurveTo(left, depth + 1);
-    _flattenCurveTo(right, depth + 1);
+    // Wang's formula, the number of uniform steps for the segments to stay
+    // within the tolerance of the curve.
+    f64 dd = max(
+        (curve.a - curve.b * 2 + curve.c).len(),
+        (curve.b - curve.c * 2 + curve.d).len()
+    );
+    isize n = clamp(Math::ceili(Math::sqrt(0.75 * dd / _tolerance)), 1, MAX_SEGMENTS);
+
+    for (isize i = 1; i < n; i++)
+        _flattenLineTo(curve.eval(i / (f64)n));
+    _flattenLineTo(curve.d);
 }
 
 void Path::_flattenArcTo(Math::Vec2f start, Math::Vec2f radii, f64 angle, Flags flags, Math::Vec2f point) {
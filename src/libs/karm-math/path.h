@@ -105,11 +105,26 @@ struct Path {
 
     // MARK: Flattening --------------------------------------------------------
 
+    // The default flattening tolerance, a quarter of a pixel.
+    static constexpr f64 TOLERANCE = 0.25;
+
+    static constexpr isize MAX_SEGMENTS = 1024;
+
+    // Curves are split in just enough segments to never be further than
+    // this from them, in path units.
+    f64 _tolerance = TOLERANCE;
+
+    // Set the flattening tolerance for the curves added from now on.
+    void tolerance(f64 tolerance);
+
+    // Number of segments needed to flatten an arc of `radius` over `angle`.
+    static isize arcSegments(f64 radius, f64 angle, f64 tolerance);
+
     void _flattenClose();
 
     void _flattenLineTo(Math::Vec2f p);
 
-    void _flattenCurveTo(Math::Curvef c, isize depth = 0);
+    void _flattenCurveTo(Math::Curvef c);
 
     void _flattenArcTo(Math::Vec2f start, Math::Vec2f radii, f64 angle, Flags flags, Math::Vec2f point);
 
@@ -0,0 +1,70 @@
+#include <karm-test/macros.h>
+
+#include "karm-math/path.h"
+
+namespace Karm::Math::Tests {
+
+// The largest distance between the middle of the flattened segments and
+// the curve they approximate.
+static f64 _flattenError(Path const& path, Curvef curve) {
+    f64 err = 0;
+    for (usize i = 0; i + 1 < path._verts.len(); i++) {
+        auto mid = (path._verts[i] + path._verts[i + 1]) / 2;
+        f64 dist = Limits<f64>::MAX;
+        for (usize j = 0; j <= 1 << 16; j++)
+            dist = min(dist, (curve.eval(j / (f64)(1 << 16)) - mid).len());
+        err = max(err, dist);
+    }
+    return err;
+}
+
+static Path _flatten(Curvef curve, f64 tolerance) {
+    Path path;
+    path.tolerance(tolerance);
+    path.moveTo(curve.a);
+    path.cubicTo(curve.b, curve.c, curve.d);
+    return path;
+}
+
+test$("path-flatten-tolerance") {
+    for (f64 size : {5.0, 50.0, 500.0}) {
+        auto curve = Curvef::cubic(
+            {0, 0},
+            {size, size * 2},
+            {size * 2, -size},
+            {size * 3, 0}
+        );
+
+        auto fine = _flatten(curve, Path::TOLERANCE);
+        expect$(_flattenError(fine, curve) <= Path::TOLERANCE);
+
+        auto coarse = _flatten(curve, 2);
+        expect$(_flattenError(coarse, curve) <= 2);
+        expect$(coarse._verts.len() <= fine._verts.len());
+    }
+
+    // Bigger curves need more segments.
+    expect$(
+        _flatten(Curvef::cubic({0, 0}, {10, 20}, {20, -10}, {30, 0}), 0.25)._verts.len() <
+        _flatten(Curvef::cubic({0, 0}, {100, 200}, {200, -100}, {300, 0}), 0.25)._verts.len()
+    );
+
+    return Ok();
+}
+
+test$("path-arc-segments") {
+    expectEq$(Path::arcSegments(0.1, Math::PI, 0.25), 1);
+    expectEq$(Path::arcSegments(100, 0, 0.25), 1);
+
+    // Bigger arcs need more segments...
+    expect$(Path::arcSegments(10, Math::PI, 0.25) < Path::arcSegments(100, Math::PI, 0.25));
+
+    // ...and so do tighter tolerances.
+    expect$(Path::arcSegments(100, Math::PI, 1) < Path::arcSegments(100, Math::PI, 0.25));
+
+    expectEq$(Path::arcSegments(1e9, Math::PI, 0.25), Path::MAX_SEGMENTS);
+
+    return Ok();
+}
+
+} // namespace Karm::Math::Tests
@@ -26,6 +26,10 @@ void Canvas::strokeStyle(Gfx::Stroke) {
     logDebugIf(DEBUG_CANVAS, "pdf: strokeStyle() operation not implemented");
 }
 
+void Canvas::tolerance(f64 tolerance) {
+    _e.ln("{} i", clamp(tolerance, 0, 100));
+}
+
 void Canvas::transform(Math::Trans2f trans) {
     _e.ln("{} {} {} {} {} {} cm", trans.xx, trans.xy, trans.yx, trans.yy, trans.ox, trans.oy);
 }
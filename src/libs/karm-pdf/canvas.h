@@ -55,6 +55,8 @@ struct Canvas : public Gfx::Canvas {
 
     void strokeStyle(Gfx::Stroke) override;
 
+    void tolerance(f64 tolerance) override;
+
     void transform(Math::Trans2f trans) override;
 
     // MARK: Path Operations ---------------------------------------------------
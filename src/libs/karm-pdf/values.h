@@ -17,6 +17,10 @@ struct Ref {
 
     bool operator==(Ref const& other) const = default;
     auto operator<=>(Ref const& other) const = default;
+
+    Hash hash() const {
+        return hashCombine(Karm::hash(num), Karm::hash(gen));
+    }
 };
 
 struct Name : public String {
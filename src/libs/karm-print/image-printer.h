@@ -21,9 +21,11 @@ struct ImagePrinter : public FilePrinter {
     Gfx::Canvas& beginPage(PaperStock paper) override {
         _pages.emplaceBack(Gfx::Surface::alloc(paper.size().cast<isize>() * _density, Gfx::RGBA8888));
 
+        // NOTE: The canvas is reused, so are the glyphs it cached.
         if (_canvas)
             _canvas->end();
-        _canvas = Gfx::CpuCanvas{};
+        else
+            _canvas = Gfx::CpuCanvas{};
         _canvas->begin(*last(_pages));
         _canvas->scale(_density);
         _canvas->clear(Gfx::WHITE);
@@ -169,7 +169,7 @@ static inline Async::Task<Message> rpcRecvAsync(Sys::IpcConnection& con) {
 
 struct Endpoint : Meta::Pinned {
     Sys::IpcConnection _con;
-    Map<u64, Async::_Promise<Message>> _pending{};
+    HashMap<u64, Async::_Promise<Message>> _pending{};
     Async::Queue<Message> _incoming{};
     u64 _seq = 1;
 
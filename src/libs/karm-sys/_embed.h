@@ -32,6 +32,8 @@ Res<Rc<Sys::Fd>> createFile(Mime::Url const& url);
 
 Res<Rc<Sys::Fd>> openOrCreateFile(Mime::Url const& url);
 
+Res<> removeFile(Mime::Url const& url);
+
 Res<Pair<Rc<Sys::Fd>, Rc<Sys::Fd>>> createPipe();
 
 Res<Rc<Sys::Fd>> createIn();
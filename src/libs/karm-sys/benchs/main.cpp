@@ -0,0 +1,102 @@
+// Echo throughput over loopback TCP.
+//
+// Measures whichever async backend the binary was built with, build it with
+// `--props=async:epoll` and `--props=async:uring` to compare them.
+
+#include <karm-async/promise.h>
+#include <karm-async/run.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/socket.h>
+#include <karm-sys/time.h>
+
+static constexpr u16 PORT = 4567;
+static constexpr usize CONNECTIONS = 64;
+static constexpr usize MESSAGES = 10'000; // Per connection
+static constexpr usize MESSAGE_SIZE = 64;
+
+static Async::Task<> _writeAllAsync(Sys::TcpConnection& conn, Bytes buf) {
+    while (buf.len()) {
+        auto n = co_trya$(conn.writeAsync(buf));
+        buf = next(buf, n);
+    }
+    co_return Ok();
+}
+
+static Async::Task<> _serveAsync(Sys::TcpConnection conn) {
+    Array<u8, 4096> buf{};
+    while (true) {
+        auto n = co_trya$(conn.readAsync(buf));
+        if (n == 0)
+            co_return Ok();
+        co_trya$(_writeAllAsync(conn, sub(buf, 0, n)));
+    }
+}
+
+static Async::Task<> _listenAsync(Sys::TcpListener& listener) {
+    while (true) {
+        auto conn = co_trya$(listener.acceptAsync());
+        Async::detach(_serveAsync(std::move(conn)), [](Res<> res) {
+            if (not res)
+                logError("echo connection failed: {}", res);
+        });
+    }
+}
+
+// Sends messages one at a time and waits for each of them to come back.
+static Async::Task<> _clientAsync() {
+    auto conn = co_try$(Sys::TcpConnection::connect(Sys::Ip4::localhost(PORT)));
+
+    Array<u8, MESSAGE_SIZE> msg{};
+    Array<u8, MESSAGE_SIZE> echo{};
+    for (usize i = 0; i < MESSAGES; i++) {
+        msg[0] = i & 0xff;
+        co_trya$(_writeAllAsync(conn, msg));
+
+        usize received = 0;
+        while (received < MESSAGE_SIZE) {
+            auto n = co_trya$(conn.readAsync(mutNext(echo, received)));
+            if (n == 0)
+                co_return Error::unexpectedEof("connection closed");
+            received += n;
+        }
+
+        if (echo[0] != msg[0])
+            co_return Error::other("echo mismatch");
+    }
+
+    co_return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    auto listener = co_try$(Sys::TcpListener::listen(Sys::Ip4::localhost(PORT)));
+    Async::detach(_listenAsync(listener), [](Res<> res) {
+        if (not res)
+            logError("listener failed: {}", res);
+    });
+
+    Async::Promise<> done;
+    auto future = done.future();
+    usize remaining = CONNECTIONS;
+    Res<> result = Ok();
+
+    auto start = Sys::now();
+    for (usize i = 0; i < CONNECTIONS; i++) {
+        Async::detach(_clientAsync(), [&](Res<> res) {
+            if (not res)
+                result = res;
+            if (--remaining == 0)
+                done.resolve(Ok());
+        });
+    }
+    co_trya$(future);
+    auto elapsed = Sys::now() - start;
+    co_try$(result);
+
+    usize messages = CONNECTIONS * MESSAGES;
+    f64 secs = elapsed.toUSecs() / 1e6;
+    Sys::println("connections: {}, messages: {} of {} bytes", CONNECTIONS, messages, MESSAGE_SIZE);
+    Sys::println("elapsed: {}", elapsed);
+    Sys::println("throughput: {} msg/s, {} MiB/s", (usize)(messages / secs), (messages * MESSAGE_SIZE * 2) / secs / (1024 * 1024));
+
+    co_return Ok();
+}
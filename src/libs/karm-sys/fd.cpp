@@ -24,6 +24,10 @@ Res<> NullFd::flush() {
     return Ok();
 }
 
+Res<> NullFd::sync() {
+    return Ok();
+}
+
 Res<Rc<Fd>> NullFd::dup() {
     return Ok(makeRc<NullFd>());
 }
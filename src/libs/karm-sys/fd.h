@@ -32,6 +32,9 @@ struct Fd : Meta::NoCopy {
 
     virtual Res<> flush() = 0;
 
+    // Make sure everything written so far reached the underlying storage.
+    virtual Res<> sync() = 0;
+
     virtual Res<Rc<Fd>> dup() = 0;
 
     virtual Res<_Accepted> accept() = 0;
@@ -60,6 +63,8 @@ struct NullFd : public Fd {
 
     Res<> flush() override;
 
+    Res<> sync() override;
+
     Res<Rc<Fd>> dup() override;
 
     Res<_Accepted> accept() override;
@@ -23,4 +23,9 @@ Res<File> File::openOrCreate(Mime::Url url) {
     return Ok(File{fd, url});
 }
 
+Res<> File::remove(Mime::Url url) {
+    try$(ensureUnrestricted());
+    return _Embed::removeFile(url);
+}
+
 } // namespace Karm::Sys
@@ -33,6 +33,10 @@ struct _File :
         return sched.flushAsync(_fd);
     }
 
+    Res<> sync() {
+        return _fd->sync();
+    }
+
     Res<Stat> stat() {
         return _fd->stat();
     }
@@ -84,6 +88,8 @@ struct File :
     static Res<FileReader> open(Mime::Url url);
 
     static Res<File> openOrCreate(Mime::Url url);
+
+    static Res<> remove(Mime::Url url);
 };
 
 /// Read the entire file as a UTF-8 string.
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <karm-base/array.h>
 #include <karm-base/checked.h>
 #include <karm-base/distinct.h>
+#include <karm-base/hash.h>
 #include <karm-base/string.h>
 #include <karm-io/emit.h>
 
@@ -20,6 +22,10 @@ struct Glyph {
     bool operator==(Glyph const& other) const = default;
 
     auto operator<=>(Glyph const& other) const = default;
+
+    Hash hash() const {
+        return hashCombine(Karm::hash(index), Karm::hash(font));
+    }
 };
 
 constexpr Glyph Glyph::TOFU{0, 0};
@@ -255,6 +261,22 @@ struct Family : _Family {
     }
 };
 
+// MARK: FontCoverage ----------------------------------------------------------
+
+// The Unicode blocks a font claims to cover, as the ulUnicodeRange bits of
+// its OS/2 table. It's only a summary, the cmap has the final word.
+struct FontCoverage {
+    Array<u32, 4> bits = {};
+
+    bool has(usize block) const {
+        if (block >= 128)
+            return false;
+        return bits[block / 32] & (1u << (block % 32));
+    }
+
+    bool operator==(FontCoverage const& other) const = default;
+};
+
 // MARK: FontAttrs -------------------------------------------------------------
 
 struct FontAttrs {
@@ -263,6 +285,7 @@ struct FontAttrs {
     FontStretch stretch = FontStretch::NORMAL;
     FontStyle style = FontStyle::NORMAL;
     Monospace monospace = Monospace::NO;
+    FontCoverage coverage = {};
 
     void repr(Io::Emit& e) const {
         e.ln("family: {#}", family);
@@ -1,14 +1,44 @@
 #include <karm-logger/logger.h>
 #include <karm-pkg/bundle.h>
+#include <karm-sys/stat.h>
 #include <karm-sys/time.h>
 
 #include "book.h"
+#include "index.h"
 #include "loader.h"
 
 namespace Karm::Text {
 
 // MARK: Font loading ----------------------------------------------------------
 
+Opt<Rc<Fontface>> FontInfo::load() const {
+    if (face or broken)
+        return face;
+
+    auto maybeFace = loadFontface(url);
+    if (not maybeFace) {
+        logWarn("could not load {}: {}", url, maybeFace.none());
+        broken = true;
+        return NONE;
+    }
+
+    face = maybeFace.take();
+    return face;
+}
+
+void FontBook::add(FontInfo info) {
+    auto& store = _store.cow();
+
+    usize index = store.faces.len();
+    if (auto indices = store.families.access(info.attrs.family))
+        indices->pushBack(index);
+    else
+        store.families.put(info.attrs.family, {index});
+
+    store.faces.pushBack(std::move(info));
+    store.matches.clear();
+}
+
 Res<> FontBook::load(Mime::Url const& url, Opt<FontAttrs> attrs) {
     auto maybeFace = loadFontface(url);
     if (not maybeFace)
@@ -26,6 +56,22 @@ Res<> FontBook::load(Mime::Url const& url, Opt<FontAttrs> attrs) {
 }
 
 Res<> FontBook::loadAll() {
+    return loadAll("location://home/.cache/karm-fonts.idx"_url);
+}
+
+Res<> FontBook::loadAll(Mime::Url const& indexUrl) {
+    // NOTE: The index is only a cache, fonts that are missing from it or
+    //       that changed since are parsed and the index written back.
+    FontIndex index;
+    if (auto maybeIndex = FontIndex::load(indexUrl))
+        index = maybeIndex.take();
+
+    Map<String, usize> indexed;
+    for (usize i = 0; i < index.entries.len(); i++)
+        indexed.put(index.entries[i].url.str(), i);
+
+    FontIndex fresh;
+    bool dirty = false;
 
     auto bundles = try$(Pkg::installedBundles());
     for (auto& bundle : bundles) {
@@ -41,12 +87,49 @@ Res<> FontBook::loadAll() {
 
             auto fontUrl = dir.path() / diren.name;
 
+            auto maybeStat = Sys::stat(fontUrl);
+            if (not maybeStat) {
+                logWarn("could not stat {}: {}", fontUrl, maybeStat.none());
+                continue;
+            }
+
+            auto stat = maybeStat.take();
+
+            if (auto i = indexed.tryGet(fontUrl.str())) {
+                auto& entry = index.entries[*i];
+                if (entry.size == stat.size and entry.modified == stat.modifyTime) {
+                    add({
+                        .url = fontUrl,
+                        .attrs = entry.attrs,
+                    });
+                    fresh.entries.pushBack(entry);
+                    continue;
+                }
+            }
+
+            dirty = true;
+
             auto res = load(fontUrl);
-            if (not res)
+            if (not res) {
                 logWarn("could not load {}: {}", fontUrl, res);
+                continue;
+            }
+
+            fresh.entries.pushBack({
+                .url = fontUrl,
+                .size = stat.size,
+                .modified = stat.modifyTime,
+                .attrs = _store->faces[_store->faces.len() - 1].attrs,
+            });
         }
     }
 
+    if (dirty or fresh.entries.len() != index.entries.len()) {
+        auto res = fresh.save(indexUrl);
+        if (not res)
+            logWarn("could not save font index to {}: {}", indexUrl, res);
+    }
+
     auto ibmVga = Fontface::fallback();
 
     add({
@@ -96,10 +179,10 @@ Str commonFamily(Str lhs, Str rhs) {
 
 Vec<String> FontBook::families() const {
     Vec<String> families;
-    for (auto& info : _faces) {
+    for (auto& [name, _] : _store->families.iter()) {
         bool found = false;
         for (auto& f : families) {
-            auto prefix = commonFamily(f, info.attrs.family);
+            auto prefix = commonFamily(f, name);
             if (prefix) {
                 found = true;
                 f = prefix;
@@ -108,7 +191,7 @@ Vec<String> FontBook::families() const {
         }
 
         if (not found)
-            families.pushBack(info.attrs.family);
+            families.pushBack(name);
     }
 
     sort(families);
@@ -118,22 +201,6 @@ Vec<String> FontBook::families() const {
 // MARK: Font Matching ---------------------------------------------------------
 // https://www.w3.org/TR/css-fonts-3/#font-matching-algorithm
 
-Str _pickFamily(Str curr, Str best, Str desired) {
-    if (curr == desired)
-        return curr;
-
-    if (best == desired)
-        return best;
-
-    auto currPrefix = commonFamily(curr, desired);
-    auto bestPrefix = commonFamily(best, desired);
-
-    if (currPrefix.len() > bestPrefix.len())
-        return curr;
-
-    return best;
-}
-
 FontStretch _pickFontStretch(FontStretch curr, FontStretch best, FontStretch desired) {
     if (best == FontStretch::NO_MATCH)
         return curr;
@@ -217,49 +284,65 @@ Str FontBook::_resolveFamily(Family const& family) const {
 }
 
 Opt<Rc<Fontface>> FontBook::queryExact(FontQuery query) const {
-    auto family = _resolveFamily(query.family);
+    auto indices = _store->families.access(_resolveFamily(query.family));
+    if (not indices)
+        return NONE;
 
-    for (auto& info : _faces) {
+    for (auto i : *indices) {
+        auto& info = _store->faces[i];
         auto& attrs = info.attrs;
 
-        if (attrs.family == family and
-            attrs.weight == query.weight and
+        if (attrs.weight == query.weight and
             attrs.stretch == query.stretch and
-            attrs.style == query.style)
-            return info.face;
+            attrs.style == query.style) {
+            if (auto face = info.load())
+                return face;
+        }
     }
 
     return NONE;
 }
 
-Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
-    Str desiredfamily = _resolveFamily(query.family);
+// The family to pick faces from, the one asked for if the book has it,
+// otherwise the first one sharing the most words with it.
+static Opt<Str> _closestFamily(Map<String, Vec<usize>> const& families, Str desired) {
+    if (families.has(desired))
+        return desired;
+
+    Opt<Str> best = NONE;
+    usize bestLen = 0;
+    for (auto& [name, _] : families.iter()) {
+        auto prefix = commonFamily(name, desired);
+        if (prefix.len() > bestLen) {
+            best = name.str();
+            bestLen = prefix.len();
+        }
+    }
+
+    return best;
+}
+
+Opt<usize> FontBook::_matchClosest(Str desiredFamily, FontQuery const& query) const {
+    auto family = _closestFamily(_store->families, desiredFamily);
+    if (not family)
+        return NONE;
 
-    Opt<Rc<Fontface>> matchingFace;
-    auto matchingFamily = ""s;
+    Opt<usize> matchingFace;
     auto matchingStretch = FontStretch::NO_MATCH;
     auto matchingStyle = FontStyle::NO_MATCH;
     auto matchingWeight = FontWeight::NO_MATCH;
 
-    for (auto& info : _faces) {
+    for (auto i : _store->families.get(*family)) {
+        auto const& info = _store->faces[i];
+        if (info.broken)
+            continue;
+
         auto const& attrs = info.attrs;
 
-        auto currFamily = matchingFamily;
         auto currStretch = matchingStretch;
         auto currStyle = matchingStyle;
         auto currWeight = matchingWeight;
 
-        currFamily = _pickFamily(attrs.family, matchingFamily, desiredfamily);
-
-        if (attrs.family != currFamily)
-            continue;
-
-        if (currFamily != matchingFamily) {
-            currStretch = FontStretch::NO_MATCH;
-            currStyle = FontStyle::NO_MATCH;
-            currWeight = FontWeight::NO_MATCH;
-        }
-
         currStretch = _pickFontStretch(attrs.stretch, currStretch, query.stretch);
         if (attrs.stretch != currStretch)
             continue;
@@ -280,8 +363,7 @@ Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
         if (attrs.weight != currWeight)
             continue;
 
-        matchingFace = info.face;
-        matchingFamily = currFamily;
+        matchingFace = i;
         matchingStretch = currStretch;
         matchingStyle = currStyle;
         matchingWeight = currWeight;
@@ -290,11 +372,46 @@ Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
     return matchingFace;
 }
 
+Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
+    _MatchKey key{
+        _resolveFamily(query.family),
+        query.weight,
+        query.stretch,
+        query.style,
+    };
+
+    auto& matches = _store->matches;
+    while (true) {
+        Opt<usize> index = NONE;
+        if (auto cached = matches.tryGet(key)) {
+            index = *cached;
+        } else {
+            index = _matchClosest(key.family, query);
+            matches.put(key, index);
+        }
+
+        if (not index)
+            return NONE;
+
+        if (auto face = _store->faces[*index].load())
+            return face;
+
+        // NOTE: The face is now marked as broken and won't be picked
+        //       again, but other queries might have settled on it too.
+        matches.clear();
+    }
+}
+
 Vec<Rc<Fontface>> FontBook::queryFamily(String family) const {
     Vec<Rc<Fontface>> res;
-    for (auto& info : _faces)
-        if (commonFamily(info.attrs.family, family) == family)
-            res.pushBack(info.face);
+    for (auto& [name, indices] : _store->families.iter()) {
+        if (commonFamily(name, family) != family)
+            continue;
+
+        for (auto i : indices)
+            if (auto face = _store->faces[i].load())
+                res.pushBack(face.take());
+    }
 
     sort(res, [](auto& lhs, auto& rhs) {
         return lhs->attrs() <=> rhs->attrs();
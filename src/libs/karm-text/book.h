@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-base/cow.h>
+#include <karm-base/map.h>
 #include <karm-base/set.h>
 #include <karm-mime/url.h>
 #include <karm-sys/mmap.h>
@@ -23,16 +25,46 @@ struct FontQuery {
     }
 };
 
+// A font known to the book, its face is only parsed the first time it's
+// picked by a query.
 struct FontInfo {
     Mime::Url url;
     FontAttrs attrs;
-    Rc<Fontface> face;
+    mutable Opt<Rc<Fontface>> face = NONE;
+    mutable bool broken = false;
+
+    Opt<Rc<Fontface>> load() const;
 };
 
 Str commonFamily(Str lhs, Str rhs);
 
 struct FontBook {
-    Vec<FontInfo> _faces;
+    struct _MatchKey {
+        String family;
+        FontWeight weight;
+        FontStretch stretch;
+        FontStyle style;
+
+        bool operator==(_MatchKey const&) const = default;
+
+        Hash hash() const {
+            auto h = Karm::hash(family);
+            h = hashCombine(h, Karm::hash(weight.value()));
+            h = hashCombine(h, Karm::hash(stretch.value()));
+            return hashCombine(h, Karm::hash(style));
+        }
+    };
+
+    // NOTE: Books are copied for every document that loads its own fonts,
+    //       the copies share the faces and the match cache until they add
+    //       a font of their own.
+    struct _Store {
+        Vec<FontInfo> faces;
+        Map<String, Vec<usize>> families;
+        mutable HashMap<_MatchKey, Opt<usize>> matches;
+    };
+
+    Cow<_Store> _store;
 
     // FIXME: these value depend on the correct loading of the bundle
     Array<String, toUnderlyingType(GenericFamily::_LEN)> _genericFamily = {
@@ -47,20 +79,22 @@ struct FontBook {
         /* FANGSONG */ "Noto"s,
     };
 
-    void add(FontInfo info) {
-        _faces.pushBack(info);
-    }
+    void add(FontInfo info);
 
     Res<> load(Mime::Url const& url, Opt<FontAttrs> attrs = NONE);
 
     Res<> loadAll();
 
+    Res<> loadAll(Mime::Url const& indexUrl);
+
     Vec<String> families() const;
 
     Str _resolveFamily(Family const& family) const;
 
     Opt<Rc<Fontface>> queryExact(FontQuery query) const;
 
+    Opt<usize> _matchClosest(Str family, FontQuery const& query) const;
+
     Opt<Rc<Fontface>> queryClosest(FontQuery query) const;
 
     Vec<Rc<Fontface>> queryFamily(String family) const;
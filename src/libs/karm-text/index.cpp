@@ -0,0 +1,142 @@
+#include <karm-io/bscan.h>
+#include <karm-io/impls.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+
+#include "index.h"
+
+namespace Karm::Text {
+
+// MARK: Decoding --------------------------------------------------------------
+
+static Res<Str> _string(Bytes strings, u32 off, u32 len) {
+    if (off > strings.len() or len > strings.len() - off)
+        return Error::invalidData("font index string out of bounds");
+    return Ok(Str{reinterpret_cast<char const*>(strings.buf()) + off, len});
+}
+
+Res<FontIndex> FontIndex::decode(Bytes bytes) {
+    Io::BScan s{bytes};
+
+    RawHeader header;
+    if (s.rem() < sizeof(RawHeader))
+        return Error::invalidData("font index too small");
+    s.readTo(&header);
+
+    if (header.magic != MAGIC)
+        return Error::invalidData("invalid font index magic");
+
+    if (header.version != VERSION)
+        return Error::invalidData("unsupported font index version");
+
+    usize entriesLen = header.count * sizeof(RawEntry);
+    if (s.rem() != entriesLen + header.stringsLen)
+        return Error::invalidData("invalid font index layout");
+
+    auto payload = next(bytes, sizeof(RawHeader));
+    if (hash(payload) != header.checksum)
+        return Error::invalidData("invalid font index checksum");
+
+    auto strings = next(payload, entriesLen);
+
+    FontIndex index;
+    index.entries.ensure(header.count);
+    for (usize i = 0; i < header.count; i++) {
+        RawEntry raw;
+        s.readTo(&raw);
+
+        if (raw.style >= toUnderlyingType(FontStyle::NO_MATCH) or
+            raw.monospace >= toUnderlyingType(Monospace::_LEN))
+            return Error::invalidData("invalid font index entry");
+
+        auto url = try$(_string(strings, raw.urlOff, raw.urlLen));
+        auto family = try$(_string(strings, raw.familyOff, raw.familyLen));
+
+        index.entries.pushBack({
+            .url = Mime::Url::parse(url),
+            .size = raw.size,
+            .modified = SystemTime{raw.modified},
+            .attrs = {
+                .family = family,
+                .weight = FontWeight{raw.weight},
+                .stretch = FontStretch{raw.stretch},
+                .style = static_cast<FontStyle>(raw.style),
+                .monospace = static_cast<Monospace>(raw.monospace),
+                .coverage = {{
+                    raw.coverage[0],
+                    raw.coverage[1],
+                    raw.coverage[2],
+                    raw.coverage[3],
+                }},
+            },
+        });
+    }
+
+    return Ok(std::move(index));
+}
+
+Res<FontIndex> FontIndex::load(Mime::Url const& url) {
+    auto file = try$(Sys::File::open(url));
+    auto map = try$(Sys::mmap().map(file));
+    return decode(map.bytes());
+}
+
+// MARK: Encoding --------------------------------------------------------------
+
+Buf<u8> FontIndex::encode() const {
+    Io::BufferWriter strings;
+    auto intern = [&](Str str) {
+        u32 off = strings.bytes().len();
+        (void)strings.write(bytes(str));
+        return off;
+    };
+
+    Io::BufferWriter payload;
+    Io::BEmit e{payload};
+    for (auto& entry : entries) {
+        auto url = entry.url.str();
+
+        RawEntry raw;
+        raw.urlOff = intern(url);
+        raw.urlLen = url.len();
+        raw.familyOff = intern(entry.attrs.family);
+        raw.familyLen = entry.attrs.family.len();
+        raw.size = entry.size;
+        raw.modified = entry.modified.val();
+        raw.weight = entry.attrs.weight.value();
+        raw.stretch = entry.attrs.stretch.value();
+        raw.style = toUnderlyingType(entry.attrs.style);
+        raw.monospace = toUnderlyingType(entry.attrs.monospace);
+        for (usize i = 0; i < 4; i++)
+            raw.coverage[i] = entry.attrs.coverage.bits[i];
+        e.writeFrom(raw);
+    }
+    (void)payload.write(strings.bytes());
+
+    RawHeader header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.count = entries.len();
+    header.stringsLen = strings.bytes().len();
+    header.checksum = hash(payload.bytes());
+
+    Io::BufferWriter out;
+    Io::BEmit{out}.writeFrom(header);
+    (void)out.write(payload.bytes());
+    return out.take();
+}
+
+Res<> FontIndex::save(Mime::Url const& url) const {
+    auto buf = encode();
+    auto file = try$(Sys::File::create(url));
+    auto rem = bytes(buf);
+    while (rem.len()) {
+        auto written = try$(file.write(rem));
+        if (written == 0)
+            return Error::writeZero();
+        rem = next(rem, written);
+    }
+    return Ok();
+}
+
+} // namespace Karm::Text
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <karm-base/endian.h>
+#include <karm-base/time.h>
+#include <karm-mime/url.h>
+
+#include "base.h"
+
+namespace Karm::Text {
+
+// A font file as recorded in the index, with everything needed to match it
+// against a query without opening it. The size and modification time tell
+// whether the file changed since it was indexed.
+struct FontIndexEntry {
+    Mime::Url url;
+    usize size;
+    SystemTime modified;
+    FontAttrs attrs;
+};
+
+// Persistent summary of the installed fonts, so they don't have to be parsed
+// every time a font book is loaded.
+//
+//     header | entry... | strings
+//
+// Entries refer to their url and family by offset into the string table.
+struct FontIndex {
+    static constexpr Array<u8, 8> MAGIC = {
+        'K', 'F', 'O', 'N', 'T', 'I', 'D', 'X'
+    };
+
+    static constexpr u32 VERSION = 1;
+
+    struct [[gnu::packed]] RawHeader {
+        Array<u8, 8> magic;
+        Le<u32> version;
+        Le<u32> count;
+        Le<u64> stringsLen;
+        Le<u64> checksum;
+    };
+
+    struct [[gnu::packed]] RawEntry {
+        Le<u32> urlOff;
+        Le<u32> urlLen;
+        Le<u32> familyOff;
+        Le<u32> familyLen;
+        Le<u64> size;
+        Le<u64> modified;
+        Le<u16> weight;
+        Le<u16> stretch;
+        u8 style;
+        u8 monospace;
+        Array<Le<u32>, 4> coverage;
+    };
+
+    Vec<FontIndexEntry> entries;
+
+    static Res<FontIndex> decode(Bytes bytes);
+
+    static Res<FontIndex> load(Mime::Url const& url);
+
+    Buf<u8> encode() const;
+
+    Res<> save(Mime::Url const& url) const;
+};
+
+} // namespace Karm::Text
@@ -1,5 +1,6 @@
 #include <karm-test/macros.h>
 #include <karm-text/book.h>
+#include <karm-text/index.h>
 
 namespace Karm::Text::Tests {
 
@@ -14,4 +15,103 @@ test$("karm-text-common-family") {
     return Ok();
 }
 
+test$("karm-text-index-roundtrip") {
+    FontIndex index;
+    index.entries.pushBack({
+        .url = "bundle://karm-fonts/fonts/NotoSans-Bold.ttf"_url,
+        .size = 1234,
+        .modified = SystemTime{5678},
+        .attrs = {
+            .family = "Noto Sans"s,
+            .weight = FontWeight::BOLD,
+            .style = FontStyle::ITALIC,
+            .coverage = {{1, 2, 3, 4}},
+        },
+    });
+    index.entries.pushBack({
+        .url = "bundle://karm-fonts/fonts/FiraCode.ttf"_url,
+        .size = 42,
+        .modified = SystemTime{43},
+        .attrs = {
+            .family = "Fira Code"s,
+            .monospace = Monospace::YES,
+        },
+    });
+
+    auto buf = index.encode();
+    auto decoded = try$(FontIndex::decode(buf));
+    expectEq$(decoded.entries.len(), 2uz);
+
+    for (usize i = 0; i < 2; i++) {
+        auto& lhs = index.entries[i];
+        auto& rhs = decoded.entries[i];
+        expectEq$(lhs.url, rhs.url);
+        expectEq$(lhs.size, rhs.size);
+        expectEq$(lhs.modified, rhs.modified);
+        expectEq$(lhs.attrs.family, rhs.attrs.family);
+        expectEq$(lhs.attrs.weight, rhs.attrs.weight);
+        expectEq$(lhs.attrs.stretch, rhs.attrs.stretch);
+        expectEq$(lhs.attrs.style, rhs.attrs.style);
+        expectEq$(lhs.attrs.monospace, rhs.attrs.monospace);
+        expect$(lhs.attrs.coverage == rhs.attrs.coverage);
+    }
+
+    buf[buf.len() - 1] ^= 1;
+    expect$(not FontIndex::decode(buf));
+    expect$(not FontIndex::decode(sub(buf, 0, buf.len() - 1)));
+
+    return Ok();
+}
+
+test$("karm-text-book-query") {
+    FontBook book;
+
+    auto add = [&](Str family, FontWeight weight, FontStyle style) {
+        auto face = Fontface::fallback();
+        book.add({
+            .url = ""_url,
+            .attrs = {
+                .family = family,
+                .weight = weight,
+                .style = style,
+            },
+            .face = face,
+        });
+        return face;
+    };
+
+    auto regular = add("Noto Sans", FontWeight::REGULAR, FontStyle::NORMAL);
+    auto bold = add("Noto Sans", FontWeight::BOLD, FontStyle::NORMAL);
+    auto italic = add("Noto Sans", FontWeight::REGULAR, FontStyle::ITALIC);
+    auto mono = add("Fira Code", FontWeight::REGULAR, FontStyle::NORMAL);
+
+    auto closest = [&](FontQuery query) {
+        return &book.queryClosest(query).unwrap().unwrap();
+    };
+
+    expect$(closest({.family = String{"Noto Sans"}}) == &regular.unwrap());
+    expect$(closest({.family = String{"Noto Sans"}, .weight = FontWeight::BLACK}) == &bold.unwrap());
+    expect$(closest({.family = String{"Noto Sans"}, .style = FontStyle::OBLIQUE}) == &italic.unwrap());
+    expect$(closest({.family = String{"Noto Sans Display"}}) == &regular.unwrap());
+    expect$(closest({.family = GenericFamily::MONOSPACE}) == &mono.unwrap());
+    expect$(not book.queryClosest({.family = String{"Comic Sans"}}));
+
+    expect$(book.queryExact({.family = String{"Noto Sans"}, .weight = FontWeight::BOLD}).has());
+    expect$(not book.queryExact({.family = String{"Noto Sans"}, .weight = FontWeight::LIGHT}));
+
+    expectEq$(book.queryFamily("Noto"s).len(), 3uz);
+
+    // Faces are only parsed when picked, one that fails to load is skipped.
+    book.add({
+        .url = "file:///nonexistent/NotoSans-Black.ttf"_url,
+        .attrs = {
+            .family = "Noto Sans"s,
+            .weight = FontWeight::BLACK,
+        },
+    });
+    expect$(closest({.family = String{"Noto Sans"}, .weight = FontWeight::BLACK}) == &bold.unwrap());
+
+    return Ok();
+}
+
 } // namespace Karm::Text::Tests
@@ -43,6 +43,7 @@ FontAttrs TtfFontface::attrs() const {
     if (_parser._os2.present()) {
         attrs.weight = FontWeight{_parser._os2.weightClass()};
         attrs.stretch = FontStretch{static_cast<u16>(_parser._os2.widthClass() * 100)};
+        attrs.coverage = {_parser._os2.unicodeRanges()};
     }
 
     return attrs;
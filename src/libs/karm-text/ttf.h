@@ -11,9 +11,9 @@ namespace Karm::Text {
 struct TtfFontface : public Fontface {
     Sys::Mmap _mmap;
     Ttf::Parser _parser;
-    Map<Rune, Glyph> _cachedEntries;
-    Map<Glyph, f64> _cachedAdvances;
-    Map<Pair<Glyph>, f64> _cachedKerns;
+    HashMap<Rune, Glyph> _cachedEntries;
+    HashMap<Glyph, f64> _cachedAdvances;
+    HashMap<Pair<Glyph>, f64> _cachedKerns;
     f64 _unitPerEm = 0;
 
     static Res<Rc<TtfFontface>> load(Sys::Mmap&& mmap);
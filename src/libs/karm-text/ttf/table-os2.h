@@ -11,6 +11,10 @@ struct Os2 : public Io::BChunk {
 
     using WeightClass = Io::BField<u16be, 4>;
     using WidthClass = Io::BField<u16be, 6>;
+    using UnicodeRange1 = Io::BField<u32be, 42>;
+    using UnicodeRange2 = Io::BField<u32be, 46>;
+    using UnicodeRange3 = Io::BField<u32be, 50>;
+    using UnicodeRange4 = Io::BField<u32be, 54>;
 
     u16 weightClass() const {
         return get<WeightClass>();
@@ -19,6 +23,15 @@ struct Os2 : public Io::BChunk {
     u16 widthClass() const {
         return get<WidthClass>();
     }
+
+    Array<u32, 4> unicodeRanges() const {
+        return {
+            get<UnicodeRange1>(),
+            get<UnicodeRange2>(),
+            get<UnicodeRange3>(),
+            get<UnicodeRange4>(),
+        };
+    }
 };
 
 } // namespace Ttf
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <karm-base/vec.h>
+#include <karm-math/rect.h>
+
+namespace Karm::Ui {
+
+// Regions of the host that need to be repainted before the next flip.
+//
+// Rects are merged when their bounding box costs no more pixels than
+// painting them one by one, this takes care of repeated and overlapping
+// damage from animated widgets. Past MAX_RECTS, walking the tree once per
+// rect costs more than a few extra pixels, so the cheapest pairs are
+// collapsed into their bounding box.
+struct Damage {
+    static constexpr usize MAX_RECTS = 16;
+
+    Vec<Math::Recti> _rects;
+
+    // Pixels painted for nothing when the bounding box is painted instead
+    // of the two rects, the overlap only counts once.
+    static isize _mergeCost(Math::Recti a, Math::Recti b) {
+        return a.mergeWith(b).area() - (a.area() + b.area() - a.clipTo(b).area());
+    }
+
+    static bool _shouldMerge(Math::Recti a, Math::Recti b) {
+        return _mergeCost(a, b) <= 0;
+    }
+
+    void add(Math::Recti r) {
+        if (r.width <= 0 or r.height <= 0)
+            return;
+
+        // Merging may make the rect mergeable with others, keep going until
+        // it settles.
+        for (usize i = 0; i < _rects.len();) {
+            if (_shouldMerge(_rects[i], r)) {
+                r = _rects[i].mergeWith(r);
+                _rects.removeAt(i);
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+
+        _rects.pushBack(r);
+
+        if (_rects.len() > MAX_RECTS)
+            _collapse();
+    }
+
+    // Replace the two rects that waste the fewest pixels when painted as
+    // their bounding box.
+    void _collapse() {
+        usize bestI = 0, bestJ = 1;
+        isize bestCost = Limits<isize>::MAX;
+        for (usize i = 0; i < _rects.len(); i++) {
+            for (usize j = i + 1; j < _rects.len(); j++) {
+                auto cost = _mergeCost(_rects[i], _rects[j]);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+
+        auto r = _rects[bestI].mergeWith(_rects[bestJ]);
+        _rects.removeAt(bestJ);
+        _rects.removeAt(bestI);
+        add(r);
+    }
+
+    Slice<Math::Recti> rects() const {
+        return _rects;
+    }
+
+    usize len() const {
+        return _rects.len();
+    }
+
+    // Number of pixels that are going to be repainted.
+    usize area() const {
+        usize res = 0;
+        for (auto& r : _rects)
+            res += r.area();
+        return res;
+    }
+
+    bool empty() const {
+        return _rects.len() == 0;
+    }
+
+    void clear() {
+        _rects.clear();
+    }
+};
+
+} // namespace Karm::Ui
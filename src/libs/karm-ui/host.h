@@ -6,6 +6,7 @@
 #include <karm-sys/time.h>
 #include <karm-text/loader.h>
 
+#include "damage.h"
 #include "node.h"
 
 namespace Karm::Ui {
@@ -13,11 +14,14 @@ namespace Karm::Ui {
 static constexpr auto FRAME_RATE = 60;
 static constexpr auto FRAME_TIME = 1.0 / FRAME_RATE;
 
+static constexpr bool DEBUG_DAMAGE = false;
+
 struct Host : public Node {
     Child _root;
     Opt<Res<>> _res;
     Gfx::CpuCanvas _g;
-    Vec<Math::Recti> _dirty;
+    Damage _damage;
+    usize _damagedPixels = 0; //< Pixels repainted by the last frame
 
     bool _shouldLayout{};
     bool _shouldAnimate{};
@@ -60,14 +64,17 @@ struct Host : public Node {
     void paint() {
         _g.begin(mutPixels());
 
-        for (auto& d : _dirty) {
+        for (auto& d : _damage.rects()) {
             paint(_g, d);
         }
 
         _g.end();
 
-        flip(_dirty);
-        _dirty.clear();
+        _damagedPixels = _damage.area();
+        logDebugIf(DEBUG_DAMAGE, "damaged {} pixels in {} rects", _damagedPixels, _damage.len());
+
+        flip(_damage.rects());
+        _damage.clear();
     }
 
     void layout(Math::Recti r) override {
@@ -80,7 +87,7 @@ struct Host : public Node {
 
     void bubble(App::Event& event) override {
         if (auto e = event.is<Node::PaintEvent>()) {
-            _dirty.pushBack(e->bound);
+            _damage.add(e->bound.clipTo(bound()));
             event.accept();
         } else if (auto e = event.is<Node::LayoutEvent>()) {
             _shouldLayout = true;
@@ -131,13 +138,11 @@ struct Host : public Node {
                 layout(bound());
                 _shouldLayout = false;
                 _shouldAnimate = true;
-                _dirty.pushBack(bound());
+                _damage.add(bound());
             }
 
-            if (_dirty.len() > 0) {
+            if (not _damage.empty())
                 Host::paint();
-                _dirty.clear();
-            }
 
             co_trya$(waitAsync(nextFrameScheduled ? nextFrame : Instant::endOfTime()));
             nextFrameScheduled = false;
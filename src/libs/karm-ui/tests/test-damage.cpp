@@ -0,0 +1,87 @@
+#include <karm-test/macros.h>
+#include <karm-ui/damage.h>
+
+namespace Karm::Ui::Tests {
+
+static bool _same(Math::Recti a, Math::Recti b) {
+    return a.x == b.x and a.y == b.y and a.width == b.width and a.height == b.height;
+}
+
+test$("damage-merge-cost") {
+    // Side by side, the bounding box is exactly the two rects.
+    expectEq$(Damage::_mergeCost({0, 0, 10, 10}, {10, 0, 10, 10}), 0);
+
+    // Overlapping, the overlap is only painted once either way.
+    expectEq$(Damage::_mergeCost({0, 0, 10, 10}, {5, 0, 10, 10}), 0);
+
+    // Contained in the other one.
+    expectEq$(Damage::_mergeCost({0, 0, 10, 10}, {2, 2, 4, 4}), 0);
+
+    // Diagonal, the two empty corners are wasted.
+    expectEq$(Damage::_mergeCost({0, 0, 10, 10}, {5, 5, 10, 10}), 225 - 175);
+
+    // Far apart.
+    expectEq$(Damage::_mergeCost({0, 0, 10, 10}, {90, 90, 10, 10}), 10000 - 200);
+
+    return Ok();
+}
+
+test$("damage-add-merges-overlapping") {
+    Damage damage;
+    damage.add({0, 0, 10, 10});
+    damage.add({5, 0, 10, 10});
+    damage.add({2, 2, 4, 4});
+
+    expectEq$(damage.len(), 1uz);
+    expect$(_same(damage.rects()[0], {0, 0, 15, 10}));
+
+    return Ok();
+}
+
+test$("damage-add-keeps-distant-apart") {
+    Damage damage;
+    damage.add({0, 0, 10, 10});
+    damage.add({90, 90, 10, 10});
+    damage.add({0, 0, 0, 10});
+
+    expectEq$(damage.len(), 2uz);
+    expectEq$(damage.area(), 200uz);
+
+    return Ok();
+}
+
+test$("damage-add-merges-until-settled") {
+    Damage damage;
+    damage.add({0, 0, 10, 10});
+    damage.add({20, 0, 10, 10});
+
+    // Bridges the two rects, the result covers all three.
+    damage.add({10, 0, 10, 10});
+
+    expectEq$(damage.len(), 1uz);
+    expect$(_same(damage.rects()[0], {0, 0, 30, 10}));
+
+    return Ok();
+}
+
+test$("damage-collapse-past-max") {
+    Damage damage;
+    for (isize i = 0; i < (isize)Damage::MAX_RECTS + 4; i++)
+        damage.add({i * 100, i * 100, 10, 10});
+
+    expect$(damage.len() <= Damage::MAX_RECTS);
+
+    // Every rect is still covered.
+    for (isize i = 0; i < (isize)Damage::MAX_RECTS + 4; i++) {
+        Math::Recti r{i * 100, i * 100, 10, 10};
+        bool covered = false;
+        for (auto& d : damage.rects())
+            if (d.contains(r))
+                covered = true;
+        expect$(covered);
+    }
+
+    return Ok();
+}
+
+} // namespace Karm::Ui::Tests
@@ -59,7 +59,7 @@ Async::Task<> entryPointAsync(Sys::Context& ctx) {
     logInfo("devices: binding IRQs...");
     auto listener = co_try$(Hj::Listener::create(Hj::ROOT));
 
-    Map<Hj::Cap, usize> cap2irq = {};
+    HashMap<Hj::Cap, usize> cap2irq = {};
     Vec<Hj::Irq> irqs = {};
 
     for (usize i = 0; i < 16; i++) {
@@ -21,6 +21,7 @@ struct Root : public Ui::ProxyNode<Root> {
     Rc<Gfx::CpuSurface> _frontbuffer;
     Rc<Gfx::Surface> _backbuffer;
     bool _shouldLayout{};
+    Gfx::CpuCanvas _g;
 
     Root(Ui::Child child, Rc<Gfx::CpuSurface> frontbuffer)
         : Ui::ProxyNode<Root>(std::move(child)),
@@ -29,7 +30,7 @@ struct Root : public Ui::ProxyNode<Root> {
     }
 
     void _repaint() {
-        Gfx::CpuCanvas g;
+        auto& g = _g;
         g.begin(*_backbuffer);
         for (auto& r : _dirty) {
             g.push();
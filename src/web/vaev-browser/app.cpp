@@ -1,5 +1,6 @@
 module;
 
+#include <karm-async/promise.h>
 #include <karm-gc/heap.h>
 #include <karm-gc/root.h>
 #include <karm-kira/context-menu.h>
@@ -103,6 +104,13 @@ struct Loaded {
     Res<Gc::Root<Dom::Document>> dom;
 };
 
+// The first chunks of a document that is still loading, shown until the
+// rest of it arrives.
+struct Partial {
+    Gc::Root<Dom::Document> dom;
+    Async::Future<Gc::Root<Dom::Document>> rest;
+};
+
 struct GoBack {};
 
 struct GoForward {};
@@ -112,6 +120,7 @@ struct ToggleWireframe {};
 using Action = Union<
     Reload,
     Loaded,
+    Partial,
     GoBack,
     GoForward,
     ToggleWireframe,
@@ -119,14 +128,50 @@ using Action = Union<
     InspectorAction,
     Navigate>;
 
+Res<Gc::Root<Dom::Document>> _root(Res<Gc::Ref<Dom::Document>> dom) {
+    if (not dom)
+        return dom.none();
+    return Ok(Gc::Root<Dom::Document>{dom.unwrap()});
+}
+
 Async::_Task<Opt<Action>> navigateAsync(Gc::Heap& heap, Http::Client& client, Navigate nav) {
     (void)co_await Sys::globalSched().sleepAsync(Sys::instant() + 300_ms);
 
-    if (nav.action == Mime::Uti::PUBLIC_MODIFY) {
-        co_return Loaded{co_await Vaev::Driver::viewSourceAsync(heap, client, nav.url)};
-    } else {
-        co_return Loaded{co_await Vaev::Driver::fetchDocumentAsync(heap, client, nav.url)};
-    }
+    if (nav.action == Mime::Uti::PUBLIC_MODIFY)
+        co_return Loaded{_root(co_await Vaev::Driver::viewSourceAsync(heap, client, nav.url))};
+
+    // NOTE: The document is shown as soon as its first chunk has been
+    //       parsed, and is loaded the rest of the way in the background.
+    struct Loading {
+        Opt<Async::Promise<Gc::Root<Dom::Document>>> first = Async::Promise<Gc::Root<Dom::Document>>{};
+        Async::Promise<Gc::Root<Dom::Document>> done;
+    };
+
+    auto loading = makeRc<Loading>();
+    auto first = loading->first->future();
+    auto rest = loading->done.future();
+
+    Async::detach(
+        Vaev::Driver::fetchDocumentAsync(heap, client, nav.url, [loading](Gc::Ref<Dom::Document> dom) {
+            if (loading->first)
+                loading->first.take().resolve(Ok(Gc::Root<Dom::Document>{dom}));
+        }),
+        [loading](Res<Gc::Ref<Dom::Document>> dom) {
+            auto res = _root(dom);
+            if (loading->first)
+                loading->first.take().resolve(res);
+            loading->done.resolve(res);
+        }
+    );
+
+    auto dom = co_await first;
+    if (not dom)
+        co_return Loaded{dom};
+    co_return Partial{dom.take(), rest};
+}
+
+Async::_Task<Opt<Action>> finishLoadingAsync(Async::Future<Gc::Root<Dom::Document>> rest) {
+    co_return Loaded{co_await rest};
 }
 
 Ui::Task<Action> reduce(State& s, Action a) {
@@ -137,9 +182,19 @@ Ui::Task<Action> reduce(State& s, Action a) {
             s.status = Status::LOADING;
             return navigateAsync(s.heap, s.client, s.currentUrl());
         },
+        [&](Partial p) -> Ui::Task<Action> {
+            s.dom = Ok(p.dom);
+            return finishLoadingAsync(p.rest);
+        },
         [&](Loaded l) -> Ui::Task<Action> {
             s.status = Status::LOADED;
             s.dom = l.dom;
+
+            // Nothing is being parsed at this point, and everything still
+            // in use is reachable from a root, so it's a safe point to
+            // reclaim the previous documents.
+            if (s.heap.shouldCollect())
+                s.heap.collect();
             return NONE;
         },
         [&](GoBack) -> Ui::Task<Action> {
@@ -365,7 +420,7 @@ export Ui::Child app(Gc::Heap& heap, Http::Client& client, Mime::Url url, Res<Gc
             heap,
             client,
             Navigate{url},
-            dom,
+            _root(dom),
         },
         [](State const& s) {
             return Kr::scaffold({
@@ -30,7 +30,7 @@ export struct SelectNode {
 export using InspectorAction = Union<ExpandNode, SelectNode>;
 
 export struct InspectState {
-    Map<Gc::Ref<Dom::Node>, bool> expandedNodes = {};
+    HashMap<Gc::Ref<Dom::Node>, bool> expandedNodes = {};
     Opt<Gc::Ref<Dom::Node>> selectedNode = NONE;
 
     void apply(InspectorAction& a) {
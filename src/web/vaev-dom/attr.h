@@ -6,21 +6,13 @@
 namespace Vaev::Dom {
 
 // https://dom.spec.whatwg.org/#interface-attr
-
-struct Attr : public Node {
+// NOSPEC: Attributes aren't nodes, they are stored inline in their element.
+struct Attr {
     AttrName name;
     String value;
 
-    Attr(AttrName name, String value)
-        : name(name), value(value) {
-    }
-
-    NodeType nodeType() const override {
-        return NodeType::ATTRIBUTE;
-    }
-
-    void _repr(Io::Emit& e) const override {
-        e(" localName={}:{} value={#}", name.ns.name(), name.name(), value);
+    void repr(Io::Emit& e) const {
+        e("({} localName={}:{} value={#})\n", NodeType::ATTRIBUTE, name.ns.name(), name.name(), value);
     }
 };
 
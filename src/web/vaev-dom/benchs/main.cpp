@@ -0,0 +1,86 @@
+#include <karm-gc/heap.h>
+#include <karm-io/funcs.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/proc.h>
+#include <karm-sys/time.h>
+#include <vaev-dom/html/parser.h>
+
+using namespace Vaev;
+
+static constexpr usize SECTIONS = 400;
+static constexpr usize ROUNDS = 8;
+
+// A page shaped like a long article: prose with inline markup, character
+// references, lists, tables and a bit of script and style. Used when no
+// page is given on the command line.
+static String _article() {
+    Io::StringWriter w;
+    // NOTE: The style and script go through arguments, format strings
+    //       can't hold braces.
+    (void)Io::format(
+        w,
+        "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n"
+        "<meta charset=\"utf-8\">\n<title>The Long Article &mdash; Bench</title>\n"
+        "<style>{}</style>\n"
+        "<script>{}</script>\n"
+        "</head>\n<body>\n<main>\n",
+        "body { font-family: serif; } .note { color: #555; }"s,
+        "window.onload = function () { if (document.title.length < 80) console.log(document.title); };"s
+    );
+
+    for (usize i = 0; i < SECTIONS; i++) {
+        (void)Io::format(
+            w,
+            "<section id=\"s{}\">\n<h2>Section {}</h2>\n"
+            "<p>Lorem ipsum dolor sit amet, <em>consectetur</em> adipiscing elit, sed do eiusmod "
+            "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis "
+            "nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.</p>\n"
+            "<p class=\"note\">Duis aute irure dolor in <a href=\"/ref/{}\">reprehenderit</a> in "
+            "voluptate velit esse cillum dolore eu fugiat nulla pariatur &amp; excepteur sint "
+            "occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim.</p>\n"
+            "<ul>\n<li>Première entrée</li>\n<li>Zweiter Eintrag &ndash; größer</li>\n"
+            "<li>Third entry with <code>inline code</code></li>\n</ul>\n"
+            "<table>\n<tr><th>Key</th><th>Value</th></tr>\n"
+            "<tr><td>alpha</td><td>{}</td></tr>\n<tr><td>beta</td><td>{}</td></tr>\n</table>\n"
+            "</section>\n",
+            i, i, i, i * 3, i * 7
+        );
+    }
+
+    (void)Io::format(w, "</main>\n</body>\n</html>\n");
+    return w.take();
+}
+
+static Res<String> _load(Sys::Context& ctx) {
+    auto& args = Sys::useArgs(ctx);
+    if (not args.len())
+        return Ok(_article());
+
+    auto url = Mime::parseUrlOrPath(args[0], try$(Sys::pwd()));
+    auto file = try$(Sys::File::open(url));
+    return Io::readAllUtf8(file);
+}
+
+Async::Task<> entryPointAsync(Sys::Context& ctx) {
+    auto html = co_try$(_load(ctx));
+
+    Duration best = Duration::fromUSecs(Limits<u64>::MAX);
+    for (usize i = 0; i < ROUNDS; i++) {
+        Gc::Heap heap;
+        auto dom = heap.alloc<Dom::Document>("about:bench"_url);
+        Dom::HtmlParser parser{heap, dom};
+
+        auto start = Sys::now();
+        parser.write(html);
+        auto elapsed = Sys::now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    f64 mbps = html.len() / max((f64)best.toUSecs(), 1.0);
+    Sys::println("size: {} bytes", html.len());
+    Sys::println("parse: {} ({} MB/s)", best, mbps);
+
+    co_return Ok();
+}
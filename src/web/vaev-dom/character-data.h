@@ -14,12 +14,14 @@ struct CharacterData : public Node {
         : _data(std::move(data)) {
     }
 
-    void appendData(String const& s) {
+    void appendData(Str s) {
         _data.append(s);
+        _changed(true);
     }
 
     void appendData(Rune rune) {
         _data.append(rune);
+        _changed(true);
     }
 
     Str data() const {
@@ -25,4 +25,20 @@ Gc::Ptr<Dom::Element> Document::documentElement() const {
     return nullptr;
 }
 
+Opt<Vec<Gc::Ref<Node>>> Document::changedData(usize generation) {
+    if (generation > _generation or _generation - generation > CHANGES)
+        return NONE;
+
+    Vec<Gc::Ref<Node>> res;
+    for (usize g = generation + 1; g <= _generation; g++) {
+        auto node = _changes[g % CHANGES];
+        if (not node)
+            return NONE;
+        Gc::Ref<Node> ref = *node;
+        if (not contains(res, ref))
+            res.pushBack(ref);
+    }
+    return res;
+}
+
 } // namespace Vaev::Dom
@@ -23,6 +23,24 @@ struct Document : public Node {
     String xmlEncoding;
     String xmlStandalone = "no"s; // https://www.w3.org/TR/xml/#NT-SDDecl
 
+    // Bumped every time the tree, an attribute or some character data is
+    // changed, so anything derived from the document can tell when it's stale.
+    usize _generation = 0;
+
+    // What each of the last few generations changed: the node whose
+    // character data changed, or null for anything else.
+    static constexpr usize CHANGES = 16;
+    Array<Gc::Ptr<Node>, CHANGES> _changes = {};
+
+    // Unique for the whole process, unlike the address of the document
+    // which can be reused once it has been collected.
+    usize _id = _nextId();
+
+    static usize _nextId() {
+        static usize id = 0;
+        return ++id;
+    }
+
     Document(Mime::Url url)
         : _url(url) {
     }
@@ -38,6 +56,29 @@ struct Document : public Node {
     }
 
     Gc::Ptr<Dom::Element> documentElement() const;
+
+    usize generation() const {
+        return _generation;
+    }
+
+    void _record(Gc::Ptr<Node> node) {
+        _generation++;
+        _changes[_generation % CHANGES] = node;
+    }
+
+    // The nodes whose character data changed since `generation`, or NONE if
+    // anything else changed, or it was too many generations ago to tell.
+    Opt<Vec<Gc::Ref<Node>>> changedData(usize generation);
+
+    usize id() const {
+        return _id;
+    }
+
+    void trace(Gc::Visitor& v) const {
+        Node::trace(v);
+        for (usize i = 0; i < CHANGES; i++)
+            v.visit(_changes[i]);
+    }
 };
 
 } // namespace Vaev::Dom
@@ -17,8 +17,10 @@ struct Element : public Node {
     }
 
     TagName tagName;
-    // NOSPEC: Should be a NamedNodeMap
-    Map<AttrName, Rc<Attr>> attributes;
+    // NOSPEC: Should be a NamedNodeMap, elements rarely have more than a
+    //         few attributes so they are kept inline and looked up by
+    //         their interned name.
+    SmallVec<Attr, 4> attributes;
     TokenList classList;
 
     Element(TagName tagName)
@@ -47,8 +49,8 @@ struct Element : public Node {
         e(" tagName={#}", this->tagName);
         if (this->attributes.len()) {
             e.indentNewline();
-            for (auto const& [name, attr] : this->attributes.iter()) {
-                attr->repr(e);
+            for (auto const& attr : this->attributes) {
+                attr.repr(e);
             }
             e.deindent();
         }
@@ -59,21 +61,39 @@ struct Element : public Node {
             for (auto class_ : iterSplit(value, ' ')) {
                 this->classList.add(class_);
             }
-            return;
+        } else if (auto* attr = _findAttribute(name)) {
+            attr->value = std::move(value);
+        } else {
+            this->attributes.emplaceBack(name, std::move(value));
         }
-        auto attr = makeRc<Attr>(name, value);
-        this->attributes.put(name, attr);
+        _changed();
+    }
+
+    Attr* _findAttribute(AttrName name) {
+        for (auto& attr : this->attributes) {
+            if (attr.name == name)
+                return &attr;
+        }
+        return nullptr;
+    }
+
+    Attr const* _findAttribute(AttrName name) const {
+        for (auto const& attr : this->attributes) {
+            if (attr.name == name)
+                return &attr;
+        }
+        return nullptr;
     }
 
     bool hasAttribute(AttrName name) const {
-        return this->attributes.tryGet(name) != NONE;
+        return _findAttribute(name) != nullptr;
     }
 
     Opt<Str> getAttribute(AttrName name) const {
-        auto attr = this->attributes.tryGet(name);
-        if (attr == NONE)
+        auto const* attr = _findAttribute(name);
+        if (not attr)
             return NONE;
-        return (*attr)->value;
+        return attr->value;
     }
 };
 
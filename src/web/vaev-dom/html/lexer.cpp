@@ -1,5 +1,7 @@
+#include <karm-base/simd.h>
 #include <karm-logger/logger.h>
 
+#include "../tags.h"
 #include "lexer.h"
 
 namespace Vaev::Dom {
@@ -26,6 +28,147 @@ void HtmlLexer::_raise(Str msg) {
     logError("{}: {}", _state, msg);
 }
 
+// MARK: Names -----------------------------------------------------------------
+
+Str HtmlLexer::_intern(Str name) {
+    if (auto atom = _names.access(name))
+        return *atom;
+
+    String atom = name;
+    Str key = atom;
+    _names.put(key, std::move(atom));
+    return key;
+}
+
+// Known names resolve to their static spelling, so they never allocate.
+
+Str HtmlLexer::_takeTagName() {
+    auto id = Html::_tagId(_builder.str());
+    Str name = id ? Html::_tagName(*id) : _intern(_builder.str());
+    _builder.clear();
+    return name;
+}
+
+Str HtmlLexer::_takeAttrName() {
+    auto id = Html::_attrId(_builder.str());
+    Str name = id ? Html::_attrName(*id) : _intern(_builder.str());
+    _builder.clear();
+    return name;
+}
+
+// MARK: Character Runs --------------------------------------------------------
+
+// States that emit most of their input as character tokens, runs of plain
+// text are emitted as a whole instead of going through consume().
+static bool _isTextState(HtmlLexer::State state) {
+    return state == HtmlLexer::DATA or
+           state == HtmlLexer::RCDATA or
+           state == HtmlLexer::RAWTEXT or
+           state == HtmlLexer::SCRIPT_DATA or
+           state == HtmlLexer::PLAINTEXT;
+}
+
+static bool _isTextStop(u8 c) {
+    return c == '<' or c == '&' or c == '\r' or c == '\0';
+}
+
+// The length of the run of plain text at the start of `str`, it stops
+// before the first character any of the text states treat specially.
+// Being ASCII, these never show up inside of a multi-byte sequence.
+static usize _scanText(Str str) {
+    auto const* buf = reinterpret_cast<u8 const*>(str.buf());
+    usize i = 0;
+
+    for (; i + 16 <= str.len(); i += 16) {
+        u8x16 v;
+        memcpy(&v, buf + i, sizeof(v));
+        auto hits = (v == '<') | (v == '&') | (v == '\r') | (v == 0);
+
+        // NOTE: Each hit is a 0xff byte, the first one is found by
+        //       counting the trailing zeros of the two halves.
+        u64 w[2];
+        memcpy(w, &hits, sizeof(w));
+        if (w[0])
+            return i + __builtin_ctzll(w[0]) / 8;
+        if (w[1])
+            return i + 8 + __builtin_ctzll(w[1]) / 8;
+    }
+
+    while (i < str.len() and not _isTextStop(buf[i]))
+        i++;
+
+    return i;
+}
+
+// Trims a run that reaches the end of the chunk back to its last complete
+// rune, so a multi-byte sequence cut by the chunk is carried to the next one.
+static usize _trimRun(Str str, usize len) {
+    if (len != str.len())
+        return len;
+
+    for (usize i = 1; i <= min(len, 4uz); i++) {
+        u8 c = str[len - i];
+        if ((c & 0xc0) == 0x80)
+            continue;
+        if (Utf8::unitLen(c) > i)
+            return len - i;
+        break;
+    }
+
+    return len;
+}
+
+void HtmlLexer::write(Str str) {
+    Cursor<Utf8::Unit> cursor = str;
+
+    if (_partialLen) {
+        usize len = Utf8::unitLen(_partial[0]);
+        while (_partialLen < len and not cursor.ended())
+            _partial[_partialLen++] = cursor.next();
+
+        if (_partialLen < len)
+            return;
+
+        Rune rune;
+        Cursor<Utf8::Unit> partial = sub(_partial, 0, _partialLen);
+        Utf8::decodeUnit(rune, partial);
+        _partialLen = 0;
+        consume(rune);
+    }
+
+    while (not cursor.ended()) {
+        if (_isTextState(_state)) {
+            Str rest = {cursor.buf(), cursor.rem()};
+            usize len = _trimRun(rest, _scanText(rest));
+            if (len) {
+                _emit(cursor.next(len));
+                continue;
+            }
+        }
+
+        // NOTE: The rest of the rune is in the next chunk.
+        if (Utf8::unitLen(*cursor) > cursor.rem()) {
+            while (not cursor.ended())
+                _partial[_partialLen++] = cursor.next();
+            break;
+        }
+
+        Rune rune;
+        Utf8::decodeUnit(rune, cursor);
+        consume(rune);
+    }
+}
+
+void HtmlLexer::end() {
+    if (_partialLen) {
+        _partialLen = 0;
+        consume(U'\uFFFD');
+    }
+
+    // NOTE: '\3' (End of Text) is used here as a placeholder so we are directed to the EOF case
+    consume('\3', true);
+}
+
 void HtmlLexer::consume(Rune rune, bool isEof) {
     logDebugIf(DEBUG_HTML_LEXER, "Lexing '{#c}' {#x} in {}", rune, rune, _state);
 
@@ -322,21 +465,21 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0020 SPACE
         // Switch to the before attribute name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeTagName();
             _switchTo(State::BEFORE_ATTRIBUTE_NAME);
         }
 
         // U+002F SOLIDUS (/)
         // Switch to the self-closing start tag state.
         else if (rune == '/') {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeTagName();
             _switchTo(State::SELF_CLOSING_START_TAG);
         }
 
         // U+003E GREATER-THAN SIGN (>)
         // Switch to the data state. Emit the current tag token.
         else if (rune == '>') {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeTagName();
             _switchTo(State::DATA);
             _emit();
         }
@@ -436,7 +579,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // treat it as per the "anything else" entry below.
         if ((rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') and
             _isAppropriateEndTagToken()) {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeTagName();
             _switchTo(State::BEFORE_ATTRIBUTE_NAME);
         }
 
@@ -445,7 +588,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // then switch to the self-closing start tag state. Otherwise,
         // treat it as per the "anything else" entry below.
         else if (rune == '/' and _isAppropriateEndTagToken()) {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeTagName();
             _switchTo(State::SELF_CLOSING_START_TAG);
         }
 
@@ -454,7 +597,7 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // then switch to the data state and emit the current tag token.
         // Otherwise, treat it as per the "anything else" entry below.
         else if (rune == '>' and _isAppropriateEndTagToken()) {
-            _ensure().name = _builder.take();
+            _ensure().name = _takeTagName();
             _switchTo(State::DATA);
             _emit();
         }
@@ -1350,14 +1493,14 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // Reconsume in the after attribute name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ' or
             rune == '/' or rune == '>' or isEof) {
-            _lastAttr().name = _builder.take();
+            _lastAttr().name = _takeAttrName();
             _reconsumeIn(State::AFTER_ATTRIBUTE_NAME, rune);
         }
 
         // U+003D EQUALS SIGN (=)
         // Switch to the before attribute value state.
         else if (rune == '=') {
-            _lastAttr().name = _builder.take();
+            _lastAttr().name = _takeAttrName();
             _switchTo(State::BEFORE_ATTRIBUTE_VALUE);
         }
 
@@ -2284,14 +2427,14 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         // U+0020 SPACE
         // Switch to the after DOCTYPE name state.
         if (rune == '\t' or rune == '\n' or rune == '\f' or rune == ' ') {
-            _ensure(HtmlToken::DOCTYPE).name = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).name = _takeTagName();
             _switchTo(State::AFTER_DOCTYPE_NAME);
         }
 
         // U+003E GREATER-THAN SIGN (>)
         // Switch to the data state. Emit the current DOCTYPE token.
         else if (rune == '>') {
-            _ensure(HtmlToken::DOCTYPE).name = _builder.take();
+            _ensure(HtmlToken::DOCTYPE).name = _takeTagName();
             _switchTo(State::DATA);
             _emit();
         }
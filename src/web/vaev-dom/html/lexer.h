@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/map.h>
 #include <karm-io/emit.h>
 
 namespace Vaev::Dom {
@@ -11,6 +12,7 @@ namespace Vaev::Dom {
     TOKEN(END_TAG)           \
     TOKEN(COMMENT)           \
     TOKEN(CHARACTER)         \
+    TOKEN(CHARACTER_RUN)     \
     TOKEN(END_OF_FILE)
 
 struct HtmlToken {
@@ -23,15 +25,21 @@ struct HtmlToken {
             _LEN,
     };
 
+    // NOTE: Tag and attribute names are interned by the lexer, they point
+    //       either to the static spelling of a known HTML name or into the
+    //       name table of the lexer.
     struct Attr {
-        String name{};
+        Str name = "";
         String value{};
     };
 
     Type type = NIL;
-    String name = ""s;
+    Str name = "";
     Rune rune = '\0';
     String data = ""s;
+    // NOTE: The text of a CHARACTER_RUN token points into the input of the
+    //       lexer, it's only valid while the token is being accepted.
+    Str chars = "";
     String publicIdent = ""s;
     String systemIdent = ""s;
     Vec<Attr> attrs = {};
@@ -46,6 +54,8 @@ struct HtmlToken {
             e(" rune='{#c}'", rune);
         if (data)
             e(" data={#}", data);
+        if (chars)
+            e(" chars={#}", chars);
         if (publicIdent)
             e(" publicIdent={#}", publicIdent);
         if (systemIdent)
@@ -102,6 +112,13 @@ struct HtmlLexer {
 
     Opt<usize> matchedCharReferenceNoSemiColon;
 
+    // NOTE: The keys point into the strings they map to.
+    Map<Str, String> _names;
+
+    // The start of a rune that was cut off at the end of the last write.
+    Array<Utf8::Unit, 4> _partial = {};
+    usize _partialLen = 0;
+
     HtmlToken& _begin(HtmlToken::Type type) {
         _token = HtmlToken{.type = type};
         return *_token;
@@ -132,6 +149,17 @@ struct HtmlLexer {
         _emit();
     }
 
+    void _emit(Str chars) {
+        _begin(HtmlToken::CHARACTER_RUN).chars = chars;
+        _emit();
+    }
+
+    Str _intern(Str name);
+
+    Str _takeTagName();
+
+    Str _takeAttrName();
+
     void _beginAttribute() {
         _ensure().attrs.emplaceBack();
     }
@@ -183,6 +211,12 @@ struct HtmlLexer {
     }
 
     void consume(Rune rune, bool isEof = false);
+
+    // Feed the next chunk of the input, chunks can be cut anywhere, even in
+    // the middle of a rune.
+    void write(Str str);
+
+    void end();
 };
 
 #undef FOREACH_TOKEN
@@ -245,6 +245,8 @@ Gc::Ref<Element> HtmlParser::_insertAForeignElement(HtmlToken const& t, Ns ns, b
     // 3. If onlyAddToElementStack is false, then run insert an element at the adjusted insertion location with element.
     if (not onlyAddToElementStack) {
         location.insert(el);
+        if (_onInsert)
+            (*_onInsert)(el);
     }
 
     // 4. Push element onto the stack of open elements so that it is the new current node.
@@ -260,31 +262,37 @@ Gc::Ref<Element> HtmlParser::_insertHtmlElement(HtmlToken const& t) {
 }
 
 // https://html.spec.whatwg.org/multipage/parsing.html#insert-a-character
-void HtmlParser::_insertACharacter(Rune c) {
+Gc::Ptr<Text> HtmlParser::_textForInsertion() {
     // 2. Let the adjusted insertion location be the appropriate place for inserting a node.
     auto location = _apropriatePlaceForInsertingANode();
 
     // 3. If the adjusted insertion location is inside a Document node, then ignore the token.
     if (location.parent->nodeType() == NodeType::DOCUMENT)
-        return;
+        return nullptr;
 
     // 4. If there is a Text node immediately before the adjusted insertion
     //    location, then append data to that Text node's data.
     auto lastChild = location.lastChild();
-    if (lastChild and lastChild->nodeType() == NodeType::TEXT) {
-        auto text = lastChild->is<Text>();
-        text->appendData(c);
-    }
+    if (lastChild and lastChild->nodeType() == NodeType::TEXT)
+        return lastChild->is<Text>();
 
     // Otherwise, create a new Text node whose data is data and whose node
     //            document is the same as that of the element in which the
     //            adjusted insertion location finds itself, and insert the
     //            newly created node at the adjusted insertion location.
-    else {
-        auto text = _heap.alloc<Text>(""s);
+    auto text = _heap.alloc<Text>(""s);
+    location.insert(text);
+    return text;
+}
+
+void HtmlParser::_insertACharacter(Rune c) {
+    if (auto text = _textForInsertion())
         text->appendData(c);
-        location.insert(text);
-    }
+}
+
+void HtmlParser::_insertCharacters(Str chars) {
+    if (auto text = _textForInsertion())
+        text->appendData(chars);
 }
 
 // https://html.spec.whatwg.org/multipage/parsing.html#insert-a-comment
@@ -614,7 +622,7 @@ void HtmlParser::_handleBeforeHead(HtmlToken const& t) {
     else {
         HtmlToken headToken;
         headToken.type = HtmlToken::START_TAG;
-        headToken.name = String{"head"};
+        headToken.name = "head"s;
         _headElement = _insertHtmlElement(headToken);
         _switchTo(Mode::IN_HEAD);
         accept(t);
@@ -827,7 +835,7 @@ void HtmlParser::_handleAfterHead(HtmlToken const& t) {
     auto anythingElse = [&] {
         HtmlToken bodyToken;
         bodyToken.type = HtmlToken::START_TAG;
-        bodyToken.name = String{"body"};
+        bodyToken.name = "body"s;
         _insertHtmlElement(bodyToken);
         _switchTo(Mode::IN_BODY);
         accept(t);
@@ -1434,7 +1442,7 @@ void HtmlParser::_handleInTable(HtmlToken const& t) {
         // Insert an HTML element for a "colgroup" start tag token with no attributes, then switch the insertion mode to "in column group".
         HtmlToken colGroupToken;
         colGroupToken.type = HtmlToken::START_TAG;
-        colGroupToken.name = String{"colgroup"};
+        colGroupToken.name = "colgroup"s;
         _insertAForeignElement(colGroupToken, Vaev::HTML);
         _switchTo(Mode::IN_COLUMN_GROUP);
 
@@ -2162,7 +2170,7 @@ void HtmlParser::_handleInForeignContent(HtmlToken const& t) {
         // Run these steps:
 
         // If node's tag name, converted to ASCII lowercase, is not the same as the tag name of the token, then this is a parse error.
-        if (not eqCi(_currentElement()->tagName.name(), t.name.str())) {
+        if (not eqCi(_currentElement()->tagName.name(), t.name)) {
             _raise();
         }
 
@@ -2174,7 +2182,7 @@ void HtmlParser::_handleInForeignContent(HtmlToken const& t) {
                 return;
 
             // If node's tag name, converted to ASCII lowercase, is the same as the tag name of the token,
-            if (eqCi(node->tagName.name(), t.name.str())) {
+            if (eqCi(node->tagName.name(), t.name)) {
                 // pop elements from the stack of open elements until node has been popped from the stack, and then return.
                 while (_currentElement() != node) {
                     _openElements.popBack();
@@ -2305,8 +2313,42 @@ void HtmlParser::_acceptIn(Mode mode, HtmlToken const& t) {
     }
 }
 
+// NOSPEC: Runs of text from the lexer are inserted as a whole in the modes
+//         where most of the text of a document ends up, everywhere else
+//         they are split back into character tokens.
+void HtmlParser::_acceptRun(Str chars) {
+    bool inHtml = isEmpty(_openElements) or
+                  _currentElement()->tagName.ns == HTML;
+
+    if (inHtml and _insertionMode == Mode::TEXT) {
+        _insertCharacters(chars);
+        return;
+    }
+
+    if (inHtml and _insertionMode == Mode::IN_BODY) {
+        _reconstructActiveFormattingElements();
+        _insertCharacters(chars);
+
+        for (auto c : chars) {
+            if (c != '\t' and c != '\n' and c != '\f' and c != ' ') {
+                _framesetOk = false;
+                break;
+            }
+        }
+        return;
+    }
+
+    for (auto rune : iterRunes(chars))
+        accept(HtmlToken{.type = HtmlToken::CHARACTER, .rune = rune});
+}
+
 // https://html.spec.whatwg.org/multipage/parsing.html#tree-construction
 void HtmlParser::accept(HtmlToken const& t) {
+    if (t.type == HtmlToken::CHARACTER_RUN) {
+        _acceptRun(t.chars);
+        return;
+    }
+
     // If the stack of open elements is empty
     // If the adjusted current node is an element in the HTML namespace
     // If the adjusted current node is a MathML text integration point and the token is a start tag whose tag name is neither "mglyph" nor "malignmark"
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/func.h>
 #include <karm-gc/heap.h>
 
 #include "../document.h"
@@ -62,6 +63,10 @@ struct HtmlParser : public HtmlSink {
 
     Vec<HtmlToken> _pendingTableCharacterTokens;
 
+    // Called for every element as soon as it's inserted into the tree, so
+    // what it refers to can be fetched while the rest is being parsed.
+    Opt<Func<void(Gc::Ref<Element>)>> _onInsert = NONE;
+
     HtmlParser(Gc::Heap& heap, Gc::Ref<Document> document)
         : _heap(heap), _document(document) {
         _lexer.bind(*this);
@@ -128,8 +133,12 @@ struct HtmlParser : public HtmlSink {
 
     Gc::Ref<Element> _insertHtmlElement(HtmlToken const& t);
 
+    Gc::Ptr<Text> _textForInsertion();
+
     void _insertACharacter(Rune c);
 
+    void _insertCharacters(Str chars);
+
     void _insertAComment(HtmlToken const& t);
 
     void _resetTheInsertionModeAppropriately();
@@ -234,13 +243,28 @@ struct HtmlParser : public HtmlSink {
 
     void _acceptIn(Mode mode, HtmlToken const& t);
 
+    void _acceptRun(Str chars);
+
     void accept(HtmlToken const& t) override;
 
+    // Parse a whole document.
     void write(Str str) {
-        for (auto r : iterRunes(str))
-            _lexer.consume(r);
-        // NOTE: '\3' (End of Text) is used here as a placeholder so we are directed to the EOF case
-        _lexer.consume('\3', true);
+        feed(str);
+        end();
+    }
+
+    // Parse the next chunk of a document that is still arriving, the tree
+    // is kept up to date as it goes.
+    void feed(Str chunk) {
+        _lexer.write(chunk);
+    }
+
+    void end() {
+        _lexer.end();
+    }
+
+    void onInsert(Func<void(Gc::Ref<Element>)> f) {
+        _onInsert = std::move(f);
     }
 };
 
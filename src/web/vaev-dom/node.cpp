@@ -20,6 +20,17 @@ Gc::Ptr<Document> Node::ownerDocument() {
     return nullptr;
 }
 
+void Node::_changed(bool data) {
+    Gc::Ptr<Node> curr = *this;
+    while (curr) {
+        if (auto doc = curr->is<Document>()) {
+            doc->_record(data ? Gc::Ptr<Node>{*this} : nullptr);
+            return;
+        }
+        curr = curr->parentNode();
+    }
+}
+
 void Node::repr(Io::Emit& e) const {
     e("({}", nodeType());
     _repr(e);
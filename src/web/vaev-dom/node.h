@@ -48,6 +48,10 @@ struct Node : public Tree<Node> {
 
     Gc::Ptr<Document> ownerDocument();
 
+    // Let the owner document know it changed, see Document::generation().
+    // `data` is set when only the character data of this node changed.
+    void _changed(bool data = false);
+
     virtual void _repr(Io::Emit&) const {}
 
     void repr(Io::Emit& e) const;
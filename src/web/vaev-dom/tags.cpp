@@ -1,5 +1,118 @@
 #include "tags.h"
 
+namespace Vaev {
+
+// MARK: Name Lookup -----------------------------------------------------------
+
+// The known spellings of each namespace are looked up in a perfect hash table
+// built at compile time (hash and displace): the hash of the name picks a
+// bucket, the seed of that bucket then picks a slot that no other known name
+// lands in, so a lookup hashes the name once and compares a single spelling.
+
+static constexpr u64 _hashName(Str name) {
+    // FNV-1a
+    u64 h = 0xcbf29ce484222325;
+    for (usize i = 0; i < name.len(); i++) {
+        h ^= static_cast<u8>(name[i]);
+        h *= 0x100000001b3;
+    }
+    return h;
+}
+
+static constexpr usize _nameSlot(u64 h, u64 seed, usize cap) {
+    u64 x = h ^ (seed * 0x9e3779b97f4a7c15);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    return x & (cap - 1);
+}
+
+// Called when no seed can place a bucket, which fails the constant
+// evaluation of the table (e.g. the same name is listed twice).
+void _unplaceableName();
+
+template <usize N>
+struct _NameTable {
+    static constexpr usize BUCKETS = N / 4 + 1;
+
+    static constexpr usize SLOTS = [] {
+        usize cap = 1;
+        while (cap < N * 2)
+            cap *= 2;
+        return cap;
+    }();
+
+    static constexpr u16 EMPTY = 0xffff;
+
+    Array<Str, N> names;
+    Array<u16, BUCKETS> seeds{};
+    Array<u16, SLOTS> slots{};
+
+    constexpr _NameTable(Array<Str, N> names)
+        : names(names) {
+        for (auto& slot : slots)
+            slot = EMPTY;
+
+        Array<u64, N> hashes{};
+        Array<usize, BUCKETS> sizes{};
+        for (usize i = 0; i < N; i++) {
+            hashes[i] = _hashName(names[i]);
+            sizes[hashes[i] % BUCKETS]++;
+        }
+
+        // Place the biggest buckets first, while most slots are still free.
+        Array<bool, BUCKETS> placed{};
+        for (usize round = 0; round < BUCKETS; round++) {
+            usize bucket = 0;
+            usize size = 0;
+            for (usize b = 0; b < BUCKETS; b++) {
+                if (not placed[b] and sizes[b] >= size) {
+                    bucket = b;
+                    size = sizes[b];
+                }
+            }
+            placed[bucket] = true;
+            _place(bucket, hashes);
+        }
+    }
+
+    constexpr void _place(usize bucket, Array<u64, N> const& hashes) {
+        for (u16 seed = 0; seed < EMPTY; seed++) {
+            Array<bool, SLOTS> taken{};
+            bool fits = true;
+            for (usize i = 0; i < N and fits; i++) {
+                if (hashes[i] % BUCKETS != bucket)
+                    continue;
+                usize slot = _nameSlot(hashes[i], seed, SLOTS);
+                fits = slots[slot] == EMPTY and not taken[slot];
+                taken[slot] = true;
+            }
+
+            if (not fits)
+                continue;
+
+            seeds[bucket] = seed;
+            for (usize i = 0; i < N; i++) {
+                if (hashes[i] % BUCKETS == bucket)
+                    slots[_nameSlot(hashes[i], seed, SLOTS)] = i;
+            }
+            return;
+        }
+
+        _unplaceableName();
+    }
+
+    Opt<usize> lookup(Str name) const {
+        u64 h = _hashName(name);
+        usize i = slots[_nameSlot(h, seeds[h % BUCKETS], SLOTS)];
+        if (i == EMPTY or names[i] != name)
+            return NONE;
+        return i;
+    }
+};
+
+} // namespace Vaev
+
 namespace Vaev::Html {
 
 Str _tagName(TagId id) {
@@ -26,25 +139,30 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
-#define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+static constexpr _NameTable _TAGS{Array{
+#define TAG(_, NAME) Str{#NAME},
 #include "defs/ns-html-tag-names.inc"
 #undef TAG
+}};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    auto i = _TAGS.lookup(name);
+    if (not i)
+        return NONE;
+    return static_cast<TagId>(*i);
 }
 
-Opt<AttrId> _attrId(Str name) {
-#define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+static constexpr _NameTable _ATTRS{Array{
+#define ATTR(_, NAME) Str{#NAME},
 #include "defs/ns-html-attr-names.inc"
 #undef ATTR
+}};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    auto i = _ATTRS.lookup(name);
+    if (not i)
+        return NONE;
+    return static_cast<AttrId>(*i);
 }
 
 } // namespace Vaev::Html
@@ -75,25 +193,30 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
-#define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+static constexpr _NameTable _TAGS{Array{
+#define TAG(_, NAME) Str{#NAME},
 #include "defs/ns-mathml-tag-names.inc"
 #undef TAG
+}};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    auto i = _TAGS.lookup(name);
+    if (not i)
+        return NONE;
+    return static_cast<TagId>(*i);
 }
 
-Opt<AttrId> _attrId(Str name) {
-#define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+static constexpr _NameTable _ATTRS{Array{
+#define ATTR(_, NAME) Str{#NAME},
 #include "defs/ns-mathml-attr-names.inc"
 #undef ATTR
+}};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    auto i = _ATTRS.lookup(name);
+    if (not i)
+        return NONE;
+    return static_cast<AttrId>(*i);
 }
 
 } // namespace Vaev::MathMl
@@ -124,25 +247,30 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
-#define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+static constexpr _NameTable _TAGS{Array{
+#define TAG(_, NAME) Str{#NAME},
 #include "defs/ns-svg-tag-names.inc"
 #undef TAG
+}};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    auto i = _TAGS.lookup(name);
+    if (not i)
+        return NONE;
+    return static_cast<TagId>(*i);
 }
 
-Opt<AttrId> _attrId(Str name) {
-#define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+static constexpr _NameTable _ATTRS{Array{
+#define ATTR(_, NAME) Str{#NAME},
 #include "defs/ns-svg-attr-names.inc"
 #undef ATTR
+}};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    auto i = _ATTRS.lookup(name);
+    if (not i)
+        return NONE;
+    return static_cast<AttrId>(*i);
 }
 
 } // namespace Vaev::Svg
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/hash.h>
 #include <karm-base/string.h>
 #include <karm-io/emit.h>
 #include <karm-logger/logger.h>
@@ -193,6 +194,10 @@ struct TagName {
 
     constexpr bool operator==(TagName const& other) const = default;
 
+    Hash hash() const {
+        return hashCombine(Karm::hash(id), Karm::hash(ns._id));
+    }
+
     void repr(Io::Emit& e) const {
         e("{}", name());
     }
@@ -259,6 +264,10 @@ struct AttrName {
 
     constexpr bool operator==(AttrName const& other) const = default;
 
+    Hash hash() const {
+        return hashCombine(Karm::hash(id), Karm::hash(ns._id));
+    }
+
     void repr(Io::Emit& e) const {
         e("{}", name());
     }
@@ -100,6 +100,159 @@ test$("parse-text") {
     return Ok();
 }
 
+test$("parse-long-text") {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    Dom::HtmlParser parser{gc, dom};
+
+    parser.write("<html><body>Ünïcödé text longer than a few words &amp; lines\r\nof it<b>and some more of it in bold</b></body></html>");
+
+    auto html = dom->firstChild()->is<Element>();
+    expectNe$(html, nullptr);
+
+    auto body = html->firstChild()->nextSibling()->is<Element>();
+    expectNe$(body, nullptr);
+    expect$(body->tagName == Html::BODY);
+    expect$(body->countChildren() == 2);
+
+    auto text = body->firstChild()->is<Text>();
+    expectNe$(text, nullptr);
+    expect$(text->data() == "Ünïcödé text longer than a few words & lines\r\nof it");
+
+    auto b = body->lastChild()->is<Element>();
+    expectNe$(b, nullptr);
+    expect$(b->tagName == Html::B);
+
+    auto boldText = b->firstChild()->is<Text>();
+    expectNe$(boldText, nullptr);
+    expect$(boldText->data() == "and some more of it in bold");
+
+    return Ok();
+}
+
+test$("parse-in-chunks") {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    Dom::HtmlParser parser{gc, dom};
+
+    // Feed the document one byte at a time, so every rune, tag and
+    // character reference is cut between two chunks.
+    Str input = "<html><body><p class=\"intro\" id=\"café\">Ünïcödé &amp; 日本語 😀</p></body></html>";
+    for (usize i = 0; i < input.len(); i++)
+        parser.feed(sub(input, i, i + 1));
+    parser.end();
+
+    auto html = dom->firstChild()->is<Element>();
+    expectNe$(html, nullptr);
+
+    auto body = html->lastChild()->is<Element>();
+    expectNe$(body, nullptr);
+    expect$(body->tagName == Html::BODY);
+
+    auto p = body->firstChild()->is<Element>();
+    expectNe$(p, nullptr);
+    expect$(p->tagName == Html::P);
+    expect$(p->classList.contains("intro"s));
+    expectEq$(p->getAttribute(Html::ID_ATTR), "café"s);
+
+    auto text = p->firstChild()->is<Text>();
+    expectNe$(text, nullptr);
+    expectEq$(text->data(), "Ünïcödé & 日本語 😀"s);
+
+    return Ok();
+}
+
+test$("parse-text-run-split-rune") {
+    // Cut the document inside of a 2, 3 and 4 byte rune in the middle
+    // of a text run, the runs on either side must not keep the halves.
+    Str input = "<p>plain é plain € plain 😀 plain</p>";
+    for (usize i = 1; i < input.len(); i++) {
+        if ((input[i] & 0xc0) != 0x80)
+            continue;
+
+        Gc::Heap gc;
+        auto dom = gc.alloc<Dom::Document>(Mime::Url());
+        Dom::HtmlParser parser{gc, dom};
+
+        parser.feed(sub(input, 0, i));
+        parser.feed(sub(input, i, input.len()));
+        parser.end();
+
+        auto html = dom->firstChild()->is<Element>();
+        expectNe$(html, nullptr);
+
+        auto body = html->lastChild()->is<Element>();
+        expectNe$(body, nullptr);
+
+        auto p = body->firstChild()->is<Element>();
+        expectNe$(p, nullptr);
+
+        auto text = p->firstChild()->is<Text>();
+        expectNe$(text, nullptr);
+        expectEq$(text->data(), "plain é plain € plain 😀 plain"s);
+    }
+
+    return Ok();
+}
+
+test$("text-append-bumps-generation") {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    Dom::HtmlParser parser{gc, dom};
+
+    parser.write("<p>text</p>"s);
+
+    auto html = dom->firstChild()->is<Element>();
+    expectNe$(html, nullptr);
+
+    auto p = html->lastChild()->firstChild()->is<Element>();
+    expectNe$(p, nullptr);
+
+    auto text = p->firstChild()->is<Text>();
+    expectNe$(text, nullptr);
+
+    usize before = dom->generation();
+    text->appendData(" more"s);
+    expectNe$(dom->generation(), before);
+
+    before = dom->generation();
+    text->appendData('!');
+    expectNe$(dom->generation(), before);
+    expectEq$(text->data(), "text more!"s);
+
+    return Ok();
+}
+
+test$("changed-data") {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    Dom::HtmlParser parser{gc, dom};
+
+    parser.write("<p>text</p>"s);
+
+    auto html = dom->firstChild()->is<Element>();
+    expectNe$(html, nullptr);
+
+    auto p = html->lastChild()->firstChild()->is<Element>();
+    expectNe$(p, nullptr);
+
+    auto text = p->firstChild()->is<Text>();
+    expectNe$(text, nullptr);
+
+    usize generation = dom->generation();
+    text->appendData(" more"s);
+    text->appendData('!');
+
+    auto changes = dom->changedData(generation);
+    expect$(changes);
+    expectEq$(changes->len(), 1uz);
+
+    p->setAttribute(Html::ID_ATTR, "p"s);
+    expect$(not dom->changedData(generation));
+
+    return Ok();
+}
+
 test$("parse-title") {
     Gc::Heap gc;
     auto dom = gc.alloc<Dom::Document>(Mime::Url());
@@ -0,0 +1,53 @@
+#include <karm-test/macros.h>
+#include <vaev-dom/tags.h>
+
+namespace Vaev::Dom::Tests {
+
+test$("tags-lookup-known-names") {
+#define TAG(IDENT, _) \
+    expectEq$(TagName::tryMake(Html::IDENT.name(), HTML), Html::IDENT);
+#include <vaev-dom/defs/ns-html-tag-names.inc>
+#undef TAG
+
+#define ATTR(IDENT, _) \
+    expectEq$(AttrName::tryMake(Html::IDENT##_ATTR.name(), HTML), Html::IDENT##_ATTR);
+#include <vaev-dom/defs/ns-html-attr-names.inc>
+#undef ATTR
+
+#define TAG(IDENT, _) \
+    expectEq$(TagName::tryMake(Svg::IDENT.name(), SVG), Svg::IDENT);
+#include <vaev-dom/defs/ns-svg-tag-names.inc>
+#undef TAG
+
+#define ATTR(IDENT, _) \
+    expectEq$(AttrName::tryMake(Svg::IDENT##_ATTR.name(), SVG), Svg::IDENT##_ATTR);
+#include <vaev-dom/defs/ns-svg-attr-names.inc>
+#undef ATTR
+
+#define TAG(IDENT, _) \
+    expectEq$(TagName::tryMake(MathMl::IDENT.name(), MathML), MathMl::IDENT);
+#include <vaev-dom/defs/ns-mathml-tag-names.inc>
+#undef TAG
+
+#define ATTR(IDENT, _) \
+    expectEq$(AttrName::tryMake(MathMl::IDENT##_ATTR.name(), MathML), MathMl::IDENT##_ATTR);
+#include <vaev-dom/defs/ns-mathml-attr-names.inc>
+#undef ATTR
+
+    return Ok();
+}
+
+test$("tags-lookup-unknown-names") {
+    expectEq$(TagName::tryMake("my-element", HTML), NONE);
+    expectEq$(TagName::tryMake("", HTML), NONE);
+    expectEq$(TagName::tryMake("DIV", HTML), NONE);
+    expectEq$(TagName::tryMake("di", HTML), NONE);
+    expectEq$(TagName::tryMake("divv", HTML), NONE);
+    expectEq$(AttrName::tryMake("data-foo", HTML), NONE);
+    expectEq$(AttrName::tryMake("viewbox", SVG), NONE);
+    expectEq$(AttrName::tryMake("viewBox", SVG), Svg::VIEW_BOX_ATTR);
+
+    return Ok();
+}
+
+} // namespace Vaev::Dom::Tests
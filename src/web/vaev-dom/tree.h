@@ -1,7 +1,7 @@
 #pragma once
 
 #include <karm-base/box.h>
-#include <karm-gc/ptr.h>
+#include <karm-gc/heap.h>
 #include <karm-meta/nocopy.h>
 
 namespace Vaev::Dom {
@@ -55,6 +55,16 @@ struct Tree : Meta::Pinned {
 
     Gc::Ptr<Node> nextSibling() const { return _nextSibling; }
 
+    // Garbage Collection ------------------------------------------------------
+
+    void trace(Gc::Visitor& v) const {
+        v.visit(_parent);
+        v.visit(_firstChild);
+        v.visit(_lastChild);
+        v.visit(_nextSibling);
+        v.visit(_prevSibling);
+    }
+
     // Insertion & Deletion ----------------------------------------------------
 
     void appendChild(Gc::Ptr<Node> node) {
@@ -68,6 +78,8 @@ struct Tree : Meta::Pinned {
         _lastChild = node;
         if (!_firstChild)
             _firstChild = _lastChild;
+
+        static_cast<Node*>(this)->_changed();
     }
 
     void prependChild(Gc::Ptr<Node> node) {
@@ -81,6 +93,8 @@ struct Tree : Meta::Pinned {
         _firstChild = node;
         if (!_lastChild)
             _lastChild = _firstChild;
+
+        static_cast<Node*>(this)->_changed();
     }
 
     void insertBefore(Node* node, Node* child) {
@@ -105,6 +119,8 @@ struct Tree : Meta::Pinned {
         child->_prevSibling = node;
 
         node->_parent = static_cast<Node*>(this);
+
+        static_cast<Node*>(this)->_changed();
     }
 
     void insertAfter(Node* node, Node* child) {
@@ -126,6 +142,8 @@ struct Tree : Meta::Pinned {
         child->_nextSibling = node;
 
         node->_parent = static_cast<Node*>(this);
+
+        static_cast<Node*>(this)->_changed();
     }
 
     void removeChild(Node* node) {
@@ -150,6 +168,8 @@ struct Tree : Meta::Pinned {
         node->_nextSibling = nullptr;
         node->_prevSibling = nullptr;
         node->_parent = nullptr;
+
+        static_cast<Node*>(this)->_changed();
     }
 
     // Iteration ---------------------------------------------------------------
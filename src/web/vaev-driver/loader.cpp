@@ -1,10 +1,15 @@
 module;
 
+#include <karm-async/promise.h>
+#include <karm-async/run.h>
+#include <karm-base/lru.h>
+#include <karm-base/set.h>
 #include <karm-gc/heap.h>
 #include <karm-mime/mime.h>
 #include <karm-mime/url.h>
 #include <karm-sys/dir.h>
 #include <karm-sys/file.h>
+#include <karm-text/book.h>
 #include <vaev-dom/document.h>
 #include <vaev-dom/html/parser.h>
 #include <vaev-dom/xml/parser.h>
@@ -17,7 +22,14 @@ import Karm.Aio;
 
 namespace Vaev::Driver {
 
-Async::Task<Gc::Ref<Dom::Document>> _loadDocumentAsync(Gc::Heap& heap, Mime::Url url, Rc<Http::Response> resp) {
+static constexpr usize BODY_CHUNK_SIZE = 16 * 1024;
+
+// Called with a document that is still being parsed, every time a chunk of
+// it has been added to the tree, so it can be laid out before all of it
+// has arrived.
+export using OnProgress = SharedFunc<void(Gc::Ref<Dom::Document>)>;
+
+Async::Task<Gc::Ref<Dom::Document>> _loadDocumentAsync(Gc::Heap& heap, Mime::Url url, Rc<Http::Response> resp, Func<void(Gc::Ref<Dom::Element>)> onInsert, Opt<OnProgress> const& onProgress) {
     auto dom = heap.alloc<Dom::Document>(url);
 
     auto mime = resp->header.contentType();
@@ -37,14 +49,29 @@ Async::Task<Gc::Ref<Dom::Document>> _loadDocumentAsync(Gc::Heap& heap, Mime::Url
         co_return Error::invalidInput("cannot determine MIME type");
 
     auto respBody = resp->body.unwrap();
-    auto buf = co_trya$(Aio::readAllUtf8Async(*respBody));
 
     if (mime->is("text/html"_mime)) {
+        // NOTE: The document is parsed as the body arrives, rather than
+        //       once all of it has been received.
         Dom::HtmlParser parser{heap, dom};
-        parser.write(buf);
+        parser.onInsert(std::move(onInsert));
+        Array<Utf8::Unit, BODY_CHUNK_SIZE> buf = {};
+        while (true) {
+            usize read = co_trya$(respBody->readAsync(buf.mutBytes()));
+            if (read == 0)
+                break;
+            parser.feed(sub(buf, 0, read));
+            if (onProgress)
+                (*onProgress)(dom);
+        }
+        parser.end();
 
         co_return Ok(dom);
-    } else if (mime->is("application/xhtml+xml"_mime)) {
+    }
+
+    auto buf = co_trya$(Aio::readAllUtf8Async(*respBody));
+
+    if (mime->is("application/xhtml+xml"_mime)) {
         Io::SScan scan{buf};
         Dom::XmlParser parser{heap};
         co_try$(parser.parse(scan, HTML, *dom));
@@ -81,60 +108,220 @@ export Async::Task<Gc::Ref<Dom::Document>> viewSourceAsync(Gc::Heap& heap, Http:
     co_return Ok(dom);
 }
 
-export Async::Task<Gc::Ref<Dom::Document>> fetchDocumentAsync(Gc::Heap& heap, Http::Client& client, Mime::Url const& url) {
-    if (url.scheme == "about") {
-        if (url.path.str() == "blank")
-            co_return co_await fetchDocumentAsync(heap, client, "bundle://vaev-driver/blank.xhtml"_url);
+// MARK: Stylesheets ----------------------------------------------------------
 
-        if (url.path.str() == "start")
-            co_return co_await fetchDocumentAsync(heap, client, "bundle://vaev-driver/start-page.xhtml"_url);
+// Parsed stylesheets are shared by every render and print job of the
+// process. They are keyed by their content as well as their url, so a sheet
+// that changed is parsed again while identical inline sheets are not.
+struct _SheetKey {
+    String url;
+    Hash content;
+    Style::Origin origin;
+
+    bool operator==(_SheetKey const&) const = default;
+
+    Hash hash() const {
+        return hashCombine(hashCombine(Karm::hash(url), content), Karm::hash(origin));
     }
+};
 
-    auto resp = co_trya$(client.getAsync(url));
-    co_return co_await _loadDocumentAsync(heap, url, resp);
+static constexpr usize SHEET_CACHE_SIZE = 256;
+
+static Lru<_SheetKey, Rc<Style::StyleSheet>>& _parsedSheets() {
+    static Lru<_SheetKey, Rc<Style::StyleSheet>> sheets{SHEET_CACHE_SIZE};
+    return sheets;
+}
+
+// The last sheet fetched along with a document, for the linked sheets that
+// can't be read again when it's rendered, eg. those served over http.
+static Lru<String, Rc<Style::StyleSheet>>& _fetchedSheets() {
+    static Lru<String, Rc<Style::StyleSheet>> sheets{SHEET_CACHE_SIZE};
+    return sheets;
+}
+
+static Rc<Style::StyleSheet> _parseStylesheet(Mime::Url const& url, Str text, Style::Origin origin) {
+    _SheetKey key{url.str(), hash(text), origin};
+    return _parsedSheets().access(key, [&] {
+        Io::SScan s{text};
+        return makeRc<Style::StyleSheet>(Style::StyleSheet::parse(s, url, origin));
+    });
 }
 
-export Res<Style::StyleSheet> fetchStylesheet(Mime::Url url, Style::Origin origin) {
+export Res<Rc<Style::StyleSheet>> fetchStylesheet(Mime::Url url, Style::Origin origin) {
     auto file = try$(Sys::File::open(url));
     auto buf = try$(Io::readAllUtf8(file));
-    Io::SScan s{buf};
-    return Ok(Style::StyleSheet::parse(s, url, origin));
+    return Ok(_parseStylesheet(url, buf, origin));
+}
+
+static Async::Task<Rc<Style::StyleSheet>> _fetchStylesheetAsync(Http::Client& client, Mime::Url url) {
+    auto resp = co_trya$(client.getAsync(url));
+    auto code = toUnderlyingType(resp->code);
+    if (code < 200 or code >= 300)
+        co_return Error::invalidInput("stylesheet request failed");
+    if (not resp->body)
+        co_return Error::invalidInput("response body is missing");
+    auto buf = co_trya$(Aio::readAllUtf8Async(*resp->body.unwrap()));
+    co_return Ok(_parseStylesheet(url, buf, Style::Origin::AUTHOR));
+}
+
+static Opt<Mime::Url> _linkedStylesheetUrl(Gc::Ref<Dom::Element> el) {
+    if (el->tagName != Html::LINK or el->getAttribute(Html::REL_ATTR) != "stylesheet"s)
+        return NONE;
+
+    auto href = el->getAttribute(Html::HREF_ATTR);
+    if (not href) {
+        logWarn("link element missing href attribute");
+        return NONE;
+    }
+
+    auto url = Mime::Url::resolveReference(el->baseURI(), Mime::parseUrlOrPath(*href));
+    if (not url) {
+        logWarn("failed to resolve stylesheet url: {}", url);
+        return NONE;
+    }
+
+    return url.take();
+}
+
+static void _collectLinkedStylesheets(Gc::Ref<Dom::Node> node, Vec<Mime::Url>& urls) {
+    if (auto el = node->is<Dom::Element>()) {
+        if (auto url = _linkedStylesheetUrl(*el)) {
+            urls.pushBack(url.take());
+            return;
+        }
+    }
+
+    for (auto child = node->firstChild(); child; child = child->nextSibling())
+        _collectLinkedStylesheets(*child, urls);
+}
+
+// Fetches the stylesheets linked from a document as soon as they are found,
+// so they download in parallel, and while the rest of the document is
+// still being parsed.
+struct _SheetFetcher {
+    Http::Client& _client;
+    Set<String> _started = {};
+    usize _pending = 0;
+    Opt<Async::Promise<>> _done = NONE;
+
+    _SheetFetcher(Http::Client& client)
+        : _client(client) {}
+
+    static void fetch(Rc<_SheetFetcher> self, Mime::Url url) {
+        auto key = url.str();
+        if (self->_started.has(key))
+            return;
+        self->_started.put(key);
+
+        self->_pending++;
+        Async::detach(_fetchStylesheetAsync(self->_client, url), [self, url](Res<Rc<Style::StyleSheet>> sheet) mutable {
+            if (sheet) {
+                auto& cached = _fetchedSheets().access(url.str(), [&] {
+                    return sheet.unwrap();
+                });
+                cached = sheet.unwrap();
+            } else {
+                logWarn("failed to fetch stylesheet from {}: {}", url, sheet.none());
+            }
+
+            if (--self->_pending == 0 and self->_done)
+                self->_done.take().resolve(Ok());
+        });
+    }
+
+    // Wait for every fetch started so far.
+    static Async::Task<> waitAsync(Rc<_SheetFetcher> self) {
+        if (self->_pending == 0)
+            co_return Ok();
+        self->_done = Async::Promise<>{};
+        auto future = self->_done->future();
+        co_return co_await future;
+    }
+};
+
+// The user agent stylesheets and the installed fonts are the same for every
+// document, so they are only loaded once.
+export Rc<Style::StyleSheet> fetchUserAgentStylesheet(Mime::Url url) {
+    static Vec<Rc<Style::StyleSheet>> sheets;
+    for (auto& sheet : sheets)
+        if (sheet->href == url)
+            return sheet;
+
+    auto sheet = fetchStylesheet(url, Style::Origin::USER_AGENT)
+                     .take("user agent stylesheet not available");
+    sheets.pushBack(sheet);
+    return sheet;
+}
+
+export Text::FontBook const& systemFontBook() {
+    static Text::FontBook fontBook = [] {
+        Text::FontBook res;
+        if (not res.loadAll())
+            logWarn("not all fonts were properly loaded into fontbook");
+        return res;
+    }();
+    return fontBook;
 }
 
 export void fetchStylesheets(Gc::Ref<Dom::Node> node, Style::StyleBook& sb) {
     auto el = node->is<Dom::Element>();
     if (el and el->tagName == Html::STYLE) {
         auto text = el->textContent();
-        Io::SScan textScan{text};
-        auto sheet = Style::StyleSheet::parse(textScan, node->baseURI());
-        sb.add(std::move(sheet));
+        sb.add(_parseStylesheet(node->baseURI(), text, Style::Origin::AUTHOR));
     } else if (el and el->tagName == Html::LINK) {
-        auto rel = el->getAttribute(Html::REL_ATTR);
-        if (rel == "stylesheet"s) {
-            auto href = el->getAttribute(Html::HREF_ATTR);
-            if (not href) {
-                logWarn("link element missing href attribute");
-                return;
-            }
-
-            auto url = Mime::Url::resolveReference(node->baseURI(), Mime::parseUrlOrPath(*href));
-            if (not url) {
-                logWarn("failed to resolve stylesheet url: {}", url);
-                return;
-            }
-
-            auto sheet = fetchStylesheet(url.unwrap(), Style::Origin::AUTHOR);
-            if (not sheet) {
-                logWarn("failed to fetch stylesheet from {}: {}", url, sheet);
-                return;
-            }
+        auto url = _linkedStylesheetUrl(*el);
+        if (not url)
+            return;
 
+        // NOTE: The sheet is read again every time, so edits show up on
+        //       the next render, but it's only parsed again if it changed.
+        auto sheet = fetchStylesheet(url.unwrap(), Style::Origin::AUTHOR);
+        if (sheet) {
             sb.add(sheet.take());
+            return;
+        }
+
+        if (auto fetched = _fetchedSheets().tryGet(url->str())) {
+            sb.add(fetched.take());
+            return;
         }
+
+        logWarn("failed to fetch stylesheet from {}: {}", url, sheet.none());
     } else {
         for (auto child = node->firstChild(); child; child = child->nextSibling())
             fetchStylesheets(*child, sb);
     }
 }
 
+// MARK: Documents -------------------------------------------------------------
+
+export Async::Task<Gc::Ref<Dom::Document>> fetchDocumentAsync(Gc::Heap& heap, Http::Client& client, Mime::Url const& url, Opt<OnProgress> onProgress = NONE) {
+    if (url.scheme == "about") {
+        if (url.path.str() == "blank")
+            co_return co_await fetchDocumentAsync(heap, client, "bundle://vaev-driver/blank.xhtml"_url, onProgress);
+
+        if (url.path.str() == "start")
+            co_return co_await fetchDocumentAsync(heap, client, "bundle://vaev-driver/start-page.xhtml"_url, onProgress);
+    }
+
+    auto fetcher = makeRc<_SheetFetcher>(client);
+    auto onInsert = [fetcher](Gc::Ref<Dom::Element> el) {
+        if (auto url = _linkedStylesheetUrl(el))
+            _SheetFetcher::fetch(fetcher, url.take());
+    };
+
+    auto resp = co_trya$(client.getAsync(url));
+    auto dom = co_trya$(_loadDocumentAsync(heap, url, resp, std::move(onInsert), onProgress));
+
+    // NOTE: Only the html parser reports elements as they are inserted,
+    //       pick up the sheets of other documents here.
+    Vec<Mime::Url> urls;
+    _collectLinkedStylesheets(dom, urls);
+    for (auto& url : urls)
+        _SheetFetcher::fetch(fetcher, url);
+
+    co_trya$(_SheetFetcher::waitAsync(fetcher));
+    co_return Ok(dom);
+}
+
 } // namespace Vaev::Driver
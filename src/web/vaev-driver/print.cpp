@@ -264,20 +264,12 @@ export Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings
     auto media = _constructMedia(settings);
 
     Style::StyleBook stylebook;
-    stylebook.add(
-        fetchStylesheet("bundle://vaev-driver/html.css"_url, Style::Origin::USER_AGENT)
-            .take("user agent stylesheet not available")
-    );
-    stylebook.add(
-        fetchStylesheet("bundle://vaev-driver/print.css"_url, Style::Origin::USER_AGENT)
-            .take("print stylesheet not available")
-    );
+    stylebook.add(fetchUserAgentStylesheet("bundle://vaev-driver/html.css"_url));
+    stylebook.add(fetchUserAgentStylesheet("bundle://vaev-driver/print.css"_url));
 
     fetchStylesheets(dom, stylebook);
 
-    Text::FontBook fontBook;
-    if (not fontBook.loadAll())
-        logWarn("not all fonts were properly loaded into fontbook");
+    Text::FontBook fontBook = systemFontBook();
 
     Style::Computer computer{
         media, stylebook, fontBook
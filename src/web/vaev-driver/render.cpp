@@ -4,6 +4,7 @@ module;
 #include <karm-scene/stack.h>
 #include <karm-sys/time.h>
 #include <karm-text/book.h>
+#include <vaev-dom/text.h>
 #include <vaev-style/computer.h>
 
 export module Vaev.Driver:render;
@@ -16,46 +17,20 @@ namespace Vaev::Driver {
 static constexpr bool DEBUG_RENDER = false;
 
 export struct RenderResult {
-    Style::StyleBook style;
-    Rc<Layout::Box> layout;
+    Rc<Style::StyleBook> style;
+    Rc<Layout::Tree> layout;
     Rc<Scene::Node> scenes;
     Rc<Layout::Frag> frag;
     Gfx::Color canvasColor;
-};
 
-export RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport) {
-    Style::StyleBook stylebook;
-    stylebook.add(
-        fetchStylesheet("bundle://vaev-driver/html.css"_url, Style::Origin::USER_AGENT)
-            .take("user agent stylesheet not available")
-    );
+    // What the tree was built from, see rerender().
+    usize dom;
+    usize generation;
+    Style::Media media;
+};
 
+static Tuple<Rc<Scene::Node>, Rc<Layout::Frag>> _layoutAndPaint(Layout::Tree& tree, Layout::Viewport viewport) {
     auto start = Sys::now();
-    fetchStylesheets(dom, stylebook);
-    auto elapsed = Sys::now() - start;
-    logDebugIf(DEBUG_RENDER, "style collection time: {}", elapsed);
-
-    start = Sys::now();
-
-    Text::FontBook fontBook;
-    if (not fontBook.loadAll())
-        logWarn("not all fonts were properly loaded into fontbook");
-
-    Style::Computer computer{media, stylebook, fontBook};
-    computer.loadFontFaces();
-
-    Layout::Tree tree = {
-        Layout::build(computer, dom),
-        viewport
-    };
-
-    auto canvasColor = fixupBackgrounds(computer, dom, tree);
-
-    elapsed = Sys::now() - start;
-
-    logDebugIf(DEBUG_RENDER, "layout tree build time: {}", elapsed);
-
-    start = Sys::now();
 
     auto [outDiscovery, root] = Layout::layoutCreateFragment(
         tree,
@@ -68,7 +43,7 @@ export RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media
 
     auto sceneRoot = makeRc<Scene::Stack>();
 
-    elapsed = Sys::now() - start;
+    auto elapsed = Sys::now() - start;
     logDebugIf(DEBUG_RENDER, "layout tree layout time: {}", elapsed);
 
     auto paintStart = Sys::now();
@@ -78,12 +53,91 @@ export RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media
     elapsed = Sys::now() - paintStart;
     logDebugIf(DEBUG_RENDER, "layout tree paint time: {}", elapsed);
 
+    return {sceneRoot, makeRc<Layout::Frag>(std::move(root))};
+}
+
+export RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport) {
+    auto stylebook = makeRc<Style::StyleBook>();
+    stylebook->add(fetchUserAgentStylesheet("bundle://vaev-driver/html.css"_url));
+
+    auto start = Sys::now();
+    fetchStylesheets(dom, *stylebook);
+    auto elapsed = Sys::now() - start;
+    logDebugIf(DEBUG_RENDER, "style collection time: {}", elapsed);
+
+    start = Sys::now();
+
+    // NOTE: Copied, so fonts loaded by the document stay with it.
+    Text::FontBook fontBook = systemFontBook();
+
+    Style::Computer computer{media, *stylebook, fontBook};
+    computer.loadFontFaces();
+
+    auto tree = makeRc<Layout::Tree>(
+        Layout::build(computer, dom),
+        viewport
+    );
+
+    auto canvasColor = fixupBackgrounds(computer, dom, *tree);
+
+    elapsed = Sys::now() - start;
+
+    logDebugIf(DEBUG_RENDER, "layout tree build time: {}", elapsed);
+    logDebugIf(DEBUG_RENDER, "style computation: {} rules, {}", stylebook->index.len(), computer.stats());
+
+    auto [scenes, frag] = _layoutAndPaint(*tree, viewport);
+
     return {
-        std::move(stylebook),
-        makeRc<Layout::Box>(std::move(tree.root)),
-        sceneRoot,
-        makeRc<Layout::Frag>(std::move(root)),
-        canvasColor
+        stylebook,
+        tree,
+        scenes,
+        frag,
+        canvasColor,
+        dom->id(),
+        dom->generation(),
+        media,
+    };
+}
+
+// Renders a document again from the tree of an earlier render, so only the
+// boxes touched by a change to some text, or by a new viewport, are laid out
+// again. Returns NONE if the styles or the boxes of the tree may not hold
+// anymore, and the document has to be rendered from scratch.
+//
+// NOTE: The tree is updated in place, and shared with the earlier render.
+export Opt<RenderResult> rerender(RenderResult& prev, Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport) {
+    if (prev.dom != dom->id())
+        return NONE;
+
+    if (not prev.style->matchesAlike(prev.media, media))
+        return NONE;
+
+    auto changes = dom->changedData(prev.generation);
+    if (not changes)
+        return NONE;
+
+    auto& tree = *prev.layout;
+    for (auto& node : *changes) {
+        auto text = node->is<Dom::Text>();
+        if (not text)
+            continue;
+        if (not Layout::rebuildText(tree, *text))
+            return NONE;
+    }
+
+    Layout::resize(tree, viewport);
+
+    auto [scenes, frag] = _layoutAndPaint(tree, viewport);
+
+    return RenderResult{
+        prev.style,
+        prev.layout,
+        scenes,
+        frag,
+        prev.canvasColor,
+        dom->id(),
+        dom->generation(),
+        media,
     };
 }
 
@@ -0,0 +1,49 @@
+#include <karm-gc/heap.h>
+#include <karm-sys/file.h>
+#include <karm-test/macros.h>
+#include <vaev-dom/document.h>
+
+import Vaev.Driver;
+
+namespace Vaev::Driver::Tests {
+
+static Res<> _writeSheet(Mime::Url const& url, Str css) {
+    auto file = try$(Sys::File::create(url));
+    try$(file.write(bytes(css)));
+    return Ok();
+}
+
+test$("linked-stylesheet-cache") {
+    auto url = "file:/tmp/vaev-driver-test-linked.css"_url;
+    try$(_writeSheet(url, "p { color: red }"));
+
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>("file:/tmp/vaev-driver-test.html"_url);
+    auto link = gc.alloc<Dom::Element>(Html::LINK);
+    link->setAttribute(Html::REL_ATTR, "stylesheet"s);
+    link->setAttribute(Html::HREF_ATTR, url.str());
+    dom->appendChild(link);
+
+    Style::StyleBook first;
+    fetchStylesheets(dom, first);
+    expectEq$(first.styleSheets.len(), 1uz);
+    expectEq$(first.styleSheets[0]->rules.len(), 1uz);
+
+    // Unchanged, the parsed sheet is reused.
+    Style::StyleBook second;
+    fetchStylesheets(dom, second);
+    expectEq$(second.styleSheets.len(), 1uz);
+    expect$(&*first.styleSheets[0] == &*second.styleSheets[0]);
+
+    // Edited, the sheet is parsed again.
+    try$(_writeSheet(url, "p { color: red } h1 { color: blue }"));
+    Style::StyleBook third;
+    fetchStylesheets(dom, third);
+    expectEq$(third.styleSheets.len(), 1uz);
+    expect$(&*first.styleSheets[0] != &*third.styleSheets[0]);
+    expectEq$(third.styleSheets[0]->rules.len(), 2uz);
+
+    return Ok();
+}
+
+} // namespace Vaev::Driver::Tests
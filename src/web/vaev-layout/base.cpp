@@ -2,6 +2,7 @@ module;
 
 #include <karm-image/picture.h>
 #include <karm-text/prose.h>
+#include <vaev-dom/text.h>
 #include <vaev-style/computer.h>
 
 export module Vaev.Layout:base;
@@ -255,6 +256,7 @@ struct Box : public Meta::NoCopy {
     Attrs attrs;
     Opt<Rc<FormatingContext>> formatingContext = NONE;
     Gc::Ptr<Dom::Element> origin;
+    Gc::Ptr<Dom::Text> textNode = nullptr; //< The node a run of text was built from
 
     Box(Rc<Style::Computed> style, Rc<Text::Fontface> font, Gc::Ptr<Dom::Element> og)
         : style{std::move(style)}, fontFace{font} , origin{og} {}
@@ -314,6 +316,10 @@ export struct Tree {
     Box root;
     Viewport viewport = {};
     Fragmentainer fc = {};
+
+    // Set when a viewport-relative length is resolved, cached layouts can't
+    // survive a resize once it is.
+    mutable bool _viewportRelative = false;
 };
 
 // MARK: Fragment --------------------------------------------------------------
@@ -355,6 +361,11 @@ export struct Frag {
     Metrics metrics;
     Vec<Frag> children;
 
+    // The layout cache entry the children were emitted from, and where the
+    // box was laid out, see LayoutCache.
+    usize cached = 0;
+    Vec2Au cachedAt = {};
+
     Frag(MutCursor<Box> box) : box{std::move(box)} {}
 
     Frag() : box{nullptr} {}
@@ -492,9 +503,114 @@ export struct Output {
     }
 };
 
+// MARK: Layout Cache ----------------------------------------------------------
+
+// Outputs of the last few layouts of a box. Outside of fragmentation, they
+// only depend on the sizes of the input, not on where the box ends up.
+//
+// Layouts that emitted fragments also keep them, but without their children:
+// each one links to the entry of its own box the children came from, so the
+// fragments of a subtree are stored once, and put back together when reused.
+export struct LayoutCache {
+    struct Entry {
+        IntrinsicSize intrinsic;
+        Math::Vec2<Opt<Au>> knownSize;
+        Vec2Au availableSpace;
+        Vec2Au containingBlock;
+        Opt<Au> capmin;
+        usize startAt;
+        Opt<usize> stopAt;
+        Output output;
+        usize serial = 0;
+        Vec2Au position = {};
+        Opt<Vec<Frag>> frags = NONE;
+
+        bool match(Input const& input, usize startAt, Opt<usize> stopAt) const {
+            return intrinsic == input.intrinsic and
+                   knownSize == input.knownSize and
+                   availableSpace == input.availableSpace and
+                   containingBlock == input.containingBlock and
+                   capmin == input.capmin and
+                   this->startAt == startAt and
+                   this->stopAt == stopAt;
+        }
+    };
+
+    // Enough for the min-content, max-content and stretch-fit measurements
+    // plus the actual layout.
+    static constexpr usize CAPACITY = 4;
+
+    Vec<Entry> _entries = {};
+    usize _next = 0;
+    usize _serial = 0;
+
+    // If the input has a fragment, only layouts that emitted fragments match.
+    Entry const* lookup(Input const& input, usize startAt, Opt<usize> stopAt) const {
+        for (auto const& entry : _entries) {
+            if (not entry.match(input, startAt, stopAt))
+                continue;
+
+            if (input.fragment and not entry.frags)
+                continue;
+
+            return &entry;
+        }
+        return nullptr;
+    }
+
+    // The entry a fragment links to, as long as it still has its fragments.
+    Entry const* find(usize serial) const {
+        for (auto const& entry : _entries)
+            if (entry.serial == serial and entry.frags)
+                return &entry;
+        return nullptr;
+    }
+
+    usize store(Input const& input, usize startAt, Opt<usize> stopAt, Output const& output, Opt<Vec<Frag>> frags = NONE) {
+        Entry entry{
+            .intrinsic = input.intrinsic,
+            .knownSize = input.knownSize,
+            .availableSpace = input.availableSpace,
+            .containingBlock = input.containingBlock,
+            .capmin = input.capmin,
+            .startAt = startAt,
+            .stopAt = stopAt,
+            .output = output,
+            .serial = ++_serial,
+            .position = input.position,
+            .frags = std::move(frags),
+        };
+
+        for (auto& e : _entries) {
+            if (e.match(input, startAt, stopAt)) {
+                e = std::move(entry);
+                return _serial;
+            }
+        }
+
+        if (_entries.len() < CAPACITY) {
+            _entries.pushBack(std::move(entry));
+        } else {
+            _entries[_next] = std::move(entry);
+            _next = (_next + 1) % CAPACITY;
+        }
+        return _serial;
+    }
+
+    // Running a layout may change state the fragments rely on, like the
+    // lines of a prose, so they can't be reused once the box, or anything
+    // inside of it, was laid out again.
+    void dropFragments() {
+        for (auto& e : _entries)
+            e.frags = NONE;
+    }
+};
+
 // MARK: Formating Context -----------------------------------------------------
 
 struct FormatingContext {
+    LayoutCache cache;
+
     virtual ~FormatingContext() = default;
 
     virtual void build(Tree&, Box&) {};
@@ -0,0 +1,99 @@
+#include <karm-gc/heap.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <karm-text/prose.h>
+#include <vaev-dom/html/parser.h>
+#include <vaev-style/computer.h>
+
+import Vaev.Driver;
+import Vaev.Layout;
+
+using namespace Vaev;
+
+static constexpr usize ROWS = 5000;
+static constexpr usize STEPS = 20;
+static constexpr usize STEP = 16;
+
+static String _document() {
+    Io::StringWriter w;
+    (void)Io::format(w, "<!DOCTYPE html><html><body><table>");
+    for (usize i = 0; i < ROWS; i++)
+        (void)Io::format(
+            w,
+            "<tr><td>{}</td><td>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</td><td>{}</td></tr>",
+            i, i * 7
+        );
+    (void)Io::format(w, "</table></body></html>");
+    return w.take();
+}
+
+static Layout::Viewport _viewport(Au width) {
+    return {.small = {width, 600_au}};
+}
+
+static Duration _layout(Layout::Tree& tree) {
+    auto start = Sys::now();
+    auto width = tree.viewport.small.width;
+    auto [_, frag] = Layout::layoutCreateFragment(
+        tree,
+        {
+            .knownSize = {width, NONE},
+            .availableSpace = {width, 0_au},
+            .containingBlock = {width, tree.viewport.small.height},
+        }
+    );
+    return Sys::now() - start;
+}
+
+static MutCursor<Layout::Box> _findProse(Layout::Box& box, usize& n) {
+    if (box.content.is<Rc<Text::Prose>>() and n-- == 0)
+        return &box;
+    for (auto& c : box.children())
+        if (auto found = _findProse(c, n))
+            return found;
+    return nullptr;
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Gc::Heap heap;
+    auto dom = heap.alloc<Dom::Document>("about:bench"_url);
+    Dom::HtmlParser parser{heap, dom};
+    parser.write(_document());
+
+    Style::StyleBook stylebook;
+    stylebook.add(Driver::fetchUserAgentStylesheet("bundle://vaev-driver/html.css"_url));
+    Driver::fetchStylesheets(dom, stylebook);
+
+    Text::FontBook fontBook = Driver::systemFontBook();
+    Style::Media media;
+    Style::Computer computer{media, stylebook, fontBook};
+    computer.loadFontFaces();
+
+    Layout::Tree tree = {
+        Layout::build(computer, dom),
+        _viewport(800_au),
+    };
+
+    Sys::println("rows: {}", ROWS);
+    Sys::println("initial layout: {}", _layout(tree));
+
+    // Narrow the viewport step by step, as when dragging a window edge.
+    Duration total{};
+    for (usize i = 0; i < STEPS; i++) {
+        Au width{800 - STEP * (i + 1)};
+        Layout::resize(tree, _viewport(width));
+        auto elapsed = _layout(tree);
+        total += elapsed;
+        Sys::println("resize to {}: {}", width, elapsed);
+    }
+    Sys::println("resize average: {}", Duration::fromUSecs(total.toUSecs() / STEPS));
+
+    // A single text node in the middle of the table changes.
+    usize n = ROWS * 3 / 2;
+    if (auto box = _findProse(tree.root, n)) {
+        Layout::markDirty(tree, *box);
+        Sys::println("single node change: {}", _layout(tree));
+    }
+
+    co_return Ok();
+}
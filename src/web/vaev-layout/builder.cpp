@@ -8,6 +8,7 @@ module;
 
 export module Vaev.Layout:builder;
 
+import :layout;
 import :values;
 
 namespace Vaev::Layout {
@@ -123,22 +124,19 @@ static Text::ProseStyle _proseStyleFomStyle(Style::Computed& style, Rc<Text::Fon
     return proseStyle;
 }
 
-static void _buildRun(Style::Computer& c, Gc::Ref<Dom::Text> node, Box& parent) {
-    auto style = makeRc<Style::Computed>(Style::Computed::initial());
-    style->inherit(*parent.style);
-
-    auto fontFace = _lookupFontface(c.fontBook, *style);
-    Io::SScan scan{node->data()};
+// The prose of a run of text, NONE if it's only made of whitespace.
+static Opt<Rc<Text::Prose>> _buildProse(Style::Computed& style, Rc<Text::Fontface> fontFace, Str data) {
+    Io::SScan scan{data};
     scan.eat(Re::space());
     if (scan.ended())
-        return;
+        return NONE;
 
-    auto proseStyle = _proseStyleFomStyle(*style, fontFace);
+    auto proseStyle = _proseStyleFomStyle(style, fontFace);
     auto prose = makeRc<Text::Prose>(proseStyle);
-    auto whitespace = style->text->whiteSpace;
+    auto whitespace = style.text->whiteSpace;
 
     while (not scan.ended()) {
-        switch (style->text->transform) {
+        switch (style.text->transform) {
         case TextTransform::UPPERCASE:
             prose->append(toAsciiUpper(scan.next()));
             break;
@@ -180,13 +178,52 @@ static void _buildRun(Style::Computer& c, Gc::Ref<Dom::Text> node, Box& parent)
         }
     }
 
-    parent.add({style, fontFace, std::move(prose), nullptr});
+    return prose;
+}
+
+static void _buildRun(Style::Computer& c, Gc::Ref<Dom::Text> node, Box& parent) {
+    auto style = makeRc<Style::Computed>(Style::Computed::initial());
+    style->inherit(*parent.style);
+
+    auto fontFace = _lookupFontface(c.fontBook, *style);
+    auto prose = _buildProse(*style, fontFace, node->data());
+    if (not prose)
+        return;
+
+    Box box{style, fontFace, prose.take(), nullptr};
+    box.textNode = node;
+    parent.add(std::move(box));
+}
+
+static bool _rebuildText(Tree& tree, Box& box, Gc::Ref<Dom::Text> node) {
+    if (box.textNode == node) {
+        auto prose = _buildProse(*box.style, box.fontFace, node->data());
+        if (not prose)
+            return false;
+
+        box.content = prose.take();
+        markDirty(tree, box);
+        return true;
+    }
+
+    for (auto& c : box.children())
+        if (_rebuildText(tree, c, node))
+            return true;
+    return false;
+}
+
+// Rebuilds the run of a text node whose data changed, and marks it dirty so
+// only its ancestors are laid out again. Returns false if the change can't be
+// done in place, eg. when the text was or becomes only whitespace.
+export bool rebuildText(Tree& tree, Gc::Ref<Dom::Text> node) {
+    return _rebuildText(tree, tree.root, node);
 }
 
+
 // MARK: Build Input -----------------------------------------------------------
 
 static void _buildInput(Style::Computer& c, Gc::Ref<Dom::Element> el, Box& parent) {
-    auto style = c.computeFor(*parent.style, el);
+    auto style = c.computeFor(parent.style, el);
     auto font = _lookupFontface(c.fontBook, *style);
     Resolver resolver{
         .rootFont = Text::Font{font, 16},
@@ -223,7 +260,7 @@ static void _buildBlock(Style::Computer& c, Rc<Style::Computed> style, Gc::Ref<D
 // MARK: Build Replace ---------------------------------------------------------
 
 static void _buildImage(Style::Computer& c, Gc::Ref<Dom::Element> el, Box& parent) {
-    auto style = c.computeFor(*parent.style, el);
+    auto style = c.computeFor(parent.style, el);
     auto font = _lookupFontface(c.fontBook, *style);
 
     auto src = el->getAttribute(Html::SRC_ATTR).unwrapOr(""s);
@@ -287,7 +324,10 @@ static void _buildTable(Style::Computer& c, Rc<Style::Computed> style, Gc::Ref<D
     wrapperStyle->margin = style->margin;
 
     Box wrapper = {wrapperStyle, font, el};
-    _buildTableChildren(c, el, wrapper, style);
+
+    // NOTE: The table box changes its display, and the style might be
+    //       shared with other elements.
+    _buildTableChildren(c, el, wrapper, makeRc<Style::Computed>(*style));
     wrapper.attrs = _parseDomAttr(el);
 
     parent.add(std::move(wrapper));
@@ -304,7 +344,7 @@ static void _buildElement(Style::Computer& c, Gc::Ref<Dom::Element> el, Box& par
         return;
     }
 
-    auto style = c.computeFor(*parent.style, el);
+    auto style = c.computeFor(parent.style, el);
     auto font = _lookupFontface(c.fontBook, *style);
 
     auto display = style->display;
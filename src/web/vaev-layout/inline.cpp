@@ -9,6 +9,8 @@ import :base;
 namespace Vaev::Layout {
 
 struct InlineFormatingContext : public FormatingContext {
+    Opt<Au> _lastInlineSize = NONE;
+
     virtual Output run([[maybe_unused]] Tree& tree, Box& box, Input input, [[maybe_unused]] usize startAt, [[maybe_unused]] Opt<usize> stopAt) override {
         // NOTE: We are not supposed to get there if the content is not a prose
         auto& prose = *box.content.unwrap<Rc<Text::Prose>>("inlineLayout");
@@ -23,7 +25,13 @@ struct InlineFormatingContext : public FormatingContext {
             }
         });
 
-        auto size = prose.layout(inlineSize);
+        // NOTE: The prose keeps the lines of its last layout, which are the
+        //       ones that get painted.
+        auto size = prose.size();
+        if (_lastInlineSize != inlineSize) {
+            size = prose.layout(inlineSize);
+            _lastInlineSize = inlineSize;
+        }
 
         if (tree.fc.allowBreak() and not tree.fc.acceptsFit(
                                          input.position.y,
@@ -47,6 +47,50 @@ static Opt<Rc<FormatingContext>> _constructFormatingContext(Box& box) {
     }
 }
 
+// Puts back the fragments of a cache entry and, through the entries they
+// link to, those of the whole subtree, as laid out at `position`.
+static bool _restoreFragments(LayoutCache const& cache, usize serial, Vec2Au position, Vec<Frag>& out) {
+    auto entry = cache.find(serial);
+    if (not entry)
+        return false;
+
+    auto d = position - entry->position;
+    for (auto const& stored : *entry->frags) {
+        Frag frag{stored.box};
+        frag.metrics = stored.metrics;
+        frag.metrics.position = frag.metrics.position + d;
+        frag.cached = stored.cached;
+        frag.cachedAt = stored.cachedAt + d;
+
+        if (frag.cached) {
+            auto& fc = frag.box->formatingContext;
+            if (not fc or not _restoreFragments(fc.unwrap()->cache, frag.cached, frag.cachedAt, frag.children))
+                return false;
+        }
+
+        out.pushBack(std::move(frag));
+    }
+
+    return true;
+}
+
+// The fragments emitted by a layout, without their children, or NONE if some
+// of them didn't come from a cached layout and can't be put back together.
+static Opt<Vec<Frag>> _shallowFragments(Slice<Frag> frags) {
+    Vec<Frag> res;
+    for (auto const& f : frags) {
+        if (f.children.len() and not f.cached)
+            return NONE;
+
+        Frag frag{f.box};
+        frag.metrics = f.metrics;
+        frag.cached = f.cached;
+        frag.cachedAt = f.cachedAt;
+        res.pushBack(std::move(frag));
+    }
+    return res;
+}
+
 Output _contentLayout(Tree& tree, Box& box, Input input, usize startAt, Opt<usize> stopAt) {
     if (box.formatingContext == NONE) {
         box.formatingContext = _constructFormatingContext(box);
@@ -55,7 +99,77 @@ Output _contentLayout(Tree& tree, Box& box, Input input, usize startAt, Opt<usiz
     }
     if (not box.formatingContext)
         return Output{};
-    return box.formatingContext.unwrap()->run(tree, box, input, startAt, stopAt);
+
+    auto& fc = *box.formatingContext.unwrap();
+
+    bool cacheable = not tree.fc.allowBreak();
+    if (cacheable) {
+        if (auto entry = fc.cache.lookup(input, startAt, stopAt)) {
+            if (not input.fragment)
+                return entry->output;
+
+            Vec<Frag> frags;
+            if (_restoreFragments(fc.cache, entry->serial, input.position, frags)) {
+                for (auto& f : frags)
+                    input.fragment->add(std::move(f));
+                input.fragment->cached = entry->serial;
+                input.fragment->cachedAt = input.position;
+                return entry->output;
+            }
+        }
+    }
+
+    // NOTE: The subtree of a box is only ever laid out through its own
+    //       formating context, so as long as it doesn't run, the fragments
+    //       it emitted last, and those its entries link to, are still valid.
+    fc.cache.dropFragments();
+
+    usize first = input.fragment ? input.fragment->children.len() : 0;
+    auto out = fc.run(tree, box, input, startAt, stopAt);
+    if (cacheable) {
+        Opt<Vec<Frag>> frags = NONE;
+        if (input.fragment)
+            frags = _shallowFragments(next(input.fragment->children, first));
+        bool linked = frags != NONE;
+        usize serial = fc.cache.store(input, startAt, stopAt, out, std::move(frags));
+        if (linked) {
+            input.fragment->cached = serial;
+            input.fragment->cachedAt = input.position;
+        }
+    }
+    return out;
+}
+
+static bool _markDirty(Box& curr, Box& box) {
+    bool onPath = &curr == &box;
+    for (auto& c : curr.children())
+        if (not onPath and _markDirty(c, box))
+            onPath = true;
+
+    // NOTE: Formating contexts hold state derived from the content of the
+    //       box (eg. the table grid), so they are rebuilt rather than just
+    //       having their cache cleared.
+    if (onPath)
+        curr.formatingContext = NONE;
+    return onPath;
+}
+
+void markDirty(Tree& tree, Box& box) {
+    _markDirty(tree.root, box);
+}
+
+static void _markAllDirty(Box& box) {
+    box.formatingContext = NONE;
+    for (auto& c : box.children())
+        _markAllDirty(c);
+}
+
+void resize(Tree& tree, Viewport viewport) {
+    tree.viewport = viewport;
+    if (tree._viewportRelative) {
+        _markAllDirty(tree.root);
+        tree._viewportRelative = false;
+    }
 }
 
 InsetsAu computeMargins(Tree& tree, Box& box, Input input) {
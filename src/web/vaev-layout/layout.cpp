@@ -20,4 +20,12 @@ export Output layout(Tree& tree, Input input);
 
 export Tuple<Output, Frag> layoutCreateFragment(Tree& tree, Input input);
 
+/// Discard the cached layouts of a box whose style or content changed, and
+/// of its ancestors, the rest of the tree is reused by the next layout.
+export void markDirty(Tree& tree, Box& box);
+
+/// Change the viewport of the tree, cached layouts are kept unless the
+/// tree uses viewport-relative lengths.
+export void resize(Tree& tree, Viewport viewport);
+
 } // namespace Vaev::Layout
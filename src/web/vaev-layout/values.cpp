@@ -22,6 +22,7 @@ export struct Resolver {
     Opt<Text::Font> boxFont = NONE;                  /// Font of the current box
     Viewport viewport = {.small = {800_au, 600_au}}; /// Viewport of the current box
     Axis boxAxis = Axis::HORIZONTAL;                 /// Inline axis of the current box
+    MutCursor<bool> viewportRelative = nullptr;      /// Set when a viewport-relative length is resolved
 
     static Resolver from(Tree const& tree, Box const& box) {
         Au fontSize{16};
@@ -31,6 +32,7 @@ export struct Resolver {
         resolver.boxFont = Text::Font{box.fontFace, fontSize.cast<f64>()};
         resolver.viewport = tree.viewport;
         resolver.boxAxis = mainAxis(box);
+        resolver.viewportRelative = &tree._viewportRelative;
         return resolver;
     }
 
@@ -93,6 +95,10 @@ export struct Resolver {
     Au resolve(Length const& value) {
         if (value.isFontRelative())
             return _resolveFontRelative(value);
+
+        if (value.isViewportRelative() and viewportRelative)
+            *viewportRelative = true;
+
         switch (value.unit()) {
 
         // Viewport-relative
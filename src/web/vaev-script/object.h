@@ -105,6 +105,11 @@ struct Object {
 
     void repr(Io::Emit& e) const;
 
+    void trace(Gc::Visitor& v) const {
+        v.visit(propertyStorage);
+        v.visit(prototype);
+    }
+
     Gc::Ref<Object> ref() {
         return *this;
     }
@@ -91,6 +91,11 @@ struct PropertyStorage {
     struct Accessor {
         Gc::Ptr<Object> get;
         Gc::Ptr<Object> set;
+
+        void trace(Gc::Visitor& v) const {
+            v.visit(get);
+            v.visit(set);
+        }
     };
 
     struct Attributes {
@@ -102,6 +107,12 @@ struct PropertyStorage {
     struct Property {
         Union<Value, Accessor> value;
         Attributes attributes;
+
+        void trace(Gc::Visitor& v) const {
+            value.visit([&](auto const& inner) {
+                v.visit(inner);
+            });
+        }
     };
 
     Map<PropertyKey, Property> _props;
@@ -113,6 +124,11 @@ struct PropertyStorage {
     Opt<Property> get(PropertyKey key) {
         return _props.tryGet(key);
     }
+
+    void trace(Gc::Visitor& v) const {
+        for (auto const& [_, prop] : _props.iter())
+            v.visit(prop);
+    }
 };
 
 } // namespace Vaev::Script
@@ -11,6 +11,11 @@ struct Realm {
     Gc::Ref<Agent> agentSignifier;
     Value globalThis = undefined;
 
+    void trace(Gc::Visitor& v) const {
+        v.visit(agentSignifier);
+        v.visit(globalThis);
+    }
+
     // https://tc39.es/ecma262/#sec-createintrinsics
     Completion createIntrinsics() {
         // 1. Set realmRec.[[Intrinsics]] to a new Record.
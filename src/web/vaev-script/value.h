@@ -3,7 +3,7 @@
 #include <karm-base/set.h>
 #include <karm-base/string.h>
 #include <karm-base/union.h>
-#include <karm-gc/ptr.h>
+#include <karm-gc/heap.h>
 #include <karm-io/emit.h>
 
 struct Agent;
@@ -203,6 +203,11 @@ struct Value {
         return store.unwrap<Gc::Ref<Object>>();
     }
 
+    void trace(Gc::Visitor& v) const {
+        if (auto obj = store.is<Gc::Ref<Object>>())
+            v.visit(*obj);
+    }
+
     void repr(Io::Emit& e) const;
 };
 
@@ -21,6 +21,26 @@ void Computer::_evalRule(Rule const& rule, Gc::Ref<Dom::Element> el, MatchingRul
     });
 }
 
+void Computer::_evalRule(RuleIndex::Entry const& entry, Gc::Ref<Dom::Element> el, MatchingRules& matches) {
+    _stats.rulesTested++;
+
+    for (auto hash : entry.ancestors) {
+        if (not _filter.mayContain(hash)) {
+            _stats.fastRejects++;
+            return;
+        }
+    }
+
+    for (auto const& media : entry.media)
+        if (not media->match(_media))
+            return;
+
+    if (auto specificity = entry.rule->match(el)) {
+        matches.pushBack({entry.rule, specificity.unwrap()});
+        _stats.matches++;
+    }
+}
+
 void Computer::_evalRule(Rule const& rule, Page const& page, PageComputedStyle& c) {
     rule.visit(Visitor{
         [&](PageRule const& r) {
@@ -97,32 +117,87 @@ Rc<Computed> Computer::_evalCascade(Computed const& parent, MatchingRules& match
     return computed;
 }
 
+void Computer::_collectRules(Gc::Ref<Dom::Element> el, MatchingRules& matches) {
+    _stats.elements++;
+
+    _filter.prepare(*el);
+    _candidates.clear();
+    _styleBook.index.collect(*el, _candidates);
+    for (auto i : _candidates)
+        _evalRule(_styleBook.index[i], el, matches);
+    _filter.push(*el);
+}
+
 // https://drafts.csswg.org/css-cascade/#cascade-origin
+Rc<Computed> Computer::_computeFor(Computed const& parent, MatchingRules matches, Str style) {
+    StyleRule styleRule{
+        .props = parseDeclarations<StyleProp>(style),
+        .origin = Origin::INLINE,
+    };
+    matches.pushBack({&styleRule, INLINE_SPEC});
+
+    return _evalCascade(parent, matches);
+}
+
 Rc<Computed> Computer::computeFor(Computed const& parent, Gc::Ref<Dom::Element> el) {
     MatchingRules matchingRules;
+    _collectRules(el, matchingRules);
 
-    // Collect matching styles rules
-    for (auto const& sheet : _styleBook.styleSheets)
-        for (auto const& rule : sheet.rules)
-            _evalRule(rule, el, matchingRules);
-
-    // Get the style attribute if any
     auto styleAttr = el->getAttribute(Html::STYLE_ATTR);
+    return _computeFor(parent, std::move(matchingRules), styleAttr ? *styleAttr : "");
+}
 
-    StyleRule styleRule{
-        .props = parseDeclarations<StyleProp>(styleAttr ? *styleAttr : ""),
-        .origin = Origin::INLINE,
-    };
-    matchingRules.pushBack({&styleRule, INLINE_SPEC});
+// MARK: Style Sharing ---------------------------------------------------------
+
+bool Computer::SharingKey::operator==(SharingKey const& other) const {
+    if (parent != other.parent or style != other.style)
+        return false;
+
+    if (rules.len() != other.rules.len())
+        return false;
+
+    for (usize i = 0; i < rules.len(); i++) {
+        StyleRule const* lhs = rules[i].v0;
+        StyleRule const* rhs = other.rules[i].v0;
+        if (lhs != rhs or rules[i].v1 != other.rules[i].v1)
+            return false;
+    }
 
-    return _evalCascade(parent, matchingRules);
+    return true;
+}
+
+Hash Computer::SharingKey::hash() const {
+    Hash h = Karm::hash(parent);
+    h = hashCombine(h, Karm::hash(style));
+    for (auto const& [rule, spec] : rules)
+        h = hashCombine(h, Karm::hash(static_cast<StyleRule const*>(rule)));
+    return h;
+}
+
+Rc<Computed> Computer::computeFor(Rc<Computed> parent, Gc::Ref<Dom::Element> el) {
+    SharingKey key{&*parent, {}, ""s};
+    _collectRules(el, key.rules);
+    if (auto styleAttr = el->getAttribute(Html::STYLE_ATTR))
+        key.style = *styleAttr;
+
+    if (auto shared = _sharing.tryGet(key)) {
+        _stats.sharingHits++;
+        return shared->computed;
+    }
+    _stats.sharingMisses++;
+
+    auto computed = _computeFor(*parent, key.rules, key.style);
+    _sharing.access(key, [&] {
+        return Shared{parent, computed};
+    });
+    return computed;
 }
 
 Rc<PageComputedStyle> Computer::computeFor(Computed const& parent, Page const& page) {
     auto computed = makeRc<PageComputedStyle>(parent);
 
     for (auto const& sheet : _styleBook.styleSheets)
-        for (auto const& rule : sheet.rules)
+        for (auto const& rule : sheet->rules)
             _evalRule(rule, page, *computed);
 
     return computed;
@@ -132,7 +207,7 @@ void Computer::loadFontFaces() {
     for (auto const& sheet : _styleBook.styleSheets) {
 
         Vec<FontFace> fontFaces;
-        for (auto const& rule : sheet.rules)
+        for (auto const& rule : sheet->rules)
             _evalRule(rule, fontFaces);
 
         for (auto const& ff : fontFaces) {
@@ -140,10 +215,10 @@ void Computer::loadFontFaces() {
                 if (src.identifier.is<Mime::Url>()) {
                     auto fontUrl = src.identifier.unwrap<Mime::Url>();
 
-                    auto resolvedUrl = Mime::Url::resolveReference(sheet.href, fontUrl);
+                    auto resolvedUrl = Mime::Url::resolveReference(sheet->href, fontUrl);
 
                     if (not resolvedUrl) {
-                        logWarn("Cannot resolve urls when loading fonts: {} {}", fontUrl, sheet.href);
+                        logWarn("Cannot resolve urls when loading fonts: {} {}", fontUrl, sheet->href);
                         continue;
                     }
 
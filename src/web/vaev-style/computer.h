@@ -1,9 +1,11 @@
 #pragma once
 
+#include <karm-base/lru.h>
 #include <karm-text/book.h>
 #include <vaev-dom/element.h>
 
 #include "computed.h"
+#include "matcher.h"
 #include "stylesheet.h"
 
 namespace Vaev::Style {
@@ -13,21 +15,78 @@ struct Computer {
     StyleBook const& _styleBook;
     Text::FontBook& fontBook;
 
+    struct Stats {
+        usize elements = 0;
+        usize rulesTested = 0; // Picked from the rule index
+        usize fastRejects = 0; // Rejected by the ancestor filter
+        usize matches = 0;
+        usize sharingHits = 0;
+        usize sharingMisses = 0;
+
+        f64 sharingHitRate() const {
+            usize lookups = sharingHits + sharingMisses;
+            return lookups ? sharingHits / (f64)lookups : 0;
+        }
+
+        void repr(Io::Emit& e) const {
+            e("(style-stats elements: {} rules-tested: {} fast-rejects: {} matches: {} sharing-hit-rate: {})", elements, rulesTested, fastRejects, matches, sharingHitRate());
+        }
+    };
+
     using MatchingRules = Vec<Tuple<Cursor<StyleRule>, Spec>>;
 
+    // Elements with the same parent style, matched rules and inline style
+    // end up with the same computed style, as siblings in lists and tables
+    // often do, so they share it.
+    struct SharingKey {
+        Computed const* parent;
+        MatchingRules rules;
+        String style;
+
+        bool operator==(SharingKey const& other) const;
+
+        Hash hash() const;
+    };
+
+    struct Shared {
+        Rc<Computed> parent; // Keeps the address in the key from being reused
+        Rc<Computed> computed;
+    };
+
+    static constexpr usize SHARING_CAPACITY = 32;
+
+    AncestorFilter _filter = {};
+    Vec<usize> _candidates = {};
+    Lru<SharingKey, Shared> _sharing{SHARING_CAPACITY};
+    Stats _stats = {};
+
     void _evalRule(Rule const& rule, Gc::Ref<Dom::Element> el, MatchingRules& matches);
 
+    void _evalRule(RuleIndex::Entry const& entry, Gc::Ref<Dom::Element> el, MatchingRules& matches);
+
     void _evalRule(Rule const& rule, Page const& page, PageComputedStyle& c);
 
     void _evalRule(Rule const& rule, Vec<FontFace>& fontFaces);
 
     Rc<Computed> _evalCascade(Computed const& parent, MatchingRules& matches);
 
+    void _collectRules(Gc::Ref<Dom::Element> el, MatchingRules& matches);
+
+    Rc<Computed> _computeFor(Computed const& parent, MatchingRules matches, Str style);
+
     Rc<Computed> computeFor(Computed const& parent, Gc::Ref<Dom::Element> el);
 
+    // Same as above, but the style may be shared with other elements that
+    // have the same parent style.
+    Rc<Computed> computeFor(Rc<Computed> parent, Gc::Ref<Dom::Element> el);
+
     Rc<PageComputedStyle> computeFor(Computed const& parent, Page const& page);
 
     void loadFontFaces();
+
+    Stats stats() const {
+        return _stats;
+    }
 };
 
 } // namespace Vaev::Style
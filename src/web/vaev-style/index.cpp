@@ -0,0 +1,147 @@
+#include "index.h"
+
+#include "matcher.h"
+
+namespace Vaev::Style {
+
+// Ordered from the least to the most selective.
+enum struct _Bucket {
+    TAG,
+    CLASS,
+    ID,
+};
+
+struct _Key {
+    _Bucket bucket;
+    Hash hash;
+};
+
+// Pick the most selective simple selector the subject of `s` must match.
+static Opt<_Key> _subjectKey(Selector const& s) {
+    if (auto infix = s.is<Infix>())
+        return _subjectKey(*infix->rhs);
+
+    if (auto nfix = s.is<Nfix>(); nfix and nfix->type == Nfix::AND) {
+        Opt<_Key> best = NONE;
+        for (auto const& inner : nfix->inners) {
+            auto key = _subjectKey(inner);
+            if (key and (not best or key->bucket > best->bucket))
+                best = key;
+        }
+        return best;
+    }
+
+    if (auto type = s.is<TypeSelector>())
+        return _Key{_Bucket::TAG, tagHash(type->type)};
+
+    if (auto id = s.is<IdSelector>())
+        return _Key{_Bucket::ID, idHash(id->id)};
+
+    if (auto class_ = s.is<ClassSelector>())
+        return _Key{_Bucket::CLASS, classHash(class_->class_)};
+
+    return NONE;
+}
+
+static void _insert(HashMap<Hash, Vec<usize>>& map, Hash hash, usize index) {
+    if (auto bucket = map.access(hash)) {
+        if (last(*bucket) != index)
+            bucket->pushBack(index);
+        return;
+    }
+    map.put(hash, {index});
+}
+
+void RuleIndex::_addStyleRule(StyleRule const& rule, Vec<Cursor<MediaRule>> const& media) {
+    usize index = _entries.len();
+    Entry entry{&rule, media, {}};
+
+    // Selector lists are indexed under each of their selectors.
+    Vec<Opt<_Key>> keys;
+    if (auto nfix = rule.selector.is<Nfix>(); nfix and nfix->type == Nfix::OR) {
+        for (auto const& inner : nfix->inners)
+            keys.pushBack(_subjectKey(inner));
+    } else {
+        keys.pushBack(_subjectKey(rule.selector));
+        collectAncestorHashes(rule.selector, entry.ancestors);
+    }
+
+    _entries.pushBack(std::move(entry));
+
+    for (auto const& key : keys) {
+        if (not key) {
+            _universal.pushBack(index);
+            return;
+        }
+    }
+
+    for (auto const& key : keys) {
+        switch (key->bucket) {
+        case _Bucket::TAG:
+            _insert(_tags, key->hash, index);
+            break;
+
+        case _Bucket::CLASS:
+            _insert(_classes, key->hash, index);
+            break;
+
+        case _Bucket::ID:
+            _insert(_ids, key->hash, index);
+            break;
+        }
+    }
+}
+
+void RuleIndex::_add(Rule const& rule, Vec<Cursor<MediaRule>>& media) {
+    rule.visit(Visitor{
+        [&](StyleRule const& r) {
+            _addStyleRule(r, media);
+        },
+        [&](MediaRule const& r) {
+            media.pushBack(&r);
+            for (auto const& subRule : r.rules)
+                _add(subRule, media);
+            media.popBack();
+        },
+        [&](auto const&) {
+            // Ignore other rule types
+        },
+    });
+}
+
+void RuleIndex::add(Rule const& rule) {
+    Vec<Cursor<MediaRule>> media;
+    _add(rule, media);
+}
+
+void RuleIndex::collect(Dom::Element const& el, Vec<usize>& entries) const {
+    auto append = [&](HashMap<Hash, Vec<usize>> const& map, Hash hash) {
+        if (auto bucket = map.access(hash))
+            entries.pushBack(*bucket);
+    };
+
+    if (auto id = el.id())
+        append(_ids, idHash(*id));
+    for (auto const& class_ : el.classList._tokens)
+        append(_classes, classHash(class_));
+    append(_tags, tagHash(el.tagName));
+    entries.pushBack(_universal);
+
+    // Restore the cascade order, and drop rules found in several buckets.
+    sort(entries);
+    usize len = 0;
+    for (usize i = 0; i < entries.len(); i++)
+        if (len == 0 or entries[len - 1] != entries[i])
+            entries[len++] = entries[i];
+    entries.trunc(len);
+}
+
+void RuleIndex::clear() {
+    _entries.clear();
+    _ids.clear();
+    _classes.clear();
+    _tags.clear();
+    _universal.clear();
+}
+
+} // namespace Vaev::Style
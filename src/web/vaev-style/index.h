@@ -0,0 +1,46 @@
+#pragma once
+
+#include <karm-base/map.h>
+
+#include "rules.h"
+
+namespace Vaev::Style {
+
+// Style rules bucketed by the id, class or tag the subject of their selector
+// must have, so only the rules that can possibly match an element are tested
+// against it.
+struct RuleIndex {
+    struct Entry {
+        Cursor<StyleRule> rule;
+        Vec<Cursor<MediaRule>> media; // Enclosing media rules
+        Vec<Hash> ancestors;          // See collectAncestorHashes()
+    };
+
+    Vec<Entry> _entries;
+    HashMap<Hash, Vec<usize>> _ids;
+    HashMap<Hash, Vec<usize>> _classes;
+    HashMap<Hash, Vec<usize>> _tags;
+    Vec<usize> _universal;
+
+    void _addStyleRule(StyleRule const& rule, Vec<Cursor<MediaRule>> const& media);
+
+    void _add(Rule const& rule, Vec<Cursor<MediaRule>>& media);
+
+    // NOTE: The rule must outlive the index, and stay at the same address.
+    void add(Rule const& rule);
+
+    // Collect the entries that may match `el`, in cascade order.
+    void collect(Dom::Element const& el, Vec<usize>& entries) const;
+
+    Entry const& operator[](usize index) const {
+        return _entries[index];
+    }
+
+    usize len() const {
+        return _entries.len();
+    }
+
+    void clear();
+};
+
+} // namespace Vaev::Style
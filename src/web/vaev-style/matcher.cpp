@@ -125,11 +125,10 @@ static bool _match(ClassSelector const& s, Gc::Ref<Dom::Element> el) {
 // 6. Attribute Selector
 // https://www.w3.org/TR/selectors-4/#attribute-selectors
 static bool _match(AttributeSelector const& s, Gc::Ref<Dom::Element> el) {
-    auto attrName = AttrName::tryMake(s.name, HTML);
-    if (not attrName)
+    if (not s.name)
         return false;
 
-    auto maybeAttrValue = el->getAttribute(attrName.unwrap());
+    auto maybeAttrValue = el->getAttribute(s.name.unwrap());
     if (s.match == AttributeSelector::PRESENT) {
         // Represents an element with the att attribute, whatever the value of the attribute.
         return maybeAttrValue != NONE;
@@ -338,4 +337,113 @@ Opt<Spec> matchSelector(Selector const& selector, Gc::Ref<Dom::Element> el) {
     return NONE;
 }
 
+// MARK: Ancestor Filter -------------------------------------------------------
+
+Hash tagHash(TagName const& tag) {
+    return hashCombine(tag.hash(), 't');
+}
+
+Hash idHash(Str id) {
+    return hashCombine(Karm::hash(id), '#');
+}
+
+Hash classHash(Str class_) {
+    return hashCombine(Karm::hash(class_), '.');
+}
+
+static Dom::Element const* _parentElement(Dom::Element const& el) {
+    if (not el.hasParentNode())
+        return nullptr;
+    Dom::Node const& parent = *el.parentNode();
+    return parent.is<Dom::Element>();
+}
+
+void AncestorFilter::_inc(Hash h) {
+    for (auto i : {h & MASK, (h >> BITS) & MASK}) {
+        // Saturated counters stay saturated, we can't know how many
+        // elements are still referencing them.
+        if (_counters[i] != 255)
+            _counters[i]++;
+    }
+}
+
+void AncestorFilter::_dec(Hash h) {
+    for (auto i : {h & MASK, (h >> BITS) & MASK}) {
+        if (_counters[i] != 255)
+            _counters[i]--;
+    }
+}
+
+void AncestorFilter::push(Dom::Element const& el) {
+    _stack.pushBack({&el, _hashes.len()});
+
+    _hashes.pushBack(tagHash(el.tagName));
+    if (auto id = el.id())
+        _hashes.pushBack(idHash(*id));
+    for (auto const& class_ : el.classList._tokens)
+        _hashes.pushBack(classHash(class_));
+
+    for (usize i = last(_stack).hashes; i < _hashes.len(); i++)
+        _inc(_hashes[i]);
+}
+
+void AncestorFilter::pop() {
+    auto frame = _stack.popBack();
+    for (usize i = frame.hashes; i < _hashes.len(); i++)
+        _dec(_hashes[i]);
+    _hashes.trunc(frame.hashes);
+}
+
+void AncestorFilter::prepare(Dom::Element const& el) {
+    auto const* parent = _parentElement(el);
+    while (_stack.len() and last(_stack).el != parent)
+        pop();
+
+    if (_stack.len() or not parent)
+        return;
+
+    // The traversal jumped somewhere else in the tree, rebuild the
+    // filter from the root.
+    Vec<Dom::Element const*> ancestors;
+    for (auto const* curr = parent; curr; curr = _parentElement(*curr))
+        ancestors.pushBack(curr);
+    for (auto const* ancestor : iterRev(ancestors))
+        push(*ancestor);
+}
+
+void AncestorFilter::clear() {
+    _counters = {};
+    _stack.clear();
+    _hashes.clear();
+}
+
+static void _collectAncestorHashes(Selector const& s, bool isAncestor, Vec<Hash>& hashes, usize max) {
+    if (hashes.len() >= max)
+        return;
+
+    if (auto infix = s.is<Infix>()) {
+        _collectAncestorHashes(*infix->rhs, isAncestor, hashes, max);
+
+        // The left-hand side of a sibling combinator is not an ancestor,
+        // but its own ancestors are.
+        bool lhsIsAncestor = infix->type == Infix::DESCENDANT or infix->type == Infix::CHILD;
+        _collectAncestorHashes(*infix->lhs, lhsIsAncestor, hashes, max);
+    } else if (auto nfix = s.is<Nfix>(); nfix and nfix->type == Nfix::AND) {
+        for (auto const& inner : nfix->inners)
+            _collectAncestorHashes(inner, isAncestor, hashes, max);
+    } else if (not isAncestor) {
+        return;
+    } else if (auto type = s.is<TypeSelector>()) {
+        hashes.pushBack(tagHash(type->type));
+    } else if (auto id = s.is<IdSelector>()) {
+        hashes.pushBack(idHash(id->id));
+    } else if (auto class_ = s.is<ClassSelector>()) {
+        hashes.pushBack(classHash(class_->class_));
+    }
+}
+
+void collectAncestorHashes(Selector const& selector, Vec<Hash>& hashes, usize max) {
+    _collectAncestorHashes(selector, false, hashes, max);
+}
+
 } // namespace Vaev::Style
@@ -9,4 +9,61 @@ namespace Vaev::Style {
 
 Opt<Spec> matchSelector(Selector const& selector, Gc::Ref<Dom::Element> el);
 
+// MARK: Ancestor Filter -------------------------------------------------------
+
+// Hashes of the simple selectors an element can be quickly tested against,
+// salted so a tag, an id and a class with the same name don't collide.
+Hash tagHash(TagName const& tag);
+
+Hash idHash(Str id);
+
+Hash classHash(Str class_);
+
+// Counting bloom filter of the tags, ids and classes of the ancestors of the
+// element being styled, lets selectors that require a missing ancestor be
+// rejected without walking up the tree.
+//
+// The filter follows the tree traversal, elements are popped until the top
+// of the stack is the parent of the next element to style, so a depth-first
+// traversal only pushes and pops each element once.
+struct AncestorFilter {
+    static constexpr usize BITS = 12;
+    static constexpr usize SIZE = 1 << BITS;
+    static constexpr usize MASK = SIZE - 1;
+
+    struct Frame {
+        Dom::Element const* el;
+        usize hashes; // Start of the element hashes in `_hashes`
+    };
+
+    Array<u8, SIZE> _counters = {};
+    Vec<Frame> _stack;
+    Vec<Hash> _hashes;
+
+    void _inc(Hash h);
+
+    void _dec(Hash h);
+
+    void push(Dom::Element const& el);
+
+    void pop();
+
+    // Make the filter hold the ancestors of `el`, and only them.
+    void prepare(Dom::Element const& el);
+
+    void clear();
+
+    bool mayContain(Hash h) const {
+        return _counters[h & MASK] and _counters[(h >> BITS) & MASK];
+    }
+
+    usize depth() const {
+        return _stack.len();
+    }
+};
+
+// Collect the hashes of the simple selectors that ancestors of an element
+// matching `selector` must match, at most `max` of them.
+void collectAncestorHashes(Selector const& selector, Vec<Hash>& hashes, usize max = 4);
+
 } // namespace Vaev::Style
@@ -124,7 +124,7 @@ static Selector _parseAttributeSelector(Slice<Css::Sst> content) {
     }
 
     return AttributeSelector{
-        name,
+        AttrName::tryMake(name, HTML),
         caze,
         match,
         value,
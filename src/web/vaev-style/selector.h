@@ -248,7 +248,9 @@ struct AttributeSelector {
         _LEN1,
     };
 
-    String name;
+    // NOTE: Resolved once when parsing, names that aren't known to the
+    //       HTML namespace never match.
+    Opt<AttrName> name;
     Case case_;
     Match match;
     String value;
@@ -47,8 +47,32 @@ void StyleBook::repr(Io::Emit& e) const {
     e("(style-book {})", styleSheets);
 }
 
-void StyleBook::add(StyleSheet&& sheet) {
+void StyleBook::add(Rc<StyleSheet> sheet) {
+    for (auto const& rule : sheet->rules)
+        index.add(rule);
     styleSheets.pushBack(std::move(sheet));
 }
 
+static bool _matchesAlike(Rule const& rule, Media const& a, Media const& b) {
+    auto media = rule.is<MediaRule>();
+    if (not media)
+        return true;
+
+    if (media->match(a) != media->match(b))
+        return false;
+
+    for (auto const& r : media->rules)
+        if (not _matchesAlike(r, a, b))
+            return false;
+    return true;
+}
+
+bool StyleBook::matchesAlike(Media const& a, Media const& b) const {
+    for (auto const& sheet : styleSheets)
+        for (auto const& rule : sheet->rules)
+            if (not _matchesAlike(rule, a, b))
+                return false;
+    return true;
+}
+
 } // namespace Vaev::Style
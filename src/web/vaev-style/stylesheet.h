@@ -1,7 +1,9 @@
 #pragma once
 
+#include <karm-base/rc.h>
 #include <karm-mime/mime.h>
 
+#include "index.h"
 #include "rules.h"
 
 namespace Vaev::Style {
@@ -30,11 +32,22 @@ struct StyleSheet {
 };
 
 struct StyleBook {
-    Vec<StyleSheet> styleSheets;
+    Vec<Rc<StyleSheet>> styleSheets;
+    RuleIndex index;
 
     void repr(Io::Emit& e) const;
 
-    void add(StyleSheet&& sheet);
+    // NOTE: Sheets are shared, so the user agent stylesheet can be parsed
+    //       once and added to every book.
+    void add(Rc<StyleSheet> sheet);
+
+    void add(StyleSheet&& sheet) {
+        add(makeRc<StyleSheet>(std::move(sheet)));
+    }
+
+    // Whether every media rule of the book matches both media the same way,
+    // so styles computed for one of them hold for the other.
+    bool matchesAlike(Media const& a, Media const& b) const;
 };
 
 } // namespace Vaev::Style
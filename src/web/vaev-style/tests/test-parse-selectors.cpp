@@ -296,7 +296,7 @@ test$("vaev-style-parse-attribute-selectors") {
         Selector::and_({
             ClassSelector{"className"s},
             AttributeSelector{
-                "type"s,
+                Html::TYPE_ATTR,
                 AttributeSelector::INSENSITIVE,
                 AttributeSelector::PRESENT,
                 ""s,
@@ -309,7 +309,7 @@ test$("vaev-style-parse-attribute-selectors") {
         Selector::and_({
             ClassSelector{"className"s},
             AttributeSelector{
-                "type"s,
+                Html::TYPE_ATTR,
                 AttributeSelector::INSENSITIVE,
                 AttributeSelector::EXACT,
                 "text"s,
@@ -322,7 +322,7 @@ test$("vaev-style-parse-attribute-selectors") {
         Selector::and_({
             ClassSelector{"className"s},
             AttributeSelector{
-                "type"s,
+                Html::TYPE_ATTR,
                 AttributeSelector::INSENSITIVE,
                 AttributeSelector::EXACT,
                 "text"s,
@@ -335,7 +335,7 @@ test$("vaev-style-parse-attribute-selectors") {
         Selector::and_({
             ClassSelector{"className"s},
             AttributeSelector{
-                "type"s,
+                Html::TYPE_ATTR,
                 AttributeSelector::INSENSITIVE,
                 AttributeSelector::STR_CONTAIN,
                 "text"s,
@@ -348,7 +348,7 @@ test$("vaev-style-parse-attribute-selectors") {
         Selector::and_({
             ClassSelector{"className"s},
             AttributeSelector{
-                "type"s,
+                Html::TYPE_ATTR,
                 AttributeSelector::SENSITIVE,
                 AttributeSelector::EXACT,
                 "text"s,
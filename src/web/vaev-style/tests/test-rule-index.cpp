@@ -0,0 +1,121 @@
+#include <karm-gc/heap.h>
+#include <karm-test/macros.h>
+#include <vaev-style/computer.h>
+
+namespace Vaev::Style::Tests {
+
+static StyleBook _styleBook(Str css) {
+    StyleBook book;
+    Io::SScan s{css};
+    book.add(StyleSheet::parse(s, ""_url));
+    return book;
+}
+
+test$("rule-index-buckets") {
+    Gc::Heap gc;
+    auto book = _styleBook(
+        "div { color: red }"
+        ".a { color: red }"
+        "#x { color: red }"
+        "* { color: red }"
+        "span { color: red }"
+        ".b, p { color: red }"
+        ".c.a { color: red }"
+        "@media screen { .a { color: red } }"
+    );
+    expectEq$(book.index.len(), 8uz);
+
+    auto el = gc.alloc<Dom::Element>(Html::DIV);
+    el->classList.add("a");
+
+    Vec<usize> entries;
+    book.index.collect(*el, entries);
+    expectEq$(entries, (Vec<usize>{0, 1, 3, 7}));
+
+    el->setAttribute(AttrName::make("id", HTML), "x"s);
+    el->classList.add("b");
+
+    entries.clear();
+    book.index.collect(*el, entries);
+    expectEq$(entries, (Vec<usize>{0, 1, 2, 3, 5, 7}));
+    expectEq$(book.index[7].media.len(), 1uz);
+
+    // Compound selectors are only indexed under one of their classes.
+    el->classList.add("c");
+
+    entries.clear();
+    book.index.collect(*el, entries);
+    expectEq$(entries, (Vec<usize>{0, 1, 2, 3, 5, 6, 7}));
+
+    return Ok();
+}
+
+test$("rule-index-ancestor-filter") {
+    Gc::Heap gc;
+    auto html = gc.alloc<Dom::Element>(Html::HTML);
+    auto body = gc.alloc<Dom::Element>(Html::BODY);
+    auto div = gc.alloc<Dom::Element>(Html::DIV);
+    auto p = gc.alloc<Dom::Element>(Html::P);
+    auto span = gc.alloc<Dom::Element>(Html::SPAN);
+    div->classList.add("a");
+    html->appendChild(body);
+    body->appendChild(div);
+    div->appendChild(p);
+    body->appendChild(span);
+
+    AncestorFilter filter;
+    filter.prepare(*p);
+    expectEq$(filter.depth(), 3uz);
+    expect$(filter.mayContain(tagHash(Html::BODY)));
+    expect$(filter.mayContain(classHash("a")));
+    expectNot$(filter.mayContain(classHash("b")));
+    expectNot$(filter.mayContain(tagHash(Html::P)));
+
+    // Moving to a sibling of an ancestor drops the elements below it.
+    filter.push(*p);
+    filter.prepare(*span);
+    expectEq$(filter.depth(), 2uz);
+    expectNot$(filter.mayContain(classHash("a")));
+    expect$(filter.mayContain(tagHash(Html::HTML)));
+
+    Vec<Hash> hashes;
+    collectAncestorHashes(try$(Selector::parse("body .a > p")), hashes);
+    expectEq$(hashes, (Vec<Hash>{classHash("a"), tagHash(Html::BODY)}));
+
+    hashes.clear();
+    collectAncestorHashes(try$(Selector::parse(".a + p")), hashes);
+    expectEq$(hashes.len(), 0uz);
+
+    return Ok();
+}
+
+test$("rule-index-computer-stats") {
+    Gc::Heap gc;
+    auto book = _styleBook(
+        ".missing p { color: red }"
+        ".a p { color: blue }"
+        "span { color: green }"
+    );
+
+    auto div = gc.alloc<Dom::Element>(Html::DIV);
+    auto p = gc.alloc<Dom::Element>(Html::P);
+    div->classList.add("a");
+    div->appendChild(p);
+
+    Text::FontBook fontBook;
+    Media media;
+    Computer computer{media, book, fontBook};
+
+    auto parent = computer.computeFor(Computed::initial(), div);
+    auto style = computer.computeFor(*parent, p);
+
+    auto stats = computer.stats();
+    expectEq$(stats.elements, 2uz);
+    expectEq$(stats.rulesTested, 2uz);
+    expectEq$(stats.fastRejects, 1uz);
+    expectEq$(stats.matches, 1uz);
+
+    return Ok();
+}
+
+} // namespace Vaev::Style::Tests
@@ -21,7 +21,7 @@ test$("select-attr-spec-exact") {
     {
         el->setAttribute(AttrName::make("id", HTML), "test"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::EXACT,
             .value = "test"s,
@@ -32,7 +32,7 @@ test$("select-attr-spec-exact") {
     {
         el->setAttribute(AttrName::make("id", HTML), "tesi"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::EXACT,
             .value = "test"s,
@@ -50,7 +50,7 @@ test$("select-attr-spec-contains") {
     {
         el->setAttribute(AttrName::make("id", HTML), "some test value"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::CONTAINS,
             .value = "test"s,
@@ -61,7 +61,7 @@ test$("select-attr-spec-contains") {
     {
         el->setAttribute(AttrName::make("id", HTML), "some testi value"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::CONTAINS,
             .value = "test"s,
@@ -79,7 +79,7 @@ test$("select-attr-spec-hyphenated") {
     {
         el->setAttribute(AttrName::make("id", HTML), "test-value"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::HYPHENATED,
             .value = "test"s,
@@ -90,7 +90,7 @@ test$("select-attr-spec-hyphenated") {
     {
         el->setAttribute(AttrName::make("id", HTML), "test"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::HYPHENATED,
             .value = "test"s,
@@ -101,7 +101,7 @@ test$("select-attr-spec-hyphenated") {
     {
         el->setAttribute(AttrName::make("id", HTML), "tesi-value"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::HYPHENATED,
             .value = "test"s,
@@ -112,7 +112,7 @@ test$("select-attr-spec-hyphenated") {
     {
         el->setAttribute(AttrName::make("id", HTML), "value-test"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::HYPHENATED,
             .value = "test"s,
@@ -130,7 +130,7 @@ test$("select-attr-spec-str-start-with") {
     {
         el->setAttribute(AttrName::make("id", HTML), "teste"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_START_WITH,
             .value = "test"s,
@@ -141,7 +141,7 @@ test$("select-attr-spec-str-start-with") {
     {
         el->setAttribute(AttrName::make("id", HTML), "tesitest"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_START_WITH,
             .value = "test"s,
@@ -152,7 +152,7 @@ test$("select-attr-spec-str-start-with") {
     {
         el->setAttribute(AttrName::make("id", HTML), ""s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_START_WITH,
             .value = "test"s,
@@ -170,7 +170,7 @@ test$("select-attr-spec-str-end-with") {
     {
         el->setAttribute(AttrName::make("id", HTML), "itest"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_END_WITH,
             .value = "test"s,
@@ -181,7 +181,7 @@ test$("select-attr-spec-str-end-with") {
     {
         el->setAttribute(AttrName::make("id", HTML), "testtesi"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_END_WITH,
             .value = "test"s,
@@ -192,7 +192,7 @@ test$("select-attr-spec-str-end-with") {
     {
         el->setAttribute(AttrName::make("id", HTML), ""s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_END_WITH,
             .value = "test"s,
@@ -210,7 +210,7 @@ test$("select-attr-spec-str-contain") {
     {
         el->setAttribute(AttrName::make("id", HTML), "value-test-value"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_CONTAIN,
             .value = "test"s,
@@ -221,7 +221,7 @@ test$("select-attr-spec-str-contain") {
     {
         el->setAttribute(AttrName::make("id", HTML), "est-tesi-tes"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_CONTAIN,
             .value = "test"s,
@@ -232,7 +232,7 @@ test$("select-attr-spec-str-contain") {
     {
         el->setAttribute(AttrName::make("id", HTML), ""s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_CONTAIN,
             .value = "test"s,
@@ -250,7 +250,7 @@ test$("select-attr-spec-case") {
     {
         el->setAttribute(AttrName::make("id", HTML), "teST"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::INSENSITIVE,
             .match = AttributeSelector::EXACT,
             .value = "test"s,
@@ -261,7 +261,7 @@ test$("select-attr-spec-case") {
     {
         el->setAttribute(AttrName::make("id", HTML), "tesT"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::EXACT,
             .value = "test"s,
@@ -272,7 +272,7 @@ test$("select-attr-spec-case") {
     {
         el->setAttribute(AttrName::make("id", HTML), "teST"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::INSENSITIVE,
             .match = AttributeSelector::CONTAINS,
             .value = "test"s,
@@ -283,7 +283,7 @@ test$("select-attr-spec-case") {
     {
         el->setAttribute(AttrName::make("id", HTML), "tesT"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::CONTAINS,
             .value = "test"s,
@@ -294,7 +294,7 @@ test$("select-attr-spec-case") {
     {
         el->setAttribute(AttrName::make("id", HTML), "teST"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::INSENSITIVE,
             .match = AttributeSelector::STR_START_WITH,
             .value = "test"s,
@@ -305,7 +305,7 @@ test$("select-attr-spec-case") {
     {
         el->setAttribute(AttrName::make("id", HTML), "tesT"s);
         Selector sel = AttributeSelector{
-            .name = "id"s,
+            .name = Html::ID_ATTR,
             .case_ = AttributeSelector::SENSITIVE,
             .match = AttributeSelector::STR_START_WITH,
             .value = "test"s,
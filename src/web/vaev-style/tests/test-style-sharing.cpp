@@ -0,0 +1,53 @@
+#include <karm-gc/heap.h>
+#include <karm-test/macros.h>
+#include <vaev-style/computer.h>
+
+namespace Vaev::Style::Tests {
+
+test$("style-sharing-siblings") {
+    Gc::Heap gc;
+    StyleBook book;
+    Io::SScan s{
+        "li { color: red }"
+        "li.active { color: blue }"
+    };
+    book.add(StyleSheet::parse(s, ""_url));
+
+    auto ul = gc.alloc<Dom::Element>(Html::UL);
+    auto first = gc.alloc<Dom::Element>(Html::LI);
+    auto second = gc.alloc<Dom::Element>(Html::LI);
+    auto active = gc.alloc<Dom::Element>(Html::LI);
+    auto inlined = gc.alloc<Dom::Element>(Html::LI);
+    active->classList.add("active");
+    inlined->setAttribute(Html::STYLE_ATTR, "color: green"s);
+    ul->appendChild(first);
+    ul->appendChild(second);
+    ul->appendChild(active);
+    ul->appendChild(inlined);
+
+    Text::FontBook fontBook;
+    Media media;
+    Computer computer{media, book, fontBook};
+
+    auto parent = computer.computeFor(Computed::initial(), ul);
+    auto firstStyle = computer.computeFor(parent, first);
+    auto secondStyle = computer.computeFor(parent, second);
+    auto activeStyle = computer.computeFor(parent, active);
+    auto inlinedStyle = computer.computeFor(parent, inlined);
+
+    expect$(&*firstStyle == &*secondStyle);
+    expect$(&*firstStyle != &*activeStyle);
+    expect$(&*firstStyle != &*inlinedStyle);
+
+    // Same rules, but a different parent style.
+    auto otherParent = computer.computeFor(Computed::initial(), ul);
+    expect$(&*firstStyle != &*computer.computeFor(otherParent, first));
+
+    auto stats = computer.stats();
+    expectEq$(stats.sharingHits, 1uz);
+    expectEq$(stats.sharingMisses, 4uz);
+
+    return Ok();
+}
+
+} // namespace Vaev::Style::Tests
@@ -1,5 +1,6 @@
 module;
 
+#include <karm-gc/root.h>
 #include <karm-kira/print-dialog.h>
 #include <vaev-dom/document.h>
 
@@ -9,9 +10,9 @@ import Vaev.Driver;
 
 namespace Vaev::View {
 
-export Ui::Child printDialog(Gc::Ref<Dom::Document> dom) {
+export Ui::Child printDialog(Gc::Root<Dom::Document> dom) {
     return Kr::printDialog([dom](Print::Settings const& settings) -> Vec<Print::Page> {
-        return Driver::print(dom, settings) | collect<Vec<Print::Page>>();
+        return Driver::print(dom.ref(), settings) | collect<Vec<Print::Page>>();
     });
 }
 
@@ -1,5 +1,6 @@
 module;
 
+#include <karm-base/lru.h>
 #include <karm-gc/root.h>
 #include <karm-ui/node.h>
 #include <karm-ui/view.h>
@@ -18,9 +19,34 @@ export struct ViewProps {
 };
 
 struct View : public Ui::View<View> {
+    // NOTE: The media only depends on the viewport.
+    struct RenderKey {
+        usize dom;
+        usize generation;
+        Math::Vec2i viewport;
+
+        bool operator==(RenderKey const&) const = default;
+
+        Hash hash() const {
+            Hash h = Karm::hash(dom);
+            h = hashCombine(h, Karm::hash(generation));
+            h = hashCombine(h, Karm::hash(viewport.x));
+            return hashCombine(h, Karm::hash(viewport.y));
+        }
+    };
+
+    static constexpr usize RENDER_CACHE_SIZE = 4;
+
     Gc::Root<Dom::Document> _dom;
     ViewProps _props;
-    Opt<Driver::RenderResult> _renderResult;
+
+    // Measuring and painting the page at the same size happen a lot
+    // during a single layout pass, keep the last few renders around.
+    Lru<RenderKey, Rc<Driver::RenderResult>> _renders{RENDER_CACHE_SIZE};
+
+    // The last render made, the next one starts from its tree when only the
+    // viewport or some text changed.
+    Opt<Rc<Driver::RenderResult>> _last = NONE;
 
     View(Gc::Root<Dom::Document> dom, ViewProps props)
         : _dom(dom), _props(props) {}
@@ -65,25 +91,47 @@ struct View : public Ui::View<View> {
     }
 
     void reconcile(View& o) override {
+        // NOTE: Renders hold on to the nodes of their document, don't keep
+        //       them around once the view has moved on to another one.
+        if (_dom->id() != o._dom->id()) {
+            _renders.clear();
+            _last = NONE;
+        }
         _dom = o._dom;
         _props = o._props;
-        _renderResult = NONE;
+    }
+
+    Rc<Driver::RenderResult> _render(Math::Vec2i viewport) {
+        RenderKey key{_dom->id(), _dom->generation(), viewport};
+        return _renders.access(key, [&] {
+            auto media = _constructMedia(viewport);
+            Layout::Viewport layoutViewport{.small = viewport.cast<Au>()};
+
+            Opt<Driver::RenderResult> result = NONE;
+            if (_last)
+                result = Driver::rerender(*_last.unwrap(), *_dom, media, layoutViewport);
+            if (not result)
+                result = Driver::render(*_dom, media, layoutViewport);
+
+            auto render = makeRc<Driver::RenderResult>(result.take());
+            _last = render;
+            return render;
+        });
     }
 
     void paint(Gfx::Canvas& g, Math::Recti rect) override {
         // Painting browser's viewport.
         auto viewport = bound().size();
-        if (not _renderResult) {
-            auto media = _constructMedia(viewport);
-            _renderResult = Driver::render(*_dom, media, {.small = viewport.cast<Au>()});
-        }
+        auto result = _render(viewport);
 
         g.push();
 
         g.origin(bound().xy.cast<f64>());
         g.clip(viewport);
 
-        auto [_, layout, paint, frag, canvasColor] = *_renderResult;
+        auto& paint = result->scenes;
+        auto& frag = result->frag;
+        auto canvasColor = result->canvasColor;
         auto paintRect = rect.offset(-bound().xy);
 
         if (canvasColor.alpha < 255) {
@@ -100,15 +148,9 @@ struct View : public Ui::View<View> {
         g.pop();
     }
 
-    void layout(Math::Recti bound) override {
-        _renderResult = NONE;
-        Ui::View<View>::layout(bound);
-    }
-
     Math::Vec2i size(Math::Vec2i size, Ui::Hint) override {
-        // FIXME: This is wasteful, we should cache the result
-        auto media = _constructMedia(size);
-        auto [_, layout, _, frag, _] = Driver::render(*_dom, media, {.small = size.cast<Au>()});
+        auto result = _render(size);
+        auto& frag = result->frag;
 
         return {
             frag->metrics.borderBox().width.cast<isize>(),